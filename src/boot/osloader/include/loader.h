@@ -4,9 +4,11 @@
 #ifndef _LOADER_H_
 #define _LOADER_H_
 
+#include <rt/hashtable.h>
 #include <rt/list.h>
 
 typedef struct {
+    RtHashEntry HashEntry;
     const char *Name;
     uint64_t Address;
 } OslpExportEntry;
@@ -22,6 +24,7 @@ typedef struct {
     const char *Name;
     size_t ExportTableSize;
     OslpExportEntry *ExportTable;
+    RtHashTable ExportHashTable;
 } OslpLoadedProgram;
 
 typedef struct {
@@ -6,8 +6,67 @@
 #include <loader.h>
 #include <memory.h>
 #include <pe.h>
+#include <rt/hash.h>
 #include <string.h>
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given export entry has the given name.
+ *
+ * PARAMETERS:
+ *     Entry - Hash table entry of the export.
+ *     Key - Name we're searching for.
+ *
+ * RETURN VALUE:
+ *     1 if the entry matches, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int CompareExport(RtHashEntry *Entry, const void *Key) {
+    return !strcmp(CONTAINING_RECORD(Entry, OslpExportEntry, HashEntry)->Name, Key);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates storage for an export hash table.
+ *
+ * PARAMETERS:
+ *     Size - How many bytes the table needs.
+ *
+ * RETURN VALUE:
+ *     Pointer to the allocated memory, or NULL on failure.
+ *-----------------------------------------------------------------------------------------------*/
+static void *AllocateTable(size_t Size) {
+    void *Base;
+    return gBS->AllocatePool(EfiLoaderData, Size, &Base) == EFI_SUCCESS ? Base : NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function frees storage previously allocated by AllocateTable().
+ *
+ * PARAMETERS:
+ *     Base - Pointer to the memory.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void FreeTable(void *Base) {
+    gBS->FreePool(Base);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hashes the name of an exported symbol.
+ *
+ * PARAMETERS:
+ *     Name - Name of the symbol.
+ *
+ * RETURN VALUE:
+ *     Hash of the name.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t HashExport(const char *Name) {
+    return RtGetXxh3Hash(Name, strlen(Name), 0);
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function loads up the given PE image into memory, and adds it to the loaded programs
@@ -153,6 +212,7 @@ int OslLoadExecutable(RtDList *LoadedPrograms, const char *ImageName, const char
 
     /* Grab up this image's export table, we need it for the next boot step (after we load all
      * images). */
+    RtInitializeHashTable(&ThisProgram->ExportHashTable, CompareExport, AllocateTable, FreeTable);
     if (Header->DataDirectories.ExportTable.Size) {
         PeExportHeader *ExportHeader =
             (PeExportHeader *)((char *)ThisProgram->PhysicalAddress +
@@ -182,6 +242,16 @@ int OslLoadExecutable(RtDList *LoadedPrograms, const char *ImageName, const char
                 (char *)ThisProgram->PhysicalAddress + NamePointers[i];
             ThisProgram->ExportTable[i].Address =
                 Header->ImageBase + AddressTable[ExportOrdinals[i]];
+
+            if (!RtInsertHashTable(
+                    &ThisProgram->ExportHashTable,
+                    &ThisProgram->ExportTable[i].HashEntry,
+                    HashExport(ThisProgram->ExportTable[i].Name))) {
+                OslPrint("Failed to load a kernel/driver file.\r\n");
+                OslPrint("The system ran out of memory while loading %s.\r\n", ImagePath);
+                OslPrint("The boot process cannot continue.\r\n");
+                return 0;
+            }
         }
     } else {
         ThisProgram->ExportTableSize = 0;
@@ -276,17 +346,10 @@ int OslFixupImports(RtDList *LoadedPrograms) {
                     }
 
                     char *SearchName = (char *)ThisProgram->PhysicalAddress + *(ImportTable++) + 2;
-                    int Found = 0;
-
-                    for (size_t i = 0; i < ImportedProgram->ExportTableSize; i++) {
-                        if (!strcmp(ImportedProgram->ExportTable[i].Name, SearchName)) {
-                            *(AddressTable++) = ImportedProgram->ExportTable[i].Address;
-                            Found = 1;
-                            break;
-                        }
-                    }
+                    RtHashEntry *Entry = RtLookupHashTable(
+                        &ImportedProgram->ExportHashTable, HashExport(SearchName), SearchName);
 
-                    if (!Found) {
+                    if (!Entry) {
                         OslPrint("Failed to load a kernel/driver file.\r\n");
                         OslPrint(
                             "The kernel/driver %s tried importing the non-existant symbol %s from "
@@ -297,6 +360,9 @@ int OslFixupImports(RtDList *LoadedPrograms) {
                         OslPrint("The boot process cannot continue.\r\n");
                         return 0;
                     }
+
+                    *(AddressTable++) =
+                        CONTAINING_RECORD(Entry, OslpExportEntry, HashEntry)->Address;
                 }
 
                 ImportHeader++;
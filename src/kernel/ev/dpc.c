@@ -1,8 +1,9 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <ev.h>
+#include <evp.h>
 #include <halp.h>
+#include <psp.h>
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -21,11 +22,51 @@
 void EvInitializeDpc(EvDpc *Dpc, void (*Routine)(void *Context), void *Context) {
     Dpc->Routine = Routine;
     Dpc->Context = Context;
+    Dpc->Importance = EV_DPC_IMPORTANCE_MEDIUM;
+    Dpc->Inserted = 0;
+    Dpc->TargetProcessor = EV_DPC_TARGET_CURRENT;
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function adds a previously initialized DPC to this processor's list.
+ *     This function sets how urgently the DPC needs to run once dispatched. High importance DPCs
+ *     go to the front of the queue and always interrupt the target processor, medium importance
+ *     DPCs only interrupt remote processors that are idle, and low importance DPCs are batched
+ *     until the next clock tick (or until too many of them pile up).
+ *
+ * PARAMETERS:
+ *     Dpc - DPC context struct.
+ *     Importance - One of the EV_DPC_IMPORTANCE_* values.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void EvSetImportanceDpc(EvDpc *Dpc, int Importance) {
+    Dpc->Importance = Importance;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function binds the DPC to a specific processor, instead of whichever processor calls
+ *     EvDispatchDpc().
+ *
+ * PARAMETERS:
+ *     Dpc - DPC context struct.
+ *     Number - Index of the target processor, or EV_DPC_TARGET_CURRENT to go back to running on
+ *              the dispatching processor.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void EvSetTargetProcessorDpc(EvDpc *Dpc, uint32_t Number) {
+    Dpc->TargetProcessor = Number;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a previously initialized DPC to the target processor's list (or to this
+ *     processor's list if no target was set). Dispatching a DPC that is already queued does
+ *     nothing.
  *
  * PARAMETERS:
  *     Dpc - DPC context struct.
@@ -35,10 +76,170 @@ void EvInitializeDpc(EvDpc *Dpc, void (*Routine)(void *Context), void *Context)
  *-----------------------------------------------------------------------------------------------*/
 void EvDispatchDpc(EvDpc *Dpc) {
     void *Context = HalpEnterCriticalSection();
-    RtAppendDList(&HalGetCurrentProcessor()->DpcQueue, &Dpc->ListHeader);
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    KeProcessor *Target = Processor;
+
+    if (Dpc->TargetProcessor != EV_DPC_TARGET_CURRENT && HalpProcessorList &&
+        Dpc->TargetProcessor < HalpProcessorCount) {
+        Target = HalpProcessorList[Dpc->TargetProcessor];
+    }
+
+    /* Claim the DPC before touching any queue; The target processor can change while the DPC is
+     * still queued somewhere else, so checking this under the target's lock wouldn't be enough to
+     * stop it from getting linked into two queues at once. */
+    int Expected = 0;
+    if (!__atomic_compare_exchange_n(
+            &Dpc->Inserted, &Expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        HalpLeaveCriticalSection(Context);
+        return;
+    }
+
+    KeAcquireSpinLockHighIrql(&Target->DpcQueueLock);
+
+    /* Don't touch the DPC after releasing the lock; It can run (and get freed by its owner) right
+     * after we're out. */
+    int Importance = Dpc->Importance;
+    if (Importance == EV_DPC_IMPORTANCE_HIGH) {
+        RtPushDList(&Target->DpcQueue, &Dpc->ListHeader);
+    } else {
+        RtAppendDList(&Target->DpcQueue, &Dpc->ListHeader);
+    }
+
+    Dpc->QueueTime = HalGetTime();
+    uint32_t QueueSize = ++Target->DpcQueueSize;
+    KeReleaseSpinLockHighIrql(&Target->DpcQueueLock);
+
+    /* Figure out if the target processor needs to know about this right now, or if it can wait
+     * until its next clock tick. */
+    int Notify = 0;
+    if (Importance == EV_DPC_IMPORTANCE_HIGH) {
+        Notify = 1;
+    } else if (Target != Processor && Importance == EV_DPC_IMPORTANCE_MEDIUM) {
+        Notify = Target->CurrentThread == Target->IdleThread;
+    } else if (Target != Processor) {
+        Notify = QueueSize >= EVP_DPC_BATCH_SIZE;
+    }
+
+    if (Notify) {
+        HalpNotifyProcessor(Target, 0);
+    }
+
     HalpLeaveCriticalSection(Context);
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs the pending DPCs of the given processor, until either the queue is empty,
+ *     or we ran out of budget for this pass. We expect to already be at the DISPATCH IRQL.
+ *     How long each DPC sat in the queue also gets recorded here.
+ *
+ * PARAMETERS:
+ *     Processor - Which processor's queue we're draining (should be the current one).
+ *
+ * RETURN VALUE:
+ *     1 if there are still pending DPCs, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int DrainQueue(KeProcessor *Processor) {
+    uint64_t CurrentTime = HalGetTime();
+    uint64_t Deadline = CurrentTime + EVP_DPC_BUDGET_TIME;
+
+    for (int i = 0; i < EVP_DPC_BUDGET_COUNT; i++) {
+        void *Context = HalpEnterCriticalSection();
+        KeAcquireSpinLockHighIrql(&Processor->DpcQueueLock);
+
+        RtDList *ListHeader = RtPopDList(&Processor->DpcQueue);
+        if (ListHeader == &Processor->DpcQueue) {
+            KeReleaseSpinLockHighIrql(&Processor->DpcQueueLock);
+            HalpLeaveCriticalSection(Context);
+            return 0;
+        }
+
+        /* Save the routine and context before unlocking, the DPC is free to be reinitialized and
+         * requeued once we're out. */
+        EvDpc *Dpc = CONTAINING_RECORD(ListHeader, EvDpc, ListHeader);
+        void (*Routine)(void *) = Dpc->Routine;
+        void *RoutineContext = Dpc->Context;
+        uint64_t QueueTime = Dpc->QueueTime;
+        __atomic_store_n(&Dpc->Inserted, 0, __ATOMIC_RELEASE);
+        Processor->DpcQueueSize--;
+
+        KeReleaseSpinLockHighIrql(&Processor->DpcQueueLock);
+        HalpLeaveCriticalSection(Context);
+
+        /* The DPC might have been queued by another processor, whose view of the time can be
+         * slightly behind ours. */
+        KeRecordHistogram(
+            &Processor->Histograms[KE_HISTOGRAM_DPC_DELAY],
+            CurrentTime > QueueTime ? CurrentTime - QueueTime : 0);
+
+        Routine(RoutineContext);
+
+        CurrentTime = HalGetTime();
+        if (CurrentTime >= Deadline) {
+            break;
+        }
+    }
+
+    return __atomic_load_n(&Processor->DpcQueueSize, __ATOMIC_RELAXED) != 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function is the entry point of the per-processor DPC thread. We only get scheduled
+ *     when a dispatch pass runs out of budget, and we keep draining the queue (in budget sized
+ *     chunks, so that other threads still get to run) until it's empty.
+ *
+ * PARAMETERS:
+ *     None that we make use of.
+ *
+ * RETURN VALUE:
+ *     Does not return.
+ *-----------------------------------------------------------------------------------------------*/
+[[noreturn]] static void DpcThread(void *) {
+    while (1) {
+        KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+        KeProcessor *Processor = HalGetCurrentProcessor();
+
+        /* We're only ever readied by EvpProcessQueue on our own processor, and that only happens
+         * at DISPATCH, so there's no race between checking the queue and going to sleep. */
+        if (!DrainQueue(Processor)) {
+            Processor->DpcThreadActive = 0;
+            PsYieldExecution(PS_YIELD_WAITING);
+        } else if (Processor->ThreadQueueSize) {
+            PsYieldExecution(PS_YIELD_NORMAL);
+        }
+
+        KeLowerIrql(OldIrql);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function creates the DPC thread for this processor. It won't be scheduled until the
+ *     first time the DPC queue overflows.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void EvpCreateDpcThread(void) {
+    PsThread *Thread = PsCreateThread(DpcThread, NULL);
+    if (!Thread) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_SCHEDULER_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0,
+            0);
+    }
+
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    Thread->BoundProcessor = Processor->Number;
+    Processor->DpcThread = Thread;
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function handles dispatching any pending events in the processor queue. We expect to
@@ -52,7 +253,7 @@ void EvDispatchDpc(EvDpc *Dpc) {
  *-----------------------------------------------------------------------------------------------*/
 void EvpProcessQueue(HalInterruptFrame *) {
     KeProcessor *Processor = HalGetCurrentProcessor();
-    uint64_t CurrentTicks = HalGetTimerTicks();
+    uint64_t CurrentTime = HalGetTime();
     KeIrql Irql = KeGetIrql();
     if (Irql != KE_IRQL_DISPATCH) {
         KeFatalError(KE_PANIC_IRQL_NOT_DISPATCH, Irql, 0, 0, 0);
@@ -67,9 +268,7 @@ void EvpProcessQueue(HalInterruptFrame *) {
 
         /* Out of the deadline, for anything but timers, this will make WaitObject return an
            error. */
-        if (Header->DeadlineTicks &&
-            HalCheckTimerExpiration(
-                CurrentTicks, Header->DeadlineReference, Header->DeadlineTicks)) {
+        if (Header->Deadline && CurrentTime >= Header->Deadline) {
             Header->Finished = 1;
         }
 
@@ -78,22 +277,23 @@ void EvpProcessQueue(HalInterruptFrame *) {
             RtUnlinkDList(&Header->ListHeader);
 
             if (Header->Source) {
-                /* Boost the priority of the waiting task, and insert it back. */
-                KeIrql OldIrql = KeAcquireSpinLock(&Processor->ThreadQueueLock);
-                RtPushDList(&Processor->ThreadQueue, &Header->Source->ListHeader);
-                __atomic_add_fetch(&Processor->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
-                KeReleaseSpinLock(&Processor->ThreadQueueLock, OldIrql);
+                Header->Source->WakeupTime = CurrentTime;
+
+                /* Boost the priority of the waiting task, and insert it back (preferably close to
+                 * where it was running). */
+                PspReadyThread(Header->Source, 1);
             }
 
             if (Header->Dpc) {
-                RtAppendDList(&Processor->DpcQueue, &Header->Dpc->ListHeader);
+                EvDispatchDpc(Header->Dpc);
             }
         }
     }
 
-    /* Process any pending DPCs. */
-    while (Processor->DpcQueue.Next != &Processor->DpcQueue) {
-        EvDpc *Dpc = CONTAINING_RECORD(RtPopDList(&Processor->DpcQueue), EvDpc, ListHeader);
-        Dpc->Routine(Dpc->Context);
+    /* Process any pending DPCs; If we ran out of budget, wake up the DPC thread to handle the
+     * rest (unless it's already awake). */
+    if (DrainQueue(Processor) && Processor->DpcThread && !Processor->DpcThreadActive) {
+        Processor->DpcThreadActive = 1;
+        PspQueueThread(Processor, Processor->DpcThread, 1);
     }
 }
@@ -22,7 +22,7 @@
  *-----------------------------------------------------------------------------------------------*/
 void EvpDispatchObject(void *Object, uint64_t Timeout, int Yield) {
     KeProcessor *Processor = HalGetCurrentProcessor();
-    uint64_t CurrentTicks = HalGetTimerTicks();
+    uint64_t CurrentTime = HalGetTime();
     EvHeader *Header = Object;
 
     /* Enter critical section (can't let any scheduling happen here), and update the event
@@ -36,10 +36,9 @@ void EvpDispatchObject(void *Object, uint64_t Timeout, int Yield) {
     /* Ignore the target timeout for already dispatched objects (we probably just want to yield
        this thread out). */
     if (!Header->Dispatched) {
-        Header->DeadlineTicks = 0;
-        if (Timeout) {
-            Header->DeadlineReference = CurrentTicks;
-            Header->DeadlineTicks = Timeout / HalGetTimerPeriod();
+        Header->Deadline = Timeout ? CurrentTime + Timeout : 0;
+        if (Header->Deadline) {
+            HalSetNextTimerEvent(Header->Deadline);
         }
 
         RtAppendDList(&HalGetCurrentProcessor()->EventQueue, &Header->ListHeader);
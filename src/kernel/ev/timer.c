@@ -3,6 +3,7 @@
 
 #include <evp.h>
 #include <halp.h>
+#include <psp.h>
 #include <string.h>
 
 /*-------------------------------------------------------------------------------------------------
@@ -27,7 +28,9 @@ void EvInitializeTimer(EvTimer *Timer, uint64_t Timeout, EvDpc *Dpc) {
        (just set us as finished). */
     if (!Timeout) {
         Timer->Finished = 1;
-        EvDispatchDpc(Dpc);
+        if (Dpc) {
+            EvDispatchDpc(Dpc);
+        }
         return;
     }
 
@@ -46,37 +49,43 @@ void EvInitializeTimer(EvTimer *Timer, uint64_t Timeout, EvDpc *Dpc) {
  *-----------------------------------------------------------------------------------------------*/
 void EvpHandleTimer(HalInterruptFrame *) {
     KeProcessor *Processor = HalGetCurrentProcessor();
-    uint64_t CurrentTicks = HalGetTimerTicks();
+    uint64_t CurrentTime = HalGetTime();
+    uint64_t NextEvent = CurrentTime + EVP_TIMER_TICK;
     int TriggerEvent = 0;
 
-    /* Check our pending events. */
+    /* Check our pending events (and find the closest deadline that's still in the future). */
     RtDList *ListHeader = Processor->EventQueue.Next;
     while (ListHeader != &Processor->EventQueue) {
         EvHeader *Header = CONTAINING_RECORD(ListHeader, EvHeader, ListHeader);
         ListHeader = ListHeader->Next;
-        if ((Header->DeadlineTicks &&
-             HalCheckTimerExpiration(
-                 CurrentTicks, Header->DeadlineReference, Header->DeadlineTicks)) ||
-            Header->Finished) {
+        if ((Header->Deadline && CurrentTime >= Header->Deadline) || Header->Finished) {
             TriggerEvent = 1;
+        } else if (Header->Deadline && Header->Deadline < NextEvent) {
+            NextEvent = Header->Deadline;
         }
     }
 
-    /* Check if we have any DPCs (we should probably only trigger the dispatch event if we have
-     * enough DPCs, or one of the other events).*/
-    if (Processor->DpcQueue.Next != &Processor->DpcQueue) {
+    /* Update the load average (this might also queue up the load balancer). */
+    PspUpdateLoad(Processor, CurrentTime);
+
+    /* Check if we have any DPCs (this is where batched low importance DPCs get picked up). */
+    if (__atomic_load_n(&Processor->DpcQueueSize, __ATOMIC_RELAXED)) {
         TriggerEvent = 1;
     }
 
     /* At last, check for a quantum expiration (thread swap). */
     if (Processor->CurrentThread) {
         PsThread *CurrentThread = Processor->CurrentThread;
-        if (HalCheckTimerExpiration(
-                CurrentTicks, CurrentThread->ExpirationReference, CurrentThread->ExpirationTicks)) {
+        if (CurrentTime >= CurrentThread->ExpirationTime) {
             TriggerEvent = 1;
+        } else if (CurrentThread->ExpirationTime < NextEvent) {
+            NextEvent = CurrentThread->ExpirationTime;
         }
     }
 
+    /* The timer is one-shot, so we need to rearm it ourselves. */
+    HalSetNextTimerEvent(NextEvent);
+
     /* Finally, trigger an event at dispatch IRQL if we need to do anything else. */
     if (TriggerEvent) {
         HalpNotifyProcessor(Processor, 0);
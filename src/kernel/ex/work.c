@@ -0,0 +1,642 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <exp.h>
+#include <halp.h>
+#include <mm.h>
+#include <psp.h>
+
+typedef struct {
+    KeSpinLock Lock;
+    RtDList ItemQueue;
+    RtDList WorkerList;
+    RtDList IdleList;
+    RtDList FlushList;
+    uint32_t FlushWaiters;
+    uint32_t Processor;
+    uint32_t NextProcessor;
+    uint32_t WorkerCount;
+    uint32_t RunningCount;
+    uint32_t MaxWorkers;
+    uint32_t MaxRunning;
+    int Creating;
+    EvDpc CreateDpc;
+} WorkQueue;
+
+typedef struct {
+    RtDList ListHeader;
+    RtDList IdleListHeader;
+    WorkQueue *Queue;
+    PsThread *Thread;
+    EvDpc WakeDpc;
+    ExWorkItem *Batch[EXP_WORKER_BATCH_SIZE];
+    uint32_t BatchSize;
+    uint32_t BatchIndex;
+    int Executing;
+    int Sleeping;
+    int WakePending;
+} Worker;
+
+typedef struct {
+    RtDList ListHeader;
+    ExWorkItem *Item;
+    PsThread *Thread;
+    EvDpc WakeDpc;
+    int Sleeping;
+    int WakePending;
+} FlushWaiter;
+
+static WorkQueue *BoundQueues = NULL;
+static WorkQueue UnboundQueue = {};
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function puts the current worker to sleep until someone calls WakeDpc() for it.
+ *
+ * PARAMETERS:
+ *     Self - Worker structure of the current thread.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void Sleep(Worker *Self) {
+    /* The wake DPC targets our processor, and DPCs only run at DISPATCH, so raising to DISPATCH is
+     * enough to make checking the pending flag + yielding atomic. */
+    KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+
+    if (!Self->WakePending) {
+        Self->Sleeping = 1;
+        PsYieldExecution(PS_YIELD_WAITING);
+    }
+
+    Self->WakePending = 0;
+    KeLowerIrql(OldIrql);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs on the processor a worker is pinned to, putting it back into the ready
+ *     queue (or flagging it so that it doesn't go to sleep, if it hasn't gotten there yet).
+ *
+ * PARAMETERS:
+ *     Context - Worker structure.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void WakeDpc(void *Context) {
+    Worker *Target = Context;
+
+    if (Target->Sleeping) {
+        Target->Sleeping = 0;
+        Target->Thread->WakeupTime = HalGetTime();
+        PspQueueThread(HalGetCurrentProcessor(), Target->Thread, 0);
+    } else {
+        Target->WakePending = 1;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function locks the queue the given work item was last added to. The item can be
+ *     requeued into another queue at any moment, so we need to check that it's still the same
+ *     queue after taking the lock (and retry otherwise).
+ *
+ * PARAMETERS:
+ *     Item - Work item struct.
+ *     OldIrql - Output; IRQL to be restored when releasing the queue lock.
+ *
+ * RETURN VALUE:
+ *     Which queue we locked, or NULL if the item was never queued.
+ *-----------------------------------------------------------------------------------------------*/
+static WorkQueue *LockItemQueue(ExWorkItem *Item, KeIrql *OldIrql) {
+    while (1) {
+        WorkQueue *Queue = __atomic_load_n(&Item->Queue, __ATOMIC_ACQUIRE);
+        if (!Queue) {
+            return NULL;
+        }
+
+        *OldIrql = KeAcquireSpinLock(&Queue->Lock);
+        if (__atomic_load_n(&Item->Queue, __ATOMIC_RELAXED) == Queue) {
+            return Queue;
+        }
+
+        KeReleaseSpinLock(&Queue->Lock, *OldIrql);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given work item is either queued, or grabbed by a worker and not
+ *     finished yet. We expect the lock of the queue the item was added to be held.
+ *
+ * PARAMETERS:
+ *     Queue - Which queue the item was added to.
+ *     Item - Work item struct.
+ *
+ * RETURN VALUE:
+ *     1 if the item is still pending, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int IsItemPending(WorkQueue *Queue, ExWorkItem *Item) {
+    int Pending = __atomic_load_n(&Item->Queued, __ATOMIC_RELAXED) == EXP_ITEM_QUEUED;
+    for (RtDList *ListHeader = Queue->WorkerList.Next; !Pending && ListHeader != &Queue->WorkerList;
+         ListHeader = ListHeader->Next) {
+        Worker *Entry = CONTAINING_RECORD(ListHeader, Worker, ListHeader);
+        uint32_t BatchIndex = __atomic_load_n(&Entry->BatchIndex, __ATOMIC_SEQ_CST);
+        for (uint32_t i = BatchIndex; i < Entry->BatchSize; i++) {
+            if (Entry->Batch[i] == Item) {
+                Pending = 1;
+                break;
+            }
+        }
+    }
+
+    return Pending;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs on the processor a thread sleeping in ExFlushWorkItem() went to sleep on,
+ *     putting it back into the ready queue (or flagging it so that it doesn't go to sleep, if it
+ *     hasn't gotten there yet).
+ *
+ * PARAMETERS:
+ *     Context - Flush waiter structure.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void FlushWakeDpc(void *Context) {
+    FlushWaiter *Waiter = Context;
+
+    if (Waiter->Sleeping) {
+        Waiter->Sleeping = 0;
+        Waiter->Thread->WakeupTime = HalGetTime();
+        PspQueueThread(HalGetCurrentProcessor(), Waiter->Thread, 1);
+    } else {
+        Waiter->WakePending = 1;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function wakes up everyone in ExFlushWorkItem() whose item isn't pending anymore.
+ *     Workers call this after finishing an item, if anyone is waiting on the queue.
+ *
+ * PARAMETERS:
+ *     Queue - Which queue the finished item came from.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void WakeFlushWaiters(WorkQueue *Queue) {
+    KeIrql OldIrql = KeAcquireSpinLock(&Queue->Lock);
+
+    RtDList *ListHeader = Queue->FlushList.Next;
+    while (ListHeader != &Queue->FlushList) {
+        FlushWaiter *Waiter = CONTAINING_RECORD(ListHeader, FlushWaiter, ListHeader);
+        ListHeader = ListHeader->Next;
+
+        if (!IsItemPending(Queue, Waiter->Item)) {
+            RtUnlinkDList(&Waiter->ListHeader);
+            __atomic_sub_fetch(&Queue->FlushWaiters, 1, __ATOMIC_RELAXED);
+            EvDispatchDpc(&Waiter->WakeDpc);
+        }
+    }
+
+    KeReleaseSpinLock(&Queue->Lock, OldIrql);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets another worker running for the given queue, either by waking an idle
+ *     worker up, or by asking for a new one to be created. We expect the queue lock to be held.
+ *
+ * PARAMETERS:
+ *     Queue - Which queue needs another worker.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void WakeWorker(WorkQueue *Queue) {
+    if (Queue->IdleList.Next != &Queue->IdleList) {
+        Worker *Target =
+            CONTAINING_RECORD(RtPopDList(&Queue->IdleList), Worker, IdleListHeader);
+        Queue->RunningCount++;
+        EvDispatchDpc(&Target->WakeDpc);
+        return;
+    }
+
+    if (Queue->Creating || Queue->WorkerCount >= Queue->MaxWorkers) {
+        return;
+    }
+
+    /* Unbound workers get spread across all processors. */
+    uint32_t Processor = Queue->Processor;
+    if (Processor == EV_DPC_TARGET_CURRENT) {
+        Processor = Queue->NextProcessor++ % HalpProcessorCount;
+    }
+
+    Queue->Creating = 1;
+    EvSetTargetProcessorDpc(&Queue->CreateDpc, Processor);
+    EvDispatchDpc(&Queue->CreateDpc);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function is the entry point of all worker threads; We grab batches of items from our
+ *     queue, and go to sleep once it's empty.
+ *
+ * PARAMETERS:
+ *     Context - Worker structure.
+ *
+ * RETURN VALUE:
+ *     Does not return.
+ *-----------------------------------------------------------------------------------------------*/
+[[noreturn]] static void WorkerThread(void *Context) {
+    Worker *Self = Context;
+    WorkQueue *Queue = Self->Queue;
+
+    while (1) {
+        KeIrql OldIrql = KeAcquireSpinLock(&Queue->Lock);
+
+        uint32_t BatchSize = 0;
+        while (BatchSize < EXP_WORKER_BATCH_SIZE && Queue->ItemQueue.Next != &Queue->ItemQueue) {
+            ExWorkItem *Item =
+                CONTAINING_RECORD(RtPopDList(&Queue->ItemQueue), ExWorkItem, ListHeader);
+            __atomic_store_n(&Item->Queued, EXP_ITEM_IDLE, __ATOMIC_RELEASE);
+            Self->Batch[BatchSize++] = Item;
+        }
+
+        Self->BatchSize = BatchSize;
+        Self->BatchIndex = 0;
+
+        if (!BatchSize) {
+            RtPushDList(&Queue->IdleList, &Self->IdleListHeader);
+            Queue->RunningCount--;
+            KeReleaseSpinLock(&Queue->Lock, OldIrql);
+            Sleep(Self);
+            continue;
+        }
+
+        KeReleaseSpinLock(&Queue->Lock, OldIrql);
+
+        /* Items might free themselves (including the item struct), so save everything we need
+         * before the call, and only compare against the pointers afterwards.
+         * The BatchIndex store and the FlushWaiters load pair up with the opposite order in
+         * ExFlushWorkItem(); Either we see the waiter, or it sees the item as finished. */
+        Self->Executing = 1;
+        for (uint32_t i = 0; i < BatchSize; i++) {
+            ExWorkItem *Item = Self->Batch[i];
+            Item->Routine(Item->Context);
+            __atomic_store_n(&Self->BatchIndex, i + 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&Queue->FlushWaiters, __ATOMIC_SEQ_CST)) {
+                WakeFlushWaiters(Queue);
+            }
+        }
+        Self->Executing = 0;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function creates a new worker for the given queue, pinning it to the processor we're
+ *     running on.
+ *
+ * PARAMETERS:
+ *     Context - Which queue needs a new worker.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void CreateDpc(void *Context) {
+    WorkQueue *Queue = Context;
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    KeIrql OldIrql = KeAcquireSpinLock(&Queue->Lock);
+
+    /* Someone might have already picked the work up while we were waiting to run. */
+    Queue->Creating = 0;
+    if (Queue->ItemQueue.Next == &Queue->ItemQueue || Queue->RunningCount >= Queue->MaxRunning ||
+        Queue->WorkerCount >= Queue->MaxWorkers) {
+        KeReleaseSpinLock(&Queue->Lock, OldIrql);
+        return;
+    }
+
+    /* Failing here isn't fatal, we'll just try again on the next ExQueueWorkItem. */
+    Worker *NewWorker = MmAllocatePool(sizeof(Worker), "Ex  ");
+    if (!NewWorker) {
+        KeReleaseSpinLock(&Queue->Lock, OldIrql);
+        return;
+    }
+
+    NewWorker->Queue = Queue;
+    NewWorker->Thread = PsCreateThread(WorkerThread, NewWorker);
+    if (!NewWorker->Thread) {
+        MmFreePool(NewWorker, "Ex  ");
+        KeReleaseSpinLock(&Queue->Lock, OldIrql);
+        return;
+    }
+
+    NewWorker->Thread->BoundProcessor = Processor->Number;
+    NewWorker->Thread->Worker = NewWorker;
+    EvInitializeDpc(&NewWorker->WakeDpc, WakeDpc, NewWorker);
+    EvSetImportanceDpc(&NewWorker->WakeDpc, EV_DPC_IMPORTANCE_HIGH);
+    EvSetTargetProcessorDpc(&NewWorker->WakeDpc, Processor->Number);
+
+    RtAppendDList(&Queue->WorkerList, &NewWorker->ListHeader);
+    Queue->WorkerCount++;
+    Queue->RunningCount++;
+    KeReleaseSpinLock(&Queue->Lock, OldIrql);
+
+    PspQueueThread(Processor, NewWorker->Thread, 0);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes a single work queue.
+ *
+ * PARAMETERS:
+ *     Queue - Which queue to initialize.
+ *     Processor - Processor all workers should be pinned to, or EV_DPC_TARGET_CURRENT for the
+ *                 unbound queue.
+ *     MaxWorkers - How many workers this queue can have in total.
+ *     MaxRunning - How many workers can be running (not blocked) at once.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void InitializeQueue(
+    WorkQueue *Queue,
+    uint32_t Processor,
+    uint32_t MaxWorkers,
+    uint32_t MaxRunning) {
+    RtInitializeDList(&Queue->ItemQueue);
+    RtInitializeDList(&Queue->WorkerList);
+    RtInitializeDList(&Queue->IdleList);
+    RtInitializeDList(&Queue->FlushList);
+    Queue->Processor = Processor;
+    Queue->MaxWorkers = MaxWorkers;
+    Queue->MaxRunning = MaxRunning;
+    EvInitializeDpc(&Queue->CreateDpc, CreateDpc, Queue);
+    EvSetImportanceDpc(&Queue->CreateDpc, EV_DPC_IMPORTANCE_HIGH);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sets up the per-processor and unbound work queues. No worker threads are
+ *     created until some work gets queued. We should only be called by the BSP, after all
+ *     processors are online.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void ExpInitializeWorkQueues(void) {
+    BoundQueues = MmAllocatePool(HalpProcessorCount * sizeof(WorkQueue), "Ex  ");
+    if (!BoundQueues) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_SCHEDULER_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0,
+            0);
+    }
+
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        InitializeQueue(&BoundQueues[i], i, EXP_MAX_BOUND_WORKERS, 1);
+    }
+
+    InitializeQueue(
+        &UnboundQueue,
+        EV_DPC_TARGET_CURRENT,
+        HalpProcessorCount * EXP_MAX_UNBOUND_WORKERS_PER_PROCESSOR,
+        HalpProcessorCount);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets called by the scheduler when a thread is about to block; If it's a
+ *     worker in the middle of running an item, we make sure the rest of its queue doesn't stall
+ *     behind it.
+ *
+ * PARAMETERS:
+ *     Thread - Which thread is blocking.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void ExpNotifyWorkerBlocked(PsThread *Thread) {
+    Worker *Self = Thread->Worker;
+    if (!Self || !Self->Executing) {
+        return;
+    }
+
+    WorkQueue *Queue = Self->Queue;
+    KeIrql OldIrql = KeAcquireSpinLock(&Queue->Lock);
+
+    Queue->RunningCount--;
+    if (Queue->ItemQueue.Next != &Queue->ItemQueue && Queue->RunningCount < Queue->MaxRunning) {
+        WakeWorker(Queue);
+    }
+
+    KeReleaseSpinLock(&Queue->Lock, OldIrql);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets called by the scheduler once a thread that blocked in
+ *     ExpNotifyWorkerBlocked() gets to run again.
+ *
+ * PARAMETERS:
+ *     Thread - Which thread is running again.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void ExpNotifyWorkerRunning(PsThread *Thread) {
+    Worker *Self = Thread->Worker;
+    if (!Self || !Self->Executing) {
+        return;
+    }
+
+    KeIrql OldIrql = KeAcquireSpinLock(&Self->Queue->Lock);
+    Self->Queue->RunningCount++;
+    KeReleaseSpinLock(&Self->Queue->Lock, OldIrql);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes the given work item.
+ *     Do not try manually initializing the struct, there's no guarantee its fields will stay the
+ *     same across different kernel revisions!
+ *
+ * PARAMETERS:
+ *     Item - Work item struct.
+ *     Routine - What should be executed (at PASSIVE IRQL).
+ *     Context - Context for the routine.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void ExInitializeWorkItem(ExWorkItem *Item, void (*Routine)(void *Context), void *Context) {
+    Item->Routine = Routine;
+    Item->Context = Context;
+    Item->Queue = NULL;
+    Item->Queued = EXP_ITEM_IDLE;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a list of work items to the given queue, taking the queue lock (and
+ *     waking up a worker) only once for the whole list.
+ *     This can be called at up to DISPATCH IRQL.
+ *
+ * PARAMETERS:
+ *     Items - List of previously initialized work items.
+ *     Count - How many items the list has.
+ *     Queue - EX_WORK_QUEUE_BOUND to run the items on a worker pinned to the current processor,
+ *             or EX_WORK_QUEUE_UNBOUND to run them on any processor.
+ *
+ * RETURN VALUE:
+ *     How many items were queued (items that were already queued are skipped).
+ *-----------------------------------------------------------------------------------------------*/
+size_t ExQueueWorkItemBatch(ExWorkItem **Items, size_t Count, int Queue) {
+    KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+    WorkQueue *Target = &UnboundQueue;
+    if (Queue == EX_WORK_QUEUE_BOUND) {
+        Target = &BoundQueues[HalGetCurrentProcessor()->Number];
+    }
+
+    KeAcquireSpinLock(&Target->Lock);
+
+    /* The item might be getting added to some other queue at the same time (under another lock),
+     * so claim it atomically before linking it. */
+    size_t Queued = 0;
+    for (size_t i = 0; i < Count; i++) {
+        int Expected = EXP_ITEM_IDLE;
+        if (!__atomic_compare_exchange_n(
+                &Items[i]->Queued,
+                &Expected,
+                EXP_ITEM_INSERTING,
+                0,
+                __ATOMIC_ACQUIRE,
+                __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        RtAppendDList(&Target->ItemQueue, &Items[i]->ListHeader);
+        __atomic_store_n(&Items[i]->Queue, Target, __ATOMIC_RELEASE);
+        __atomic_store_n(&Items[i]->Queued, EXP_ITEM_QUEUED, __ATOMIC_RELEASE);
+        Queued++;
+    }
+
+    if (Queued && Target->RunningCount < Target->MaxRunning) {
+        WakeWorker(Target);
+    }
+
+    KeReleaseSpinLock(&Target->Lock, OldIrql);
+    return Queued;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a previously initialized work item to the given queue.
+ *     This can be called at up to DISPATCH IRQL.
+ *
+ * PARAMETERS:
+ *     Item - Work item struct.
+ *     Queue - EX_WORK_QUEUE_BOUND to run the item on a worker pinned to the current processor,
+ *             or EX_WORK_QUEUE_UNBOUND to run it on any processor.
+ *
+ * RETURN VALUE:
+ *     1 if the item was queued, 0 if it was already queued.
+ *-----------------------------------------------------------------------------------------------*/
+int ExQueueWorkItem(ExWorkItem *Item, int Queue) {
+    return ExQueueWorkItemBatch(&Item, 1, Queue) != 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes a work item from its queue, if it hasn't been picked up by a worker
+ *     yet. Use ExFlushWorkItem() if you need to make sure it also isn't running anymore.
+ *     This can be called at up to DISPATCH IRQL.
+ *
+ * PARAMETERS:
+ *     Item - Work item struct.
+ *
+ * RETURN VALUE:
+ *     1 if the item was removed from the queue, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+int ExCancelWorkItem(ExWorkItem *Item) {
+    KeIrql OldIrql;
+    WorkQueue *Queue = LockItemQueue(Item, &OldIrql);
+    if (!Queue) {
+        return 0;
+    }
+
+    /* EXP_ITEM_INSERTING means someone is still adding the item to another queue; That can only
+     * be seen as a race with the caller, so we just say we didn't cancel it. */
+    int Cancelled = __atomic_load_n(&Item->Queued, __ATOMIC_RELAXED) == EXP_ITEM_QUEUED;
+    if (Cancelled) {
+        RtUnlinkDList(&Item->ListHeader);
+        __atomic_store_n(&Item->Queued, EXP_ITEM_IDLE, __ATOMIC_RELEASE);
+    }
+
+    KeReleaseSpinLock(&Queue->Lock, OldIrql);
+    return Cancelled;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function waits until the given work item has finished running (if it's queued or
+ *     running at all). We sleep until the worker that runs the item wakes us up, instead of
+ *     polling. The item must not requeue itself, and this must not be called from the item itself.
+ *     This should only be called at PASSIVE IRQL.
+ *
+ * PARAMETERS:
+ *     Item - Work item struct.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void ExFlushWorkItem(ExWorkItem *Item) {
+    FlushWaiter Waiter;
+    Waiter.Item = Item;
+    Waiter.Thread = HalGetCurrentProcessor()->CurrentThread;
+    Waiter.Sleeping = 0;
+    Waiter.WakePending = 0;
+    EvInitializeDpc(&Waiter.WakeDpc, FlushWakeDpc, &Waiter);
+    EvSetImportanceDpc(&Waiter.WakeDpc, EV_DPC_IMPORTANCE_HIGH);
+
+    /* Same as the worker Sleep(), the wake DPC targets our processor, so staying at DISPATCH
+     * until we yield makes the pending check + sleep atomic. */
+    KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+    EvSetTargetProcessorDpc(&Waiter.WakeDpc, HalGetCurrentProcessor()->Number);
+
+    KeIrql QueueIrql;
+    WorkQueue *Queue = LockItemQueue(Item, &QueueIrql);
+    if (!Queue) {
+        KeLowerIrql(OldIrql);
+        return;
+    }
+
+    __atomic_add_fetch(&Queue->FlushWaiters, 1, __ATOMIC_SEQ_CST);
+    if (!IsItemPending(Queue, Item)) {
+        __atomic_sub_fetch(&Queue->FlushWaiters, 1, __ATOMIC_RELAXED);
+        KeReleaseSpinLock(&Queue->Lock, QueueIrql);
+        KeLowerIrql(OldIrql);
+        return;
+    }
+
+    RtAppendDList(&Queue->FlushList, &Waiter.ListHeader);
+    KeReleaseSpinLock(&Queue->Lock, QueueIrql);
+
+    if (!Waiter.WakePending) {
+        Waiter.Sleeping = 1;
+        PsYieldExecution(PS_YIELD_WAITING);
+    }
+
+    KeLowerIrql(OldIrql);
+}
@@ -0,0 +1,238 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function stops the hardware from raising the given interrupt. Only line and MSI-X
+ *     interrupts can be masked from here, this does nothing for anything else.
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt to mask.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpMaskInterruptSource(HalpInterrupt *Interrupt) {
+    if (Interrupt->Source == HALP_INT_SOURCE_LINE) {
+        HalpMaskGsi(Interrupt->Gsi);
+    } else if (Interrupt->Source == HALP_INT_SOURCE_MESSAGE && Interrupt->MsixTable) {
+        volatile uint32_t *Entry =
+            (volatile uint32_t *)((char *)Interrupt->MsixTable + Interrupt->MsixIndex * 16);
+        Entry[3] |= 1;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function points the hardware at the current target processor and vector of the
+ *     interrupt, unmasking it. Like HalpMaskInterruptSource, this only handles line and MSI-X
+ *     interrupts.
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt to reprogram.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpUnmaskInterruptSource(HalpInterrupt *Interrupt) {
+    KeProcessor *Processor = HalpProcessorList[Interrupt->Processor];
+
+    if (Interrupt->Source == HALP_INT_SOURCE_LINE) {
+        HalpRouteGsi(
+            Interrupt->Gsi,
+            Interrupt->Vector,
+            Interrupt->PinPolarity,
+            Interrupt->Type == HAL_INT_TYPE_LEVEL,
+            Processor->ApicId);
+    } else if (Interrupt->Source == HALP_INT_SOURCE_MESSAGE && Interrupt->MsixTable) {
+        HalMessageInterrupt Message;
+        HalpBuildMessage(&Message, Processor, Interrupt->Irql, Interrupt->Vector);
+        HalWriteMsixEntry(Interrupt->MsixTable, Interrupt->MsixIndex, &Message);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function unlinks the interrupt from the handler list of the processor it used to
+ *     target. This runs as a DPC on that processor; At DISPATCH, we know nobody there is halfway
+ *     through walking the list.
+ *
+ * PARAMETERS:
+ *     Context - Which interrupt is moving.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void MoveDpc(void *Context) {
+    HalpInterrupt *Interrupt = Context;
+    KeProcessor *Processor = HalGetCurrentProcessor();
+
+    KeIrql OldIrql = KeAcquireSpinLock(&Processor->InterruptListLock);
+    RtUnlinkDList(&Interrupt->ListHeader);
+    KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
+
+    __atomic_store_n(&Interrupt->MoveDone, 1, __ATOMIC_RELEASE);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the vector the interrupt used on this processor still has anything
+ *     pending (requested or in service) in the local APIC. This runs as a DPC on the old
+ *     processor, after the hardware was already pointed somewhere else.
+ *
+ * PARAMETERS:
+ *     Context - Which interrupt is moving.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void DrainDpc(void *Context) {
+    HalpInterrupt *Interrupt = Context;
+    uint32_t Register = (Interrupt->MoveVector >> 5) << 4;
+    uint32_t Bit = 1u << (Interrupt->MoveVector & 0x1F);
+
+    /* ISR is at 0x100, and IRR is at 0x200; Each covers 32 vectors every 16 bytes. */
+    Interrupt->MovePending =
+        ((HalpReadLapicRegister(0x100 + Register) | HalpReadLapicRegister(0x200 + Register)) &
+         Bit) != 0;
+
+    __atomic_store_n(&Interrupt->MoveDone, 1, __ATOMIC_RELEASE);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs the given routine as a DPC on the processor the interrupt used to target,
+ *     waiting until it's done.
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt is moving.
+ *     Source - Processor the interrupt used to target.
+ *     Routine - DPC routine to run there.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void RunOnSource(HalpInterrupt *Interrupt, KeProcessor *Source, void (*Routine)(void *)) {
+    Interrupt->MoveDone = 0;
+    EvInitializeDpc(&Interrupt->MoveDpc, Routine, Interrupt);
+    EvSetImportanceDpc(&Interrupt->MoveDpc, EV_DPC_IMPORTANCE_HIGH);
+    EvSetTargetProcessorDpc(&Interrupt->MoveDpc, Source->Number);
+    EvDispatchDpc(&Interrupt->MoveDpc);
+    while (!__atomic_load_n(&Interrupt->MoveDone, __ATOMIC_ACQUIRE)) {
+        HalpPauseProcessor();
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function moves a line or MSI-X interrupt to another processor, allocating a new vector
+ *     there. The caller should own the Moving flag of the interrupt, and be running at PASSIVE
+ *     IRQL (we wait for a DPC on the old processor).
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt to move.
+ *     Target - Which processor should handle the interrupt from now on.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the interrupt can't be moved there.
+ *-----------------------------------------------------------------------------------------------*/
+int HalpMoveInterrupt(HalpInterrupt *Interrupt, KeProcessor *Target) {
+    /* Plain MSI lives in the PCI config space, which only the driver can reach. */
+    if (Interrupt->Source == HALP_INT_SOURCE_LOCAL ||
+        (Interrupt->Source == HALP_INT_SOURCE_MESSAGE && !Interrupt->MsixTable)) {
+        return 0;
+    } else if (Interrupt->Processor == Target->Number) {
+        return 1;
+    } else if (
+        Target->Number >= 64 || !(Interrupt->AffinityMask & (1ull << Target->Number)) ||
+        Target->ApicId > 0xFF) {
+        return 0;
+    }
+
+    uint32_t Vector;
+    if (!HalpAllocateVectors(Target, Interrupt->Irql, 1, &Vector)) {
+        return 0;
+    }
+
+    KeProcessor *Source = HalpProcessorList[Interrupt->Processor];
+    uint32_t OldVector = Interrupt->Vector;
+
+    if (!Interrupt->Enabled) {
+        Interrupt->Processor = Target->Number;
+        Interrupt->Vector = Vector;
+        HalpFreeVectors(Source, OldVector, 1);
+        return 1;
+    }
+
+    /* Masked MSI-X entries remember pending messages, and level triggered lines reassert on
+     * unmask, so this shouldn't lose anything (other than edge triggered lines firing in this
+     * exact window). */
+    HalpMaskInterruptSource(Interrupt);
+
+    RunOnSource(Interrupt, Source, MoveDpc);
+
+    Interrupt->Processor = Target->Number;
+    Interrupt->Vector = Vector;
+
+    KeIrql OldIrql = KeAcquireSpinLock(&Target->InterruptListLock);
+    RtAppendDList(&Target->InterruptList[Vector], &Interrupt->ListHeader);
+    KeReleaseSpinLock(&Target->InterruptListLock, OldIrql);
+
+    /* Don't unmask anything the interrupt thread still needs masked. */
+    HalpUnmaskInterruptSource(Interrupt);
+    if (__atomic_load_n(&Interrupt->HandlerMasked, __ATOMIC_RELAXED)) {
+        HalpMaskInterruptSource(Interrupt);
+    }
+
+    /* Something sent before we masked the source could still be on its way to (or waiting
+     * inside) the old processor; Only give the vector back once it has nothing left there,
+     * otherwise whoever gets it next would see our interrupt. */
+    Interrupt->MoveVector = OldVector;
+    do {
+        RunOnSource(Interrupt, Source, DrainDpc);
+    } while (Interrupt->MovePending);
+
+    HalpFreeVectors(Source, OldVector, 1);
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function restricts which processors can handle the given interrupt, moving it if the
+ *     current target isn't allowed anymore. Only line and MSI-X (after HalConnectMsixEntry)
+ *     interrupts can be moved. This should only be called at PASSIVE IRQL.
+ *     Moving an edge triggered line can lose an interrupt that fires during the move, so the
+ *     balancer never does it on its own; Only do it when the device can cope with that (or is
+ *     quiet).
+ *
+ * PARAMETERS:
+ *     Handle - Which interrupt to update.
+ *     AffinityMask - Bitmask of processors allowed to handle the interrupt.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the interrupt couldn't be moved into the new mask.
+ *-----------------------------------------------------------------------------------------------*/
+int HalSetInterruptAffinity(HalInterrupt *Handle, uint64_t AffinityMask) {
+    HalpInterrupt *Interrupt = (HalpInterrupt *)Handle;
+
+    if (!AffinityMask) {
+        return 0;
+    }
+
+    while (__atomic_exchange_n(&Interrupt->Moving, 1, __ATOMIC_ACQUIRE)) {
+        HalpPauseProcessor();
+    }
+
+    Interrupt->AffinityMask = AffinityMask;
+
+    int Result = 1;
+    if (Interrupt->Processor >= 64 || !(AffinityMask & (1ull << Interrupt->Processor))) {
+        KeProcessor *Target = HalpSelectInterruptProcessor(AffinityMask);
+        Result = Target && HalpMoveInterrupt(Interrupt, Target);
+    }
+
+    __atomic_store_n(&Interrupt->Moving, 0, __ATOMIC_RELEASE);
+    return Result;
+}
@@ -8,13 +8,33 @@
 #include <hal.h>
 #include <ke.h>
 #include <mm.h>
+#include <rt/hash.h>
 #include <vid.h>
 
+static int CompareLapic(RtHashEntry *Entry, const void *Key);
+
 RtSList HalpLapicListHead = {};
 uint32_t HalpProcessorCount = 0;
 
 static void *LapicAddress = NULL;
 static int X2ApicEnabled = 0;
+static RtHashTable LapicTable =
+    RT_HASH_TABLE_INITIALIZER(CompareLapic, MmAllocateHashTable, MmFreeHashTable);
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given LAPIC table entry has the given APIC id.
+ *
+ * PARAMETERS:
+ *     Entry - Hash table entry of the LAPIC.
+ *     Key - APIC id we're looking for.
+ *
+ * RETURN VALUE:
+ *     1 if the id matches, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int CompareLapic(RtHashEntry *Entry, const void *Key) {
+    return CONTAINING_RECORD(Entry, LapicEntry, HashEntry)->ApicId == *(const uint32_t *)Key;
+}
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -27,19 +47,32 @@ static int X2ApicEnabled = 0;
  *     Pointer to the LapicEntry struct, or NULL if we didn't find it.
  *-----------------------------------------------------------------------------------------------*/
 static LapicEntry *GetLapic(uint32_t Id) {
-    RtSList *ListHeader = HalpLapicListHead.Next;
-
-    while (ListHeader) {
-        LapicEntry *Entry = CONTAINING_RECORD(ListHeader, LapicEntry, ListHeader);
-
-        if (Entry->ApicId == Id) {
-            return Entry;
-        }
+    RtHashEntry *Entry = RtLookupHashTable(&LapicTable, RtGetXxh3Hash(&Id, sizeof(Id), 0), &Id);
+    return Entry ? CONTAINING_RECORD(Entry, LapicEntry, HashEntry) : NULL;
+}
 
-        ListHeader = ListHeader->Next;
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a new LAPIC into our processor list.
+ *
+ * PARAMETERS:
+ *     Entry - LAPIC to be added.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void AddLapic(LapicEntry *Entry) {
+    uint64_t Hash = RtGetXxh3Hash(&Entry->ApicId, sizeof(Entry->ApicId), 0);
+    if (!RtInsertHashTable(&LapicTable, &Entry->HashEntry, Hash)) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_APIC_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0,
+            0);
     }
 
-    return NULL;
+    RtPushSList(&HalpLapicListHead, &Entry->ListHeader);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -150,7 +183,7 @@ void HalpInitializeApic(void) {
                 Entry->ApicId = Record->Lapic.ApicId;
                 Entry->AcpiId = Record->Lapic.AcpiId;
                 Entry->IsX2Apic = 0;
-                RtPushSList(&HalpLapicListHead, &Entry->ListHeader);
+                AddLapic(Entry);
                 VidPrint(
                     VID_MESSAGE_DEBUG,
                     "Kernel HAL",
@@ -182,7 +215,7 @@ void HalpInitializeApic(void) {
                 Entry->ApicId = Record->X2Apic.X2ApicId;
                 Entry->AcpiId = Record->X2Apic.AcpiId;
                 Entry->IsX2Apic = 1;
-                RtPushSList(&HalpLapicListHead, &Entry->ListHeader);
+                AddLapic(Entry);
                 VidPrint(
                     VID_MESSAGE_DEBUG,
                     "Kernel HAL",
@@ -286,6 +319,54 @@ void HalpSendNmi(uint32_t Target) {
     }
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if we're using the x2APIC.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     1 if the x2APIC is enabled, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+int HalpIsX2ApicEnabled(void) {
+    return X2ApicEnabled;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sends an IPI to all processors but the current one, using a single ICR write
+ *     (the "all excluding self" shorthand).
+ *
+ * PARAMETERS:
+ *     Vector - Interrupt vector/action we want to trigger in the targets.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpBroadcastIpi(uint32_t Vector) {
+    HalpWriteLapicRegister(0x300, 0xC0000 | Vector);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sends an IPI to a group of processors inside the same x2APIC cluster, using
+ *     a single ICR write (logical destination mode). This should only be used if
+ *     HalpIsX2ApicEnabled() returns 1.
+ *
+ * PARAMETERS:
+ *     Cluster - Cluster ID (bits 4 and up of the x2APIC ID).
+ *     Members - Bitmask of the targets inside the cluster (bit N is x2APIC ID Cluster * 16 + N).
+ *     Vector - Interrupt vector/action we want to trigger in the targets.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpSendClusterIpi(uint32_t Cluster, uint32_t Members, uint32_t Vector) {
+    uint64_t Destination = (Cluster << 16) | (Members & 0xFFFF);
+    HalpWriteLapicRegister(0x300, (Destination << 32) | 0x800 | Vector);
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function busy loops until the Local APIC says a previously sent IPI was delivered.
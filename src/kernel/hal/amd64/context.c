@@ -1,9 +1,10 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <amd64/context.h>
+#include <halp.h>
 
 extern void HalpThreadEntry(void);
+extern void HalpSwapContext(HalContextFrame *CurrentThread, HalContextFrame *TargetThread);
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -33,3 +34,28 @@ void HalpInitializeContext(
     ExceptionFrame->ReturnAddress = (uint64_t)HalpThreadEntry;
     Context->Rsp = (uint64_t)ExceptionFrame;
 }
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function transfers execution to the given thread context, saving the extended
+ *     (x87/AVX) state of the current thread, and loading the one from the target.
+ *
+ * PARAMETERS:
+ *     CurrentThread - Current thread context pointer; Can be NULL if we're not running under any
+ *                     thread yet.
+ *     TargetThread - Target thread context pointer.
+ *
+ * RETURN VALUE:
+ *     We return to the context of the given thread; Execution can be returned to the current/old
+ *     context by calling us again.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpSwitchContext(HalContextFrame *CurrentThread, HalContextFrame *TargetThread) {
+    /* Nothing between the restore and the stack swap touches the extended state (the kernel is
+     * built without anything above SSE), so it's safe to load the target state early. */
+    if (CurrentThread) {
+        HalpSaveExtendedState(CurrentThread);
+    }
+
+    HalpRestoreExtendedState(TargetThread);
+    HalpSwapContext(CurrentThread, TargetThread);
+}
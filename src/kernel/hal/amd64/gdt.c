@@ -2,6 +2,7 @@
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
 #include <amd64/halp.h>
+#include <amd64/msr.h>
 
 extern void HalpFlushGdt(void);
 
@@ -78,6 +79,9 @@ void HalpInitializeGdt(KeProcessor *Processor) {
     __asm__ volatile("lgdt %0" : : "m"(Descriptor));
     HalpFlushGdt();
     __asm__ volatile("mov $0x28, %%ax; ltr %%ax" : : : "%rax");
+
+    /* Reloading GS also reset its base, so point it back at the processor block. */
+    WriteMsr(0xC0000101, (uint64_t)Processor);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -5,11 +5,11 @@
 #include <halp.h>
 #include <ke.h>
 #include <mi.h>
-#include <vid.h>
 
 static void *HpetAddress = NULL;
-static uint64_t Period = 1;
-static int Width = HAL_TIMER_WIDTH_64B;
+static int Is64Bit = 1;
+static uint64_t LastCounter = 0;
+static HalpClockSource ClockSource = {};
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -40,6 +40,42 @@ static void WriteHpetRegister(uint32_t Number, uint64_t Data) {
     *(volatile uint64_t *)((char *)HpetAddress + Number) = Data;
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads the HPET main counter. 32-bit counters get extended into 64-bits, which
+ *     works as long as someone reads the counter at least once every half wrap around (the clock
+ *     tick makes sure of that).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     How many HPET ticks have elapsed since the counter was initialized.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t ReadCounter(void) {
+    if (Is64Bit) {
+        return ReadHpetRegister(HPET_VAL_REG);
+    }
+
+    uint64_t Last = __atomic_load_n(&LastCounter, __ATOMIC_RELAXED);
+    uint32_t Counter = ReadHpetRegister(HPET_VAL_REG);
+
+    while (1) {
+        /* Someone else might have read a newer value than us in the meantime; Don't go back in
+         * time (or worse, think we wrapped around). */
+        int32_t Delta = Counter - (uint32_t)Last;
+        if (Delta <= 0) {
+            return Last;
+        }
+
+        uint64_t Extended = Last + Delta;
+        if (__atomic_compare_exchange_n(
+                &LastCounter, &Last, Extended, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return Extended;
+        }
+    }
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function finds and initializes the HPET (High Precision Event Time).
@@ -83,62 +119,18 @@ void HalpInitializeHpet(void) {
         WriteHpetRegister(HPET_TIMER_CAP_REG(i), Reg & ~HPET_TIMER_MASK);
     }
 
+    /* The capabilities register gives us the period in femtoseconds. */
     Reg = ReadHpetRegister(HPET_CAP_REG);
-    Width = (Reg & HPET_CAP_64B) ? HAL_TIMER_WIDTH_64B : HAL_TIMER_WIDTH_32B;
-    Period = (Reg >> HPET_CAP_FREQ_START) / 1000000;
-    VidPrint(
-        VID_MESSAGE_DEBUG,
-        "Kernel HAL",
-        "using HPET as timer tick source (%u-bits counter, period = %llu ns)\n",
-        Width,
-        Period);
+    Is64Bit = (Reg & HPET_CAP_64B) != 0;
+    ClockSource.Name = Is64Bit ? "HPET (64-bits)" : "HPET (32-bits)";
+    ClockSource.Read = ReadCounter;
+    ClockSource.Frequency = 1000000000000000ull / (Reg >> HPET_CAP_FREQ_START);
 
-    /* At last we can reenable the main counter (after zeroing it). */
+    /* At last we can reenable the main counter (after zeroing it), and start using it as the
+     * clock source. */
     Reg = ReadHpetRegister(HPET_CFG_REG);
     WriteHpetRegister(HPET_VAL_REG, 0);
     WriteHpetRegister(HPET_CFG_REG, (Reg & ~HPET_CFG_MASK) | HPET_CFG_INT_ENABLE);
+    HalpSetClockSource(&ClockSource);
 }
 
-/*-------------------------------------------------------------------------------------------------
- * PURPOSE:
- *     This function returns the width of the timer (useful for handling overflow!).
- *
- * PARAMETERS:
- *     None.
- *
- * RETURN VALUE:
- *     HAL_TIMER_WIDTH_32B if the timer is 32-bits long, or HAL_TIMER_WIDTH_64B if the timer is
- *     64-bits long.
- *-----------------------------------------------------------------------------------------------*/
-int HalGetTimerWidth(void) {
-    return Width;
-}
-
-/*-------------------------------------------------------------------------------------------------
- * PURPOSE:
- *     This function returns the period (in nanoseconds) of the HAL timer.
- *
- * PARAMETERS:
- *     None.
- *
- * RETURN VALUE:
- *     Period of the timer.
- *-----------------------------------------------------------------------------------------------*/
-uint64_t HalGetTimerPeriod(void) {
-    return Period;
-}
-
-/*-------------------------------------------------------------------------------------------------
- * PURPOSE:
- *     This function returns how many timer ticks have elapsed since the timer was initialized.
- *
- * PARAMETERS:
- *     None.
- *
- * RETURN VALUE:
- *     How many ticks have elapsed since system boot. Multiply it by the timer period to get how
- *     many nanoseconds have elapsed.
- *-----------------------------------------------------------------------------------------------*/
-uint64_t HalGetTimerTicks(void) {
-    return ReadHpetRegister(HPET_VAL_REG);
-}
@@ -0,0 +1,167 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+#include <cpuid.h>
+#include <ev.h>
+#include <string.h>
+#include <vid.h>
+
+/* Skip the deeper C-states if the next timer event is closer than this; Their exit latency would
+ * just make us late for it. */
+#define DEEP_IDLE_THRESHOLD (100 * EV_MICROSECS)
+#define SHALLOW_IDLE_HINT 0x00
+
+static int MwaitEnabled = 0;
+static uint32_t DeepHint = SHALLOW_IDLE_HINT;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if we're running under QEMU's TCG. It advertises MONITOR/MWAIT on some
+ *     CPU models, but it just implements MWAIT as HLT, and it never wakes up on the monitored
+ *     write.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     1 if we're running under TCG, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int IsTcg(void) {
+    uint32_t Eax, Ebx, Ecx, Edx;
+    __cpuid(1, Eax, Ebx, Ecx, Edx);
+    if (!(Ecx & 0x80000000)) {
+        return 0;
+    }
+
+    char Signature[12];
+    __cpuid(0x40000000, Eax, Ebx, Ecx, Edx);
+    memcpy(Signature, &Ebx, 4);
+    memcpy(Signature + 4, &Ecx, 4);
+    memcpy(Signature + 8, &Edx, 4);
+    return !memcmp(Signature, "TCGTCGTCGTCG", 12);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if MONITOR/MWAIT can be used by the idle loop, and picks the C-state
+ *     hints we'll pass to MWAIT (using the sub C-state counts in CPUID leaf 5). We should only be
+ *     called once, by the BSP; All processors are assumed to support the same C-states.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpInitializeIdle(void) {
+    uint32_t Eax, Ebx, Ecx, Edx;
+
+    __cpuid(0, Eax, Ebx, Ecx, Edx);
+    uint32_t MaxLeaf = Eax;
+    __cpuid(1, Eax, Ebx, Ecx, Edx);
+    if (MaxLeaf < 5 || !(Ecx & 0x08) || IsTcg()) {
+        VidPrint(VID_MESSAGE_INFO, "Kernel HAL", "using HLT for the idle loop\n");
+        return;
+    }
+
+    /* We need both the MWAIT extensions and the ability to break out of MWAIT on interrupts
+     * while IF=0; Without the latter, there is no way to close the window between checking for
+     * work and going to sleep. */
+    __cpuid(5, Eax, Ebx, Ecx, Edx);
+    if ((Ecx & 0x03) != 0x03) {
+        VidPrint(VID_MESSAGE_INFO, "Kernel HAL", "using HLT for the idle loop\n");
+        return;
+    }
+
+    /* EDX has the amount of sub C-states for C0-C7 (4 bits each); The MWAIT hint is encoded as
+     * (C-state - 1) << 4 | sub C-state. C1 with sub-state 0 is always valid.
+     * The local APIC timer stops in C3 and deeper, unless it's always running (ARAT); We have no
+     * broadcast timer to fall back to, so without ARAT we stay in C1 (and still get to use MWAIT
+     * for the wake line). */
+    uint32_t PowerEdx = Edx;
+    int HasArat = 0;
+    if (MaxLeaf >= 6) {
+        __cpuid(6, Eax, Ebx, Ecx, Edx);
+        HasArat = (Eax & 0x04) != 0;
+    }
+
+    for (int State = 7; HasArat && State >= 1; State--) {
+        uint32_t SubStates = (PowerEdx >> (State * 4)) & 0x0F;
+        if (SubStates) {
+            DeepHint = ((State - 1) << 4) | (SubStates - 1);
+            break;
+        }
+    }
+
+    MwaitEnabled = 1;
+    VidPrint(
+        VID_MESSAGE_INFO,
+        "Kernel HAL",
+        "using MWAIT for the idle loop (deepest hint is 0x%02x)\n",
+        DeepHint);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function puts the current processor to sleep until either an interrupt arrives, or
+ *     HalpNotifyProcessor() writes into our wake line. The caller is expected to check its
+ *     queues once we return, as there is no interrupt to do that for it in the second case.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpIdleProcessor(void) {
+    if (!MwaitEnabled) {
+        HalpStopProcessor();
+        return;
+    }
+
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    uint64_t NextTimerEvent = Processor->NextTimerEvent;
+    uint32_t Hint = DeepHint;
+    if (NextTimerEvent && NextTimerEvent < HalGetTime() + DEEP_IDLE_THRESHOLD) {
+        Hint = SHALLOW_IDLE_HINT;
+    }
+
+    /* Interrupts stay disabled until we're out of MWAIT; Otherwise, an interrupt could switch us
+     * out while IdleMonitoring is still set, and anyone notifying us would skip the IPI. */
+    __asm__ volatile("cli" ::: "memory");
+    __atomic_store_n(&Processor->IdleWakeRequest, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&Processor->IdleMonitoring, 1, __ATOMIC_SEQ_CST);
+    __asm__ volatile("monitor" : : "a"(&Processor->IdleWakeRequest), "c"(0), "d"(0) : "memory");
+
+    /* Anything queued before we set IdleMonitoring didn't touch the wake line, so we need to
+     * check the queues ourselves. */
+    if (!__atomic_load_n(&Processor->IdleWakeRequest, __ATOMIC_SEQ_CST) &&
+        !__atomic_load_n(&Processor->ThreadQueueSize, __ATOMIC_SEQ_CST) &&
+        !__atomic_load_n(&Processor->DpcQueueSize, __ATOMIC_SEQ_CST)) {
+        __asm__ volatile("mwait" : : "a"(Hint), "c"(1) : "memory");
+    }
+
+    __atomic_store_n(&Processor->IdleMonitoring, 0, __ATOMIC_SEQ_CST);
+    __asm__ volatile("sti" ::: "memory");
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function wakes up the given processor by writing into its wake line, if it's sleeping
+ *     in HalpIdleProcessor().
+ *
+ * PARAMETERS:
+ *     Processor - Which processor to wake up.
+ *
+ * RETURN VALUE:
+ *     1 if the processor was idle (and no IPI is required), 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+int HalpWakeIdleProcessor(KeProcessor *Processor) {
+    if (!__atomic_load_n(&Processor->IdleMonitoring, __ATOMIC_SEQ_CST)) {
+        return 0;
+    }
+
+    __atomic_store_n(&Processor->IdleWakeRequest, 1, __ATOMIC_SEQ_CST);
+    return 1;
+}
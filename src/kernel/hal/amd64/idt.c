@@ -37,6 +37,7 @@ extern void HalpVmmCommunicationTrapEntry(void);
 extern void HalpSecurityTrapEntry(void);
 extern void HalpDispatchEntry(void);
 extern void HalpTimerEntry(void);
+extern void HalpIpiEntry(void);
 
 static struct {
     void (*Handler)(void);
@@ -252,13 +253,26 @@ void HalpDispatchInterrupt(HalInterruptFrame *InterruptFrame) {
     KeProcessor *Processor = HalGetCurrentProcessor();
     RtDList *HandlerList = &Processor->InterruptList[InterruptFrame->InterruptNumber];
 
+    /* Statistics are per-processor, so relaxed atomics are enough (we only need to make sure
+     * nested interrupts don't lose any updates). */
+    __atomic_add_fetch(
+        &Processor->InterruptCounts[InterruptFrame->InterruptNumber], 1, __ATOMIC_RELAXED);
+
     for (RtDList *ListHeader = HandlerList->Next; ListHeader != HandlerList;
          ListHeader = ListHeader->Next) {
-        HalInterrupt *Interrupt = CONTAINING_RECORD(ListHeader, HalInterrupt, ListHeader);
+        HalpInterrupt *Interrupt = CONTAINING_RECORD(ListHeader, HalpInterrupt, ListHeader);
         HalpSetIrql(Interrupt->Irql);
         __asm__ volatile("sti");
         KeAcquireSpinLockHighIrql(&Interrupt->Lock);
-        Interrupt->Handler(InterruptFrame, Interrupt->HandlerContext);
+        __atomic_add_fetch(&Interrupt->Count, 1, __ATOMIC_RELAXED);
+        uint64_t StartTime = HalpReadTimestamp();
+        if (!Interrupt->CheckRoutine) {
+            Interrupt->Handler(InterruptFrame, Interrupt->HandlerContext);
+        } else if (Interrupt->CheckRoutine(InterruptFrame, Interrupt->HandlerContext)) {
+            HalpDeferInterrupt(Interrupt);
+        }
+        KeRecordHistogram(
+            &Processor->Histograms[KE_HISTOGRAM_INTERRUPT_TIME], HalpReadTimestamp() - StartTime);
         KeReleaseSpinLockHighIrql(&Interrupt->Lock);
         __asm__ volatile("cli");
         HalpSetIrql(InterruptFrame->Irql);
@@ -267,6 +281,42 @@ void HalpDispatchInterrupt(HalInterruptFrame *InterruptFrame) {
     HalpSendEoi();
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function accounts for and acknowledges a dispatch interrupt, before we start
+ *     processing the event/DPC queue.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpAcknowledgeDispatchEvent(void) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    __atomic_add_fetch(&Processor->InterruptCounts[HAL_INT_DISPATCH_VECTOR], 1, __ATOMIC_RELAXED);
+    HalpSendEoi();
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function handles the cross-call IPI; We stay with interrupts disabled for the whole
+ *     thing.
+ *
+ * PARAMETERS:
+ *     InterruptFrame - Current interrupt data.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpDispatchIpi(HalInterruptFrame *) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    __atomic_add_fetch(&Processor->InterruptCounts[HAL_INT_IPI_VECTOR], 1, __ATOMIC_RELAXED);
+    HalpSetIrql(HAL_INT_IPI_IRQL);
+    KiProcessIpiRequests();
+    HalpSendEoi();
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function initializes an entry inside the IDT.
@@ -335,6 +385,8 @@ void HalpInitializeIdt(KeProcessor *Processor) {
             Base = (uint64_t)HalpDispatchEntry;
         } else if (i == HAL_INT_TIMER_VECTOR) {
             Base = (uint64_t)HalpTimerEntry;
+        } else if (i == HAL_INT_IPI_VECTOR) {
+            Base = (uint64_t)HalpIpiEntry;
         }
 
         /* Default IRQ handlers for everything else. */
@@ -357,12 +409,14 @@ void HalpInitializeIdt(KeProcessor *Processor) {
  *     This function attempts to enable the handling of the given interrupt.
  *
  * PARAMETERS:
- *     Interrupt - Target interrupt to be enabled.
+ *     Handle - Target interrupt to be enabled.
  *
  * RETURN VALUE:
  *     0 if the interrupt couldn't be registered, 1 otherwise.
  *-----------------------------------------------------------------------------------------------*/
-int HalEnableInterrupt(HalInterrupt *Interrupt) {
+int HalEnableInterrupt(HalInterrupt *Handle) {
+    HalpInterrupt *Interrupt = (HalpInterrupt *)Handle;
+
     /* We'll be assuming that if the interrupt is already enabled, the caller would rather receive a
      * "success" than a failure (as a previous call with the exact same interrupt object did
      * succeed). */
@@ -378,7 +432,7 @@ int HalEnableInterrupt(HalInterrupt *Interrupt) {
     }
 
     /* Related to that, don't try using any reserved vector! */
-    if (Interrupt->Vector == HAL_INT_TIMER_VECTOR) {
+    if (Interrupt->Vector == HAL_INT_TIMER_VECTOR || Interrupt->Vector == HAL_INT_IPI_VECTOR) {
         return 0;
     }
 
@@ -387,7 +441,7 @@ int HalEnableInterrupt(HalInterrupt *Interrupt) {
         return 0;
     }
 
-    KeProcessor *Processor = HalGetCurrentProcessor();
+    KeProcessor *Processor = HalpProcessorList[Interrupt->Processor];
     KeIrql OldIrql = KeAcquireSpinLock(&Processor->InterruptListLock);
     RtDList *Handlers = &Processor->InterruptList[Interrupt->Vector];
 
@@ -395,7 +449,7 @@ int HalEnableInterrupt(HalInterrupt *Interrupt) {
         /* We already have one or more interrupt handlers on this vector, validate if we are
          * compatible with the already installed handlers (one single vector can only be level or
          * edge triggered, not both). */
-        if (CONTAINING_RECORD(Handlers->Next, HalInterrupt, ListHeader)->Type != Interrupt->Type) {
+        if (CONTAINING_RECORD(Handlers->Next, HalpInterrupt, ListHeader)->Type != Interrupt->Type) {
             KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
             return 0;
         }
@@ -405,6 +459,21 @@ int HalEnableInterrupt(HalInterrupt *Interrupt) {
     KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
     Interrupt->Enabled = 1;
 
+    /* Line interrupts also need their IOAPIC pin routed to us; Anything that isn't bound to the
+     * processor that created it is also a candidate for the interrupt balancer. */
+    if (Interrupt->Source == HALP_INT_SOURCE_LINE) {
+        HalpRouteGsi(
+            Interrupt->Gsi,
+            Interrupt->Vector,
+            Interrupt->PinPolarity,
+            Interrupt->Type == HAL_INT_TYPE_LEVEL,
+            Processor->ApicId);
+    }
+
+    if (Interrupt->Source != HALP_INT_SOURCE_LOCAL) {
+        HalpTrackInterrupt(Interrupt);
+    }
+
     return 1;
 }
 
@@ -413,23 +482,41 @@ int HalEnableInterrupt(HalInterrupt *Interrupt) {
  *     This function disables the handling of the given interrupt.
  *
  * PARAMETERS:
- *     Interrupt - Target interrupt to be disabled.
+ *     Handle - Target interrupt to be disabled.
  *
  * RETURN VALUE:
  *     None
  *-----------------------------------------------------------------------------------------------*/
-void HalDisableInterrupt(HalInterrupt *Interrupt) {
-    if (Interrupt->Enabled) {
+void HalDisableInterrupt(HalInterrupt *Handle) {
+    HalpInterrupt *Interrupt = (HalpInterrupt *)Handle;
+
+    if (!Interrupt->Enabled) {
         return;
     }
 
-    /* Should be as simple as marking us as not enabled + unlinking from the interrupt handler
-     * list. */
-    KeProcessor *Processor = HalGetCurrentProcessor();
+    if (Interrupt->Source != HALP_INT_SOURCE_LOCAL) {
+        HalpUntrackInterrupt(Interrupt);
+    }
+
+    /* Claim the interrupt before touching the hardware, so that neither an in-progress move nor
+     * the interrupt thread can unmask it again after us. */
+    while (__atomic_exchange_n(&Interrupt->Moving, 1, __ATOMIC_ACQUIRE)) {
+        HalpPauseProcessor();
+    }
+
+    if (Interrupt->Source == HALP_INT_SOURCE_LINE) {
+        HalpMaskGsi(Interrupt->Gsi);
+    }
+
+    /* Other than that, it should be as simple as marking us as not enabled + unlinking from the
+     * interrupt handler list. */
+    KeProcessor *Processor = HalpProcessorList[Interrupt->Processor];
     KeIrql OldIrql = KeAcquireSpinLock(&Processor->InterruptListLock);
     RtUnlinkDList(&Interrupt->ListHeader);
     KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
     Interrupt->Enabled = 0;
+
+    __atomic_store_n(&Interrupt->Moving, 0, __ATOMIC_RELEASE);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -6,6 +6,8 @@
 #include <mi.h>
 #include <vid.h>
 
+#define IOAPIC_REDIR_MASKED 0x10000
+
 static RtSList IoapicListHead = {};
 static RtSList IoapicOverrideListHead = {};
 
@@ -42,6 +44,31 @@ static void WriteIoapicRegister(IoapicEntry *Entry, uint8_t Number, uint32_t Dat
     *(volatile uint32_t *)(Entry->VirtualAddress + IOAPIC_DATA) = Data;
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function finds the IOAPIC handling the given GSI.
+ *
+ * PARAMETERS:
+ *     Gsi - Which interrupt we're looking for.
+ *
+ * RETURN VALUE:
+ *     IOAPIC entry, or NULL if no IOAPIC handles the GSI.
+ *-----------------------------------------------------------------------------------------------*/
+static IoapicEntry *FindIoapic(uint8_t Gsi) {
+    RtSList *ListHeader = IoapicListHead.Next;
+
+    while (ListHeader) {
+        IoapicEntry *Entry = CONTAINING_RECORD(ListHeader, IoapicEntry, ListHeader);
+        if (Entry->GsiBase <= Gsi && Gsi < Entry->GsiBase + Entry->Size) {
+            return Entry;
+        }
+
+        ListHeader = ListHeader->Next;
+    }
+
+    return NULL;
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function enables and sets up the given GSI.
@@ -62,22 +89,18 @@ static void UnmaskIoapicVector(
     int PinPolarity,
     int TriggerMode,
     uint32_t ApicId) {
-    RtSList *ListHeader = IoapicListHead.Next;
-
-    while (ListHeader) {
-        IoapicEntry *Entry = CONTAINING_RECORD(ListHeader, IoapicEntry, ListHeader);
-
-        if (Entry->GsiBase <= Gsi && Gsi < Entry->GsiBase + Entry->Size) {
-            WriteIoapicRegister(
-                Entry,
-                IOAPIC_REDIR_REG_LOW(Gsi - Entry->GsiBase),
-                TargetVector | (PinPolarity << 13) | (TriggerMode << 15));
-            WriteIoapicRegister(Entry, IOAPIC_REDIR_REG_HIGH(Gsi - Entry->GsiBase), ApicId << 24);
-            return;
-        }
-
-        ListHeader = ListHeader->Next;
+    IoapicEntry *Entry = FindIoapic(Gsi);
+    if (!Entry) {
+        return;
     }
+
+    /* Keep the pin masked while we change the destination, otherwise it could fire with the new
+     * vector on the old processor (or the other way around). */
+    uint8_t Pin = Gsi - Entry->GsiBase;
+    uint32_t Low = TargetVector | (PinPolarity << 13) | (TriggerMode << 15);
+    WriteIoapicRegister(Entry, IOAPIC_REDIR_REG_LOW(Pin), Low | IOAPIC_REDIR_MASKED);
+    WriteIoapicRegister(Entry, IOAPIC_REDIR_REG_HIGH(Pin), ApicId << 24);
+    WriteIoapicRegister(Entry, IOAPIC_REDIR_REG_LOW(Pin), Low);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -183,34 +206,54 @@ void HalpInitializeIoapic(void) {
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function enables the given IRQ, using the override list if required.
+ *     This function translates a legacy IRQ into a GSI, using the override list if required.
  *
  * PARAMETERS:
- *     Irq - Which IRQ we wish to enable.
- *     Vector - Which IDT IRQ vector it should trigger.
+ *     Irq - Which IRQ we're translating.
+ *     Gsi - Output; Which GSI the IRQ is connected to.
+ *     PinPolarity - Output; 0: Active high, 1: Active low.
+ *     TriggerMode - Output; 0: Edge, 1: Level.
  *
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-void HalpEnableIrq(uint8_t Irq, uint8_t Vector) {
-    uint8_t Gsi = Irq;
+static void ResolveIrq(uint8_t Irq, uint8_t *Gsi, int *PinPolarity, int *TriggerMode) {
     RtSList *ListHeader = IoapicOverrideListHead.Next;
-    int PinPolarity = 0;
-    int TriggerMode = 0;
+
+    *Gsi = Irq;
+    *PinPolarity = 0;
+    *TriggerMode = 0;
 
     while (ListHeader) {
         IoapicOverrideEntry *Entry = CONTAINING_RECORD(ListHeader, IoapicOverrideEntry, ListHeader);
 
         if (Entry->Irq == Irq) {
-            Gsi = Entry->Gsi;
-            PinPolarity = Entry->PinPolarity;
-            TriggerMode = Entry->TriggerMode;
-            break;
+            *Gsi = Entry->Gsi;
+            *PinPolarity = Entry->PinPolarity;
+            *TriggerMode = Entry->TriggerMode;
+            return;
         }
 
         ListHeader = ListHeader->Next;
     }
+}
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function enables the given IRQ, using the override list if required.
+ *
+ * PARAMETERS:
+ *     Irq - Which IRQ we wish to enable.
+ *     Vector - Which IDT IRQ vector it should trigger.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpEnableIrq(uint8_t Irq, uint8_t Vector) {
+    uint8_t Gsi;
+    int PinPolarity;
+    int TriggerMode;
+    ResolveIrq(Irq, &Gsi, &PinPolarity, &TriggerMode);
     UnmaskIoapicVector(
         Gsi, Vector + 32, PinPolarity, TriggerMode, HalGetCurrentProcessor()->ApicId);
 }
@@ -229,3 +272,91 @@ void HalpEnableIrq(uint8_t Irq, uint8_t Vector) {
 void HalpEnableGsi(uint8_t Gsi, uint8_t Vector) {
     UnmaskIoapicVector(Gsi, Vector + 32, 0, 1, HalGetCurrentProcessor()->ApicId);
 }
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function routes the given GSI into the given vector and processor, unmasking it.
+ *
+ * PARAMETERS:
+ *     Gsi - Which GSI we're routing.
+ *     Vector - Which vector should be raised on the target processor.
+ *     PinPolarity - 0: Active high, 1: Active low.
+ *     TriggerMode - 0: Edge, 1: Level.
+ *     ApicId - APIC ID of the target processor.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpRouteGsi(uint8_t Gsi, uint8_t Vector, int PinPolarity, int TriggerMode, uint32_t ApicId) {
+    UnmaskIoapicVector(Gsi, Vector, PinPolarity, TriggerMode, ApicId);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function masks the given GSI, keeping the rest of its routing intact.
+ *
+ * PARAMETERS:
+ *     Gsi - Which GSI we're masking.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpMaskGsi(uint8_t Gsi) {
+    IoapicEntry *Entry = FindIoapic(Gsi);
+    if (Entry) {
+        uint8_t Register = IOAPIC_REDIR_REG_LOW(Gsi - Entry->GsiBase);
+        WriteIoapicRegister(
+            Entry, Register, ReadIoapicRegister(Entry, Register) | IOAPIC_REDIR_MASKED);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function creates an interrupt object for the given legacy IRQ (routed through the
+ *     IOAPIC). We allocate a vector for it on the least loaded processor; The IOAPIC pin gets
+ *     unmasked by HalEnableInterrupt.
+ *
+ * PARAMETERS:
+ *     Irql - IRQL the interrupt handler should run at.
+ *     Irq - Which IRQ we want to handle.
+ *     Handler - Function to be called when the interrupt gets triggered.
+ *     HandlerContext - Data to be provided to the interrupt handler when it gets triggered.
+ *
+ * RETURN VALUE:
+ *     Either the interrupt object, or NULL on failure.
+ *-----------------------------------------------------------------------------------------------*/
+HalInterrupt *HalCreateLineInterrupt(
+    KeIrql Irql,
+    uint8_t Irq,
+    void (*Handler)(HalInterruptFrame *, void *),
+    void *HandlerContext) {
+    uint8_t Gsi;
+    int PinPolarity;
+    int TriggerMode;
+    ResolveIrq(Irq, &Gsi, &PinPolarity, &TriggerMode);
+    if (!FindIoapic(Gsi) || Irql >= HAL_INT_TIMER_IRQL) {
+        return NULL;
+    }
+
+    HalMessageInterrupt Message;
+    if (!HalAllocateMessageInterrupts(Irql, 1, PS_AFFINITY_ALL, 0, &Message)) {
+        return NULL;
+    }
+
+    HalpInterrupt *Interrupt = HalpCreateInterrupt(
+        Irql,
+        Message.Vector,
+        TriggerMode ? HAL_INT_TYPE_LEVEL : HAL_INT_TYPE_EDGE,
+        Handler,
+        HandlerContext);
+    if (!Interrupt) {
+        HalFreeMessageInterrupts(&Message, 1);
+        return NULL;
+    }
+
+    Interrupt->Source = HALP_INT_SOURCE_LINE;
+    Interrupt->Processor = Message.Processor;
+    Interrupt->Gsi = Gsi;
+    Interrupt->PinPolarity = PinPolarity;
+    return (HalInterrupt *)Interrupt;
+}
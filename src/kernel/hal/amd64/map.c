@@ -1,6 +1,7 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include <halp.h>
 #include <mi.h>
 #include <string.h>
 
@@ -101,6 +102,20 @@ int HalpMapPage(void *VirtualAddress, uint64_t PhysicalAddress, int Flags) {
     return 1;
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function flushes the given address from the TLB of the current processor.
+ *
+ * PARAMETERS:
+ *     VirtualAddress - Target address.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void FlushPage(void *VirtualAddress) {
+    __asm__ volatile("invlpg (%0)" : : "b"(VirtualAddress) : "memory");
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function unmaps a physical addresses from virtual memory.
@@ -143,8 +158,34 @@ void HalpUnmapPage(void *VirtualAddress) {
         break;
     }
 
-    /* TODO: We also want to notify other processors. */
-    __asm__ volatile("invlpg (%0)" : : "b"(VirtualAddress) : "memory");
+    /* Before SMP initialization, we're the only one who could have the page cached. */
+    if (!HalpProcessorList || HalpProcessorCount < 2) {
+        FlushPage(VirtualAddress);
+        return;
+    }
+
+    /* Other processors might have the page cached too, and they could start using whatever gets
+     * mapped here next through their stale entry; Cross-calls can only be sent at or below
+     * DISPATCH, so unmapping anything above that is a bug. */
+    KeIrql Irql = KeGetIrql();
+    if (Irql > KE_IRQL_DISPATCH) {
+        KeFatalError(KE_PANIC_IRQL_NOT_LESS_OR_EQUAL, Irql, KE_IRQL_DISPATCH, 0, 0);
+    }
+
+    /* This includes us (and anyone numbered past the affinity mask); We should always be able to
+     * run it at least locally, so failing here means the IPI code is broken, and we can't trust
+     * the mappings anymore. */
+    KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+    if (!KeIpiGenericCall(FlushPage, VirtualAddress, KE_IPI_ALL_PROCESSORS, 1)) {
+        KeFatalError(
+            KE_PANIC_IPI_NOT_DELIVERED,
+            (uint64_t)FlushPage,
+            (uint64_t)VirtualAddress,
+            HalGetCurrentProcessor()->Number,
+            0);
+    }
+
+    KeLowerIrql(OldIrql);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -0,0 +1,247 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+
+#define MSI_ADDRESS_BASE 0xFEE00000
+#define MSI_ADDRESS_DESTINATION_SHIFT 12
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function picks the least loaded processor (by amount of allocated vectors) out of the
+ *     given mask.
+ *
+ * PARAMETERS:
+ *     AffinityMask - Which processors we can pick.
+ *
+ * RETURN VALUE:
+ *     Processor block, or NULL if the mask has no usable processors.
+ *-----------------------------------------------------------------------------------------------*/
+KeProcessor *HalpSelectInterruptProcessor(uint64_t AffinityMask) {
+    KeProcessor *Best = NULL;
+
+    for (uint32_t i = 0; i < HalpProcessorCount && i < 64; i++) {
+        KeProcessor *Processor = HalpProcessorList[i];
+
+        /* Without interrupt remapping, MSIs can only target the first 256 APIC IDs. */
+        if (!(AffinityMask & (1ull << i)) || Processor->ApicId > 0xFF) {
+            continue;
+        }
+
+        if (!Best || __atomic_load_n(&Processor->VectorCount, __ATOMIC_RELAXED) <
+                         __atomic_load_n(&Best->VectorCount, __ATOMIC_RELAXED)) {
+            Best = Processor;
+        }
+    }
+
+    return Best;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function fills the address/data pair that will make the device raise the given
+ *     vector on the given processor.
+ *
+ * PARAMETERS:
+ *     Message - Output; Message interrupt to be filled.
+ *     Processor - Target processor.
+ *     Irql - IRQL of the vector.
+ *     Vector - Target vector.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpBuildMessage(
+    HalMessageInterrupt *Message,
+    KeProcessor *Processor,
+    KeIrql Irql,
+    uint32_t Vector) {
+    /* Physical destination mode, fixed delivery, edge triggered. */
+    Message->Address =
+        MSI_ADDRESS_BASE | ((uint64_t)Processor->ApicId << MSI_ADDRESS_DESTINATION_SHIFT);
+    Message->Data = Vector;
+    Message->Processor = Processor->Number;
+    Message->Vector = Vector;
+    Message->Irql = Irql;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates a size aligned block of vectors on the least loaded allowed
+ *     processor; If its vectors at this IRQL are all taken (or too fragmented), everyone else in
+ *     the mask gets a chance before we give up.
+ *
+ * PARAMETERS:
+ *     Irql - IRQL the vectors should be at.
+ *     Count - How many vectors we need.
+ *     AffinityMask - Which processors we can use.
+ *     Vector - Output; First vector of the block.
+ *
+ * RETURN VALUE:
+ *     Which processor the vectors were allocated on, or NULL on failure.
+ *-----------------------------------------------------------------------------------------------*/
+static KeProcessor *AllocateVectors(
+    KeIrql Irql,
+    uint32_t Count,
+    uint64_t AffinityMask,
+    uint32_t *Vector) {
+    KeProcessor *Processor;
+
+    while ((Processor = HalpSelectInterruptProcessor(AffinityMask)) &&
+           !HalpAllocateVectors(Processor, Irql, Count, Vector)) {
+        AffinityMask &= ~(1ull << Processor->Number);
+    }
+
+    return Processor;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates vectors for a device using message signaled interrupts
+ *     (MSI/MSI-X), spreading them across the given processors (each message goes to whichever
+ *     allowed processor has the least vectors in use, so multi-queue devices end up with one
+ *     queue per core).
+ *
+ * PARAMETERS:
+ *     Irql - IRQL the interrupt handlers should run at.
+ *     Count - How many messages we need.
+ *     AffinityMask - Which processors the messages can target.
+ *     Flags - HAL_MESSAGE_CONTIGUOUS if this is for plain MSI with multiple messages (all
+ *             vectors go to the same processor, as a size aligned block, and Count should be a
+ *             power of 2).
+ *     Messages - Output; Array of Count entries, to be filled with the address/data pairs.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if we couldn't allocate all messages (nothing is allocated in that
+ *     case).
+ *-----------------------------------------------------------------------------------------------*/
+int HalAllocateMessageInterrupts(
+    KeIrql Irql,
+    uint32_t Count,
+    uint64_t AffinityMask,
+    int Flags,
+    HalMessageInterrupt *Messages) {
+    if (!Count || Irql >= HAL_INT_TIMER_IRQL) {
+        return 0;
+    }
+
+    if (Flags & HAL_MESSAGE_CONTIGUOUS) {
+        uint32_t Vector;
+        KeProcessor *Processor = AllocateVectors(Irql, Count, AffinityMask, &Vector);
+        if (!Processor) {
+            return 0;
+        }
+
+        for (uint32_t i = 0; i < Count; i++) {
+            HalpBuildMessage(&Messages[i], Processor, Irql, Vector + i);
+        }
+
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < Count; i++) {
+        uint32_t Vector;
+        KeProcessor *Processor = AllocateVectors(Irql, 1, AffinityMask, &Vector);
+        if (!Processor) {
+            HalFreeMessageInterrupts(Messages, i);
+            return 0;
+        }
+
+        HalpBuildMessage(&Messages[i], Processor, Irql, Vector);
+    }
+
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function frees message interrupts allocated by HalAllocateMessageInterrupts. Any
+ *     interrupt objects using them should be disabled first.
+ *
+ * PARAMETERS:
+ *     Messages - Array of message interrupts.
+ *     Count - How many entries the array has.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalFreeMessageInterrupts(HalMessageInterrupt *Messages, uint32_t Count) {
+    for (uint32_t i = 0; i < Count; i++) {
+        HalpFreeVectors(HalpProcessorList[Messages[i].Processor], Messages[i].Vector, 1);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function creates an interrupt object for the given message interrupt (targeting the
+ *     processor it was allocated on).
+ *
+ * PARAMETERS:
+ *     Message - Message interrupt, as returned by HalAllocateMessageInterrupts.
+ *     Handler - Function to be called when the interrupt gets triggered.
+ *     HandlerContext - Data to be provided to the interrupt handler when it gets triggered.
+ *
+ * RETURN VALUE:
+ *     Either the interrupt object, or NULL on failure.
+ *-----------------------------------------------------------------------------------------------*/
+HalInterrupt *HalCreateMessageInterrupt(
+    HalMessageInterrupt *Message,
+    void (*Handler)(HalInterruptFrame *, void *),
+    void *HandlerContext) {
+    HalpInterrupt *Interrupt = HalpCreateInterrupt(
+        Message->Irql, Message->Vector, HAL_INT_TYPE_EDGE, Handler, HandlerContext);
+    if (Interrupt) {
+        Interrupt->Source = HALP_INT_SOURCE_MESSAGE;
+        Interrupt->Processor = Message->Processor;
+    }
+
+    return (HalInterrupt *)Interrupt;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function programs (and unmasks) one entry of a device's MSI-X table.
+ *
+ * PARAMETERS:
+ *     Table - Mapped MSI-X table of the device.
+ *     Index - Which entry to program.
+ *     Message - Message interrupt to write into the entry.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalWriteMsixEntry(void *Table, uint32_t Index, HalMessageInterrupt *Message) {
+    volatile uint32_t *Entry = (volatile uint32_t *)((char *)Table + Index * 16);
+
+    /* Mask the entry while we update it, so the device can't see a half written message. */
+    Entry[3] |= 1;
+    Entry[0] = Message->Address;
+    Entry[1] = Message->Address >> 32;
+    Entry[2] = Message->Data;
+    Entry[3] &= ~1u;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function programs the MSI-X table entry for the given message interrupt, and
+ *     remembers where it is, so that HalSetInterruptAffinity can retarget it later.
+ *
+ * PARAMETERS:
+ *     Handle - Interrupt object, as returned by HalCreateMessageInterrupt.
+ *     Table - Mapped MSI-X table of the device.
+ *     Index - Which entry belongs to this interrupt.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalConnectMsixEntry(HalInterrupt *Handle, void *Table, uint32_t Index) {
+    HalpInterrupt *Interrupt = (HalpInterrupt *)Handle;
+
+    HalMessageInterrupt Message;
+    HalpBuildMessage(
+        &Message, HalpProcessorList[Interrupt->Processor], Interrupt->Irql, Interrupt->Vector);
+
+    Interrupt->MsixTable = Table;
+    Interrupt->MsixIndex = Index;
+    HalWriteMsixEntry(Table, Index, &Message);
+}
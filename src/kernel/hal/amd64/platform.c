@@ -23,6 +23,10 @@ static KeProcessor BootProcessor __attribute__((aligned(4096))) = {};
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void HalpInitializeBootStack(KiLoaderBlock *LoaderBlock) {
+    /* Point the GS base at the boot processor block already; Self is still NULL, so
+     * HalGetCurrentProcessor() keeps returning NULL until HalpInitializeBootProcessor(). */
+    WriteMsr(0xC0000101, (uint64_t)&BootProcessor);
+
     __asm__ volatile("mov %0, %%rax\n"
                      "mov %1, %%rcx\n"
                      "mov %2, %%rdx\n"
@@ -53,17 +57,23 @@ void HalpInitializeBootStack(KiLoaderBlock *LoaderBlock) {
  *-----------------------------------------------------------------------------------------------*/
 void HalpInitializeBootProcessor(void) {
     /* This should always go well (if it doesn't, KeFatalError is called outside of us). */
-    WriteMsr(0xC0000102, (uint64_t)&BootProcessor);
+    BootProcessor.Self = &BootProcessor;
     HalpInitializeGdt(&BootProcessor);
     HalpInitializeIdt(&BootProcessor);
     HalpInitializeIoapic();
     HalpInitializeApic();
     HalpEnableApic();
     BootProcessor.ApicId = HalpReadLapicId();
+    HalpInitializeTopology(&BootProcessor);
+    HalpInitializeExtendedState(&BootProcessor);
+    HalpInitializeIdle();
     HalpInitializeHpet();
+    HalpInitializeTsc();
     HalpInitializeSmp();
+    HalpCheckTscSynchronization();
     HalpInitializeApicTimer();
     HalpSetIrql(KE_IRQL_PASSIVE);
+    __atomic_store_n(&BootProcessor.Online, 1, __ATOMIC_RELEASE);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -78,13 +88,17 @@ void HalpInitializeBootProcessor(void) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void HalpInitializeApplicationProcessor(KeProcessor *Processor) {
-    WriteMsr(0xC0000102, (uint64_t)Processor);
+    Processor->Self = Processor;
     HalpInitializeGdt(Processor);
     HalpInitializeIdt(Processor);
     HalpEnableApic();
     Processor->ApicId = HalpReadLapicId();
+    HalpInitializeTopology(Processor);
+    HalpInitializeExtendedState(Processor);
+    HalpCheckTscSynchronization();
     HalpInitializeApicTimer();
     HalpSetIrql(KE_IRQL_PASSIVE);
+    __atomic_store_n(&Processor->Online, 1, __ATOMIC_RELEASE);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -3,7 +3,6 @@
 
 #include <amd64/apic.h>
 #include <amd64/halp.h>
-#include <amd64/msr.h>
 #include <ke.h>
 #include <mi.h>
 #include <string.h>
@@ -58,7 +57,15 @@ void HalpInitializeSmp(void) {
             HalpProcessorList[i] = MmAllocatePool(sizeof(KeProcessor), "Halp");
         }
 
-        if (!HalpProcessorList[i]) {
+        if (HalpProcessorList[i]) {
+            /* Cross-calls track their senders/targets as one bit per processor. */
+            uint32_t Words = (HalpProcessorCount + 63) / 64;
+            HalpProcessorList[i]->IpiRequests = MmAllocatePool(Words * sizeof(uint64_t), "Halp");
+            HalpProcessorList[i]->IpiTargets = MmAllocatePool(Words * sizeof(uint64_t), "Halp");
+        }
+
+        if (!HalpProcessorList[i] || !HalpProcessorList[i]->IpiRequests ||
+            !HalpProcessorList[i]->IpiTargets) {
             KeFatalError(
                 KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
                 KE_PANIC_PARAMETER_SMP_INITIALIZATION_FAILURE,
@@ -67,6 +74,7 @@ void HalpInitializeSmp(void) {
                 0);
         }
 
+        HalpProcessorList[i]->Number = i;
         RtInitializeDList(&HalpProcessorList[i]->ThreadQueue);
         RtInitializeDList(&HalpProcessorList[i]->DpcQueue);
         RtInitializeDList(&HalpProcessorList[i]->EventQueue);
@@ -106,53 +114,130 @@ void HalpInitializeSmp(void) {
     HalpUnmapPage((void *)0x8000);
 }
 
+/* HalGetCurrentProcessor is inline (see hal.h), but drivers still import it from us, so we need to
+ * emit an external definition somewhere. */
+extern KeProcessor *HalGetCurrentProcessor(void);
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function gets a pointer to the processor-specific structure of the current processor.
- *     The result of this will always be NULL before HalpInitializePlatform().
+ *     This function notifies another processor that some (probably significant) event has
+ *     happend. Processors sleeping on MWAIT only need their wake line written to, so we skip the
+ *     IPI for them.
  *
  * PARAMETERS:
- *     None.
+ *     Processor - Which processor to notify.
+ *     WaitDelivery - Set this to 1 if we should wait for delivery (important for events!)
  *
  * RETURN VALUE:
- *     Pointer to the processor struct.
+ *     None.
  *-----------------------------------------------------------------------------------------------*/
-KeProcessor *HalGetCurrentProcessor(void) {
-    return (KeProcessor *)ReadMsr(0xC0000102);
+void HalpNotifyProcessor(KeProcessor *Processor, int WaitDelivery) {
+    if (HalpWakeIdleProcessor(Processor)) {
+        return;
+    }
+
+    HalpSendIpi(Processor->ApicId, HAL_INT_DISPATCH_VECTOR);
+
+    if (WaitDelivery) {
+        HalpWaitIpiDelivery();
+    }
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function notifies another processor that some (probably significant) event has
- *     happend.
+ *     This function sends the cross-call IPI to all the given processors, using as few ICR
+ *     writes as we can: a single broadcast if we're targeting everyone else, or one write per
+ *     cluster if we're using the x2APIC.
  *
  * PARAMETERS:
- *     Processor - Which processor to notify.
- *     WaitDelivery - Set this to 1 if we should wait for delivery (important for events!)
+ *     TargetSet - Bitmap of processor indices to notify (one bit per processor); Shouldn't
+ *                 include the current processor.
+ *     TargetCount - How many bits are set in the bitmap.
  *
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-void HalpNotifyProcessor(KeProcessor *Processor, int WaitDelivery) {
-    HalpSendIpi(Processor->ApicId, HAL_INT_DISPATCH_VECTOR);
-
-    if (WaitDelivery) {
+void HalpRequestIpi(const uint64_t *TargetSet, uint32_t TargetCount) {
+    if (TargetCount > 1 && TargetCount == HalpProcessorCount - 1) {
+        HalpBroadcastIpi(HAL_INT_IPI_VECTOR);
         HalpWaitIpiDelivery();
+        return;
+    }
+
+    uint32_t Words = (HalpProcessorCount + 63) / 64;
+
+    /* The xAPIC ICR can only take one IPI at a time. */
+    if (!HalpIsX2ApicEnabled()) {
+        for (uint32_t Word = 0; Word < Words; Word++) {
+            for (uint64_t Mask = TargetSet[Word]; Mask; Mask &= Mask - 1) {
+                HalpSendIpi(
+                    HalpProcessorList[Word * 64 + __builtin_ctzll(Mask)]->ApicId,
+                    HAL_INT_IPI_VECTOR);
+                HalpWaitIpiDelivery();
+            }
+        }
+
+        return;
+    }
+
+    /* Otherwise, batch up the targets by cluster; Processor numbers often follow the APIC IDs, so
+     * consecutive targets tend to share their cluster. */
+    uint32_t Cluster = UINT32_MAX;
+    uint32_t Members = 0;
+    for (uint32_t Word = 0; Word < Words; Word++) {
+        for (uint64_t Mask = TargetSet[Word]; Mask; Mask &= Mask - 1) {
+            uint32_t ApicId = HalpProcessorList[Word * 64 + __builtin_ctzll(Mask)]->ApicId;
+            if ((ApicId >> 4) != Cluster) {
+                if (Members) {
+                    HalpSendClusterIpi(Cluster, Members, HAL_INT_IPI_VECTOR);
+                }
+
+                Cluster = ApicId >> 4;
+                Members = 0;
+            }
+
+            Members |= 1u << (ApicId & 0x0F);
+        }
+    }
+
+    if (Members) {
+        HalpSendClusterIpi(Cluster, Members, HAL_INT_IPI_VECTOR);
     }
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function notifies another processor that it should stop running (permanently, as we
- *     don't have a way to specify it should start running again for now).
+ *     This function notifies all other processors that they should stop running (permanently,
+ *     as we don't have a way to specify they should start running again for now). Once everyone
+ *     is online, a single broadcast NMI is enough.
  *
  * PARAMETERS:
- *     Processor - Which processor to notify.
+ *     None.
  *
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-void HalpFreezeProcessor(KeProcessor *Processor) {
-    Processor->EventStatus = KE_EVENT_FREEZE;
-    HalpSendNmi(Processor->ApicId);
+void HalpFreezeProcessors(void) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    if (!HalpProcessorList) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        if (HalpProcessorList[i] != Processor) {
+            HalpProcessorList[i]->EventStatus = KE_EVENT_FREEZE;
+        }
+    }
+
+    if (__atomic_load_n(&HalpOnlineProcessorCount, __ATOMIC_RELAXED) == HalpProcessorCount) {
+        HalpBroadcastIpi(0x400);
+        return;
+    }
+
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        if (HalpProcessorList[i] != Processor) {
+            HalpSendNmi(HalpProcessorList[i]->ApicId);
+            HalpWaitIpiDelivery();
+        }
+    }
 }
@@ -2,36 +2,159 @@
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
 #include <amd64/halp.h>
+#include <amd64/msr.h>
+#include <cpuid.h>
+#include <vid.h>
+
+#define LAPIC_TIMER_ONE_SHOT 0x00000
+#define LAPIC_TIMER_MASKED 0x10000
+#define LAPIC_TIMER_TSC_DEADLINE 0x40000
+
+#define TSC_DEADLINE_MSR 0x6E0
+
+static int UseTscDeadline = 0;
+static uint64_t TscFrequency = 0;
+static uint64_t ApicTicksPerMs = 0;
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function initializes the per-CPU event timer (Local APIC Timer).
+ *     This function measures how many LAPIC timer ticks happen per millisecond. All processors
+ *     share the same timer clock, so this only needs to run once.
  *
  * PARAMETERS:
  *     None.
  *
  * RETURN VALUE:
- *     None.
+ *     LAPIC timer ticks per millisecond.
  *-----------------------------------------------------------------------------------------------*/
-void HalpInitializeApicTimer(void) {
-    /* Max out the divider. */
-    HalpWriteLapicRegister(0x3E0, 0);
-
+static uint64_t Calibrate(void) {
     /* We'll be taking the average over 4 runs. */
     uint64_t Accum = 0;
-    uint64_t Ticks = (1 * EV_MILLISECS) / HalGetTimerPeriod();
     for (int i = 0; i < 4; i++) {
-        uint64_t End = HalGetTimerTicks() + Ticks;
+        uint64_t End = HalGetTime() + 1 * EV_MILLISECS;
         HalpWriteLapicRegister(0x380, UINT32_MAX);
-        while (HalGetTimerTicks() < End)
+        while (HalGetTime() < End)
             ;
 
-        HalpWriteLapicRegister(0x320, 0x10000);
+        HalpWriteLapicRegister(0x320, LAPIC_TIMER_MASKED);
         Accum += UINT32_MAX - HalpReadLapicRegister(0x390);
     }
 
-    /* Now we can enable the LAPIC in periodic mode. */
-    HalpWriteLapicRegister(0x320, 0x20000 | HAL_INT_TIMER_VECTOR);
+    return Accum / 4;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes the per-CPU event timer (Local APIC Timer). We use the
+ *     TSC-deadline mode if possible, and one-shot mode otherwise; Either way, the timer needs to
+ *     be rearmed with HalSetNextTimerEvent after every interrupt.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpInitializeApicTimer(void) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    uint32_t Eax, Ebx, Ecx, Edx;
+
+    /* Max out the divider. */
     HalpWriteLapicRegister(0x3E0, 0);
-    HalpWriteLapicRegister(0x380, Accum / 4);
+
+    if (!Processor->Number) {
+        /* TSC-deadline needs an invariant TSC (otherwise we have no idea of how many cycles are
+         * in a nanosecond). */
+        __cpuid(1, Eax, Ebx, Ecx, Edx);
+        TscFrequency = HalpGetTscFrequency();
+        UseTscDeadline = (Ecx & 0x1000000) && TscFrequency;
+
+        if (UseTscDeadline) {
+            VidPrint(VID_MESSAGE_DEBUG, "Kernel HAL", "using TSC-deadline mode for the LAPIC\n");
+        } else {
+            ApicTicksPerMs = Calibrate();
+            VidPrint(
+                VID_MESSAGE_DEBUG,
+                "Kernel HAL",
+                "using one-shot mode for the LAPIC (%llu ticks per ms)\n",
+                ApicTicksPerMs);
+        }
+    }
+
+    if (UseTscDeadline) {
+        /* The LVT write needs to land before any writes to the deadline MSR. */
+        HalpWriteLapicRegister(0x320, LAPIC_TIMER_TSC_DEADLINE | HAL_INT_TIMER_VECTOR);
+        __asm__ volatile("mfence" : : : "memory");
+    } else {
+        HalpWriteLapicRegister(0x320, LAPIC_TIMER_ONE_SHOT | HAL_INT_TIMER_VECTOR);
+    }
+
+    /* Kick off the clock tick (the timer handler keeps rearming it after this). */
+    Processor->NextTimerEvent = UINT64_MAX;
+    HalSetNextTimerEvent(HalGetTime() + 1 * EV_MILLISECS);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function marks the armed timer event of the current processor as fired (and accounts
+ *     for it in the interrupt statistics). This should be called by the timer interrupt handler,
+ *     before anything else.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpAcknowledgeTimerEvent(void) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    Processor->NextTimerEvent = UINT64_MAX;
+    __atomic_add_fetch(&Processor->InterruptCounts[HAL_INT_TIMER_VECTOR], 1, __ATOMIC_RELAXED);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function arms the timer of the current processor to fire at the given time, unless
+ *     it's already armed to fire earlier than that.
+ *
+ * PARAMETERS:
+ *     Time - Absolute time (in the same base as HalGetTime) of the event, in nanoseconds.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalSetNextTimerEvent(uint64_t Time) {
+    void *Context = HalpEnterCriticalSection();
+    KeProcessor *Processor = HalGetCurrentProcessor();
+
+    if (Time >= Processor->NextTimerEvent) {
+        HalpLeaveCriticalSection(Context);
+        return;
+    }
+
+    Processor->NextTimerEvent = Time;
+
+    /* The timers count in their own units, so we need a relative delay (this also keeps us
+     * independent from which clock source HalGetTime is using). */
+    uint64_t CurrentTime = HalGetTime();
+    uint64_t Delay = Time > CurrentTime ? Time - CurrentTime : 0;
+
+    if (UseTscDeadline) {
+        /* Cap the delay so the multiplication can't overflow; We'll just get an early event and
+         * rearm if anyone asks for more than that. */
+        if (Delay > EV_SECS) {
+            Delay = EV_SECS;
+        }
+
+        WriteMsr(TSC_DEADLINE_MSR, HalpReadTsc() + Delay * TscFrequency / EV_SECS + 1);
+    } else {
+        uint64_t Count = Delay * ApicTicksPerMs / EV_MILLISECS;
+        if (Delay > EV_SECS || Count > UINT32_MAX) {
+            Count = UINT32_MAX;
+        }
+
+        HalpWriteLapicRegister(0x380, Count ? Count : 1);
+    }
+
+    HalpLeaveCriticalSection(Context);
 }
@@ -0,0 +1,210 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+#include <cpuid.h>
+
+#define SRAT_LAPIC_RECORD 0
+#define SRAT_X2APIC_RECORD 2
+
+typedef struct __attribute__((packed)) {
+    char Signature[4];
+    uint32_t Length;
+    char Unused[40];
+} SratHeader;
+
+typedef struct __attribute__((packed)) {
+    uint8_t Type;
+    uint8_t Length;
+    union {
+        struct __attribute__((packed)) {
+            uint8_t ProximityDomainLow;
+            uint8_t ApicId;
+            uint32_t Flags;
+            uint8_t SapicEid;
+            uint8_t ProximityDomainHigh[3];
+            uint32_t ClockDomain;
+        } Lapic;
+        struct __attribute__((packed)) {
+            uint16_t Reserved;
+            uint32_t ProximityDomain;
+            uint32_t X2ApicId;
+            uint32_t Flags;
+            uint32_t ClockDomain;
+        } X2Apic;
+    };
+} SratRecord;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets how many bits of the APIC ID are needed to represent the given amount of
+ *     logical processors.
+ *
+ * PARAMETERS:
+ *     Count - How many logical processors share the same topology level.
+ *
+ * RETURN VALUE:
+ *     How much the APIC ID should be shifted right to get the ID of the next level.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t GetShift(uint32_t Count) {
+    uint32_t Shift = 0;
+    while ((1u << Shift) < Count) {
+        Shift++;
+    }
+
+    return Shift;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function walks the deterministic cache parameters leaf (leaf 4 on Intel, 0x8000001D on
+ *     AMD), looking for the last level cache.
+ *
+ * PARAMETERS:
+ *     Leaf - Which CPUID leaf to use.
+ *     Shift - Output; How much the APIC ID should be shifted to get the LLC ID.
+ *
+ * RETURN VALUE:
+ *     1 if we found at least one cache level, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int GetCacheShift(uint32_t Leaf, uint32_t *Shift) {
+    uint32_t HighestLevel = 0;
+    uint32_t Eax, Ebx, Ecx, Edx;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        __cpuid_count(Leaf, i, Eax, Ebx, Ecx, Edx);
+
+        /* Type 0 means there are no more caches. */
+        if (!(Eax & 0x1F)) {
+            break;
+        }
+
+        uint32_t Level = (Eax >> 5) & 0x07;
+        if (Level >= HighestLevel) {
+            HighestLevel = Level;
+            *Shift = GetShift(((Eax >> 14) & 0xFFF) + 1);
+        }
+    }
+
+    return HighestLevel != 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches the SRAT for the NUMA node (proximity domain) of the given processor.
+ *
+ * PARAMETERS:
+ *     ApicId - APIC ID of the processor.
+ *
+ * RETURN VALUE:
+ *     Proximity domain of the processor, or 0 if the system has no SRAT (or the processor isn't
+ *     listed in it).
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t GetNodeId(uint32_t ApicId) {
+    SratHeader *Srat = KiFindAcpiTable("SRAT", 0);
+    if (!Srat) {
+        return 0;
+    }
+
+    char *Position = (char *)(Srat + 1);
+    char *End = (char *)Srat + Srat->Length;
+    while (Position + 2 <= End) {
+        SratRecord *Record = (SratRecord *)Position;
+        if (Record->Length < 2) {
+            break;
+        }
+
+        if (Record->Type == SRAT_LAPIC_RECORD && (Record->Lapic.Flags & 1) &&
+            Record->Lapic.ApicId == ApicId) {
+            return Record->Lapic.ProximityDomainLow |
+                   ((uint32_t)Record->Lapic.ProximityDomainHigh[0] << 8) |
+                   ((uint32_t)Record->Lapic.ProximityDomainHigh[1] << 16) |
+                   ((uint32_t)Record->Lapic.ProximityDomainHigh[2] << 24);
+        } else if (
+            Record->Type == SRAT_X2APIC_RECORD && (Record->X2Apic.Flags & 1) &&
+            Record->X2Apic.X2ApicId == ApicId) {
+            return Record->X2Apic.ProximityDomain;
+        }
+
+        Position += Record->Length;
+    }
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function figures out where the current processor sits in the system topology (which
+ *     core, last level cache, package and NUMA node it belongs to), using its APIC ID, the CPUID
+ *     topology leaves, and the SRAT.
+ *
+ * PARAMETERS:
+ *     Processor - Processor block of the current processor.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpInitializeTopology(KeProcessor *Processor) {
+    uint32_t Eax, Ebx, Ecx, Edx;
+    uint32_t SmtShift = 0;
+    uint32_t PackageShift = 0;
+    uint32_t CacheShift = 0;
+
+    __cpuid(0, Eax, Ebx, Ecx, Edx);
+    uint32_t MaxLeaf = Eax;
+    __cpuid(0x80000000, Eax, Ebx, Ecx, Edx);
+    uint32_t MaxExtendedLeaf = Eax;
+
+    /* Prefer the extended topology leaf (0xB), it directly tells us how many APIC ID bits each
+     * level uses. */
+    int HasExtendedTopology = 0;
+    if (MaxLeaf >= 0x0B) {
+        __cpuid_count(0x0B, 0, Eax, Ebx, Ecx, Edx);
+        HasExtendedTopology = Ebx != 0;
+    }
+
+    if (HasExtendedTopology) {
+        for (uint32_t i = 0; i < 8; i++) {
+            __cpuid_count(0x0B, i, Eax, Ebx, Ecx, Edx);
+
+            uint32_t Type = (Ecx >> 8) & 0xFF;
+            if (!Type) {
+                break;
+            } else if (Type == 1) {
+                SmtShift = Eax & 0x1F;
+            }
+
+            PackageShift = Eax & 0x1F;
+        }
+    } else {
+        /* Legacy fallback, leaf 1 gives the logical processor count per package, and leaf 4
+         * gives the core count. */
+        __cpuid(1, Eax, Ebx, Ecx, Edx);
+        PackageShift = (Edx & 0x10000000) ? GetShift((Ebx >> 16) & 0xFF) : 0;
+
+        if (MaxLeaf >= 4) {
+            __cpuid_count(4, 0, Eax, Ebx, Ecx, Edx);
+            uint32_t CoreShift = GetShift(((Eax >> 26) & 0x3F) + 1);
+            SmtShift = PackageShift > CoreShift ? PackageShift - CoreShift : 0;
+        }
+    }
+
+    /* If we can't find the LLC, assume it's shared by the whole package. */
+    CacheShift = PackageShift;
+    if (MaxLeaf < 4 || !GetCacheShift(4, &CacheShift)) {
+        int HasTopologyExtensions = 0;
+        if (MaxExtendedLeaf >= 0x8000001D) {
+            __cpuid(0x80000001, Eax, Ebx, Ecx, Edx);
+            HasTopologyExtensions = (Ecx & 0x400000) != 0;
+        }
+
+        if (!HasTopologyExtensions || !GetCacheShift(0x8000001D, &CacheShift)) {
+            CacheShift = PackageShift;
+        }
+    }
+
+    Processor->CoreId = Processor->ApicId >> SmtShift;
+    Processor->CacheId = Processor->ApicId >> CacheShift;
+    Processor->PackageId = Processor->ApicId >> PackageShift;
+    Processor->NodeId = GetNodeId(Processor->ApicId);
+}
@@ -0,0 +1,223 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+#include <amd64/msr.h>
+#include <cpuid.h>
+#include <vid.h>
+
+#define TSC_ADJUST_MSR 0x3B
+
+#define CALIBRATION_RUNS 3
+#define CALIBRATION_TIME (10 * EV_MILLISECS)
+#define SYNCHRONIZATION_TIME (2 * EV_MILLISECS)
+
+static HalpClockSource ClockSource = {};
+static HalpClockSource *FallbackSource = NULL;
+static int HasTscAdjust = 0;
+static uint64_t BootTscAdjust = 0;
+static uint64_t LastTsc = 0;
+static int Unstable = 0;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads the time stamp counter.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Current TSC value.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t HalpReadTsc(void) {
+    uint32_t LowPart;
+    uint32_t HighPart;
+    __asm__ volatile("rdtsc" : "=a"(LowPart), "=d"(HighPart));
+    return LowPart | ((uint64_t)HighPart << 32);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads the time stamp counter, making sure the read can't be executed before
+ *     any earlier loads.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Current TSC value.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t ReadTscOrdered(void) {
+    uint32_t LowPart;
+    uint32_t HighPart;
+    __asm__ volatile("lfence; rdtsc" : "=a"(LowPart), "=d"(HighPart) : : "memory");
+    return LowPart | ((uint64_t)HighPart << 32);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures the TSC frequency against the current clock source (the HPET).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     TSC frequency in Hz.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t Calibrate(void) {
+    uint64_t Samples[CALIBRATION_RUNS];
+
+    for (int i = 0; i < CALIBRATION_RUNS; i++) {
+        uint64_t StartTime = HalGetTime();
+        uint64_t StartTsc = ReadTscOrdered();
+        uint64_t EndTime;
+        do {
+            EndTime = HalGetTime();
+        } while (EndTime - StartTime < CALIBRATION_TIME);
+        uint64_t EndTsc = ReadTscOrdered();
+
+        Samples[i] = (EndTsc - StartTsc) * EV_SECS / (EndTime - StartTime);
+    }
+
+    /* Use the median, one of the runs might have been disturbed by an SMI or a VM exit. */
+    for (int i = 1; i < CALIBRATION_RUNS; i++) {
+        for (int j = i; j > 0 && Samples[j - 1] > Samples[j]; j--) {
+            uint64_t Sample = Samples[j];
+            Samples[j] = Samples[j - 1];
+            Samples[j - 1] = Sample;
+        }
+    }
+
+    return Samples[CALIBRATION_RUNS / 2];
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the processor has an invariant TSC, and if so, calibrates it and
+ *     switches the system clock source over to it. This should be called once, on the BSP, after
+ *     the HPET is initialized.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpInitializeTsc(void) {
+    uint32_t Eax, Ebx, Ecx, Edx;
+
+    /* Without the invariant bit, the TSC rate might change with P-/C-states. */
+    __cpuid(0x80000000, Eax, Ebx, Ecx, Edx);
+    if (Eax < 0x80000007) {
+        return;
+    }
+
+    __cpuid(0x80000007, Eax, Ebx, Ecx, Edx);
+    if (!(Edx & 0x100)) {
+        VidPrint(VID_MESSAGE_DEBUG, "Kernel HAL", "TSC is not invariant, not using it\n");
+        return;
+    }
+
+    __cpuid(0, Eax, Ebx, Ecx, Edx);
+    if (Eax >= 7) {
+        __cpuid_count(7, 0, Eax, Ebx, Ecx, Edx);
+        HasTscAdjust = (Ebx & 0x02) != 0;
+        if (HasTscAdjust) {
+            BootTscAdjust = ReadMsr(TSC_ADJUST_MSR);
+        }
+    }
+
+    FallbackSource = HalpGetClockSource();
+    ClockSource.Name = "TSC";
+    ClockSource.Read = HalpReadTsc;
+    ClockSource.Frequency = Calibrate();
+    HalpSetClockSource(&ClockSource);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the TSC of the current processor is in sync with the others. All
+ *     processors run this at around the same time during boot, each one checking that its TSC
+ *     never goes behind the latest value read by anyone else. If it does, we go back to the
+ *     fallback clock source.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpCheckTscSynchronization(void) {
+    if (HalpGetClockSource() != &ClockSource) {
+        return;
+    }
+
+    /* Firmware sometimes leaves the APs with a different TSC adjustment than the BSP; Fixing it
+     * up is a lot better than giving up on the TSC. */
+    if (HasTscAdjust && ReadMsr(TSC_ADJUST_MSR) != BootTscAdjust) {
+        WriteMsr(TSC_ADJUST_MSR, BootTscAdjust);
+    }
+
+    uint64_t EndTime = HalGetTime() + SYNCHRONIZATION_TIME;
+    while (HalGetTime() < EndTime && !__atomic_load_n(&Unstable, __ATOMIC_RELAXED)) {
+        uint64_t Last = __atomic_load_n(&LastTsc, __ATOMIC_ACQUIRE);
+        uint64_t Current = ReadTscOrdered();
+
+        if (Current < Last) {
+            if (!__atomic_exchange_n(&Unstable, 1, __ATOMIC_SEQ_CST)) {
+                VidPrint(
+                    VID_MESSAGE_DEBUG,
+                    "Kernel HAL",
+                    "TSC is out of sync on processor %u (by %llu cycles)\n",
+                    HalGetCurrentProcessor()->Number,
+                    Last - Current);
+                HalpSetClockSource(FallbackSource);
+            }
+
+            break;
+        }
+
+        while (Current > Last) {
+            if (__atomic_compare_exchange_n(
+                    &LastTsc, &Last, Current, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the calibrated TSC frequency.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     TSC frequency in Hz, or 0 if the TSC isn't invariant (and as such, was never calibrated).
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t HalpGetTscFrequency(void) {
+    return ClockSource.Frequency;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets a cheap timestamp for measuring short intervals on the current
+ *     processor. This uses the TSC when we managed to calibrate it (even if it turned out to be
+ *     out of sync between processors, which doesn't matter for local intervals), and the current
+ *     clock source otherwise.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Timestamp in nanoseconds; Only differences between two timestamps taken on the same
+ *     processor are meaningful.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t HalpReadTimestamp(void) {
+    if (!ClockSource.Frequency) {
+        return HalGetTime();
+    }
+
+    return ((unsigned __int128)HalpReadTsc() * ClockSource.Multiplier) >> HALP_CLOCK_SOURCE_SHIFT;
+}
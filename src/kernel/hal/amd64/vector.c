@@ -0,0 +1,100 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+
+#define SPURIOUS_VECTOR 0xFF
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given vector is free on the processor (not allocated, not
+ *     reserved by the HAL, and without any manually installed handlers).
+ *
+ * PARAMETERS:
+ *     Processor - Which processor to check.
+ *     Vector - Which vector to check.
+ *
+ * RETURN VALUE:
+ *     1 if the vector is free, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int IsVectorFree(KeProcessor *Processor, uint32_t Vector) {
+    if (Vector < (KE_IRQL_DEVICE << 4) || Vector == HAL_INT_TIMER_VECTOR ||
+        Vector == HAL_INT_IPI_VECTOR || Vector == SPURIOUS_VECTOR) {
+        return 0;
+    } else if (Processor->VectorBitmap[Vector >> 6] & (1ull << (Vector & 63))) {
+        return 0;
+    }
+
+    RtDList *Handlers = &Processor->InterruptList[Vector];
+    return Handlers->Next == Handlers;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates a block of contiguous vectors on the given processor. The block is
+ *     aligned to its size (as required by multi-message MSI), and all vectors in it share the
+ *     same IRQL.
+ *
+ * PARAMETERS:
+ *     Processor - Which processor the vectors are for.
+ *     Irql - Which IRQL the vectors should be at.
+ *     Count - How many vectors we need; Should be a power of 2, up to 16.
+ *     Vector - Output; First vector of the block.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if there's no free block at that IRQL.
+ *-----------------------------------------------------------------------------------------------*/
+int HalpAllocateVectors(KeProcessor *Processor, KeIrql Irql, uint32_t Count, uint32_t *Vector) {
+    if (Irql < KE_IRQL_DEVICE || Irql > KE_IRQL_MASK || !Count || Count > 16 ||
+        (Count & (Count - 1))) {
+        return 0;
+    }
+
+    KeIrql OldIrql = KeAcquireSpinLock(&Processor->InterruptListLock);
+
+    for (uint32_t Base = Irql << 4; Base < (Irql + 1) << 4; Base += Count) {
+        uint32_t i = 0;
+        while (i < Count && IsVectorFree(Processor, Base + i)) {
+            i++;
+        }
+
+        if (i < Count) {
+            continue;
+        }
+
+        for (i = 0; i < Count; i++) {
+            Processor->VectorBitmap[(Base + i) >> 6] |= 1ull << ((Base + i) & 63);
+        }
+
+        Processor->VectorCount += Count;
+        KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
+        *Vector = Base;
+        return 1;
+    }
+
+    KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
+    return 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function returns a block of vectors allocated by HalpAllocateVectors.
+ *
+ * PARAMETERS:
+ *     Processor - Which processor the vectors were allocated on.
+ *     Vector - First vector of the block.
+ *     Count - How many vectors were allocated.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpFreeVectors(KeProcessor *Processor, uint32_t Vector, uint32_t Count) {
+    KeIrql OldIrql = KeAcquireSpinLock(&Processor->InterruptListLock);
+
+    for (uint32_t i = 0; i < Count; i++) {
+        Processor->VectorBitmap[(Vector + i) >> 6] &= ~(1ull << ((Vector + i) & 63));
+    }
+
+    Processor->VectorCount -= Count;
+    KeReleaseSpinLock(&Processor->InterruptListLock, OldIrql);
+}
@@ -0,0 +1,465 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <amd64/halp.h>
+#include <amd64/msr.h>
+#include <cpuid.h>
+#include <ke.h>
+#include <mm.h>
+#include <ps.h>
+#include <string.h>
+
+#define XSTATE_X87 0x01
+#define XSTATE_SSE 0x02
+#define XSTATE_AVX 0x04
+#define XSTATE_AVX512 0xE0
+
+#define XSTATE_HEADER_XCOMP_BV 520
+#define XSTATE_COMPACTED (1ull << 63)
+
+#define MODE_FNSAVE 0
+#define MODE_XSAVE 1
+#define MODE_XSAVEOPT 2
+#define MODE_XSAVES 3
+
+/* Slots for KeSaveExtendedState, one for each IRQL from DISPATCH and up. */
+#define SLOT_COUNT (KE_IRQL_MASK - KE_IRQL_DISPATCH + 1)
+
+static int Mode = MODE_FNSAVE;
+static int HasInUseTracking = 0;
+static uint64_t EnabledFeatures = XSTATE_X87 | XSTATE_SSE;
+static uint64_t ManagedFeatures = XSTATE_X87;
+static uint32_t AreaSize = 108;
+static char *InitialArea = NULL;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads which of the managed state components aren't in their initial
+ *     configuration right now (XINUSE).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Bitmask of the in use components, or all managed components if the processor doesn't
+ *     support telling us that.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t GetInUseFeatures(void) {
+    if (!HasInUseTracking) {
+        return ManagedFeatures;
+    }
+
+    uint32_t LowPart;
+    uint32_t HighPart;
+    __asm__ volatile("xgetbv" : "=a"(LowPart), "=d"(HighPart) : "c"(1));
+    return (LowPart | ((uint64_t)HighPart << 32)) & ManagedFeatures;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function saves the managed extended state components into the given area, using the
+ *     best instruction the processor has.
+ *
+ * PARAMETERS:
+ *     Area - 64-byte aligned save area.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void SaveArea(char *Area) {
+    uint32_t LowPart = ManagedFeatures;
+    uint32_t HighPart = ManagedFeatures >> 32;
+
+    switch (Mode) {
+        case MODE_XSAVES:
+            __asm__ volatile("xsaves64 (%0)"
+                             :
+                             : "r"(Area), "a"(LowPart), "d"(HighPart)
+                             : "memory");
+            break;
+        case MODE_XSAVEOPT:
+            __asm__ volatile("xsaveopt64 (%0)"
+                             :
+                             : "r"(Area), "a"(LowPart), "d"(HighPart)
+                             : "memory");
+            break;
+        case MODE_XSAVE:
+            __asm__ volatile("xsave64 (%0)"
+                             :
+                             : "r"(Area), "a"(LowPart), "d"(HighPart)
+                             : "memory");
+            break;
+        default:
+            __asm__ volatile("fnsave (%0)" : : "r"(Area) : "memory");
+            break;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function loads the managed extended state components from the given area.
+ *
+ * PARAMETERS:
+ *     Area - 64-byte aligned save area.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void RestoreArea(char *Area) {
+    uint32_t LowPart = ManagedFeatures;
+    uint32_t HighPart = ManagedFeatures >> 32;
+
+    switch (Mode) {
+        case MODE_XSAVES:
+            __asm__ volatile("xrstors64 (%0)"
+                             :
+                             : "r"(Area), "a"(LowPart), "d"(HighPart)
+                             : "memory");
+            break;
+        case MODE_XSAVEOPT:
+        case MODE_XSAVE:
+            __asm__ volatile("xrstor64 (%0)"
+                             :
+                             : "r"(Area), "a"(LowPart), "d"(HighPart)
+                             : "memory");
+            break;
+        default:
+            __asm__ volatile("frstor (%0)" : : "r"(Area) : "memory");
+            break;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function fills the given area with the initial configuration of all managed
+ *     components.
+ *
+ * PARAMETERS:
+ *     Area - 64-byte aligned save area.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void InitializeArea(char *Area) {
+    memset(Area, 0, AreaSize);
+
+    if (Mode == MODE_FNSAVE) {
+        /* FRSTOR has no notion of "initial state", so we need the actual default values (control
+         * word, and all registers tagged as empty). */
+        *(uint16_t *)Area = 0x37F;
+        *(uint16_t *)(Area + 8) = 0xFFFF;
+    } else if (Mode == MODE_XSAVES) {
+        /* XSTATE_BV stays zeroed (everything is in the initial configuration), but XRSTORS
+         * requires the compacted format bit. */
+        *(uint64_t *)(Area + XSTATE_HEADER_XCOMP_BV) = XSTATE_COMPACTED | ManagedFeatures;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates a 64-byte aligned save area.
+ *
+ * PARAMETERS:
+ *     Size - How many bytes we need.
+ *     Buffer - Output; Raw pool allocation, to be passed into MmFreePool later.
+ *
+ * RETURN VALUE:
+ *     Aligned save area, or NULL if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+static char *AllocateArea(uint64_t Size, void **Buffer) {
+    *Buffer = MmAllocatePool(Size + 63, "Halp");
+    if (!*Buffer) {
+        return NULL;
+    }
+
+    return (char *)(((uint64_t)*Buffer + 63) & ~63ull);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function detects the extended state instructions and components supported by the
+ *     processor, and enables them. On the BSP, this also decides which save/restore path we'll be
+ *     using everywhere; The APs are expected to support the same features as the BSP.
+ *
+ * PARAMETERS:
+ *     Processor - Processor block of the current processor.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpInitializeExtendedState(KeProcessor *Processor) {
+    uint32_t Eax, Ebx, Ecx, Edx;
+
+    if (Processor->Number == 0) {
+        __cpuid(0, Eax, Ebx, Ecx, Edx);
+        uint32_t MaxLeaf = Eax;
+        __cpuid(1, Eax, Ebx, Ecx, Edx);
+
+        if ((Ecx & 0x4000000) && MaxLeaf >= 0x0D) {
+            __cpuid_count(0x0D, 0, Eax, Ebx, Ecx, Edx);
+            uint64_t Supported = Eax | ((uint64_t)Edx << 32);
+
+            /* We only enable the components that need no extra setup (so no MPX, PKRU or AMX);
+             * AVX-512 also needs all three of its components, or none at all. */
+            EnabledFeatures = XSTATE_X87 | XSTATE_SSE;
+            if (Supported & XSTATE_AVX) {
+                EnabledFeatures |= XSTATE_AVX;
+                if ((Supported & XSTATE_AVX512) == XSTATE_AVX512) {
+                    EnabledFeatures |= XSTATE_AVX512;
+                }
+            }
+
+            /* XMM0-15 and MXCSR are already handled by the exception frames during the context
+             * switch, so we leave the SSE component out. */
+            ManagedFeatures = EnabledFeatures & ~XSTATE_SSE;
+
+            __cpuid_count(0x0D, 1, Eax, Ebx, Ecx, Edx);
+            HasInUseTracking = (Eax & 0x04) != 0;
+            if (Eax & 0x08) {
+                Mode = MODE_XSAVES;
+            } else if (Eax & 0x01) {
+                Mode = MODE_XSAVEOPT;
+            } else {
+                Mode = MODE_XSAVE;
+            }
+        }
+    }
+
+    if (Mode != MODE_FNSAVE) {
+        uint64_t Cr4;
+        __asm__ volatile("mov %%cr4, %0" : "=r"(Cr4));
+        __asm__ volatile("mov %0, %%cr4" : : "r"(Cr4 | 0x40000));
+        __asm__ volatile("xsetbv"
+                         :
+                         : "a"((uint32_t)EnabledFeatures),
+                           "d"((uint32_t)(EnabledFeatures >> 32)),
+                           "c"(0));
+
+        /* We have no supervisor components, but XSAVES still checks against XCR0 | XSS. */
+        if (Mode == MODE_XSAVES) {
+            WriteMsr(0xDA0, 0);
+        }
+    }
+
+    /* The size only makes sense once XCR0 is set up (it's the size for the enabled components,
+     * not for all supported ones). */
+    if (Processor->Number == 0) {
+        if (Mode == MODE_XSAVES) {
+            __cpuid_count(0x0D, 1, Eax, Ebx, Ecx, Edx);
+            AreaSize = Ebx;
+        } else if (Mode != MODE_FNSAVE) {
+            __cpuid_count(0x0D, 0, Eax, Ebx, Ecx, Edx);
+            AreaSize = Ebx;
+        }
+
+        AreaSize = (AreaSize + 63) & ~63u;
+
+        void *Buffer;
+        InitialArea = AllocateArea(AreaSize, &Buffer);
+        if (!InitialArea) {
+            KeFatalError(
+                KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+                KE_PANIC_PARAMETER_XSTATE_INITIALIZATION_FAILURE,
+                KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+                0,
+                0);
+        }
+
+        InitializeArea(InitialArea);
+    }
+
+    void *Buffer;
+    Processor->ExtendedStateSlots = AllocateArea(AreaSize * SLOT_COUNT, &Buffer);
+    if (!Processor->ExtendedStateSlots) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_XSTATE_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0,
+            0);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates the extended state save area for a new thread. The area starts out
+ *     in the initial configuration.
+ *
+ * PARAMETERS:
+ *     Context - Which thread context we're initializing.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+int HalpAllocateExtendedState(HalContextFrame *Context) {
+    void *Buffer;
+    Context->ExtendedState = AllocateArea(AreaSize, &Buffer);
+    Context->ExtendedStateBuffer = Buffer;
+    if (!Context->ExtendedState) {
+        return 0;
+    }
+
+    InitializeArea(Context->ExtendedState);
+    Context->ExtendedStateInUse = 0;
+    Context->ExtendedStateUsers = 0;
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function frees the extended state save area of a thread.
+ *
+ * PARAMETERS:
+ *     Context - Which thread context we're cleaning up.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpFreeExtendedState(HalContextFrame *Context) {
+    if (Context->ExtendedStateBuffer) {
+        MmFreePool(Context->ExtendedStateBuffer, "Halp");
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets called by KeSaveExtendedState() below DISPATCH, marking the current
+ *     thread as a user of the extended registers until the matching HalpLeaveExtendedState().
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpEnterExtendedState(void) {
+    PsThread *Thread = KeGetCurrentThread();
+    if (Thread) {
+        __atomic_add_fetch(&Thread->Context.ExtendedStateUsers, 1, __ATOMIC_RELAXED);
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function undoes HalpEnterExtendedState().
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpLeaveExtendedState(void) {
+    PsThread *Thread = KeGetCurrentThread();
+    if (Thread) {
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        __atomic_sub_fetch(&Thread->Context.ExtendedStateUsers, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function saves the extended state of the thread we're switching away from. We skip the
+ *     save entirely if none of the managed components left their initial configuration (which is
+ *     the common case, as the kernel itself never touches anything above SSE), and XSAVEOPT/XSAVES
+ *     additionally skip any components that weren't modified since the last restore.
+ *     Without XSAVE, we have no way to tell if the x87 registers were touched, so we only save
+ *     them for threads inside a KeSaveExtendedState() bracket (the only place kernel code is
+ *     allowed to use them).
+ *
+ * PARAMETERS:
+ *     Context - Context of the current thread.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpSaveExtendedState(HalContextFrame *Context) {
+    int InUse;
+    if (Mode == MODE_FNSAVE) {
+        InUse = __atomic_load_n(&Context->ExtendedStateUsers, __ATOMIC_RELAXED) != 0;
+    } else {
+        InUse = GetInUseFeatures() != 0;
+    }
+
+    if (!InUse) {
+        Context->ExtendedStateInUse = 0;
+        return;
+    }
+
+    SaveArea(Context->ExtendedState);
+    Context->ExtendedStateInUse = 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function loads the extended state of the thread we're switching into. If the target
+ *     has nothing saved, we only need to reset the registers if the previous thread left them
+ *     dirty (FNSAVE already resets them after saving, and isn't used for clean threads).
+ *
+ * PARAMETERS:
+ *     Context - Context of the target thread.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpRestoreExtendedState(HalContextFrame *Context) {
+    if (Context->ExtendedStateInUse) {
+        RestoreArea(Context->ExtendedState);
+    } else if (Mode != MODE_FNSAVE && GetInUseFeatures()) {
+        RestoreArea(InitialArea);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function saves the extended state of whatever we interrupted into the current
+ *     processor's slot for the given IRQL.
+ *
+ * PARAMETERS:
+ *     Irql - Current IRQL; Should be DISPATCH or above.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the slot is already in use (nested save at the same IRQL).
+ *-----------------------------------------------------------------------------------------------*/
+int HalpSaveExtendedStateSlot(KeIrql Irql) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    uint32_t Slot = Irql - KE_IRQL_DISPATCH;
+
+    if (Processor->ExtendedStateSlotsBusy & (1u << Slot)) {
+        return 0;
+    }
+
+    Processor->ExtendedStateSlotsBusy |= 1u << Slot;
+    if (Mode == MODE_FNSAVE || GetInUseFeatures()) {
+        Processor->ExtendedStateSlotsDirty |= 1u << Slot;
+        SaveArea(Processor->ExtendedStateSlots + Slot * AreaSize);
+    } else {
+        Processor->ExtendedStateSlotsDirty &= ~(1u << Slot);
+    }
+
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function undoes HalpSaveExtendedStateSlot, restoring the interrupted extended state.
+ *
+ * PARAMETERS:
+ *     Irql - IRQL passed to HalpSaveExtendedStateSlot.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpRestoreExtendedStateSlot(KeIrql Irql) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    uint32_t Slot = Irql - KE_IRQL_DISPATCH;
+
+    if (Processor->ExtendedStateSlotsDirty & (1u << Slot)) {
+        RestoreArea(Processor->ExtendedStateSlots + Slot * AreaSize);
+    } else if (Mode != MODE_FNSAVE && GetInUseFeatures()) {
+        RestoreArea(InitialArea);
+    }
+
+    Processor->ExtendedStateSlotsBusy &= ~(1u << Slot);
+}
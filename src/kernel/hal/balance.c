@@ -0,0 +1,226 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+#include <mm.h>
+
+/* How often the balancer wakes up, and how many interrupts (per interval) a processor needs to
+ * handle before we consider it worth moving anything away from it. */
+#define BALANCE_INTERVAL (1 * EV_SECS)
+#define BALANCE_MIN_RATE 1000
+
+/* The busiest processor needs to handle at least this many percent as many interrupts as the
+ * target, otherwise we'd just keep bouncing the same interrupt around. */
+#define BALANCE_IMBALANCE 150
+
+static KeSpinLock ListLock = {0};
+static RtDList ListHead = {&ListHead, &ListHead};
+static uint64_t *Loads = NULL;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function calculates how far away (in the topology) two processors are; Moving an
+ *     interrupt further away from where it used to be is more likely to move it away from the
+ *     threads that consume its data.
+ *
+ * PARAMETERS:
+ *     Source - Where the interrupt is currently being handled.
+ *     Target - Where we're thinking of moving it to.
+ *
+ * RETURN VALUE:
+ *     0 if the processors share their last level cache, 1 if they share a NUMA node, 2 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t GetDistance(KeProcessor *Source, KeProcessor *Target) {
+    if (Source->CacheId == Target->CacheId && Source->PackageId == Target->PackageId) {
+        return 0;
+    } else if (Source->NodeId == Target->NodeId) {
+        return 1;
+    } else {
+        return 2;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function samples how many times each tracked interrupt fired since the last pass, and
+ *     moves at most one interrupt away from the busiest processor.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void Balance(void) {
+    uint32_t Count = HalpProcessorCount < 64 ? HalpProcessorCount : 64;
+
+    for (uint32_t i = 0; i < Count; i++) {
+        Loads[i] = 0;
+    }
+
+    KeIrql OldIrql = KeAcquireSpinLock(&ListLock);
+
+    for (RtDList *ListHeader = ListHead.Next; ListHeader != &ListHead;
+         ListHeader = ListHeader->Next) {
+        HalpInterrupt *Interrupt = CONTAINING_RECORD(ListHeader, HalpInterrupt, BalanceListHeader);
+        uint64_t Total = __atomic_load_n(&Interrupt->Count, __ATOMIC_RELAXED);
+        Interrupt->Rate = Total - Interrupt->LastCount;
+        Interrupt->LastCount = Total;
+
+        if (Interrupt->Processor < Count) {
+            Loads[Interrupt->Processor] += Interrupt->Rate;
+        }
+    }
+
+    uint32_t Busiest = 0;
+    for (uint32_t i = 1; i < Count; i++) {
+        if (Loads[i] > Loads[Busiest]) {
+            Busiest = i;
+        }
+    }
+
+    if (Loads[Busiest] < BALANCE_MIN_RATE) {
+        KeReleaseSpinLock(&ListLock, OldIrql);
+        return;
+    }
+
+    /* Prefer processors close to the busiest one; Each step away in the topology costs us a
+     * fraction of the busiest processor's load. */
+    KeProcessor *Source = HalpProcessorList[Busiest];
+    uint32_t Target = Busiest;
+    uint64_t TargetScore = UINT64_MAX;
+    for (uint32_t i = 0; i < Count; i++) {
+        if (i == Busiest || HalpProcessorList[i]->ApicId > 0xFF) {
+            continue;
+        }
+
+        uint64_t Score =
+            Loads[i] + GetDistance(Source, HalpProcessorList[i]) * (Loads[Busiest] / 4);
+        if (Score < TargetScore) {
+            TargetScore = Score;
+            Target = i;
+        }
+    }
+
+    if (Target == Busiest || Loads[Busiest] * 100 <= Loads[Target] * BALANCE_IMBALANCE) {
+        KeReleaseSpinLock(&ListLock, OldIrql);
+        return;
+    }
+
+    /* Move the heaviest interrupt that doesn't just flip the imbalance around. Edge triggered
+     * lines stay where they are, as moving them means masking the pin, and any edge that comes in
+     * while it's masked is gone for good (they still count towards the processor load). */
+    uint64_t Difference = Loads[Busiest] - Loads[Target];
+    HalpInterrupt *Candidate = NULL;
+    for (RtDList *ListHeader = ListHead.Next; ListHeader != &ListHead;
+         ListHeader = ListHeader->Next) {
+        HalpInterrupt *Interrupt = CONTAINING_RECORD(ListHeader, HalpInterrupt, BalanceListHeader);
+        if (Interrupt->Processor != Busiest || !Interrupt->Rate ||
+            Interrupt->Rate >= Difference || !(Interrupt->AffinityMask & (1ull << Target)) ||
+            (Interrupt->Source == HALP_INT_SOURCE_MESSAGE && !Interrupt->MsixTable) ||
+            (Interrupt->Source == HALP_INT_SOURCE_LINE && Interrupt->Type == HAL_INT_TYPE_EDGE) ||
+            (Candidate && Interrupt->Rate <= Candidate->Rate)) {
+            continue;
+        }
+
+        Candidate = Interrupt;
+    }
+
+    /* Claiming the interrupt while still holding the list lock makes sure it can't be disabled
+     * under us. */
+    if (Candidate && __atomic_exchange_n(&Candidate->Moving, 1, __ATOMIC_ACQUIRE)) {
+        Candidate = NULL;
+    }
+
+    KeReleaseSpinLock(&ListLock, OldIrql);
+
+    if (Candidate) {
+        HalpMoveInterrupt(Candidate, HalpProcessorList[Target]);
+        __atomic_store_n(&Candidate->Moving, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function is the main loop of the interrupt balancer thread.
+ *
+ * PARAMETERS:
+ *     Context - Unused.
+ *
+ * RETURN VALUE:
+ *     Does not return.
+ *-----------------------------------------------------------------------------------------------*/
+[[noreturn]] static void BalancerThread(void *) {
+    while (1) {
+        EvTimer Timer;
+        EvInitializeTimer(&Timer, BALANCE_INTERVAL, NULL);
+        EvWaitObject(&Timer, 0);
+        Balance();
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function starts up the interrupt balancer thread; Single processor systems don't get
+ *     one (there's nowhere to move anything to).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpInitializeInterruptBalancer(void) {
+    if (HalpProcessorCount < 2) {
+        return;
+    }
+
+    uint32_t Count = HalpProcessorCount < 64 ? HalpProcessorCount : 64;
+    Loads = MmAllocatePool(Count * sizeof(uint64_t), "Halp");
+    PsThread *Thread = PsCreateThread(BalancerThread, NULL);
+    if (!Loads || !Thread) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_INTERRUPT_BALANCER_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0,
+            0);
+    }
+
+    Thread->AffinityMask = 1;
+    PsReadyThread(Thread);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds the given interrupt to the list the balancer is allowed to move around.
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt to track.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpTrackInterrupt(HalpInterrupt *Interrupt) {
+    Interrupt->LastCount = __atomic_load_n(&Interrupt->Count, __ATOMIC_RELAXED);
+    KeIrql OldIrql = KeAcquireSpinLock(&ListLock);
+    RtAppendDList(&ListHead, &Interrupt->BalanceListHeader);
+    KeReleaseSpinLock(&ListLock, OldIrql);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes the given interrupt from the balancer list. Moves that already
+ *     started will still finish; HalDisableInterrupt waits for those itself.
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt to stop tracking.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpUntrackInterrupt(HalpInterrupt *Interrupt) {
+    KeIrql OldIrql = KeAcquireSpinLock(&ListLock);
+    RtUnlinkDList(&Interrupt->BalanceListHeader);
+    KeReleaseSpinLock(&ListLock, OldIrql);
+}
@@ -1,13 +1,14 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <hal.h>
+#include <halp.h>
 #include <mm.h>
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function creates and initializes a new interrupt object, getting it ready for
- *     HalEnableInterrupt.
+ *     HalEnableInterrupt. The interrupt targets the current processor. This is the internal
+ *     version of HalCreateInterrupt, for HAL code that needs to fill in the private fields.
  *
  * PARAMETERS:
  *     Irql - Target IRQL of the interrupt handler.
@@ -19,13 +20,13 @@
  * RETURN VALUE:
  *     Either the interrupt object, or NULL on failure.
  *-----------------------------------------------------------------------------------------------*/
-HalInterrupt *HalCreateInterrupt(
+HalpInterrupt *HalpCreateInterrupt(
     KeIrql Irql,
     uint32_t Vector,
     uint8_t Type,
     void (*Handler)(HalInterruptFrame *, void *),
     void *HandlerContext) {
-    HalInterrupt *Interrupt = MmAllocatePool(sizeof(HalInterrupt), "HalI");
+    HalpInterrupt *Interrupt = MmAllocatePool(sizeof(HalpInterrupt), "HalI");
     if (!Interrupt) {
         return NULL;
     }
@@ -35,7 +36,61 @@ HalInterrupt *HalCreateInterrupt(
     Interrupt->Irql = Irql;
     Interrupt->Vector = Vector;
     Interrupt->Type = Type;
+    Interrupt->Source = HALP_INT_SOURCE_LOCAL;
+    Interrupt->Processor = HalGetCurrentProcessor()->Number;
+    Interrupt->AffinityMask = PS_AFFINITY_ALL;
     Interrupt->Handler = Handler;
     Interrupt->HandlerContext = HandlerContext;
     return Interrupt;
 }
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function creates and initializes a new interrupt object, getting it ready for
+ *     HalEnableInterrupt. The interrupt targets the current processor.
+ *
+ * PARAMETERS:
+ *     Irql - Target IRQL of the interrupt handler.
+ *     Vector - Target vector of the interrupt; The exact meaning of this varies by platform.
+ *     Type - Type of the interrupt (level or edge).
+ *     Handler - Function to be called when the interrupt gets triggered.
+ *     HandlerContext - Data to be provided to the interrupt handler when it gets triggered.
+ *
+ * RETURN VALUE:
+ *     Either the interrupt object, or NULL on failure.
+ *-----------------------------------------------------------------------------------------------*/
+HalInterrupt *HalCreateInterrupt(
+    KeIrql Irql,
+    uint32_t Vector,
+    uint8_t Type,
+    void (*Handler)(HalInterruptFrame *, void *),
+    void *HandlerContext) {
+    return (HalInterrupt *)HalpCreateInterrupt(Irql, Vector, Type, Handler, HandlerContext);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets called by the interrupt dispatcher after the check routine of a
+ *     threaded or polled interrupt claims the interrupt. We mask the source, and hand the rest
+ *     of the work to the interrupt thread/poll DPC, which unmasks it once done.
+ *
+ * PARAMETERS:
+ *     Interrupt - Which interrupt fired.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpDeferInterrupt(HalpInterrupt *Interrupt) {
+    /* Masking an edge triggered line would just lose any edges until we unmask it. */
+    if (Interrupt->Source != HALP_INT_SOURCE_LINE || Interrupt->Type == HAL_INT_TYPE_LEVEL) {
+        __atomic_store_n(&Interrupt->HandlerMasked, 1, __ATOMIC_RELAXED);
+        HalpMaskInterruptSource(Interrupt);
+    }
+
+    if (Interrupt->PollRoutine) {
+        EvDispatchDpc(&Interrupt->PollDpc);
+    } else {
+        __atomic_store_n(&Interrupt->ThreadPending, 1, __ATOMIC_RELEASE);
+        EvDispatchDpc(&Interrupt->ThreadDpc);
+    }
+}
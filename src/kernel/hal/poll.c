@@ -0,0 +1,86 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs one pass of the poll routine of an interrupt. If the routine used up
+ *     its whole budget, there's probably more work pending, so we requeue ourselves at the back
+ *     of the DPC queue (letting everything else queued on this processor run first); Otherwise,
+ *     the device is drained, and we can go back to waiting for interrupts.
+ *
+ * PARAMETERS:
+ *     Context - Which interrupt we're polling.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void PollDpc(void *Context) {
+    HalpInterrupt *Interrupt = Context;
+
+    if (Interrupt->PollRoutine(Interrupt->HandlerContext, Interrupt->PollBudget) >=
+        Interrupt->PollBudget) {
+        EvDispatchDpc(&Interrupt->PollDpc);
+        return;
+    }
+
+    /* We can't wait for an in-progress move at DISPATCH (it might be waiting on a DPC queued
+     * behind us), so just poll again later instead. */
+    if (__atomic_exchange_n(&Interrupt->Moving, 1, __ATOMIC_ACQUIRE)) {
+        EvDispatchDpc(&Interrupt->PollDpc);
+        return;
+    }
+
+    if (__atomic_exchange_n(&Interrupt->HandlerMasked, 0, __ATOMIC_RELAXED) &&
+        Interrupt->Enabled) {
+        HalpUnmaskInterruptSource(Interrupt);
+    }
+
+    __atomic_store_n(&Interrupt->Moving, 0, __ATOMIC_RELEASE);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function switches the given interrupt into polling mode. The check routine runs at
+ *     the interrupt IRQL; If it returns 1 (the interrupt came from its device), the source gets
+ *     masked, and the poll routine gets called from a DPC on the same processor, with a budget
+ *     of how many work items it should process. While the poll routine keeps using up its whole
+ *     budget, we keep polling (with the source masked); Once it returns less than that, the
+ *     source is unmasked again. Under sustained load, this means we stop taking one interrupt
+ *     per work item.
+ *     Level triggered lines and MSI-X interrupts (after HalConnectMsixEntry) are masked by us;
+ *     For anything else, the check routine should quiet down the device itself.
+ *     This needs to be called before HalEnableInterrupt.
+ *
+ * PARAMETERS:
+ *     Handle - Which interrupt to update.
+ *     CheckRoutine - Function to be called at the interrupt IRQL; This should be as short as
+ *                    possible.
+ *     PollRoutine - Function to be called at DISPATCH afterwards; It receives the handler
+ *                   context and the budget, and should return how many work items it
+ *                   processed.
+ *     Budget - Max amount of work items per poll, or 0 for HAL_POLL_DEFAULT_BUDGET.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+int HalCreateInterruptPoll(
+    HalInterrupt *Handle,
+    int (*CheckRoutine)(HalInterruptFrame *, void *),
+    uint32_t (*PollRoutine)(void *, uint32_t),
+    uint32_t Budget) {
+    HalpInterrupt *Interrupt = (HalpInterrupt *)Handle;
+
+    if (Interrupt->Enabled || Interrupt->CheckRoutine) {
+        return 0;
+    }
+
+    /* Medium importance (and no target processor), as the poll should run right after the
+     * interrupt, on the same processor, but it shouldn't jump ahead of the rest of the queue. */
+    EvInitializeDpc(&Interrupt->PollDpc, PollDpc, Interrupt);
+    Interrupt->PollBudget = Budget ? Budget : HAL_POLL_DEFAULT_BUDGET;
+    Interrupt->PollRoutine = PollRoutine;
+    Interrupt->CheckRoutine = CheckRoutine;
+    return 1;
+}
@@ -0,0 +1,117 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+#include <psp.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function wakes up the interrupt thread (if it isn't already awake). We always run on
+ *     the same processor as the thread, at DISPATCH, so this can't race with it going to sleep.
+ *
+ * PARAMETERS:
+ *     Context - Which interrupt fired.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void WakeDpc(void *Context) {
+    HalpInterrupt *Interrupt = Context;
+    if (!Interrupt->ThreadActive) {
+        Interrupt->ThreadActive = 1;
+        Interrupt->Thread->WakeupTime = HalGetTime();
+        PspQueueThread(HalGetCurrentProcessor(), Interrupt->Thread, 1);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function is the main loop of an interrupt thread. We run the threaded handler once
+ *     for each batch of interrupts, unmasking the source after it returns.
+ *
+ * PARAMETERS:
+ *     Context - Which interrupt we're handling.
+ *
+ * RETURN VALUE:
+ *     Does not return.
+ *-----------------------------------------------------------------------------------------------*/
+[[noreturn]] static void InterruptThread(void *Context) {
+    HalpInterrupt *Interrupt = Context;
+
+    while (1) {
+        KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+        if (!__atomic_exchange_n(&Interrupt->ThreadPending, 0, __ATOMIC_ACQUIRE)) {
+            Interrupt->ThreadActive = 0;
+            PsYieldExecution(PS_YIELD_WAITING);
+            KeLowerIrql(OldIrql);
+            continue;
+        }
+
+        KeLowerIrql(OldIrql);
+        Interrupt->ThreadRoutine(Interrupt->HandlerContext);
+
+        /* Moves and HalDisableInterrupt also touch the mask, so take ownership of the interrupt
+         * for this. */
+        while (__atomic_exchange_n(&Interrupt->Moving, 1, __ATOMIC_ACQUIRE)) {
+            HalpPauseProcessor();
+        }
+
+        if (__atomic_exchange_n(&Interrupt->HandlerMasked, 0, __ATOMIC_RELAXED) &&
+            Interrupt->Enabled) {
+            HalpUnmaskInterruptSource(Interrupt);
+        }
+
+        __atomic_store_n(&Interrupt->Moving, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function turns the given interrupt into a threaded interrupt. Instead of running the
+ *     handler at the interrupt IRQL, we only run the check routine there; If it returns 1 (the
+ *     interrupt came from its device), the source gets masked, and the thread routine runs on a
+ *     dedicated thread, at PASSIVE. The source is unmasked again once the thread routine
+ *     returns.
+ *     Level triggered lines and MSI-X interrupts (after HalConnectMsixEntry) are masked by us;
+ *     For anything else, the check routine should quiet down the device itself.
+ *     This needs to be called before HalEnableInterrupt.
+ *
+ * PARAMETERS:
+ *     Handle - Which interrupt to update.
+ *     CheckRoutine - Function to be called at the interrupt IRQL; This should be as short as
+ *                    possible.
+ *     ThreadRoutine - Function to be called at PASSIVE afterwards.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+int HalCreateInterruptThread(
+    HalInterrupt *Handle,
+    int (*CheckRoutine)(HalInterruptFrame *, void *),
+    void (*ThreadRoutine)(void *)) {
+    HalpInterrupt *Interrupt = (HalpInterrupt *)Handle;
+
+    if (Interrupt->Enabled || Interrupt->CheckRoutine) {
+        return 0;
+    }
+
+    PsThread *Thread = PsCreateThread(InterruptThread, Interrupt);
+    if (!Thread) {
+        return 0;
+    }
+
+    /* The thread is bound to the processor the interrupt was created for (even if the interrupt
+     * gets moved later), which is what keeps the wake up DPC simple. */
+    uint32_t Number = Interrupt->Processor;
+    Thread->BoundProcessor = Number;
+
+    Interrupt->Thread = Thread;
+    Interrupt->ThreadPending = 0;
+    Interrupt->ThreadActive = 0;
+    EvInitializeDpc(&Interrupt->ThreadDpc, WakeDpc, Interrupt);
+    EvSetImportanceDpc(&Interrupt->ThreadDpc, EV_DPC_IMPORTANCE_HIGH);
+    EvSetTargetProcessorDpc(&Interrupt->ThreadDpc, Number);
+    Interrupt->CheckRoutine = CheckRoutine;
+    Interrupt->ThreadRoutine = ThreadRoutine;
+    return 1;
+}
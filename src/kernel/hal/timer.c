@@ -1,37 +1,85 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <hal.h>
+#include <halp.h>
+#include <vid.h>
+
+static HalpClockSource *CurrentSource = NULL;
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function checks if we already reached or went past the given target timestamp.
- *     Use this instead of manually checking, as we also handle overflow on 32-bit timers.
+ *     This function converts the current counter value of the given clock source into
+ *     nanoseconds (using the scale factor calculated by HalpSetClockSource).
  *
  * PARAMETERS:
- *     Current - Current value of HalGetTimerTicks().
- *     Reference - Value of HalGetTimerTicks() in the initial call time (for overflow checks).
- *     Time - How much timer ticks past the reference we want to wait until expiration.
+ *     Source - Which clock source to read.
  *
  * RETURN VALUE:
- *     1 if we reached the target time, 0 otherwise.
+ *     Current time according to the clock source, in nanoseconds.
  *-----------------------------------------------------------------------------------------------*/
-int HalCheckTimerExpiration(uint64_t Current, uint64_t Reference, uint64_t Ticks) {
-    uint64_t Target = Reference + Ticks;
+uint64_t HalpGetClockSourceTime(HalpClockSource *Source) {
+    unsigned __int128 Scaled = (unsigned __int128)Source->Read() * Source->Multiplier;
+    return (uint64_t)(Scaled >> HALP_CLOCK_SOURCE_SHIFT) + Source->Offset;
+}
 
-    if (HalGetTimerWidth() == HAL_TIMER_WIDTH_64B) {
-        /* 64-bit timers are easier to handle, we should be able to just not care about overflow. */
-        return Current >= Target;
-    }
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the clock source currently backing HalGetTime.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Current clock source, or NULL if none was set up yet.
+ *-----------------------------------------------------------------------------------------------*/
+HalpClockSource *HalpGetClockSource(void) {
+    return __atomic_load_n(&CurrentSource, __ATOMIC_ACQUIRE);
+}
 
-    /* For 32-bit timers, we need to handle overflow; If the target time is still a 32-bit
-     * number, then any overflow means we reached it; If it's 64-bits, then we need to wait til
-     * overflow, and then mask off the high bits (and wait again). */
-    if (Target <= UINT32_MAX) {
-        return Current < Reference || Current >= Target;
-    }
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function switches the clock source backing HalGetTime. The new source gets offset so
+ *     that the time keeps going from where the old source was.
+ *
+ * PARAMETERS:
+ *     Source - Which clock source to use from now on; Name, Read and Frequency should already be
+ *              filled.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void HalpSetClockSource(HalpClockSource *Source) {
+    HalpClockSource *Previous = HalpGetClockSource();
+    uint64_t CurrentTime = Previous ? HalpGetClockSourceTime(Previous) : 0;
 
-    return Current < Reference && Current >= ((Target >> 32) << 32);
+    /* Scale the counter into nanoseconds with a multiply+shift (instead of a division on every
+     * read). */
+    Source->Multiplier = (EV_SECS << HALP_CLOCK_SOURCE_SHIFT) / Source->Frequency;
+    Source->Offset = 0;
+    Source->Offset = CurrentTime - HalpGetClockSourceTime(Source);
+    __atomic_store_n(&CurrentSource, Source, __ATOMIC_RELEASE);
+
+    VidPrint(
+        VID_MESSAGE_DEBUG,
+        "Kernel HAL",
+        "using %s as clock source (frequency = %llu Hz)\n",
+        Source->Name,
+        Source->Frequency);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function returns how much time has elapsed since the system timer was initialized.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     How many nanoseconds have elapsed since system boot.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t HalGetTime(void) {
+    HalpClockSource *Source = HalpGetClockSource();
+    return Source ? HalpGetClockSourceTime(Source) : 0;
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -46,8 +94,8 @@ int HalCheckTimerExpiration(uint64_t Current, uint64_t Reference, uint64_t Ticks
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void HalWaitTimer(uint64_t Time) {
-    uint64_t Start = HalGetTimerTicks();
-    uint64_t Ticks = Time / HalGetTimerPeriod();
-    while (!HalCheckTimerExpiration(HalGetTimerTicks(), Start, Ticks))
-        ;
+    uint64_t Target = HalGetTime() + Time;
+    while (HalGetTime() < Target) {
+        HalpPauseProcessor();
+    }
 }
@@ -4,6 +4,7 @@
 #ifndef _AMD64_APIC_H_
 #define _AMD64_APIC_H_
 
+#include <rt/hashtable.h>
 #include <rt/list.h>
 
 #define IOAPIC_INDEX 0x00
@@ -64,6 +65,7 @@ typedef struct __attribute__((packed)) {
 
 typedef struct {
     RtSList ListHeader;
+    RtHashEntry HashEntry;
     uint32_t ApicId;
     uint32_t AcpiId;
     int IsX2Apic;
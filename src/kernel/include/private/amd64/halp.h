@@ -12,6 +12,9 @@
 #define HAL_INT_TIMER_IRQL (KE_IRQL_DEVICE + 10)
 #define HAL_INT_TIMER_VECTOR (HAL_INT_TIMER_IRQL << 4)
 
+#define HAL_INT_IPI_IRQL KE_IRQL_IPI
+#define HAL_INT_IPI_VECTOR (HAL_INT_IPI_IRQL << 4)
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -28,17 +31,42 @@ void HalpWriteLapicRegister(uint32_t Number, uint64_t Data);
 uint32_t HalpReadLapicId(void);
 void HalpSendIpi(uint32_t Target, uint32_t Vector);
 void HalpSendNmi(uint32_t Target);
+int HalpIsX2ApicEnabled(void);
+void HalpBroadcastIpi(uint32_t Vector);
+void HalpSendClusterIpi(uint32_t Cluster, uint32_t Members, uint32_t Vector);
 void HalpWaitIpiDelivery(void);
 void HalpSendEoi(void);
 
+int HalpAllocateVectors(KeProcessor *Processor, KeIrql Irql, uint32_t Count, uint32_t *Vector);
+void HalpFreeVectors(KeProcessor *Processor, uint32_t Vector, uint32_t Count);
+KeProcessor *HalpSelectInterruptProcessor(uint64_t AffinityMask);
+void HalpBuildMessage(
+    HalMessageInterrupt *Message,
+    KeProcessor *Processor,
+    KeIrql Irql,
+    uint32_t Vector);
+
 void HalpInitializeIoapic(void);
 void HalpEnableIrq(uint8_t Irq, uint8_t Vector);
 void HalpEnableGsi(uint8_t Gsi, uint8_t Vector);
+void HalpRouteGsi(uint8_t Gsi, uint8_t Vector, int PinPolarity, int TriggerMode, uint32_t ApicId);
+void HalpMaskGsi(uint8_t Gsi);
 
 void HalpInitializeHpet(void);
+void HalpInitializeTsc(void);
+void HalpCheckTscSynchronization(void);
+uint64_t HalpReadTsc(void);
+uint64_t HalpGetTscFrequency(void);
+uint64_t HalpReadTimestamp(void);
 void HalpInitializeApicTimer(void);
+void HalpAcknowledgeTimerEvent(void);
+void HalpAcknowledgeDispatchEvent(void);
 
 void HalpInitializeSmp(void);
+void HalpInitializeTopology(KeProcessor *Processor);
+void HalpInitializeExtendedState(KeProcessor *Processor);
+void HalpInitializeIdle(void);
+int HalpWakeIdleProcessor(KeProcessor *Processor);
 
 #ifdef __cplusplus
 }
@@ -5,12 +5,27 @@
 #define _EVP_H_
 
 #include <ev.h>
+#include <hal.h>
+
+/* Amount of low importance DPCs we let pile up on a remote processor before notifying it. */
+#define EVP_DPC_BATCH_SIZE 16
+
+/* Limits for a single pass over the DPC queue; Anything left after that is handed over to the
+ * per-processor DPC thread. */
+#define EVP_DPC_BUDGET_COUNT 64
+#define EVP_DPC_BUDGET_TIME (100 * EV_MICROSECS)
+
+/* Max time between two clock interrupts; The timer gets armed earlier than this if there's any
+ * closer deadline. */
+#define EVP_TIMER_TICK (1 * EV_MILLISECS)
 
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+void EvpCreateDpcThread(void);
 void EvpDispatchObject(void *Object, uint64_t Timeout, int Yield);
+void EvpProcessQueue(HalInterruptFrame *InterruptFrame);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,36 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef _EXP_H_
+#define _EXP_H_
+
+#include <ex.h>
+#include <ps.h>
+
+/* How many items a worker grabs from its queue at once. */
+#define EXP_WORKER_BATCH_SIZE 8
+
+/* Worker limits; Bound queues only allow one running (non blocked) worker at a time, while the
+ * unbound queue allows one per processor. */
+#define EXP_MAX_BOUND_WORKERS 4
+#define EXP_MAX_UNBOUND_WORKERS_PER_PROCESSOR 2
+
+/* Work item states (ExWorkItem.Queued); INSERTING means the item was claimed by someone adding it
+ * to a queue, but isn't linked in yet. */
+#define EXP_ITEM_IDLE 0
+#define EXP_ITEM_INSERTING 1
+#define EXP_ITEM_QUEUED 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void ExpInitializeWorkQueues(void);
+void ExpNotifyWorkerBlocked(PsThread *Thread);
+void ExpNotifyWorkerRunning(PsThread *Thread);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _EXP_H_ */
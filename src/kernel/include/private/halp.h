@@ -8,10 +8,56 @@
 #include <hal.h>
 #include <ki.h>
 
+#define HALP_CLOCK_SOURCE_SHIFT 32
+
+#define HALP_INT_SOURCE_LOCAL 0
+#define HALP_INT_SOURCE_LINE 1
+#define HALP_INT_SOURCE_MESSAGE 2
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+typedef struct {
+    const char *Name;
+    uint64_t (*Read)(void);
+    uint64_t Frequency;
+    uint64_t Multiplier;
+    uint64_t Offset;
+} HalpClockSource;
+
+/* HAL side of an interrupt object; Drivers only ever see the HalInterrupt part (which always comes
+ * first), everything else is private to the HAL. */
+typedef struct {
+    HalInterrupt;
+    uint8_t Source;
+    uint8_t PinPolarity;
+    uint32_t Processor;
+    uint32_t Gsi;
+    void *MsixTable;
+    uint32_t MsixIndex;
+    uint64_t AffinityMask;
+    uint64_t Count;
+    uint64_t LastCount;
+    uint64_t Rate;
+    RtDList BalanceListHeader;
+    EvDpc MoveDpc;
+    int MoveDone;
+    uint32_t MoveVector;
+    int MovePending;
+    int Moving;
+    int (*CheckRoutine)(HalInterruptFrame *, void *);
+    void (*ThreadRoutine)(void *);
+    PsThread *Thread;
+    EvDpc ThreadDpc;
+    int ThreadPending;
+    int ThreadActive;
+    uint32_t (*PollRoutine)(void *, uint32_t);
+    uint32_t PollBudget;
+    EvDpc PollDpc;
+    int HandlerMasked;
+} HalpInterrupt;
+
 extern uint32_t HalpProcessorCount;
 extern KeProcessor **HalpProcessorList;
 
@@ -20,17 +66,37 @@ void HalpInitializeBootProcessor(void);
 void HalpInitializeApplicationProcessor(KeProcessor *Processor);
 void HalpStopProcessor(void);
 void HalpPauseProcessor(void);
+void HalpIdleProcessor(void);
 
 uint64_t HalpGetPhysicalAddress(void *VirtualAddress);
 int HalpMapPage(void *VirtualAddress, uint64_t PhysicalAddress, int Flags);
 void HalpUnmapPage(void *VirtualAddress);
 
 void HalpNotifyProcessor(KeProcessor *Processor, int WaitDelivery);
-void HalpFreezeProcessor(KeProcessor *Processor);
+void HalpRequestIpi(const uint64_t *TargetSet, uint32_t TargetCount);
+void HalpFreezeProcessors(void);
+
+HalpInterrupt *HalpCreateInterrupt(
+    KeIrql Irql,
+    uint32_t Vector,
+    uint8_t Type,
+    void (*Handler)(HalInterruptFrame *, void *),
+    void *HandlerContext);
+void HalpInitializeInterruptBalancer(void);
+void HalpTrackInterrupt(HalpInterrupt *Interrupt);
+void HalpUntrackInterrupt(HalpInterrupt *Interrupt);
+int HalpMoveInterrupt(HalpInterrupt *Interrupt, KeProcessor *Target);
+void HalpMaskInterruptSource(HalpInterrupt *Interrupt);
+void HalpUnmaskInterruptSource(HalpInterrupt *Interrupt);
+void HalpDeferInterrupt(HalpInterrupt *Interrupt);
 
 void *HalpEnterCriticalSection(void);
 void HalpLeaveCriticalSection(void *Context);
 
+uint64_t HalpGetClockSourceTime(HalpClockSource *Source);
+HalpClockSource *HalpGetClockSource(void);
+void HalpSetClockSource(HalpClockSource *Source);
+
 KeIrql HalpGetIrql(void);
 void HalpSetIrql(KeIrql NewIrql);
 
@@ -42,6 +108,15 @@ void HalpInitializeContext(
     void *Parameter);
 void HalpSwitchContext(HalContextFrame *CurrentThread, HalContextFrame *TargetThread);
 
+int HalpAllocateExtendedState(HalContextFrame *Context);
+void HalpFreeExtendedState(HalContextFrame *Context);
+void HalpSaveExtendedState(HalContextFrame *Context);
+void HalpRestoreExtendedState(HalContextFrame *Context);
+void HalpEnterExtendedState(void);
+void HalpLeaveExtendedState(void);
+int HalpSaveExtendedStateSlot(KeIrql Irql);
+void HalpRestoreExtendedStateSlot(KeIrql Irql);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
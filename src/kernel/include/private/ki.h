@@ -35,6 +35,8 @@ void KiSaveBootStartDrivers(KiLoaderBlock *BootData);
 void KiRunBootStartDrivers(void);
 void KiDumpSymbol(void *Address);
 
+void KiProcessIpiRequests(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
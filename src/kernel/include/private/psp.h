@@ -10,12 +10,61 @@
 #define PSP_THREAD_QUANTUM (10 * EV_MILLISECS)
 #define PSP_THREAD_MIN_QUANTUM (1 * EV_MILLISECS)
 
+/* Scheduling domain levels, from the closest (cheapest to migrate between) to the farthest. */
+#define PSP_DOMAIN_SMT 0
+#define PSP_DOMAIN_CACHE 1
+#define PSP_DOMAIN_PACKAGE 2
+#define PSP_DOMAIN_NODE 3
+
+/* Load averages are fixed point, with PSP_LOAD_SCALE meaning one runnable thread; They get
+ * updated once every PSP_LOAD_UPDATE_INTERVAL. */
+#define PSP_LOAD_SCALE 1024
+#define PSP_LOAD_DECAY_SHIFT 3
+#define PSP_LOAD_UPDATE_INTERVAL (1 * EV_MILLISECS)
+
+/* The SMT level gets balanced every PSP_BALANCE_INTERVAL load updates, and each level above that
+ * gets balanced half as often. */
+#define PSP_BALANCE_INTERVAL 4
+#define PSP_BALANCE_IMBALANCE 125
+#define PSP_MIGRATION_COOLDOWN (20 * EV_MILLISECS)
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the thread is allowed to run on the given processor. Threads bound
+ *     to a processor (such as the DPC thread) can only ever run there, no matter their affinity
+ *     mask.
+ *
+ * PARAMETERS:
+ *     Thread - Which thread to check.
+ *     Number - Index of the processor.
+ *
+ * RETURN VALUE:
+ *     1 if the thread can run on the processor, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static inline int PspCheckAffinity(PsThread *Thread, uint32_t Number) {
+    if (Thread->BoundProcessor != PS_PROCESSOR_NONE) {
+        return Thread->BoundProcessor == Number;
+    }
+
+    /* Processors past the end of the mask can only run threads with no affinity at all. */
+    if (Number >= 64) {
+        return Thread->AffinityMask == PS_AFFINITY_ALL;
+    }
+
+    return (Thread->AffinityMask >> Number) & 1;
+}
+
 void PspCreateSystemThread(void);
 void PspCreateIdleThread(void);
+void PspInitializeLoadBalancer(void);
+void PspUpdateLoad(KeProcessor *Processor, uint64_t CurrentTime);
+void PspQueueThread(KeProcessor *Processor, PsThread *Thread, int Boost);
+void PspReadyThread(PsThread *Thread, int Boost);
+void PspProcessQueue(HalInterruptFrame *InterruptFrame);
 
 #ifdef __cplusplus
 }
@@ -67,6 +67,10 @@ typedef struct __attribute__((packed)) {
 
 typedef struct __attribute__((packed)) {
     uint64_t Rsp;
+    char *ExtendedState;
+    void *ExtendedStateBuffer;
+    uint64_t ExtendedStateInUse;
+    uint64_t ExtendedStateUsers;
 } HalContextFrame;
 
 #endif /* _AMD64_CONTEXT_H_ */
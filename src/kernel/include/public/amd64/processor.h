@@ -7,18 +7,49 @@
 #include <amd64/descr.h>
 #include <ps.h>
 #include <rt/list.h>
+#include <stddef.h>
 
-typedef struct {
+/* The GS base of each processor points to its own processor block (so Self always points back to
+ * the start of it, or is NULL during early boot); This lets us access any of its fields with a
+ * single GS-relative load. */
+typedef struct KeProcessor {
+    struct KeProcessor *Self;
+    uint32_t Number;
     uint32_t ApicId;
+    uint32_t CoreId;
+    uint32_t CacheId;
+    uint32_t PackageId;
+    uint32_t NodeId;
+    uint64_t NextTimerEvent;
     uint64_t ThreadQueueLock;
     RtDList ThreadQueue;
     uint32_t ThreadQueueSize;
     PsThread *InitialThread;
     PsThread *CurrentThread;
     PsThread *IdleThread;
+    uint64_t LoadAverage;
+    uint64_t NextLoadUpdate;
+    uint64_t BalanceTicks;
+    int BalanceLevels;
+    EvDpc BalanceDpc;
     int EventStatus;
+    int Online;
+    uint64_t IpiSummary;
+    uint64_t *IpiRequests;
+    uint64_t *IpiTargets;
+    int IpiPolling;
+    int IdleMonitoring;
+    KeIpiPacket IpiPacket;
+    uint64_t DpcQueueLock;
     RtDList DpcQueue;
+    uint32_t DpcQueueSize;
+    PsThread *DpcThread;
+    int DpcThreadActive;
     RtDList EventQueue;
+    char *ExtendedStateSlots;
+    uint32_t ExtendedStateSlotsBusy;
+    uint32_t ExtendedStateSlotsDirty;
+    uint64_t IdleWakeRequest __attribute__((aligned(64)));
     char SystemStack[8192] __attribute__((aligned(4096)));
     char NmiStack[8192] __attribute__((aligned(4096)));
     char DoubleFaultStack[8192] __attribute__((aligned(4096)));
@@ -27,7 +58,41 @@ typedef struct {
     HalpTssEntry TssEntry;
     HalpIdtEntry IdtEntries[256];
     uint64_t InterruptListLock;
+    uint64_t VectorBitmap[4];
+    uint32_t VectorCount;
     RtDList InterruptList[256];
+    uint64_t InterruptCounts[256];
+    KeHistogram Histograms[KE_HISTOGRAM_COUNT];
 } KeProcessor;
 
+/* Reads a (scalar) field of the current processor block, without having to get a pointer to it
+ * first. Unless we're at DISPATCH or above, the result might already be stale (as we might have
+ * been moved to another processor) by the time we use it.
+ * The compiler can't tell which memory a GS-relative access touches, so the load is also a
+ * compiler barrier; Otherwise, it could be moved past a plain store to the same field (made through
+ * a normal pointer to the processor block), and return the old value. */
+#define KeGetCurrentProcessorField(Field)                    \
+    ({                                                       \
+        __typeof__(((KeProcessor *)0)->Field) Value;         \
+        __asm__ volatile("mov %%gs:%c1, %0"                  \
+                         : "=r"(Value)                       \
+                         : "i"(offsetof(KeProcessor, Field)) \
+                         : "memory");                        \
+        Value;                                               \
+    })
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the thread currently running on this processor.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Pointer to the current thread, or NULL if the scheduler isn't up yet.
+ *-----------------------------------------------------------------------------------------------*/
+static inline PsThread *KeGetCurrentThread(void) {
+    return KeGetCurrentProcessorField(CurrentThread);
+}
+
 #endif /* _AMD64_PROCESSOR_H_ */
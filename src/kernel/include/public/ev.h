@@ -12,6 +12,12 @@
 #define EV_MILLISECS 1000000ull
 #define EV_SECS 1000000000ull
 
+#define EV_DPC_IMPORTANCE_LOW 0
+#define EV_DPC_IMPORTANCE_MEDIUM 1
+#define EV_DPC_IMPORTANCE_HIGH 2
+
+#define EV_DPC_TARGET_CURRENT UINT32_MAX
+
 struct PsThread;
 
 /* Deferred Procedure Call; We're the only event that doesn't have an event header ourselves. */
@@ -19,6 +25,10 @@ typedef struct {
     RtDList ListHeader;
     void (*Routine)(void *Context);
     void *Context;
+    int Importance;
+    int Inserted;
+    uint32_t TargetProcessor;
+    uint64_t QueueTime;
 } EvDpc;
 
 typedef struct {
@@ -28,8 +38,7 @@ typedef struct {
     int Finished;
     struct PsThread *Source;
     EvDpc *Dpc;
-    uint64_t DeadlineReference;
-    uint64_t DeadlineTicks;
+    uint64_t Deadline;
 } EvHeader, EvTimer;
 
 #ifdef __cplusplus
@@ -37,6 +46,8 @@ extern "C" {
 #endif /* __cplusplus */
 
 void EvInitializeDpc(EvDpc *Dpc, void (*Routine)(void *Context), void *Context);
+void EvSetImportanceDpc(EvDpc *Dpc, int Importance);
+void EvSetTargetProcessorDpc(EvDpc *Dpc, uint32_t Number);
 void EvDispatchDpc(EvDpc *Dpc);
 
 void EvInitializeTimer(EvTimer *Timer, uint64_t Timeout, EvDpc *Dpc);
@@ -0,0 +1,36 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef _EX_H_
+#define _EX_H_
+
+#include <rt/list.h>
+
+#define EX_WORK_QUEUE_BOUND 0
+#define EX_WORK_QUEUE_UNBOUND 1
+
+/* Deferred (PASSIVE IRQL) work item; Don't touch any of the fields manually, use
+ * ExInitializeWorkItem() instead. */
+typedef struct {
+    RtDList ListHeader;
+    void (*Routine)(void *Context);
+    void *Context;
+    void *Queue;
+    int Queued;
+} ExWorkItem;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void ExInitializeWorkItem(ExWorkItem *Item, void (*Routine)(void *Context), void *Context);
+int ExQueueWorkItem(ExWorkItem *Item, int Queue);
+size_t ExQueueWorkItemBatch(ExWorkItem **Items, size_t Count, int Queue);
+int ExCancelWorkItem(ExWorkItem *Item);
+void ExFlushWorkItem(ExWorkItem *Item);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _EX_H_ */
@@ -10,12 +10,13 @@
 #define HAL_NO_EVENT 0
 #define HAL_PANIC_EVENT 1
 
-#define HAL_TIMER_WIDTH_32B 32
-#define HAL_TIMER_WIDTH_64B 64
-
 #define HAL_INT_TYPE_EDGE 0
 #define HAL_INT_TYPE_LEVEL 1
 
+#define HAL_POLL_DEFAULT_BUDGET 64
+
+#define HAL_MESSAGE_CONTIGUOUS 0x01
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -31,12 +32,31 @@ typedef struct {
     void *HandlerContext;
 } HalInterrupt;
 
-KeProcessor *HalGetCurrentProcessor(void);
+typedef struct {
+    uint64_t Address;
+    uint32_t Data;
+    uint32_t Processor;
+    uint32_t Vector;
+    KeIrql Irql;
+} HalMessageInterrupt;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets a pointer to the processor-specific structure of the current processor.
+ *     The result of this will always be NULL before HalpInitializePlatform().
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Pointer to the processor struct.
+ *-----------------------------------------------------------------------------------------------*/
+inline KeProcessor *HalGetCurrentProcessor(void) {
+    return KeGetCurrentProcessorField(Self);
+}
 
-int HalGetTimerWidth(void);
-uint64_t HalGetTimerPeriod(void);
-uint64_t HalGetTimerTicks(void);
-int HalCheckTimerExpiration(uint64_t Current, uint64_t Reference, uint64_t Ticks);
+uint64_t HalGetTime(void);
+void HalSetNextTimerEvent(uint64_t Time);
 void HalWaitTimer(uint64_t Time);
 
 HalInterrupt *HalCreateInterrupt(
@@ -45,8 +65,37 @@ HalInterrupt *HalCreateInterrupt(
     uint8_t Type,
     void (*Handler)(HalInterruptFrame *, void *),
     void *HandlerContext);
+HalInterrupt *HalCreateLineInterrupt(
+    KeIrql Irql,
+    uint8_t Irq,
+    void (*Handler)(HalInterruptFrame *, void *),
+    void *HandlerContext);
+int HalCreateInterruptThread(
+    HalInterrupt *Interrupt,
+    int (*CheckRoutine)(HalInterruptFrame *, void *),
+    void (*ThreadRoutine)(void *));
+int HalCreateInterruptPoll(
+    HalInterrupt *Interrupt,
+    int (*CheckRoutine)(HalInterruptFrame *, void *),
+    uint32_t (*PollRoutine)(void *, uint32_t),
+    uint32_t Budget);
 int HalEnableInterrupt(HalInterrupt *Interrupt);
 void HalDisableInterrupt(HalInterrupt *Interrupt);
+int HalSetInterruptAffinity(HalInterrupt *Interrupt, uint64_t AffinityMask);
+
+int HalAllocateMessageInterrupts(
+    KeIrql Irql,
+    uint32_t Count,
+    uint64_t AffinityMask,
+    int Flags,
+    HalMessageInterrupt *Messages);
+void HalFreeMessageInterrupts(HalMessageInterrupt *Messages, uint32_t Count);
+HalInterrupt *HalCreateMessageInterrupt(
+    HalMessageInterrupt *Message,
+    void (*Handler)(HalInterruptFrame *, void *),
+    void *HandlerContext);
+void HalWriteMsixEntry(void *Table, uint32_t Index, HalMessageInterrupt *Message);
+void HalConnectMsixEntry(HalInterrupt *Interrupt, void *Table, uint32_t Index);
 
 #ifdef __cplusplus
 }
@@ -4,6 +4,30 @@
 #ifndef _KE_H_
 #define _KE_H_
 
+#include <stdint.h>
+
+/* Log2 histograms: bucket N counts values in [2^(N-1), 2^N), and bucket 0 counts zeroes. */
+#define KE_HISTOGRAM_BUCKETS 64
+
+#define KE_HISTOGRAM_INTERRUPT_TIME 0
+#define KE_HISTOGRAM_DPC_DELAY 1
+#define KE_HISTOGRAM_WAKEUP_DELAY 2
+#define KE_HISTOGRAM_COUNT 3
+
+#define KE_STATISTICS_ALL_PROCESSORS UINT32_MAX
+
+#define KE_IPI_ALL_PROCESSORS UINT64_MAX
+
+typedef struct {
+    uint64_t Buckets[KE_HISTOGRAM_BUCKETS];
+} KeHistogram;
+
+typedef struct {
+    void (*Routine)(void *Context);
+    void *Context;
+    uint32_t Remaining;
+} KeIpiPacket;
+
 #ifdef ARCH_amd64
 #include <amd64/processor.h>
 #else
@@ -29,7 +53,8 @@
 #define KE_PANIC_DRIVER_INITIALIZATION_FAILURE 11
 #define KE_PANIC_BAD_PFN_HEADER 12
 #define KE_PANIC_BAD_POOL_HEADER 13
-#define KE_PANIC_COUNT 14
+#define KE_PANIC_IPI_NOT_DELIVERED 14
+#define KE_PANIC_COUNT 15
 
 #define KE_PANIC_PARAMETER_OUT_OF_RESOURCES 0x0000000000000000
 
@@ -43,7 +68,9 @@
 #define KE_PANIC_PARAMETER_IOAPIC_INITIALIZATION_FAILURE 0x0000000000000006
 #define KE_PANIC_PARAMETER_HPET_INITIALIZATION_FAILURE 0x0000000000000007
 #define KE_PANIC_PARAMETER_SMP_INITIALIZATION_FAILURE 0x0000000000000008
+#define KE_PANIC_PARAMETER_XSTATE_INITIALIZATION_FAILURE 0x0000000000000009
 #endif
+#define KE_PANIC_PARAMETER_INTERRUPT_BALANCER_INITIALIZATION_FAILURE 0x000000000000000A
 
 #define KE_PANIC_PARAMETER_BAD_RSDT_TABLE 0x0000000000000000
 #define KE_PANIC_PARAMETER_BAD_APIC_TABLE 0x0000000000000001
@@ -56,6 +83,7 @@
 #define KE_IRQL_PASSIVE 0
 #define KE_IRQL_DISPATCH 2
 #define KE_IRQL_DEVICE 3
+#define KE_IRQL_IPI 14
 #define KE_IRQL_MASK 15
 
 #define KE_STACK_SIZE 0x2000
@@ -66,6 +94,11 @@
 typedef uint64_t KeSpinLock;
 typedef uint64_t KeIrql;
 
+typedef struct {
+    KeIrql Irql;
+    int Saved;
+} KeExtendedState;
+
 typedef struct {
     RtDList ListHeader;
     void *ImageBase;
@@ -86,6 +119,11 @@ KeIrql KeGetIrql(void);
 KeIrql KeRaiseIrql(KeIrql NewIrql);
 void KeLowerIrql(KeIrql NewIrql);
 
+int KeIpiGenericCall(void (*Routine)(void *Context), void *Context, uint64_t TargetMask, int Wait);
+
+int KeSaveExtendedState(KeExtendedState *State);
+void KeRestoreExtendedState(KeExtendedState *State);
+
 int KeTryAcquireSpinLockHighIrql(KeSpinLock *Lock);
 KeIrql KeAcquireSpinLock(KeSpinLock *Lock);
 void KeAcquireSpinLockHighIrql(KeSpinLock *Lock);
@@ -93,6 +131,12 @@ void KeReleaseSpinLock(KeSpinLock *Lock, KeIrql NewIrql);
 void KeReleaseSpinLockHighIrql(KeSpinLock *Lock);
 int KeTestSpinLock(KeSpinLock *Lock);
 
+void KeRecordHistogram(KeHistogram *Histogram, uint64_t Value);
+uint64_t KeGetHistogramPercentile(KeHistogram *Histogram, uint32_t Percentile);
+uint64_t KeGetInterruptCount(uint32_t Number, uint32_t Vector);
+int KeQueryHistogram(uint32_t Number, int Type, KeHistogram *Histogram);
+void KeDumpStatistics(void);
+
 [[noreturn]] void KeFatalError(
     uint32_t Message,
     uint64_t Parameter1,
@@ -28,6 +28,9 @@ void MmUnmapSpace(void *VirtualAddress);
 void *MmAllocatePool(size_t Size, const char Tag[4]);
 void MmFreePool(void *Base, const char Tag[4]);
 
+void *MmAllocateHashTable(size_t Size);
+void MmFreeHashTable(void *Base);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -5,17 +5,27 @@
 #define _PS_H_
 
 #include <ev.h>
+#include <ex.h>
 #include <generic/context.h>
 
 #define PS_YIELD_NORMAL 0x00
 #define PS_YIELD_WAITING 0x01
 
+#define PS_AFFINITY_ALL UINT64_MAX
+#define PS_PROCESSOR_NONE UINT32_MAX
+
 typedef struct PsThread {
     RtDList ListHeader;
-    uint64_t ExpirationReference;
-    uint64_t ExpirationTicks;
+    uint64_t ExpirationTime;
     int Terminated;
+    uint64_t AffinityMask;
+    uint32_t BoundProcessor;
+    uint32_t LastProcessor;
+    uint64_t MigrationTime;
+    uint64_t WakeupTime;
     EvDpc TerminationDpc;
+    ExWorkItem TerminationWorkItem;
+    void *Worker;
     HalContextFrame Context;
     char *Stack;
 } PsThread;
@@ -26,6 +36,7 @@ extern "C" {
 
 PsThread *PsCreateThread(void (*EntryPoint)(void *), void *Parameter);
 void PsReadyThread(PsThread *Thread);
+int PsSetThreadAffinity(PsThread *Thread, uint64_t AffinityMask);
 [[noreturn]] void PsTerminateThread(void);
 void PsYieldExecution(int Type);
 
@@ -4,11 +4,30 @@
 #include <io.h>
 #include <ke.h>
 #include <mm.h>
+#include <rt/hash.h>
 #include <string.h>
 
-static RtSList DeviceListHead = {.Next = NULL};
+static int CompareDevice(RtHashEntry *Entry, const void *Key);
+
+static RtHashTable DeviceTable =
+    RT_HASH_TABLE_INITIALIZER(CompareDevice, MmAllocateHashTable, MmFreeHashTable);
 static KeSpinLock Lock = {0};
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given device table entry has the given name.
+ *
+ * PARAMETERS:
+ *     Entry - Hash table entry of the device.
+ *     Key - Name we're looking for.
+ *
+ * RETURN VALUE:
+ *     1 if the name matches, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int CompareDevice(RtHashEntry *Entry, const void *Key) {
+    return !strcmp(CONTAINING_RECORD(Entry, IoDevice, HashEntry)->Name, Key);
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function registers a new device, using the specified unique name.
@@ -22,10 +41,6 @@ static KeSpinLock Lock = {0};
  *     1 on success, 0 on failure (either out of memory, or the name already exists).
  *-----------------------------------------------------------------------------------------------*/
 int IoCreateDevice(const char *Name, IoReadFn Read, IoWriteFn Write) {
-    if (IoOpenDevice(Name)) {
-        return 0;
-    }
-
     IoDevice *Entry = MmAllocatePool(sizeof(IoDevice), "Io  ");
     if (!Entry) {
         return 0;
@@ -41,10 +56,20 @@ int IoCreateDevice(const char *Name, IoReadFn Read, IoWriteFn Write) {
     Entry->Read = Read;
     Entry->Write = Write;
 
+    /* The existence check and the insert need to happen under the same lock, otherwise two
+     * callers could register the same name at once. */
+    uint64_t Hash = RtGetXxh3Hash(Name, strlen(Name), 0);
     KeIrql OldIrql = KeAcquireSpinLock(&Lock);
-    RtPushSList(&DeviceListHead, &Entry->ListHeader);
-    KeReleaseSpinLock(&Lock, OldIrql);
 
+    if (RtLookupHashTable(&DeviceTable, Hash, Name) ||
+        !RtInsertHashTable(&DeviceTable, &Entry->HashEntry, Hash)) {
+        KeReleaseSpinLock(&Lock, OldIrql);
+        MmFreePool((char *)Entry->Name, "Io  ");
+        MmFreePool(Entry, "Io  ");
+        return 0;
+    }
+
+    KeReleaseSpinLock(&Lock, OldIrql);
     return 1;
 }
 
@@ -59,17 +84,9 @@ int IoCreateDevice(const char *Name, IoReadFn Read, IoWriteFn Write) {
  *     Pointer to the device on success, NULL otherwise.
  *-----------------------------------------------------------------------------------------------*/
 IoDevice *IoOpenDevice(const char *Name) {
+    uint64_t Hash = RtGetXxh3Hash(Name, strlen(Name), 0);
     KeIrql OldIrql = KeAcquireSpinLock(&Lock);
-    RtSList *ListHeader = DeviceListHead.Next;
-
-    while (ListHeader) {
-        IoDevice *Entry = CONTAINING_RECORD(ListHeader, IoDevice, ListHeader);
-        if (!strcmp(Entry->Name, Name)) {
-            KeReleaseSpinLock(&Lock, OldIrql);
-            return Entry;
-        }
-    }
-
+    RtHashEntry *Entry = RtLookupHashTable(&DeviceTable, Hash, Name);
     KeReleaseSpinLock(&Lock, OldIrql);
-    return NULL;
+    return Entry ? CONTAINING_RECORD(Entry, IoDevice, HashEntry) : NULL;
 }
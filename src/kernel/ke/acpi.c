@@ -3,13 +3,10 @@
 
 #include <ki.h>
 #include <mi.h>
+#include <rt/hash.h>
+#include <rt/hashtable.h>
 #include <string.h>
 
-static uint64_t BaseAddress = 0;
-static int TableType = KI_ACPI_NONE;
-static RtSList ListHead = {};
-static int CacheTableDone = 0;
-
 typedef struct __attribute__((packed)) {
     char Signature[4];
     uint32_t Length;
@@ -28,11 +25,114 @@ typedef struct __attribute__((packed)) {
 } FadtHeader;
 
 typedef struct {
-    RtSList ListHeader;
+    RtHashEntry HashEntry;
     SdtHeader *SdtHeader;
     int Index;
 } CacheEntry;
 
+typedef struct {
+    const char *Signature;
+    int Index;
+} CacheKey;
+
+static int CompareEntry(RtHashEntry *Entry, const void *Key);
+
+static uint64_t BaseAddress = 0;
+static int TableType = KI_ACPI_NONE;
+static RtHashTable TableCache =
+    RT_HASH_TABLE_INITIALIZER(CompareEntry, MmAllocateHashTable, MmFreeHashTable);
+static int CacheTableDone = 0;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given cache entry matches the given signature and index.
+ *
+ * PARAMETERS:
+ *     Entry - Hash table entry of the cached table.
+ *     Key - Pointer to a CacheKey.
+ *
+ * RETURN VALUE:
+ *     1 if the entry matches, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int CompareEntry(RtHashEntry *Entry, const void *Key) {
+    CacheEntry *CachedEntry = CONTAINING_RECORD(Entry, CacheEntry, HashEntry);
+    const CacheKey *CachedKey = Key;
+    return CachedEntry->Index == CachedKey->Index &&
+           !memcmp(CachedEntry->SdtHeader->Signature, CachedKey->Signature, 4);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hashes the signature+index pair used to look up a cached table.
+ *
+ * PARAMETERS:
+ *     Signature - Signature of the table.
+ *     Index - Which instance of the table this is.
+ *
+ * RETURN VALUE:
+ *     Hash of the pair.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t HashKey(const char Signature[4], int Index) {
+    char Key[8];
+    memcpy(Key, Signature, 4);
+    memcpy(Key + 4, &Index, 4);
+    return RtGetXxh3Hash(Key, sizeof(Key), 0);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for a table inside the cache.
+ *
+ * PARAMETERS:
+ *     Signature - Signature of the table.
+ *     Index - Which instance of the table we want.
+ *
+ * RETURN VALUE:
+ *     Cache entry, or NULL if we didn't find it.
+ *-----------------------------------------------------------------------------------------------*/
+static CacheEntry *FindEntry(const char Signature[4], int Index) {
+    CacheKey Key = {.Signature = Signature, .Index = Index};
+    RtHashEntry *Entry = RtLookupHashTable(&TableCache, HashKey(Signature, Index), &Key);
+    return Entry ? CONTAINING_RECORD(Entry, CacheEntry, HashEntry) : NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a new table into the cache.
+ *
+ * PARAMETERS:
+ *     Header - Header of the table; It should already be mapped and validated.
+ *     Index - Which instance of the table this is.
+ *     Table - Which KE_PANIC_PARAMETER_BAD_*_TABLE to report if we fail.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void AddEntry(SdtHeader *Header, int Index, uint64_t Table) {
+    CacheEntry *Entry = MmAllocatePool(sizeof(CacheEntry), "KAcp");
+    if (!Entry) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_ACPI_INITIALIZATION_FAILURE,
+            Table,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0);
+    }
+
+    Entry->SdtHeader = Header;
+    Entry->Index = Index;
+
+    if (!RtInsertHashTable(
+            &TableCache, &Entry->HashEntry, HashKey(Header->Signature, Index))) {
+        KeFatalError(
+            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
+            KE_PANIC_PARAMETER_ACPI_INITIALIZATION_FAILURE,
+            Table,
+            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
+            0);
+    }
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function calculates and validates the checksum for a system table.
@@ -157,30 +257,11 @@ static void CacheTable(void) {
         /* Calculate the current index for this entry (should realistically be 0 for most
          * tables). */
         int Index = 0;
-        RtSList *ListHeader = ListHead.Next;
-        while (ListHeader) {
-            CacheEntry *Entry = CONTAINING_RECORD(ListHeader, CacheEntry, ListHeader);
-
-            if (!memcmp(Entry->SdtHeader->Signature, Header->Signature, 4)) {
-                Index++;
-            }
-
-            ListHeader = ListHeader->Next;
-        }
-
-        CacheEntry *Entry = MmAllocatePool(sizeof(CacheEntry), "KAcp");
-        if (!Entry) {
-            KeFatalError(
-                KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
-                KE_PANIC_PARAMETER_ACPI_INITIALIZATION_FAILURE,
-                KE_PANIC_PARAMETER_BAD_RSDT_TABLE,
-                KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
-                0);
+        while (FindEntry(Header->Signature, Index)) {
+            Index++;
         }
 
-        Entry->SdtHeader = Header;
-        Entry->Index = Index;
-        RtPushSList(&ListHead, &Entry->ListHeader);
+        AddEntry(Header, Index, KE_PANIC_PARAMETER_BAD_RSDT_TABLE);
     }
 
     /* We're still missing the DSDT (we're not trusting any DSDT in the RSDT), grab the FACP, and
@@ -224,19 +305,7 @@ static void CacheTable(void) {
             0);
     }
 
-    CacheEntry *Entry = MmAllocatePool(sizeof(CacheEntry), "KAcp");
-    if (!Entry) {
-        KeFatalError(
-            KE_PANIC_KERNEL_INITIALIZATION_FAILURE,
-            KE_PANIC_PARAMETER_ACPI_INITIALIZATION_FAILURE,
-            KE_PANIC_PARAMETER_BAD_DSDT_TABLE,
-            KE_PANIC_PARAMETER_OUT_OF_RESOURCES,
-            0);
-    }
-
-    Entry->SdtHeader = Header;
-    Entry->Index = 0;
-    RtPushSList(&ListHead, &Entry->ListHeader);
+    AddEntry(Header, 0, KE_PANIC_PARAMETER_BAD_DSDT_TABLE);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -270,16 +339,6 @@ void *KiFindAcpiTable(const char Signature[4], int Index) {
         CacheTable();
     }
 
-    RtSList *ListHeader = ListHead.Next;
-    while (ListHeader) {
-        CacheEntry *Entry = CONTAINING_RECORD(ListHeader, CacheEntry, ListHeader);
-
-        if (Entry->Index == Index && !memcmp(Entry->SdtHeader->Signature, Signature, 4)) {
-            return Entry->SdtHeader;
-        }
-
-        ListHeader = ListHeader->Next;
-    }
-
-    return NULL;
+    CacheEntry *Entry = FindEntry(Signature, Index);
+    return Entry ? Entry->SdtHeader : NULL;
 }
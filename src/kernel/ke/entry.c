@@ -1,6 +1,8 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include <evp.h>
+#include <exp.h>
 #include <halp.h>
 #include <ki.h>
 #include <mi.h>
@@ -57,6 +59,10 @@ static void InitializeBootProcessor(KiLoaderBlock *LoaderBlock) {
     /* Stage 5 (BSP): Scheduler initialization. */
     PspCreateIdleThread();
     PspCreateSystemThread();
+    PspInitializeLoadBalancer();
+    EvpCreateDpcThread();
+    ExpInitializeWorkQueues();
+    HalpInitializeInterruptBalancer();
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -76,6 +82,8 @@ static void InitializeApplicationProcessor(KeProcessor *Processor) {
 
     /* Stage 1 (AP): Scheduler initialization. */
     PspCreateIdleThread();
+    PspInitializeLoadBalancer();
+    EvpCreateDpcThread();
 }
 
 /*-------------------------------------------------------------------------------------------------
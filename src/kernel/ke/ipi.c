@@ -0,0 +1,194 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+#include <ki.h>
+#include <string.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs all cross-calls queued up for the current processor. This gets called
+ *     from the IPI handler, and from anyone spinning inside KeIpiGenericCall (so that two
+ *     processors waiting on each other don't deadlock).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void KiProcessIpiRequests(void) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    uint64_t Summary = __atomic_exchange_n(&Processor->IpiSummary, 0, __ATOMIC_ACQUIRE);
+    uint32_t Words = (HalpProcessorCount + 63) / 64;
+
+    /* Each summary bit says some of the request words (the ones with the same index mod 64) might
+     * have something for us. */
+    while (Summary) {
+        for (uint32_t Word = __builtin_ctzll(Summary); Word < Words; Word += 64) {
+            uint64_t Requests =
+                __atomic_exchange_n(&Processor->IpiRequests[Word], 0, __ATOMIC_ACQUIRE);
+
+            /* Each bit is the processor that sent the request; Its packet is only reused once
+             * everyone decremented the remaining count, so we need to be done with it before
+             * that. */
+            while (Requests) {
+                KeIpiPacket *Packet =
+                    &HalpProcessorList[Word * 64 + __builtin_ctzll(Requests)]->IpiPacket;
+                Packet->Routine(Packet->Context);
+                __atomic_sub_fetch(&Packet->Remaining, 1, __ATOMIC_RELEASE);
+                Requests &= Requests - 1;
+            }
+        }
+
+        Summary &= Summary - 1;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs any pending cross-calls at the same IRQL the IPI handler would.
+ *
+ * PARAMETERS:
+ *     Processor - Processor we're running on.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void ProcessRequests(KeProcessor *Processor) {
+    if (__atomic_load_n(&Processor->IpiSummary, __ATOMIC_SEQ_CST)) {
+        KeIrql OldIrql = KeRaiseIrql(KE_IRQL_IPI);
+        KiProcessIpiRequests();
+        KeLowerIrql(OldIrql);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function waits until all targets of our packet ran it. While we wait, we mark
+ *     ourselves as polling (so that anyone sending us a cross-call can skip the IPI), and run
+ *     any cross-calls sent to us.
+ *
+ * PARAMETERS:
+ *     Processor - Processor we're running on.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void WaitPacket(KeProcessor *Processor) {
+    if (!__atomic_load_n(&Processor->IpiPacket.Remaining, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    __atomic_store_n(&Processor->IpiPolling, 1, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n(&Processor->IpiPacket.Remaining, __ATOMIC_ACQUIRE)) {
+        ProcessRequests(Processor);
+        HalpPauseProcessor();
+    }
+
+    /* Anyone who saw us polling skipped the IPI, so check one last time after we stop. */
+    __atomic_store_n(&Processor->IpiPolling, 0, __ATOMIC_SEQ_CST);
+    ProcessRequests(Processor);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs the given routine on all processors in the target mask, at IPI IRQL
+ *     (with interrupts disabled). Each processor can only have one cross-call in flight; If a
+ *     previous call (with Wait == 0) is still running, we wait for it before sending this one.
+ *     Like affinity masks, the mask can only name the first 64 processors; Use
+ *     KE_IPI_ALL_PROCESSORS to target every online processor (no matter its number).
+ *     This should only be called at or below DISPATCH.
+ *
+ * PARAMETERS:
+ *     Routine - What should be executed.
+ *     Context - Context for the routine.
+ *     TargetMask - Bitmask of processor indices, or KE_IPI_ALL_PROCESSORS; The current processor
+ *                  is allowed, and runs the routine directly.
+ *     Wait - Set this to 1 if we should only return once all targets ran the routine.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if none of the targets were online (so the routine didn't run anywhere).
+ *-----------------------------------------------------------------------------------------------*/
+int KeIpiGenericCall(void (*Routine)(void *Context), void *Context, uint64_t TargetMask, int Wait) {
+    KeIrql Irql = KeGetIrql();
+    if (Irql > KE_IRQL_DISPATCH) {
+        KeFatalError(KE_PANIC_IRQL_NOT_LESS_OR_EQUAL, Irql, KE_IRQL_DISPATCH, 0, 0);
+    }
+
+    KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    int CallSelf = TargetMask == KE_IPI_ALL_PROCESSORS ||
+                   (Processor->Number < 64 && (TargetMask & (1ull << Processor->Number)));
+
+    /* Collect everyone else into our target set, skipping anyone that isn't online yet (they
+     * would never answer). */
+    uint32_t Words = (HalpProcessorCount + 63) / 64;
+    uint32_t Remote = 0;
+    if (HalpProcessorList && Processor->IpiTargets) {
+        uint32_t Limit = HalpProcessorCount;
+        if (TargetMask != KE_IPI_ALL_PROCESSORS && Limit > 64) {
+            Limit = 64;
+        }
+
+        memset(Processor->IpiTargets, 0, Words * sizeof(uint64_t));
+        for (uint32_t Number = 0; Number < Limit; Number++) {
+            if (Number != Processor->Number && ((TargetMask >> (Number & 63)) & 1) &&
+                __atomic_load_n(&HalpProcessorList[Number]->Online, __ATOMIC_ACQUIRE)) {
+                Processor->IpiTargets[Number >> 6] |= 1ull << (Number & 63);
+                Remote++;
+            }
+        }
+    }
+
+    if (!Remote && !CallSelf) {
+        KeLowerIrql(OldIrql);
+        return 0;
+    }
+
+    if (Remote) {
+        WaitPacket(Processor);
+        Processor->IpiPacket.Routine = Routine;
+        Processor->IpiPacket.Context = Context;
+        __atomic_store_n(&Processor->IpiPacket.Remaining, Remote, __ATOMIC_RELAXED);
+
+        /* Targets that already had requests pending (or that are spinning in here) will see
+         * ours without needing another IPI, so drop them from the set as we go. */
+        uint32_t SelfWord = Processor->Number >> 6;
+        uint64_t SelfBit = 1ull << (Processor->Number & 63);
+        uint32_t Notify = 0;
+        for (uint32_t Word = 0; Word < Words; Word++) {
+            for (uint64_t Mask = Processor->IpiTargets[Word]; Mask; Mask &= Mask - 1) {
+                KeProcessor *Target = HalpProcessorList[Word * 64 + __builtin_ctzll(Mask)];
+                __atomic_fetch_or(&Target->IpiRequests[SelfWord], SelfBit, __ATOMIC_SEQ_CST);
+                if (!__atomic_fetch_or(
+                        &Target->IpiSummary, 1ull << (SelfWord & 63), __ATOMIC_SEQ_CST) &&
+                    !__atomic_load_n(&Target->IpiPolling, __ATOMIC_SEQ_CST)) {
+                    Notify++;
+                } else {
+                    Processor->IpiTargets[Word] &= ~(Mask & -Mask);
+                }
+            }
+        }
+
+        if (Notify) {
+            HalpRequestIpi(Processor->IpiTargets, Notify);
+        }
+    }
+
+    if (CallSelf) {
+        KeIrql CallIrql = KeRaiseIrql(KE_IRQL_IPI);
+        void *CriticalContext = HalpEnterCriticalSection();
+        Routine(Context);
+        HalpLeaveCriticalSection(CriticalContext);
+        KeLowerIrql(CallIrql);
+    }
+
+    if (Remote && Wait) {
+        WaitPacket(Processor);
+    }
+
+    KeLowerIrql(OldIrql);
+    return 1;
+}
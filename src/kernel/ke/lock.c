@@ -14,10 +14,13 @@
  *     Target lock value.
  *-----------------------------------------------------------------------------------------------*/
 static inline uint64_t GetTargetLockValue(void) {
+    PsThread *Thread = KeGetCurrentThread();
+    if (Thread) {
+        return (uint64_t)Thread | 1;
+    }
+
     KeProcessor *Processor = HalGetCurrentProcessor();
-    if (Processor && Processor->CurrentThread) {
-        return (uint64_t)Processor->CurrentThread | 1;
-    } else if (Processor) {
+    if (Processor) {
         return (uint64_t)Processor | 1;
     } else {
         return 1;
@@ -23,6 +23,7 @@ static const char *Messages[] = {
     "DRIVER_INITIALIZATION_FAILURE",
     "BAD_PFN_HEADER",
     "BAD_POOL_HEADER",
+    "IPI_NOT_DELIVERED",
 };
 
 static uint64_t Lock = 0;
@@ -58,7 +59,7 @@ static uint64_t Lock = 0;
     /* Disable maskable interrupts, and raise the IRQL to the max (so we can be sure nothing
      * will interrupts us). */
     HalpEnterCriticalSection();
-    HalpSetIrql(KE_IRQL_MAX);
+    HalpSetIrql(KE_IRQL_MASK);
 
     /* Someone might have reached this handler before us (while we reached here before they sent
      * the panic event), hang ourselves if that't the case. */
@@ -69,11 +70,7 @@ static uint64_t Lock = 0;
     }
 
     /* We're the first to get here, freeze everyone else before continuing. */
-    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
-        if (HalpProcessorList[i] != Processor) {
-            HalpFreezeProcessor(HalpProcessorList[i]);
-        }
-    }
+    HalpFreezeProcessors();
 
     /* Acquire "ownership" of the display (disable the lock checks), setup the panic screen, and
      * show the basic message + error code. */
@@ -0,0 +1,186 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+#include <string.h>
+#include <vid.h>
+
+#define VECTOR_COUNT (sizeof(((KeProcessor *)0)->InterruptCounts) / sizeof(uint64_t))
+
+static const char *HistogramNames[KE_HISTOGRAM_COUNT] = {
+    "interrupt handler time",
+    "DPC queue delay",
+    "thread wakeup delay",
+};
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a single sample to the given histogram. This is lock-free, and safe to
+ *     call at any IRQL; Histograms are expected to be per-processor, so that the atomic increment
+ *     stays uncontended.
+ *
+ * PARAMETERS:
+ *     Histogram - Which histogram to update.
+ *     Value - Value of the sample (usually nanoseconds).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void KeRecordHistogram(KeHistogram *Histogram, uint64_t Value) {
+    uint32_t Bucket = Value ? 64 - __builtin_clzll(Value) : 0;
+    if (Bucket >= KE_HISTOGRAM_BUCKETS) {
+        Bucket = KE_HISTOGRAM_BUCKETS - 1;
+    }
+
+    __atomic_add_fetch(&Histogram->Buckets[Bucket], 1, __ATOMIC_RELAXED);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function estimates the given percentile of a histogram. As we only keep log2 buckets,
+ *     this is the (exclusive) upper bound of the bucket the percentile falls into.
+ *
+ * PARAMETERS:
+ *     Histogram - Which histogram to check.
+ *     Percentile - Which percentile we want (0-100).
+ *
+ * RETURN VALUE:
+ *     Upper bound of the percentile, or 0 if the histogram is empty.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t KeGetHistogramPercentile(KeHistogram *Histogram, uint32_t Percentile) {
+    uint64_t Total = 0;
+    for (uint32_t i = 0; i < KE_HISTOGRAM_BUCKETS; i++) {
+        Total += __atomic_load_n(&Histogram->Buckets[i], __ATOMIC_RELAXED);
+    }
+
+    if (!Total) {
+        return 0;
+    } else if (Percentile > 100) {
+        Percentile = 100;
+    }
+
+    uint64_t Target = (Total * Percentile + 99) / 100;
+    uint64_t Seen = 0;
+    for (uint32_t i = 0; i < KE_HISTOGRAM_BUCKETS; i++) {
+        Seen += __atomic_load_n(&Histogram->Buckets[i], __ATOMIC_RELAXED);
+        if (Seen >= Target && Seen) {
+            return i >= KE_HISTOGRAM_BUCKETS - 1 ? UINT64_MAX : 1ull << i;
+        }
+    }
+
+    return UINT64_MAX;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets how many times the given interrupt vector fired.
+ *
+ * PARAMETERS:
+ *     Number - Which processor to check, or KE_STATISTICS_ALL_PROCESSORS for the sum of all of
+ *              them.
+ *     Vector - Which interrupt vector to check.
+ *
+ * RETURN VALUE:
+ *     How many interrupts were received, or 0 if the processor/vector doesn't exist.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t KeGetInterruptCount(uint32_t Number, uint32_t Vector) {
+    if (Vector >= VECTOR_COUNT ||
+        (Number != KE_STATISTICS_ALL_PROCESSORS && Number >= HalpProcessorCount)) {
+        return 0;
+    }
+
+    uint64_t Count = 0;
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        if (Number == KE_STATISTICS_ALL_PROCESSORS || Number == i) {
+            Count +=
+                __atomic_load_n(&HalpProcessorList[i]->InterruptCounts[Vector], __ATOMIC_RELAXED);
+        }
+    }
+
+    return Count;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function takes a snapshot of one of the latency histograms. The snapshot isn't
+ *     atomic as a whole (samples keep coming in while we copy), but each bucket is.
+ *
+ * PARAMETERS:
+ *     Number - Which processor to check, or KE_STATISTICS_ALL_PROCESSORS for the sum of all of
+ *              them.
+ *     Type - Which histogram we want (KE_HISTOGRAM_*).
+ *     Histogram - Output; Where to store the snapshot.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the processor/histogram doesn't exist.
+ *-----------------------------------------------------------------------------------------------*/
+int KeQueryHistogram(uint32_t Number, int Type, KeHistogram *Histogram) {
+    if (Type < 0 || Type >= KE_HISTOGRAM_COUNT ||
+        (Number != KE_STATISTICS_ALL_PROCESSORS && Number >= HalpProcessorCount)) {
+        return 0;
+    }
+
+    memset(Histogram, 0, sizeof(KeHistogram));
+
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        if (Number != KE_STATISTICS_ALL_PROCESSORS && Number != i) {
+            continue;
+        }
+
+        KeHistogram *Source = &HalpProcessorList[i]->Histograms[Type];
+        for (uint32_t j = 0; j < KE_HISTOGRAM_BUCKETS; j++) {
+            Histogram->Buckets[j] += __atomic_load_n(&Source->Buckets[j], __ATOMIC_RELAXED);
+        }
+    }
+
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function prints the interrupt counters and latency histograms of all processors to the
+ *     screen/debug output.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void KeDumpStatistics(void) {
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        KeProcessor *Processor = HalpProcessorList[i];
+        VidPrint(VID_MESSAGE_INFO, "Kernel", "statistics for processor %u\n", i);
+
+        for (uint32_t Vector = 0; Vector < VECTOR_COUNT; Vector++) {
+            uint64_t Count = __atomic_load_n(&Processor->InterruptCounts[Vector], __ATOMIC_RELAXED);
+            if (Count) {
+                VidPrint(VID_MESSAGE_INFO, "Kernel", "    vector 0x%02x: %llu\n", Vector, Count);
+            }
+        }
+
+        for (int Type = 0; Type < KE_HISTOGRAM_COUNT; Type++) {
+            KeHistogram Histogram;
+            KeQueryHistogram(i, Type, &Histogram);
+
+            uint64_t Total = 0;
+            for (uint32_t Bucket = 0; Bucket < KE_HISTOGRAM_BUCKETS; Bucket++) {
+                Total += Histogram.Buckets[Bucket];
+            }
+
+            if (!Total) {
+                continue;
+            }
+
+            VidPrint(
+                VID_MESSAGE_INFO,
+                "Kernel",
+                "    %s: %llu samples, p50 < %llu ns, p99 < %llu ns, max < %llu ns\n",
+                HistogramNames[Type],
+                Total,
+                KeGetHistogramPercentile(&Histogram, 50),
+                KeGetHistogramPercentile(&Histogram, 99),
+                KeGetHistogramPercentile(&Histogram, 100));
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function should be called before using any extended (x87/AVX) registers inside kernel
+ *     code. Below DISPATCH, the context switch code already keeps the state of each thread apart,
+ *     so we only mark the thread as using the extended registers; At DISPATCH and above, we save
+ *     whatever we interrupted into a per-processor slot.
+ *
+ * PARAMETERS:
+ *     State - Output; Should be passed to KeRestoreExtendedState after we're done.
+ *
+ * RETURN VALUE:
+ *     1 if the extended registers can be used, 0 otherwise (nested save at the same IRQL).
+ *-----------------------------------------------------------------------------------------------*/
+int KeSaveExtendedState(KeExtendedState *State) {
+    State->Irql = KeGetIrql();
+    State->Saved = 0;
+
+    if (State->Irql < KE_IRQL_DISPATCH) {
+        HalpEnterExtendedState();
+        return 1;
+    } else if (!HalpSaveExtendedStateSlot(State->Irql)) {
+        return 0;
+    }
+
+    State->Saved = 1;
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function undoes a previous KeSaveExtendedState call. This should be called at the same
+ *     IRQL as the save.
+ *
+ * PARAMETERS:
+ *     State - What KeSaveExtendedState returned.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void KeRestoreExtendedState(KeExtendedState *State) {
+    if (State->Irql < KE_IRQL_DISPATCH) {
+        HalpLeaveExtendedState();
+    } else if (State->Saved) {
+        HalpRestoreExtendedStateSlot(State->Irql);
+        State->Saved = 0;
+    }
+}
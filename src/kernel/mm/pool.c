@@ -232,3 +232,32 @@ void MmFreePool(void *Base, const char Tag[4]) {
     RtPushSList(&SmallBlocks[Header->Head - 1], &Header->ListHeader);
     KeReleaseSpinLock(&Lock, OldIrql);
 }
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates storage for a hash table; Pass it (together with
+ *     MmFreeHashTable) to RtInitializeHashTable for any table living in the pool.
+ *
+ * PARAMETERS:
+ *     Size - How many bytes the table needs.
+ *
+ * RETURN VALUE:
+ *     Pointer to the allocated memory, or NULL on failure.
+ *-----------------------------------------------------------------------------------------------*/
+void *MmAllocateHashTable(size_t Size) {
+    return MmAllocatePool(Size, "Hash");
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function frees storage previously allocated by MmAllocateHashTable().
+ *
+ * PARAMETERS:
+ *     Base - Pointer to the memory.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void MmFreeHashTable(void *Base) {
+    MmFreePool(Base, "Hash");
+}
@@ -0,0 +1,239 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <halp.h>
+#include <psp.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the ID of the scheduling domain the processor belongs to at the given
+ *     level; Processors with the same ID share that domain.
+ *
+ * PARAMETERS:
+ *     Processor - Which processor to check.
+ *     Level - PSP_DOMAIN_* value.
+ *
+ * RETURN VALUE:
+ *     ID of the domain.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t GetDomainId(KeProcessor *Processor, int Level) {
+    switch (Level) {
+        case PSP_DOMAIN_SMT:
+            return Processor->CoreId;
+        case PSP_DOMAIN_CACHE:
+            return Processor->CacheId;
+        case PSP_DOMAIN_PACKAGE:
+            return Processor->PackageId;
+        default:
+            return Processor->NodeId;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function moves up to the given amount of threads from the busiest processor's queue
+ *     into our own queue. Threads that can't run here, or that were migrated too recently, are
+ *     skipped.
+ *
+ * PARAMETERS:
+ *     Processor - Processor we're running on.
+ *     Busiest - Which processor we're pulling threads from.
+ *     Count - Max amount of threads to pull.
+ *
+ * RETURN VALUE:
+ *     How many threads were moved.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t PullThreads(KeProcessor *Processor, KeProcessor *Busiest, uint32_t Count) {
+    uint64_t CurrentTime = HalGetTime();
+    RtDList Pulled;
+    uint32_t Moved = 0;
+
+    RtInitializeDList(&Pulled);
+
+    /* Start from the back of the queue, the threads there will take the longest to run, and are
+     * the least likely to still have anything in the cache. */
+    KeIrql OldIrql = KeAcquireSpinLock(&Busiest->ThreadQueueLock);
+    RtDList *ListHeader = Busiest->ThreadQueue.Prev;
+    while (Moved < Count && ListHeader != &Busiest->ThreadQueue) {
+        PsThread *Thread = CONTAINING_RECORD(ListHeader, PsThread, ListHeader);
+        ListHeader = ListHeader->Prev;
+
+        if (!PspCheckAffinity(Thread, Processor->Number) ||
+            (Thread->MigrationTime &&
+             CurrentTime - Thread->MigrationTime < PSP_MIGRATION_COOLDOWN)) {
+            continue;
+        }
+
+        RtUnlinkDList(&Thread->ListHeader);
+        RtAppendDList(&Pulled, &Thread->ListHeader);
+        __atomic_sub_fetch(&Busiest->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
+        Thread->MigrationTime = CurrentTime;
+        Moved++;
+    }
+    KeReleaseSpinLock(&Busiest->ThreadQueueLock, OldIrql);
+
+    while (Pulled.Next != &Pulled) {
+        PsThread *Thread = CONTAINING_RECORD(RtPopDList(&Pulled), PsThread, ListHeader);
+        PspQueueThread(Processor, Thread, 0);
+    }
+
+    /* Account for the migration right away, so that nobody else tries to balance the same load
+     * before the averages catch up. The busiest processor (and other balancers) can be updating
+     * its average at the same time, so this needs to be a single atomic (saturating) update. */
+    uint64_t BusiestLoad = __atomic_load_n(&Busiest->LoadAverage, __ATOMIC_RELAXED);
+    uint64_t Delta = Moved * PSP_LOAD_SCALE;
+    while (!__atomic_compare_exchange_n(
+        &Busiest->LoadAverage,
+        &BusiestLoad,
+        BusiestLoad > Delta ? BusiestLoad - Delta : 0,
+        0,
+        __ATOMIC_RELAXED,
+        __ATOMIC_RELAXED)) {
+    }
+
+    __atomic_add_fetch(&Processor->LoadAverage, Delta, __ATOMIC_RELAXED);
+
+    return Moved;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function balances the load inside one of our scheduling domains, by pulling threads
+ *     from its busiest processor if the imbalance is big enough.
+ *
+ * PARAMETERS:
+ *     Processor - Processor we're running on.
+ *     Level - PSP_DOMAIN_* value.
+ *
+ * RETURN VALUE:
+ *     1 if we moved any threads, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int BalanceDomain(KeProcessor *Processor, int Level) {
+    uint32_t DomainId = GetDomainId(Processor, Level);
+    uint64_t Load = __atomic_load_n(&Processor->LoadAverage, __ATOMIC_RELAXED);
+    KeProcessor *Busiest = NULL;
+    uint64_t BusiestLoad = 0;
+
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        KeProcessor *Entry = HalpProcessorList[i];
+        if (Entry == Processor || GetDomainId(Entry, Level) != DomainId ||
+            !__atomic_load_n(&Entry->ThreadQueueSize, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        uint64_t EntryLoad = __atomic_load_n(&Entry->LoadAverage, __ATOMIC_RELAXED);
+        if (EntryLoad > BusiestLoad) {
+            BusiestLoad = EntryLoad;
+            Busiest = Entry;
+        }
+    }
+
+    /* Hysteresis: the busiest processor needs to be both relatively (by PSP_BALANCE_IMBALANCE
+     * percent) and absolutely (by more than one thread) busier than us; Otherwise, moving a single
+     * thread would just flip the imbalance around, and it would bounce back on the next pass. */
+    if (!Busiest || BusiestLoad * 100 <= Load * PSP_BALANCE_IMBALANCE ||
+        BusiestLoad - Load <= PSP_LOAD_SCALE) {
+        return 0;
+    }
+
+    /* Move enough threads to split the difference. */
+    uint32_t Count = (BusiestLoad - Load) / (2 * PSP_LOAD_SCALE);
+    return PullThreads(Processor, Busiest, Count ? Count : 1) != 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs the load balancer for all domain levels that are due, from the smallest
+ *     domain to the biggest (moving threads between SMT siblings is way cheaper than moving them
+ *     between NUMA nodes).
+ *
+ * PARAMETERS:
+ *     Context - Processor we're running on.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void BalanceDpc(void *Context) {
+    KeProcessor *Processor = Context;
+    int Levels = __atomic_exchange_n(&Processor->BalanceLevels, 0, __ATOMIC_RELAXED);
+
+    for (int Level = PSP_DOMAIN_SMT; Level <= PSP_DOMAIN_NODE; Level++) {
+        if ((Levels & (1 << Level)) && BalanceDomain(Processor, Level)) {
+            break;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sets up the load balancer for the current processor.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void PspInitializeLoadBalancer(void) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+    EvInitializeDpc(&Processor->BalanceDpc, BalanceDpc, Processor);
+    EvSetImportanceDpc(&Processor->BalanceDpc, EV_DPC_IMPORTANCE_LOW);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function updates the decayed runnable load average of the current processor, and
+ *     queues up the load balancer if it's due for any domain level. This should be called on
+ *     every clock interrupt; The update itself only happens every PSP_LOAD_UPDATE_INTERVAL, no
+ *     matter how often the timer fires.
+ *
+ * PARAMETERS:
+ *     Processor - Processor we're running on.
+ *     CurrentTime - Current value of HalGetTime().
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void PspUpdateLoad(KeProcessor *Processor, uint64_t CurrentTime) {
+    /* Don't bother with anything before the scheduler is up. */
+    if (!Processor->CurrentThread || CurrentTime < Processor->NextLoadUpdate) {
+        return;
+    }
+
+    Processor->NextLoadUpdate = CurrentTime + PSP_LOAD_UPDATE_INTERVAL;
+
+    int64_t Runnable = __atomic_load_n(&Processor->ThreadQueueSize, __ATOMIC_RELAXED);
+    if (Processor->CurrentThread != Processor->IdleThread) {
+        Runnable++;
+    }
+
+    /* Exponential moving average, each update moves us 1/2^PSP_LOAD_DECAY_SHIFT of the way towards
+     * the current amount of runnable threads. Balancers on other processors can adjust our
+     * average at the same time (when they pull threads from us), so retry if that happens. */
+    uint64_t Load = __atomic_load_n(&Processor->LoadAverage, __ATOMIC_RELAXED);
+    int64_t NewLoad;
+    do {
+        NewLoad = (int64_t)Load +
+                  (Runnable * PSP_LOAD_SCALE - (int64_t)Load) / (1 << PSP_LOAD_DECAY_SHIFT);
+    } while (!__atomic_compare_exchange_n(
+        &Processor->LoadAverage,
+        &Load,
+        NewLoad < 0 ? 0 : NewLoad,
+        0,
+        __ATOMIC_RELAXED,
+        __ATOMIC_RELAXED));
+
+    /* Each level up gets balanced half as often as the one below it. */
+    uint64_t Ticks = ++Processor->BalanceTicks;
+    int Levels = 0;
+    for (int Level = PSP_DOMAIN_SMT; Level <= PSP_DOMAIN_NODE; Level++) {
+        if (!(Ticks % (PSP_BALANCE_INTERVAL << Level))) {
+            Levels |= 1 << Level;
+        }
+    }
+
+    if (Levels) {
+        __atomic_or_fetch(&Processor->BalanceLevels, Levels, __ATOMIC_RELAXED);
+        EvDispatchDpc(&Processor->BalanceDpc);
+    }
+}
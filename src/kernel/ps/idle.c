@@ -1,7 +1,9 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include <evp.h>
 #include <halp.h>
+#include <psp.h>
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -14,7 +16,19 @@
  *     Does not return.
  *-----------------------------------------------------------------------------------------------*/
 [[noreturn]] void PspIdleThread(void *) {
+    KeProcessor *Processor = HalGetCurrentProcessor();
+
     while (1) {
-        HalpStopProcessor();
+        HalpIdleProcessor();
+
+        /* If we got woken up by a write into our wake line (instead of an interrupt), nobody ran
+         * the dispatcher for us yet. */
+        if (__atomic_load_n(&Processor->DpcQueueSize, __ATOMIC_RELAXED) ||
+            __atomic_load_n(&Processor->ThreadQueueSize, __ATOMIC_RELAXED)) {
+            KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+            EvpProcessQueue(NULL);
+            PspProcessQueue(NULL);
+            KeLowerIrql(OldIrql);
+        }
     }
 }
@@ -1,13 +1,15 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include <exp.h>
 #include <halp.h>
 #include <mm.h>
 #include <psp.h>
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     Cleanup routine for killed/terminated threads.
+ *     Cleanup routine for killed/terminated threads; This runs on a worker thread (at PASSIVE
+ *     IRQL).
  *
  * PARAMETERS:
  *     Thread - Which thread was killed.
@@ -15,12 +17,32 @@
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-static void TerminationDpc(void *ThreadPointer) {
+static void TerminationWorkItem(void *ThreadPointer) {
     PsThread *Thread = ThreadPointer;
+    HalpFreeExtendedState(&Thread->Context);
     MmFreePool(Thread->Stack, "Ps  ");
     MmFreePool(Thread, "Ps  ");
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hands a terminated thread over to the cleanup work item. We can't queue the
+ *     work item directly from the scheduler, as another processor could pick it up and free the
+ *     stack before we're done switching away from it; The DPC only runs on the current processor
+ *     once the switch is over.
+ *
+ * PARAMETERS:
+ *     Thread - Which thread was killed.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void TerminationDpc(void *ThreadPointer) {
+    PsThread *Thread = ThreadPointer;
+    ExInitializeWorkItem(&Thread->TerminationWorkItem, TerminationWorkItem, Thread);
+    ExQueueWorkItem(&Thread->TerminationWorkItem, EX_WORK_QUEUE_UNBOUND);
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function tries getting a new thread to be executed.
@@ -33,30 +55,61 @@ static void TerminationDpc(void *ThreadPointer) {
  *     Which thread we should run.
  *-----------------------------------------------------------------------------------------------*/
 static PsThread *GetNextThread(KeProcessor *Processor, int AllowInitial) {
-    /* First try getting a thread from the current processor wait list. */
+    /* First try getting a thread from the current processor wait list. Threads that had their
+     * affinity changed (after being queued) and can't run here anymore get moved elsewhere. */
     if (Processor->ThreadQueueSize) {
+        PsThread *Thread = NULL;
+        RtDList Moved;
+
+        RtInitializeDList(&Moved);
+
         KeIrql OldIrql = KeAcquireSpinLock(&Processor->ThreadQueueLock);
-        RtDList *ListHeader = RtPopDList(&Processor->ThreadQueue);
-        if (ListHeader != &Processor->ThreadQueue) {
+        while (!Thread) {
+            RtDList *ListHeader = RtPopDList(&Processor->ThreadQueue);
+            if (ListHeader == &Processor->ThreadQueue) {
+                break;
+            }
+
             __atomic_sub_fetch(&Processor->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
-            KeReleaseSpinLock(&Processor->ThreadQueueLock, OldIrql);
-            return CONTAINING_RECORD(ListHeader, PsThread, ListHeader);
+            PsThread *Entry = CONTAINING_RECORD(ListHeader, PsThread, ListHeader);
+            if (PspCheckAffinity(Entry, Processor->Number)) {
+                Thread = Entry;
+            } else {
+                RtAppendDList(&Moved, ListHeader);
+            }
         }
         KeReleaseSpinLock(&Processor->ThreadQueueLock, OldIrql);
+
+        /* PspReadyThread takes the target queue lock, so this needs to wait until we released
+         * ours. */
+        while (Moved.Next != &Moved) {
+            PspReadyThread(CONTAINING_RECORD(RtPopDList(&Moved), PsThread, ListHeader), 0);
+        }
+
+        if (Thread) {
+            return Thread;
+        }
     }
 
-    /* If we fail to do so, let's try stealing something from another processor. */
+    /* If we fail to do so, let's try stealing something from another processor (skipping any
+     * threads that aren't allowed to run on this processor). */
     for (uint32_t i = 0; i < HalpProcessorCount; i++) {
         if (HalpProcessorList[i] == Processor || !HalpProcessorList[i]->ThreadQueueSize) {
             continue;
         }
 
         KeIrql OldIrql = KeAcquireSpinLock(&HalpProcessorList[i]->ThreadQueueLock);
-        RtDList *ListHeader = RtPopDList(&HalpProcessorList[i]->ThreadQueue);
-        if (ListHeader != &HalpProcessorList[i]->ThreadQueue) {
-            __atomic_sub_fetch(&HalpProcessorList[i]->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
-            KeReleaseSpinLock(&HalpProcessorList[i]->ThreadQueueLock, OldIrql);
-            return CONTAINING_RECORD(ListHeader, PsThread, ListHeader);
+        RtDList *ListHeader = HalpProcessorList[i]->ThreadQueue.Next;
+        while (ListHeader != &HalpProcessorList[i]->ThreadQueue) {
+            PsThread *Thread = CONTAINING_RECORD(ListHeader, PsThread, ListHeader);
+            if (PspCheckAffinity(Thread, Processor->Number)) {
+                RtUnlinkDList(ListHeader);
+                __atomic_sub_fetch(&HalpProcessorList[i]->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
+                KeReleaseSpinLock(&HalpProcessorList[i]->ThreadQueueLock, OldIrql);
+                return Thread;
+            }
+
+            ListHeader = ListHeader->Next;
         }
         KeReleaseSpinLock(&HalpProcessorList[i]->ThreadQueueLock, OldIrql);
     }
@@ -78,22 +131,23 @@ static PsThread *GetNextThread(KeProcessor *Processor, int AllowInitial) {
  *     This function creates a DPC to handle thread termination if required.
  *
  * PARAMETERS:
- *     Processor - Which CPU scheduler we're using.
  *     Thread - Which thread to check for termination.
  *
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-static void CheckTermination(KeProcessor *Processor, PsThread *Thread) {
+static void CheckTermination(PsThread *Thread) {
     if (Thread && Thread->Terminated) {
         EvInitializeDpc(&Thread->TerminationDpc, TerminationDpc, Thread);
-        RtAppendDList(&Processor->DpcQueue, &Thread->TerminationDpc.ListHeader);
+        EvSetImportanceDpc(&Thread->TerminationDpc, EV_DPC_IMPORTANCE_LOW);
+        EvDispatchDpc(&Thread->TerminationDpc);
     }
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function appends the given thread back into the queue.
+ *     This function appends the given thread back into the queue (or moves it into another
+ *     processor, if its affinity changed and it can't run here anymore).
  *
  * PARAMETERS:
  *     Processor - Which CPU scheduler we're using.
@@ -103,18 +157,20 @@ static void CheckTermination(KeProcessor *Processor, PsThread *Thread) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 static void AdjustQueue(KeProcessor *Processor, PsThread *Thread) {
-    if (!Thread->Terminated) {
-        KeIrql OldIrql = KeAcquireSpinLock(&Processor->ThreadQueueLock);
-        RtAppendDList(&Processor->ThreadQueue, &Thread->ListHeader);
-        __atomic_add_fetch(&Processor->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
-        KeReleaseSpinLock(&Processor->ThreadQueueLock, OldIrql);
+    if (Thread->Terminated) {
+        return;
+    } else if (PspCheckAffinity(Thread, Processor->Number)) {
+        PspQueueThread(Processor, Thread, 0);
+    } else {
+        PspReadyThread(Thread, 0);
     }
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function adjusts the expiration of the new current thread using the thread queue
- *     size.
+ *     size, and marks it as running on this processor. If the thread just finished waiting, we
+ *     also record how long it took to get it running.
  *
  * PARAMETERS:
  *     Processor - Which CPU scheduler we're using.
@@ -124,12 +180,22 @@ static void AdjustQueue(KeProcessor *Processor, PsThread *Thread) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 static void AdjustExpiration(KeProcessor *Processor, PsThread *Thread) {
-    uint64_t CurrentTicks = HalGetTimerTicks();
     uint64_t ThreadQueueSize = Processor->ThreadQueueSize;
+    uint64_t CurrentTime = HalGetTime();
+
+    if (Thread->WakeupTime) {
+        KeRecordHistogram(
+            &Processor->Histograms[KE_HISTOGRAM_WAKEUP_DELAY],
+            CurrentTime > Thread->WakeupTime ? CurrentTime - Thread->WakeupTime : 0);
+        Thread->WakeupTime = 0;
+    }
+
+    /* This is also where we remember where the thread last ran (for wake-affine placement). */
+    Thread->LastProcessor = Processor->Number;
+
     if (Thread == Processor->IdleThread || !ThreadQueueSize) {
         /* No use in setting an expiration if we have no more threads ahead. */
-        Thread->ExpirationReference = 0;
-        Thread->ExpirationTicks = 0;
+        Thread->ExpirationTime = 0;
     } else {
         /* Otherwise just make sure we limit how low the quantum can be. */
         uint64_t ThreadQuantum = PSP_THREAD_QUANTUM / ThreadQueueSize;
@@ -137,8 +203,8 @@ static void AdjustExpiration(KeProcessor *Processor, PsThread *Thread) {
             ThreadQuantum = PSP_THREAD_MIN_QUANTUM;
         }
 
-        Thread->ExpirationReference = CurrentTicks;
-        Thread->ExpirationTicks = ThreadQuantum / HalGetTimerPeriod();
+        Thread->ExpirationTime = CurrentTime + ThreadQuantum;
+        HalSetNextTimerEvent(Thread->ExpirationTime);
     }
 }
 
@@ -161,15 +227,20 @@ void PsYieldExecution(int Type) {
     /* This is the only place that's allowed to switch from the non-scheduler world
      * (KiSystemStartup) into the scheduler world (KiContinueSystemStartup or PspIdleThread). */
     PsThread *TargetThread = GetNextThread(Processor, 1);
-    CheckTermination(Processor, CurrentThread);
+    CheckTermination(CurrentThread);
     if (Type != PS_YIELD_WAITING) {
         AdjustQueue(Processor, CurrentThread);
+    } else if (CurrentThread) {
+        ExpNotifyWorkerBlocked(CurrentThread);
     }
     AdjustExpiration(Processor, TargetThread);
 
     Processor->CurrentThread = TargetThread;
     if (CurrentThread) {
         HalpSwitchContext(&CurrentThread->Context, &TargetThread->Context);
+        if (Type == PS_YIELD_WAITING) {
+            ExpNotifyWorkerRunning(CurrentThread);
+        }
     } else {
         HalpSwitchContext(NULL, &TargetThread->Context);
     }
@@ -204,10 +275,7 @@ void PspProcessQueue(HalInterruptFrame *) {
     }
 
     /* Don't bother with anything if the current thread still has time left til expiration. */
-    uint64_t CurrentTicks = HalGetTimerTicks();
-    if (CurrentThread->ExpirationTicks &&
-        !HalCheckTimerExpiration(
-            CurrentTicks, CurrentThread->ExpirationReference, CurrentThread->ExpirationTicks)) {
+    if (CurrentThread->ExpirationTime && HalGetTime() < CurrentThread->ExpirationTime) {
         return;
     }
 
@@ -215,13 +283,12 @@ void PspProcessQueue(HalInterruptFrame *) {
      * to indicate that we want to switch asap (once we have something to do). */
     PsThread *TargetThread = GetNextThread(Processor, 0);
     if (TargetThread == Processor->IdleThread) {
-        CurrentThread->ExpirationReference = 0;
-        CurrentThread->ExpirationTicks = 0;
+        CurrentThread->ExpirationTime = 0;
         return;
     }
 
     /* Otherwise adjust both threads, and switch away.*/
-    CheckTermination(Processor, CurrentThread);
+    CheckTermination(CurrentThread);
     AdjustQueue(Processor, CurrentThread);
     AdjustExpiration(Processor, TargetThread);
     Processor->CurrentThread = TargetThread;
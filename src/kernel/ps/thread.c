@@ -33,11 +33,116 @@ PsThread *PsCreateThread(void (*EntryPoint)(void *), void *Parameter) {
         return NULL;
     }
 
+    if (!HalpAllocateExtendedState(&Thread->Context)) {
+        MmFreePool(Thread->Stack, "Ps  ");
+        MmFreePool(Thread, "Ps  ");
+        return NULL;
+    }
+
     HalpInitializeContext(&Thread->Context, Thread->Stack, KE_STACK_SIZE, EntryPoint, Parameter);
+    Thread->AffinityMask = PS_AFFINITY_ALL;
+    Thread->BoundProcessor = PS_PROCESSOR_NONE;
+    Thread->LastProcessor = PS_PROCESSOR_NONE;
 
     return Thread;
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function estimates how busy the given processor is.
+ *
+ * PARAMETERS:
+ *     Processor - Which processor to check.
+ *
+ * RETURN VALUE:
+ *     Amount of threads queued or running on the processor.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t GetLoad(KeProcessor *Processor) {
+    uint32_t Load = __atomic_load_n(&Processor->ThreadQueueSize, __ATOMIC_RELAXED);
+    if (Processor->CurrentThread != Processor->IdleThread) {
+        Load++;
+    }
+
+    return Load;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function picks which processor a thread that is becoming ready should go to. We try
+ *     to keep the thread cache warm: its last processor (or the waker's processor) wins if it's
+ *     idle, and after that we prefer processors sharing the last level cache with where it ran
+ *     last, unless they're noticeably busier than everyone else.
+ *
+ * PARAMETERS:
+ *     Thread - Which thread is becoming ready.
+ *
+ * RETURN VALUE:
+ *     Which processor the thread should go to.
+ *-----------------------------------------------------------------------------------------------*/
+static KeProcessor *SelectProcessor(PsThread *Thread) {
+    KeProcessor *Current = HalGetCurrentProcessor();
+    KeProcessor *Last = NULL;
+
+    if (Thread->LastProcessor < HalpProcessorCount &&
+        PspCheckAffinity(Thread, Thread->LastProcessor)) {
+        Last = HalpProcessorList[Thread->LastProcessor];
+        if (!GetLoad(Last)) {
+            return Last;
+        }
+    }
+
+    if (PspCheckAffinity(Thread, Current->Number) && !GetLoad(Current)) {
+        return Current;
+    }
+
+    /* Start off with the last processor (so that it wins any ties), and scan everything else
+     * we're allowed to run on. Processors outside the reference cache domain count as having one
+     * extra thread. */
+    KeProcessor *Reference = Last ? Last : Current;
+    KeProcessor *BestMatch = Last;
+    uint32_t BestMatchLoad = Last ? GetLoad(Last) : UINT32_MAX;
+
+    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
+        KeProcessor *Processor = HalpProcessorList[i];
+        if (Processor == Last || !PspCheckAffinity(Thread, i)) {
+            continue;
+        }
+
+        uint32_t Load = GetLoad(Processor);
+        if (Processor->CacheId != Reference->CacheId) {
+            Load++;
+        }
+
+        if (Load < BestMatchLoad) {
+            BestMatchLoad = Load;
+            BestMatch = Processor;
+        }
+    }
+
+    /* An affinity mask that matches no online processor is rejected by PsSetThreadAffinity, but
+     * just in case, fallback to the current processor. */
+    return BestMatch ? BestMatch : Current;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a thread to the best processor queue (according to its affinity and
+ *     where it last ran).
+ *
+ * PARAMETERS:
+ *     Thread - Which thread to add.
+ *     Boost - Set this to 1 if the thread should be placed at the front of the queue (for
+ *             example, when it just finished waiting for an event).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void PspReadyThread(PsThread *Thread, int Boost) {
+    KeIrql OldIrql = KeRaiseIrql(KE_IRQL_DISPATCH);
+    PspQueueThread(SelectProcessor(Thread), Thread, Boost);
+    KeLowerIrql(OldIrql);
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function adds a thread to a processor queue, calling a switch event if overdue.
@@ -49,25 +154,73 @@ PsThread *PsCreateThread(void (*EntryPoint)(void *), void *Parameter) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void PsReadyThread(PsThread *Thread) {
-    /* Always try and add the thread to the least full queue. */
-    size_t BestMatchSize = SIZE_MAX;
-    KeProcessor *BestMatch = NULL;
+    PspReadyThread(Thread, 0);
+}
 
-    for (uint32_t i = 0; i < HalpProcessorCount; i++) {
-        /* Unless the processor list is somehow NULL, we should be TRUE in the if below at least
-           once. */
-        if (!BestMatch || HalpProcessorList[i]->ThreadQueueSize < BestMatchSize) {
-            BestMatchSize = HalpProcessorList[i]->ThreadQueueSize;
-            BestMatch = HalpProcessorList[i];
-        }
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sets which processors the given thread is allowed to run on. If the thread is
+ *     currently running on a processor outside the new mask, it'll be moved the next time it gets
+ *     scheduled out; If it's queued on one, it'll be moved once that processor gets to it.
+ *
+ * PARAMETERS:
+ *     Thread - Which thread to modify.
+ *     AffinityMask - Bitmask of processor indices; Use PS_AFFINITY_ALL to allow all processors.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the mask doesn't contain any online processor, or if the thread is
+ *     bound to a processor.
+ *-----------------------------------------------------------------------------------------------*/
+int PsSetThreadAffinity(PsThread *Thread, uint64_t AffinityMask) {
+    if (Thread->BoundProcessor != PS_PROCESSOR_NONE) {
+        return 0;
     }
 
-    /* Now we're forced to lock the processor queue (there was no need up until now, as we were
-       only reading). */
-    KeIrql OldIrql = KeAcquireSpinLock(&BestMatch->ThreadQueueLock);
-    RtAppendDList(&BestMatch->ThreadQueue, &Thread->ListHeader);
-    __atomic_add_fetch(&BestMatch->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
-    KeReleaseSpinLock(&BestMatch->ThreadQueueLock, OldIrql);
+    uint64_t OnlineMask = PS_AFFINITY_ALL;
+    if (HalpProcessorCount < 64) {
+        OnlineMask = (1ull << HalpProcessorCount) - 1;
+    }
+
+    if (!(AffinityMask & OnlineMask)) {
+        return 0;
+    }
+
+    __atomic_store_n(&Thread->AffinityMask, AffinityMask, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds a thread to a specific processor queue, waking the processor up if it's
+ *     idle. This is mostly meant for threads pinned to a processor (which can't go through
+ *     PsReadyThread()).
+ *
+ * PARAMETERS:
+ *     Processor - Which processor queue to use.
+ *     Thread - Which thread to add.
+ *     Boost - Set this to 1 if the thread should be placed at the front of the queue.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void PspQueueThread(KeProcessor *Processor, PsThread *Thread, int Boost) {
+    KeIrql OldIrql = KeAcquireSpinLock(&Processor->ThreadQueueLock);
+
+    if (Boost) {
+        RtPushDList(&Processor->ThreadQueue, &Thread->ListHeader);
+    } else {
+        RtAppendDList(&Processor->ThreadQueue, &Thread->ListHeader);
+    }
+
+    __atomic_add_fetch(&Processor->ThreadQueueSize, 1, __ATOMIC_SEQ_CST);
+    KeReleaseSpinLock(&Processor->ThreadQueueLock, OldIrql);
+
+    /* Idle processors won't look at their queue until something wakes them up (this is just a
+     * write into their wake line if they're sleeping on MWAIT). */
+    if (Processor != HalGetCurrentProcessor() && Processor->CurrentThread &&
+        Processor->CurrentThread == Processor->IdleThread) {
+        HalpNotifyProcessor(Processor, 0);
+    }
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -13,5 +13,5 @@
  *-----------------------------------------------------------------------------------------------*/
 int isxdigit(int ch) {
     return (unsigned int)ch - 0x30 < 0x0A || (unsigned int)ch - 0x41 < 0x06 ||
-           (unsigned char)ch - 0x61 < 0x06;
+           (unsigned int)ch - 0x61 < 0x06;
 }
@@ -21,6 +21,7 @@ struct FILE {
     size_t buffer_file_pos;
     char unget_buffer[16];
     size_t unget_size;
+    size_t readahead_pos;
     int flags;
 };
 
@@ -47,6 +48,51 @@ struct fpos_t {
 #define __STDIO_FLAGS_EOF 0x40
 #define __STDIO_FLAGS_READING 0x80
 #define __STDIO_FLAGS_WRITING 0x100
+#define __STDIO_FLAGS_SEQUENTIAL 0x200
+#define __STDIO_FLAGS_MAPPED 0x400
+
+/* How far ahead of the current position we ask the OS to read on streams marked as sequential
+ * (setvbuf with _IOSEQ); We ask for the next window once we're halfway through the last one. */
+#define __READAHEAD_SIZE (256ull << 10)
+
+#define __CPU_FEATURE_ERMS 0x01
+#define __CPU_FEATURE_FSRM 0x02
+#define __CPU_FEATURE_AVX2 0x04
+
+/* Size classes for the mem* routines; Anything up to __SMALL_COPY_SIZE is done with a few
+ * (overlapping) loads and stores, medium sizes use a vector loop (or REP MOVSB/STOSB on processors
+ * where that's fast), and anything past __NON_TEMPORAL_THRESHOLD bypasses the cache (it would
+ * just evict everything else, and we won't read it back any time soon). */
+#define __SMALL_COPY_SIZE 64
+#define __REP_THRESHOLD_ERMS 2048
+#define __REP_THRESHOLD_FSRM 128
+#define __NON_TEMPORAL_THRESHOLD (4ull << 20)
+
+/* Range of the power of five table used by the string to float conversion. */
+#define __STRTOD_POW5_MIN (-342)
+#define __STRTOD_POW5_MAX 308
+
+typedef uint16_t __attribute__((may_alias, aligned(1))) __unaligned_uint16_t;
+typedef uint32_t __attribute__((may_alias, aligned(1))) __unaligned_uint32_t;
+typedef uint64_t __attribute__((may_alias, aligned(1))) __unaligned_uint64_t;
+
+/* Layout of a binary floating point type; This is what lets strtof/strtod/strtold share the same
+ * conversion code. */
+struct __float_format {
+    int mantissa_bits;
+    int exponent_bias;
+    int max_exponent;
+    int min_power;
+    int max_power;
+};
+
+/* Unpacked floating point value. The mantissa includes the leading (integer) bit, and the exponent
+ * is biased (0 for zeroes and subnormals, max_exponent for infinities and NaNs). */
+struct __float_value {
+    uint64_t mantissa;
+    int exponent;
+    int negative;
+};
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +103,10 @@ void *__fopen(const char *filename, int mode, size_t *length);
 void __fclose(void *handle);
 int __fread(void *handle, size_t pos, void *buffer, size_t size, size_t *read);
 int __fwrite(void *handle, size_t pos, const void *buffer, size_t size, size_t *wrote);
+void *__fmap(void *handle, size_t size);
+void __funmap(void *handle, void *base, size_t size);
+void __freadahead(void *handle, size_t pos, size_t size);
+void __release_buffer(struct FILE *stream);
 
 int __vprintf(
     const char *format,
@@ -85,13 +135,18 @@ int __vwscanf(
     void (*unread_ch)(void *context, int ch));
 
 void *__allocate_pages(size_t pages);
+void __free_pages(void *base, size_t pages);
 
-double __strtod_hex(const char *str, double sign);
-double __strtod_dec(const char *str, double sign);
+extern const uint64_t __strtod_pow5[__STRTOD_POW5_MAX - __STRTOD_POW5_MIN + 1][2];
+
+const char *
+__strtod(const char *str, const struct __float_format *format, struct __float_value *value);
 
 uint64_t __rand64(void);
 void __srand64(uint64_t seed);
 
+int __get_cpu_features(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -20,6 +20,12 @@
 #define _IOLBF 1
 #define _IOFBF 2
 
+/* Non-standard hints that can be OR'ed into the setvbuf() mode. _IOSEQ says the stream will be read
+ * sequentially (so the OS can read ahead of us), and _IOMAP asks for read-only streams to be read
+ * straight out of a memory mapping of the file (if the OS can't map it, we use a normal buffer). */
+#define _IOSEQ 0x100
+#define _IOMAP 0x200
+
 #define SEEK_SET 0
 #define SEEK_CUR 1
 #define SEEK_END 2
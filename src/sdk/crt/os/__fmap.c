@@ -0,0 +1,22 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stddef.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function maps the start of the file into memory (read-only).
+ *
+ * PARAMETERS:
+ *     handle - OS-specific handle.
+ *     size - How many bytes of the file we want to map.
+ *
+ * RETURN VALUE:
+ *     Start of the mapping, or NULL if the file can't be mapped (the caller should fall back to
+ *     __fread).
+ *-----------------------------------------------------------------------------------------------*/
+void *__fmap(void *handle, size_t size) {
+    (void)handle;
+    (void)size;
+    return NULL;
+}
@@ -0,0 +1,23 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stddef.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hints that a range of the file is going to be read soon; The OS can start
+ *     reading it in the background. This is only a hint, and it's fine to ignore it.
+ *
+ * PARAMETERS:
+ *     handle - OS-specific handle.
+ *     pos - Absolute offset from the start of the file.
+ *     size - How many bytes we're going to read.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void __freadahead(void *handle, size_t pos, size_t size) {
+    (void)handle;
+    (void)pos;
+    (void)size;
+}
@@ -0,0 +1,20 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stddef.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function returns memory previously obtained via __allocate_pages() to the OS.
+ *
+ * PARAMETERS:
+ *     base - Pointer to the first page.
+ *     pages - How many pages were allocated.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void __free_pages(void *base, size_t pages) {
+    (void)base;
+    (void)pages;
+}
@@ -0,0 +1,22 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stddef.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function unmaps a mapping previously created by __fmap.
+ *
+ * PARAMETERS:
+ *     handle - OS-specific handle.
+ *     base - Start of the mapping.
+ *     size - Size we passed to __fmap.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void __funmap(void *handle, void *base, size_t size) {
+    (void)handle;
+    (void)base;
+    (void)size;
+}
@@ -0,0 +1,28 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <crt_impl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets rid of the current file buffer (unless it belongs to the user), either
+ *     freeing or unmapping it.
+ *
+ * PARAMETERS:
+ *     stream - Pointer to an open file handle.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void __release_buffer(struct FILE *stream) {
+    if (stream->flags & __STDIO_FLAGS_MAPPED) {
+        __funmap(stream->handle, stream->buffer, stream->buffer_size);
+        stream->flags &= ~__STDIO_FLAGS_MAPPED;
+    } else if (stream->buffer && !stream->user_buffer) {
+        free(stream->buffer);
+    }
+
+    stream->buffer = NULL;
+}
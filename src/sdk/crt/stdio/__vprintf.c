@@ -5,7 +5,6 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
 
 #define MOD_NONE 0
@@ -18,6 +17,187 @@
 #define MOD_t 7
 #define MOD_L 8
 
+/* Floating point values get converted into a big decimal number, stored as base 10^9 limbs; We
+ * need enough limbs for the integer part of DBL_MAX (309 digits), plus one limb per 9 bits of
+ * division for the smallest subnormal (2^-1074). */
+#define LIMB_BASE 1000000000
+#define LIMB_DIGITS 9
+#define LIMB_COUNT 168
+#define LIMB_RADIX 40
+
+#define FILL_SIZE 32
+
+static const char digit_pairs[200] = "0001020304050607080910111213141516171819"
+                                     "2021222324252627282930313233343536373839"
+                                     "4041424344454647484950515253545556575859"
+                                     "6061626364656667686970717273747576777879"
+                                     "8081828384858687888990919293949596979899";
+
+static const uint32_t powers_of_ten[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+typedef struct {
+    char buffer[64];
+    int size;
+    void *context;
+    void (*put_buf)(const void *buffer, int size, void *context);
+} output_t;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function outputs the same character multiple times, in as few put_buf calls as we can.
+ *
+ * PARAMETERS:
+ *     ch - Which character to output; Either a space or a zero.
+ *     count - How many times to output it.
+ *     context - Implementation-defined context.
+ *     put_buf - What to do when we need to output something; Do not pass a NULL pointer!
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void put_fill(
+    int ch,
+    int count,
+    void *context,
+    void (*put_buf)(const void *buffer, int size, void *context)) {
+    static const char spaces[FILL_SIZE] = "                                ";
+    static const char zeroes[FILL_SIZE] = "00000000000000000000000000000000";
+    const char *source = ch == '0' ? zeroes : spaces;
+
+    while (count > 0) {
+        int size = count > FILL_SIZE ? FILL_SIZE : count;
+        put_buf(source, size, context);
+        count -= size;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts an unsigned integer into decimal, two digits at a time.
+ *
+ * PARAMETERS:
+ *     value - What to convert.
+ *     end - One past the last character of the output buffer; The digits are written backwards
+ *           from here.
+ *
+ * RETURN VALUE:
+ *     Pointer to the first digit.
+ *-----------------------------------------------------------------------------------------------*/
+static char *format_decimal(uintmax_t value, char *end) {
+    while (value >= 100) {
+        const char *pair = &digit_pairs[(value % 100) * 2];
+        value /= 100;
+        *(--end) = pair[1];
+        *(--end) = pair[0];
+    }
+
+    if (value >= 10) {
+        const char *pair = &digit_pairs[value * 2];
+        *(--end) = pair[1];
+        *(--end) = pair[0];
+    } else {
+        *(--end) = value + '0';
+    }
+
+    return end;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts a single limb of a big decimal number into exactly 9 digits
+ *     (including leading zeroes).
+ *
+ * PARAMETERS:
+ *     value - What to convert; Needs to be less than LIMB_BASE.
+ *     buffer - Output buffer; Needs to have space for at least 9 characters.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void format_limb(uint32_t value, char *buffer) {
+    for (int i = 7; i > 0; i -= 2) {
+        const char *pair = &digit_pairs[(value % 100) * 2];
+        value /= 100;
+        buffer[i] = pair[0];
+        buffer[i + 1] = pair[1];
+    }
+
+    buffer[0] = value + '0';
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function counts how many decimal digits the given limb has (ignoring leading zeroes).
+ *
+ * PARAMETERS:
+ *     value - Limb value.
+ *
+ * RETURN VALUE:
+ *     How many digits the value has (1 for zero).
+ *-----------------------------------------------------------------------------------------------*/
+static int count_digits(uint32_t value) {
+    int digits = 1;
+
+    while (digits < LIMB_DIGITS && value >= powers_of_ten[digits]) {
+        digits++;
+    }
+
+    return digits;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function appends some data to a buffered output, flushing it if required.
+ *
+ * PARAMETERS:
+ *     output - Buffered output state.
+ *     buffer - What to output.
+ *     size - How many characters to output.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void output_write(output_t *output, const char *buffer, int size) {
+    if (output->size + size > (int)sizeof(output->buffer)) {
+        output->put_buf(output->buffer, output->size, output->context);
+        output->size = 0;
+
+        if (size > (int)sizeof(output->buffer)) {
+            output->put_buf(buffer, size, output->context);
+            return;
+        }
+    }
+
+    memcpy(output->buffer + output->size, buffer, size);
+    output->size += size;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function appends zeroes to a buffered output.
+ *
+ * PARAMETERS:
+ *     output - Buffered output state.
+ *     count - How many zeroes to output.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void output_zeroes(output_t *output, int count) {
+    if (count <= 0) {
+        return;
+    } else if (output->size + count <= (int)sizeof(output->buffer)) {
+        memset(output->buffer + output->size, '0', count);
+        output->size += count;
+        return;
+    }
+
+    output->put_buf(output->buffer, output->size, output->context);
+    output->size = 0;
+    put_fill('0', count, output->context, output->put_buf);
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function pads the output, either before or after outputting the specified buffer.
@@ -52,20 +232,17 @@ static int pad(
         width = 0;
     }
 
-    int pad = ' ';
-    int written_size = width;
-
-    while (!left && width-- > 0) {
-        put_buf(&pad, 1, context);
+    if (!left) {
+        put_fill(' ', width, context, put_buf);
     }
 
     put_buf(buffer, size, context);
 
-    while (left && width-- > 0) {
-        put_buf(&pad, 1, context);
+    if (left) {
+        put_fill(' ', width, context, put_buf);
     }
 
-    return written_size + size;
+    return width + size;
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -100,21 +277,22 @@ static int pad_num(
     void *context,
     void (*put_buf)(const void *buffer, int size, void *context)) {
     int space_width = 0;
-    int space_ch = ' ';
     int zero_width = 0;
-    int zero_ch = '0';
-    int alt_width = 0;
-    char alt_ch[2];
-
-    /* Alternative form for octal takes action when the left most digit isn't a zero,
-       while alt form for hex takes action always. */
-    if (alt == 'o' && ((char *)buffer)[0] != '0') {
-        alt_width = 1;
-        alt_ch[0] = '0';
+    int prefix_width = 0;
+    char prefix[3];
+
+    if (sign > 0) {
+        prefix[prefix_width++] = sign;
+    }
+
+    /* Alternative form for octal takes action when the left most digit isn't a zero (and the
+       precision isn't already padding it with zeroes), while alt form for hex takes action
+       always. */
+    if (alt == 'o' && prec <= size && (!size || ((char *)buffer)[0] != '0')) {
+        prefix[prefix_width++] = '0';
     } else if (alt == 'x' || alt == 'X') {
-        alt_width = 2;
-        alt_ch[0] = '0';
-        alt_ch[1] = alt;
+        prefix[prefix_width++] = '0';
+        prefix[prefix_width++] = alt;
     }
 
     /* Rules for max width vs only min width are somewhat different.
@@ -123,7 +301,7 @@ static int pad_num(
      *     For left=1, it doesn't matter if the user requested zeroes instead of spaces.
      *     Otherwise, it works just as you would expect. */
     if (prec >= 0) {
-        int max_size = (prec > size ? prec : size) + (sign > 0) + alt_width;
+        int max_size = (prec > size ? prec : size) + prefix_width;
 
         if (width > max_size) {
             space_width = width - max_size;
@@ -131,44 +309,39 @@ static int pad_num(
 
         zero_width = prec - size;
     } else if (left || !zero) {
-        int max_size = size + (sign > 0) + alt_width;
+        int max_size = size + prefix_width;
 
         if (width > max_size) {
             space_width = width - max_size;
         }
     } else {
-        int max_size = size + (sign > 0) + alt_width;
+        int max_size = size + prefix_width;
 
         if (width > max_size) {
             zero_width = width - max_size;
         }
     }
 
-    int written_size = space_width + zero_width + alt_width + (sign > 0);
-
-    while (!left && space_width-- > 0) {
-        put_buf(&space_ch, 1, context);
-    }
-
-    if (sign > 0) {
-        put_buf(&sign, 1, context);
+    if (zero_width < 0) {
+        zero_width = 0;
     }
 
-    if (alt_width > 0) {
-        put_buf(alt_ch, alt_width, context);
+    if (!left) {
+        put_fill(' ', space_width, context, put_buf);
     }
 
-    while (zero_width-- > 0) {
-        put_buf(&zero_ch, 1, context);
+    if (prefix_width > 0) {
+        put_buf(prefix, prefix_width, context);
     }
 
+    put_fill('0', zero_width, context, put_buf);
     put_buf(buffer, size, context);
 
-    while (left && space_width-- > 0) {
-        put_buf(&space_ch, 1, context);
+    if (left) {
+        put_fill(' ', space_width, context, put_buf);
     }
 
-    return written_size + size;
+    return space_width + zero_width + prefix_width + size;
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -198,28 +371,15 @@ static int itoa(
     int prec,
     void *context,
     void (*put_buf)(const void *buffer, int size, void *context)) {
-    int value_sign = value < 0;
-    char buffer[64];
-    int size = 0;
-    int pos = 63;
-
-    if (value_sign) {
-        value *= -1;
-    }
-
-    while (value) {
-        buffer[--pos] = value % 10 + '0';
-        value /= 10;
-        size++;
-    }
+    char buffer[32];
+    char *end = buffer + sizeof(buffer);
 
-    if (!size) {
-        buffer[--pos] = '0';
-        size++;
-    }
+    /* Negate as unsigned, so that INTMAX_MIN works. */
+    uintmax_t magnitude = value < 0 ? -(uintmax_t)value : (uintmax_t)value;
+    char *start = !value && !prec ? end : format_decimal(magnitude, end);
 
     return pad_num(
-        buffer + pos, size, value_sign ? '-' : sign, 0, left, zero, width, prec, context, put_buf);
+        start, end - start, value < 0 ? '-' : sign, 0, left, zero, width, prec, context, put_buf);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -254,22 +414,28 @@ static int utoa(
     int prec,
     void *context,
     void (*put_buf)(const void *buffer, int size, void *context)) {
-    char buffer[64];
-    int size = 0;
-    int pos = 63;
+    char buffer[32];
+    char *end = buffer + sizeof(buffer);
+    char *start = end;
+    int nonzero = value != 0;
 
-    while (value) {
-        buffer[--pos] = (upper ? "0123456789ABCDEF" : "0123456789abcdef")[value % base];
-        value /= base;
-        size++;
-    }
+    /* Zero with a precision of zero outputs no digits at all; Bases other than 10 are powers of
+     * two, so we can use shifts instead of divisions. */
+    if (!value && !prec) {
+        start = end;
+    } else if (base == 10) {
+        start = format_decimal(value, end);
+    } else {
+        const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+        int shift = base == 16 ? 4 : 3;
 
-    if (!size) {
-        buffer[--pos] = '0';
-        size++;
+        do {
+            *(--start) = digits[value & (base - 1)];
+            value >>= shift;
+        } while (value);
     }
 
-    if (alt) {
+    if (alt && (nonzero || base == 8)) {
         if (base == 8) {
             alt = 'o';
         } else if (base == 16) {
@@ -277,7 +443,319 @@ static int utoa(
         }
     }
 
-    return pad_num(buffer + pos, size, 0, alt, left, zero, width, prec, context, put_buf);
+    return pad_num(start, end - start, 0, alt, left, zero, width, prec, context, put_buf);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts a floating point value to a string (using the %f, %e or %g
+ *     formats), outputting the result, and applying all specified flags and alignment.
+ *     The value is first converted into an exact big decimal number (every double is a dyadic
+ *     rational, so it has a finite decimal expansion), so the output is always correctly
+ *     rounded (to nearest, ties to even).
+ *
+ * PARAMETERS:
+ *     value - What to convert and output.
+ *     conv - Which conversion specifier was used (any of "fFeEgG").
+ *     sign - Controls if we should use a ' ' or '+' when there's not sign.
+ *     alt - Controls if we should use the alternative form.
+ *     left - Controls if we need to left-align (0), or right-align (1).
+ *     zero - Controls if the pad character is a space (0), or a zero (1).
+ *     width - Minimum width specifier.
+ *     prec - Precision specifier.
+ *     context - Implementation-defined context.
+ *     put_buf - What to do when we need to output something; Do not pass a NULL pointer!
+ *
+ * RETURN VALUE:
+ *     How many characters have been output.
+ *-----------------------------------------------------------------------------------------------*/
+static int ftoa(
+    double value,
+    int conv,
+    int sign,
+    int alt,
+    int left,
+    int zero,
+    int width,
+    int prec,
+    void *context,
+    void (*put_buf)(const void *buffer, int size, void *context)) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(uint64_t));
+
+    int upper = conv == 'F' || conv == 'E' || conv == 'G';
+    int type = conv | 0x20;
+    int biased_exponent = (bits >> 52) & 0x7FF;
+    uint64_t mantissa = bits & ((1ull << 52) - 1);
+
+    if (bits >> 63) {
+        sign = '-';
+    }
+
+    if (biased_exponent == 0x7FF) {
+        const char *str = mantissa ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+        return pad_num(str, 3, sign, 0, left, 0, width, -1, context, put_buf);
+    }
+
+    if (prec < 0) {
+        prec = 6;
+    } else if (type == 'g' && !prec) {
+        prec = 1;
+    }
+
+    int binary_exponent = -1074;
+    if (biased_exponent) {
+        mantissa |= 1ull << 52;
+        binary_exponent = biased_exponent - 1075;
+    } else if (!mantissa) {
+        binary_exponent = 0;
+    }
+
+    /* The number is stored as limbs[first...end-1], with limbs[LIMB_RADIX] being the units limb
+     * (anything after it is the fractional part). */
+    uint32_t limbs[LIMB_COUNT];
+    int radix = LIMB_RADIX;
+    int first = radix - 1;
+    int end = radix + 1;
+    int sticky = 0;
+
+    limbs[radix - 1] = mantissa / LIMB_BASE;
+    limbs[radix] = mantissa % LIMB_BASE;
+    if (!limbs[first]) {
+        first++;
+    }
+
+    while (binary_exponent > 0) {
+        int shift = binary_exponent < 29 ? binary_exponent : 29;
+        uint32_t carry = 0;
+
+        for (int i = end - 1; i >= first; i--) {
+            uint64_t product = ((uint64_t)limbs[i] << shift) + carry;
+            limbs[i] = product % LIMB_BASE;
+            carry = product / LIMB_BASE;
+        }
+
+        if (carry) {
+            limbs[--first] = carry;
+        }
+
+        binary_exponent -= shift;
+    }
+
+    /* Dividing by 2^N adds a new limb every step, but we only need the limbs up to the rounding
+     * position; Anything after it is only needed to know if we're exactly halfway (sticky). */
+    int needed = (prec + LIMB_DIGITS - 1) / LIMB_DIGITS + 2;
+    while (binary_exponent < 0) {
+        int shift = -binary_exponent < LIMB_DIGITS ? -binary_exponent : LIMB_DIGITS;
+        uint32_t mask = (1u << shift) - 1;
+        uint32_t carry = 0;
+
+        for (int i = first; i < end; i++) {
+            uint32_t remainder = limbs[i] & mask;
+            limbs[i] = (limbs[i] >> shift) + carry;
+            carry = (LIMB_BASE >> shift) * remainder;
+        }
+
+        if (carry) {
+            limbs[end++] = carry;
+        }
+
+        if (!limbs[first]) {
+            first++;
+        }
+
+        int base = type == 'f' ? radix : first;
+        if (end - base > needed) {
+            for (int i = base + needed; i < end; i++) {
+                sticky |= limbs[i] != 0;
+            }
+
+            end = base + needed;
+        }
+
+        /* Too small to show up in %f at all (not even for rounding). */
+        if (first >= end) {
+            first = end;
+            break;
+        }
+
+        binary_exponent += shift;
+    }
+
+    int exponent = 0;
+    if (first < end) {
+        exponent = LIMB_DIGITS * (radix - first) + count_digits(limbs[first]) - 1;
+    }
+
+    /* Round at the last digit we'll show; `keep` is how many digits after the decimal point that
+     * is (negative if it's inside the integer part), and `limb` is the first limb with any
+     * digit that we're dropping. */
+    int keep = type == 'f' ? prec : prec - exponent - (type == 'g');
+    int keep_limbs = keep >= 0 ? keep / LIMB_DIGITS : -((LIMB_DIGITS - 1 - keep) / LIMB_DIGITS);
+    int limb = radix + 1 + keep_limbs;
+
+    if (limb < end) {
+        uint32_t divisor = powers_of_ten[LIMB_DIGITS - (keep - keep_limbs * LIMB_DIGITS)];
+        uint32_t dropped = limbs[limb] % divisor;
+        int odd = divisor < LIMB_BASE ? (limbs[limb] / divisor) & 1
+                                      : limb > first && (limbs[limb - 1] & 1);
+        int above = sticky;
+
+        for (int i = limb + 1; i < end && !above; i++) {
+            above = limbs[i] != 0;
+        }
+
+        limbs[limb] -= dropped;
+        end = limb + 1;
+
+        if (dropped > divisor / 2 || (dropped == divisor / 2 && (above || odd))) {
+            limbs[limb] += divisor;
+
+            while (limbs[limb] >= LIMB_BASE) {
+                limbs[limb--] = 0;
+
+                if (limb < first) {
+                    first = limb;
+                    limbs[limb] = 0;
+                }
+
+                limbs[limb]++;
+            }
+
+            exponent = LIMB_DIGITS * (radix - first) + count_digits(limbs[first]) - 1;
+        }
+    }
+
+    while (end > first && !limbs[end - 1]) {
+        end--;
+    }
+
+    if (type == 'g') {
+        if (prec > exponent && exponent >= -4) {
+            type = 'f';
+            prec -= exponent + 1;
+        } else {
+            type = 'e';
+            prec--;
+        }
+
+        /* Trailing zeroes get removed unless we're using the alt form. */
+        if (!alt) {
+            int trailing = LIMB_DIGITS;
+            if (end > first) {
+                for (trailing = 0; !(limbs[end - 1] % powers_of_ten[trailing + 1]); trailing++)
+                    ;
+            }
+
+            int digits = LIMB_DIGITS * (end - radix - 1) - trailing;
+            if (type == 'e') {
+                digits += exponent;
+            }
+
+            if (prec > digits) {
+                prec = digits > 0 ? digits : 0;
+            }
+        }
+    }
+
+    char exponent_buffer[8];
+    char *exponent_end = exponent_buffer + sizeof(exponent_buffer);
+    char *exponent_start = exponent_end;
+    int size = 1 + prec + (prec || alt);
+
+    if (type == 'f') {
+        if (exponent > 0) {
+            size += exponent;
+        }
+    } else {
+        exponent_start = format_decimal(exponent < 0 ? -exponent : exponent, exponent_end);
+        if (exponent_end - exponent_start < 2) {
+            *(--exponent_start) = '0';
+        }
+
+        *(--exponent_start) = exponent < 0 ? '-' : '+';
+        *(--exponent_start) = upper ? 'E' : 'e';
+        size += exponent_end - exponent_start;
+    }
+
+    size += sign > 0;
+
+    if (!left && !zero) {
+        put_fill(' ', width - size, context, put_buf);
+    }
+
+    output_t output;
+    output.size = 0;
+    output.context = context;
+    output.put_buf = put_buf;
+
+    if (sign > 0) {
+        char ch = sign;
+        output_write(&output, &ch, 1);
+    }
+
+    if (!left && zero) {
+        output_zeroes(&output, width - size);
+    }
+
+    char digits[LIMB_DIGITS];
+    int index = type == 'f' && first > radix ? radix : first;
+    uint32_t leading = index >= first && index < end ? limbs[index] : 0;
+    int leading_size = count_digits(leading);
+
+    format_limb(leading, digits);
+
+    if (type == 'f') {
+        /* Integer part (the first limb without leading zeroes). */
+        output_write(&output, digits + LIMB_DIGITS - leading_size, leading_size);
+
+        while (++index <= radix) {
+            if (index < end) {
+                format_limb(limbs[index], digits);
+                output_write(&output, digits, LIMB_DIGITS);
+            } else {
+                output_zeroes(&output, LIMB_DIGITS);
+            }
+        }
+
+        if (prec || alt) {
+            output_write(&output, ".", 1);
+        }
+    } else {
+        /* Leading digit, then whatever is left of the leading limb. */
+        output_write(&output, digits + LIMB_DIGITS - leading_size, 1);
+
+        if (prec || alt) {
+            output_write(&output, ".", 1);
+        }
+
+        int remaining = leading_size - 1 < prec ? leading_size - 1 : prec;
+        output_write(&output, digits + LIMB_DIGITS - leading_size + 1, remaining);
+        prec -= remaining;
+        index++;
+    }
+
+    /* Fractional part (or the remaining digits for %e). */
+    while (prec > 0 && index < end) {
+        int remaining = prec < LIMB_DIGITS ? prec : LIMB_DIGITS;
+        format_limb(index >= first ? limbs[index] : 0, digits);
+        output_write(&output, digits, remaining);
+        prec -= remaining;
+        index++;
+    }
+
+    if (prec > 0) {
+        output_zeroes(&output, prec);
+    }
+
+    output_write(&output, exponent_start, exponent_end - exponent_start);
+    put_buf(output.buffer, output.size, context);
+
+    if (left) {
+        put_fill(' ', width - size, context, put_buf);
+    }
+
+    return width > size ? width : size;
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -303,14 +781,20 @@ int __vprintf(
 
     while (*format) {
         const char *start = format;
-        int ch = *(format++);
 
-        if (ch != '%') {
-            put_buf(&ch, 1, context);
-            size++;
+        /* Output the whole run of literal characters at once. */
+        if (*format != '%') {
+            while (*format && *format != '%') {
+                format++;
+            }
+
+            put_buf(start, format - start, context);
+            size += format - start;
             continue;
         }
 
+        format++;
+
         /* First group, options can appear in any order (and we don't care about repeats). */
         int sign = 0;
         int left = 0;
@@ -352,7 +836,9 @@ int __vprintf(
         /* Second group, (min) width specifier. */
         int width = 0;
         if (isdigit(*format)) {
-            width = strtol(format, (char **)&format, 10);
+            while (isdigit(*format)) {
+                width = width * 10 + *(format++) - '0';
+            }
         } else if (*format == '*') {
             width = va_arg(vlist, int);
             format++;
@@ -362,7 +848,10 @@ int __vprintf(
         int prec = -1;
         if (*format == '.') {
             if (isdigit(*(++format))) {
-                prec = strtol(format, (char **)&format, 10);
+                prec = 0;
+                while (isdigit(*format)) {
+                    prec = prec * 10 + *(format++) - '0';
+                }
             } else if (*format == '*') {
                 prec = va_arg(vlist, int);
                 format++;
@@ -410,9 +899,10 @@ int __vprintf(
 
         uintmax_t unsigned_value;
         intmax_t signed_value;
+        double float_value;
         const char *str;
 
-        ch = *(format++);
+        int ch = *(format++);
 
         /* At last, handle the conversion specifiers. */
         switch (ch) {
@@ -507,6 +997,23 @@ int __vprintf(
                     context,
                     put_buf);
 
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                /* long double is only converted at double precision. */
+                if (mod == MOD_L) {
+                    float_value = va_arg(vlist, long double);
+                } else {
+                    float_value = va_arg(vlist, double);
+                }
+
+                size += ftoa(
+                    float_value, ch, sign, alt, left, zero, width, prec, context, put_buf);
+
                 break;
             case 'n':
                 switch (mod) {
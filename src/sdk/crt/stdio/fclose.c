@@ -20,13 +20,10 @@ int fclose(struct FILE *stream) {
         return EOF;
     }
 
+    /* Mapped buffers need the handle to be unmapped, so release the buffer first. */
     fflush(stream);
+    __release_buffer(stream);
     __fclose(stream->handle);
-
-    if (stream->buffer && !stream->user_buffer) {
-        free(stream->buffer);
-    }
-
     free(stream);
 
     return 0;
@@ -46,6 +46,7 @@ FILE *fopen(const char *filename, const char *mode) {
     }
 
     stream->handle = handle;
+    stream->user_buffer = 0;
     stream->file_size = length;
     stream->file_pos = 0;
     stream->buffer_type = _IOFBF;
@@ -54,6 +55,7 @@ FILE *fopen(const char *filename, const char *mode) {
     stream->buffer_pos = 0;
     stream->buffer_file_pos = 0;
     stream->unget_size = 0;
+    stream->readahead_pos = 0;
     stream->flags = flags;
 
     return stream;
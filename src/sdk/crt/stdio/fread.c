@@ -6,6 +6,41 @@
 #include <stdlib.h>
 #include <string.h>
 
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function asks the OS to start reading the next part of the file, if the stream was
+ *     marked as sequential, and we're getting close to the end of what we already asked for.
+ *
+ * PARAMETERS:
+ *     stream - FILE stream.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void readahead(struct FILE *stream) {
+    if (!(stream->flags & __STDIO_FLAGS_SEQUENTIAL) ||
+        stream->file_pos + __READAHEAD_SIZE / 2 < stream->readahead_pos) {
+        return;
+    }
+
+    size_t pos = stream->readahead_pos;
+    if (pos < stream->file_pos) {
+        pos = stream->file_pos;
+    }
+
+    if (pos >= stream->file_size) {
+        return;
+    }
+
+    size_t size = stream->file_size - pos;
+    if (size > __READAHEAD_SIZE) {
+        size = __READAHEAD_SIZE;
+    }
+
+    __freadahead(stream->handle, pos, size);
+    stream->readahead_pos = pos + size;
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function tries reading `count` chunks of `size` bytes each from the FILE stream.
@@ -56,6 +91,26 @@ size_t fread(void *buffer, size_t size, size_t count, struct FILE *stream) {
         return count;
     }
 
+    /* Mapped files are read directly out of the mapping (which starts at the beginning of the
+     * file), so the buffer positions aren't used. */
+    if (stream->flags & __STDIO_FLAGS_MAPPED) {
+        size_t copy_size = 0;
+        if (stream->file_pos < stream->buffer_size) {
+            copy_size = stream->buffer_size - stream->file_pos;
+        }
+
+        if (total_bytes < copy_size) {
+            copy_size = total_bytes;
+        } else if (total_bytes > copy_size) {
+            stream->flags |= __STDIO_FLAGS_EOF;
+        }
+
+        memcpy(dest, stream->buffer + stream->file_pos, copy_size);
+        stream->file_pos += copy_size;
+        readahead(stream);
+        return (accum + copy_size) / size;
+    }
+
     if (!stream->buffer || stream->buffer_type == _IONBF) {
         size_t read;
         int flags = __fread(stream->handle, stream->file_pos, dest, total_bytes, &read);
@@ -65,6 +120,7 @@ size_t fread(void *buffer, size_t size, size_t count, struct FILE *stream) {
             stream->flags |= flags;
         }
 
+        readahead(stream);
         return (accum + read) / size;
     }
 
@@ -73,6 +129,31 @@ size_t fread(void *buffer, size_t size, size_t count, struct FILE *stream) {
     while (accum < size * count) {
         size_t remaining = size * count - accum;
 
+        /* Once the buffer is empty, anything that would fill it completely goes straight into the
+         * caller's buffer (instead of being copied twice). */
+        if (stream->buffer_pos >= stream->buffer_read && remaining >= stream->buffer_size) {
+            size_t read;
+            flags = __fread(stream->handle, stream->buffer_file_pos, dest, remaining, &read);
+
+            stream->buffer_file_pos += read;
+            stream->buffer_read = 0;
+            stream->buffer_pos = 0;
+            stream->file_pos += read;
+            accum += read;
+            dest += read;
+
+            if ((flags & __STDIO_FLAGS_EOF) && remaining <= read) {
+                flags &= ~__STDIO_FLAGS_EOF;
+            }
+
+            if (flags || !read) {
+                stream->flags |= flags;
+                break;
+            }
+
+            continue;
+        }
+
         if (stream->buffer_pos >= stream->buffer_read) {
             flags = __fread(
                 stream->handle,
@@ -108,5 +189,6 @@ size_t fread(void *buffer, size_t size, size_t count, struct FILE *stream) {
         }
     }
 
+    readahead(stream);
     return accum / size;
 }
@@ -24,12 +24,9 @@ FILE *freopen(const char *filename, const char *mode, struct FILE *stream) {
     }
 
     fflush(stream);
+    __release_buffer(stream);
     __fclose(stream->handle);
 
-    if (stream->buffer && !stream->user_buffer) {
-        free(stream->buffer);
-    }
-
     if (!filename || !mode) {
         free(stream);
         return NULL;
@@ -51,6 +48,7 @@ FILE *freopen(const char *filename, const char *mode, struct FILE *stream) {
     }
 
     stream->handle = handle;
+    stream->user_buffer = 0;
     stream->file_size = length;
     stream->file_pos = 0;
     stream->buffer_type = _IOFBF;
@@ -59,6 +57,7 @@ FILE *freopen(const char *filename, const char *mode, struct FILE *stream) {
     stream->buffer_pos = 0;
     stream->buffer_file_pos = 0;
     stream->unget_size = 0;
+    stream->readahead_pos = 0;
     stream->flags = flags;
 
     return stream;
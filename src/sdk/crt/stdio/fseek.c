@@ -41,6 +41,7 @@ int fseek(struct FILE *stream, long offset, int origin) {
     stream->flags &= ~__STDIO_FLAGS_EOF;
     stream->file_pos = pos;
     stream->buffer_file_pos = pos;
+    stream->readahead_pos = pos;
 
     return 0;
 }
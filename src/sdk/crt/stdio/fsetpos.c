@@ -24,6 +24,7 @@ int fsetpos(struct FILE *stream, struct fpos_t *pos) {
     stream->flags &= ~__STDIO_FLAGS_EOF;
     stream->file_pos = pos->file_pos;
     stream->buffer_file_pos = pos->file_pos;
+    stream->readahead_pos = pos->file_pos;
 
     return 0;
 }
@@ -54,6 +54,25 @@ size_t fwrite(const void *buffer, size_t size, size_t count, struct FILE *stream
        flushing if we reached the end of the buffer or if we have a newline on _IOLBF. */
     while (accum < total_bytes) {
         size_t remaining = size * count - accum;
+
+        /* Once the buffer is empty, anything that would fill it completely gets written directly
+         * from the caller's buffer; That also satisfies _IOLBF, as it's written right away. */
+        if (!stream->buffer_pos && remaining >= stream->buffer_size) {
+            int flags = __fwrite(stream->handle, stream->buffer_file_pos, src, remaining, &wrote);
+
+            stream->file_pos += wrote;
+            stream->buffer_file_pos += wrote;
+            accum += wrote;
+            src += wrote;
+
+            if (flags || !wrote) {
+                stream->flags |= flags;
+                break;
+            }
+
+            continue;
+        }
+
         size_t copy_size = stream->buffer_size - stream->buffer_pos;
         if (remaining < copy_size) {
             copy_size = remaining;
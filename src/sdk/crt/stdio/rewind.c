@@ -23,6 +23,8 @@ int rewind(struct FILE *stream) {
     fflush(stream);
     stream->flags &= ~__STDIO_FLAGS_EOF;
     stream->file_pos = 0;
+    stream->buffer_file_pos = 0;
+    stream->readahead_pos = 0;
 
     return 0;
 }
@@ -3,7 +3,6 @@
 
 #include <crt_impl.h>
 #include <stdio.h>
-#include <stdlib.h>
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -24,10 +23,7 @@ void setbuf(struct FILE *stream, char *buffer) {
     }
 
     fflush(stream);
-
-    if (stream->buffer && !stream->user_buffer) {
-        free(stream->buffer);
-    }
+    __release_buffer(stream);
 
     if (buffer) {
         stream->user_buffer = 1;
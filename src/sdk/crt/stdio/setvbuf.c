@@ -13,7 +13,7 @@
  * PARAMETERS:
  *     stream - Pointer to an open file handle.
  *     buffer - New file buffer.
- *     mode - Desired buffer type.
+ *     mode - Desired buffer type, optionally combined with the _IOSEQ/_IOMAP hints.
  *     size - Buffer size.
  *
  * RETURN VALUE:
@@ -24,34 +24,61 @@ void setvbuf(struct FILE *stream, char *buffer, int mode, size_t size) {
         return;
     }
 
-    /* We'll be overwriting those fields in the next block, so we need to save it. */
-    int user_buffer = stream->user_buffer;
     fflush(stream);
 
-    if (mode == _IOLBF || mode == _IOFBF) {
-        if (!buffer) {
-            buffer = malloc(size);
+    int hints = mode & (_IOSEQ | _IOMAP);
+    mode &= ~(_IOSEQ | _IOMAP);
 
-            if (!buffer) {
-                return;
-            }
+    stream->readahead_pos = stream->file_pos;
+    if (hints & _IOSEQ) {
+        stream->flags |= __STDIO_FLAGS_SEQUENTIAL;
+    } else {
+        stream->flags &= ~__STDIO_FLAGS_SEQUENTIAL;
+    }
 
+    /* Mappings are read-only, so we can only use them on streams that never get written to;
+     * Otherwise (or if the OS can't map the file), _IOMAP is just ignored. */
+    if ((hints & _IOMAP) && mode != _IONBF && !(stream->flags & __STDIO_FLAGS_WRITE) &&
+        stream->file_size) {
+        void *base = __fmap(stream->handle, stream->file_size);
+
+        if (base) {
+            __release_buffer(stream);
+            stream->buffer = base;
             stream->user_buffer = 0;
-        } else {
-            stream->user_buffer = 1;
+            stream->buffer_type = _IOFBF;
+            stream->buffer_size = stream->file_size;
+            stream->buffer_read = 0;
+            stream->buffer_pos = 0;
+            stream->flags |= __STDIO_FLAGS_MAPPED;
+            return;
         }
+    }
 
-        stream->buffer_type = mode;
-        stream->buffer_size = size;
-        stream->buffer_read = 0;
-        stream->buffer_pos = 0;
-    } else {
+    if (mode != _IOLBF && mode != _IOFBF) {
+        __release_buffer(stream);
+        stream->user_buffer = 0;
         stream->buffer_type = _IONBF;
+        return;
     }
 
-    if (stream->buffer && !user_buffer) {
-        free(stream->buffer);
+    /* Allocate the new buffer before releasing the old one, so that we still have something to
+     * use if we're out of memory. */
+    int user_buffer = 1;
+    if (!buffer) {
+        buffer = malloc(size);
+        if (!buffer) {
+            return;
+        }
+
+        user_buffer = 0;
     }
 
+    __release_buffer(stream);
     stream->buffer = buffer;
+    stream->user_buffer = user_buffer;
+    stream->buffer_type = mode;
+    stream->buffer_size = size;
+    stream->buffer_read = 0;
+    stream->buffer_pos = 0;
 }
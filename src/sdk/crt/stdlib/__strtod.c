@@ -0,0 +1,999 @@
+/* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <crt_impl.h>
+#include <ctype.h>
+#include <string.h>
+
+/* How many significant digits the slow path keeps around. Any halfway point between two doubles
+ * has at most 767 significant digits, so anything after that only matters as a sticky bit. Long
+ * double halfway points can have a lot more, so inputs too close to one of them get compared
+ * against its exact digits instead (see compare_halfway()). */
+#define MAX_DIGITS 768
+
+/* Limbs (base 10^9) needed for the exact digits of any halfway point; The longest one, between
+ * the two smallest long double subnormals, has 11515 significant digits. */
+#define HALFWAY_LIMBS 1280
+#define LIMB_BASE 1000000000
+
+/* Biggest shift the slow path can do at once without overflowing its 64-bit accumulator. */
+#define MAX_SHIFT 60
+
+typedef struct {
+    const char *integer;
+    const char *integer_end;
+    const char *fraction;
+    const char *fraction_end;
+    int64_t exponent;
+    uint64_t mantissa;
+    int64_t power;
+    int truncated;
+} number_t;
+
+typedef struct {
+    int count;
+    int truncated;
+    int64_t point;
+    uint8_t digits[MAX_DIGITS + 19];
+} decimal_t;
+
+static const uint64_t powers_of_five[28] = {
+    1ull,
+    5ull,
+    25ull,
+    125ull,
+    625ull,
+    3125ull,
+    15625ull,
+    78125ull,
+    390625ull,
+    1953125ull,
+    9765625ull,
+    48828125ull,
+    244140625ull,
+    1220703125ull,
+    6103515625ull,
+    30517578125ull,
+    152587890625ull,
+    762939453125ull,
+    3814697265625ull,
+    19073486328125ull,
+    95367431640625ull,
+    476837158203125ull,
+    2384185791015625ull,
+    11920928955078125ull,
+    59604644775390625ull,
+    298023223876953125ull,
+    1490116119384765625ull,
+    7450580596923828125ull,
+};
+
+/* Largest shift that keeps a value below 10^n under 1 (2^shift < 10^n). */
+static const uint8_t decimal_shifts[19] = {
+    0, 3, 6, 9, 13, 16, 19, 23, 26, 29, 33, 36, 39, 43, 46, 49, 53, 56, 59,
+};
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if all 8 characters loaded into a 64-bit integer are decimal digits.
+ *
+ * PARAMETERS:
+ *     chunk - Characters to check (loaded in little endian order).
+ *
+ * RETURN VALUE:
+ *     1 if they're all digits, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static inline int is_eight_digits(uint64_t chunk) {
+    return !(
+        ((chunk + 0x4646464646464646ull) | (chunk - 0x3030303030303030ull)) &
+        0x8080808080808080ull);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts 8 decimal digits loaded into a 64-bit integer into their value, by
+ *     combining pairs of digits, then pairs of pairs, and so on.
+ *
+ * PARAMETERS:
+ *     chunk - Digits to convert (loaded in little endian order).
+ *
+ * RETURN VALUE:
+ *     Value of the digits.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint32_t parse_eight_digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ull;
+    chunk = chunk * 10 + (chunk >> 8);
+    return (((chunk & 0x000000FF000000FFull) * 0x000F424000000064ull) +
+            (((chunk >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >>
+           32;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function accumulates a run of decimal digits into the mantissa. Anything past the
+ *     19th digit wraps around; The caller is expected to handle that.
+ *
+ * PARAMETERS:
+ *     str - Start of the digits.
+ *     mantissa - Input/output; Value we're accumulating into.
+ *
+ * RETURN VALUE:
+ *     Pointer to after the last digit.
+ *-----------------------------------------------------------------------------------------------*/
+static const char *parse_digits(const char *str, uint64_t *mantissa) {
+    uint64_t value = *mantissa;
+
+    /* We don't know where the string ends, so we can only load 8 characters at a time while
+     * they're all inside the same page (the next one might not be mapped). */
+    while (((uintptr_t)str & (__PAGE_SIZE - 1)) <= __PAGE_SIZE - 8) {
+        uint64_t chunk = *(const __unaligned_uint64_t *)str;
+        if (!is_eight_digits(chunk)) {
+            break;
+        }
+
+        value = value * 100000000 + parse_eight_digits(chunk);
+        str += 8;
+    }
+
+    while (*str >= '0' && *str <= '9') {
+        value = value * 10 + *(str++) - '0';
+    }
+
+    *mantissa = value;
+    return str;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function parses the exponent part (either decimal or binary) of a float.
+ *
+ * PARAMETERS:
+ *     str - Pointer to the exponent marker (`e` or `p`).
+ *     exponent - Output; Value of the exponent (clamped if it was too big).
+ *
+ * RETURN VALUE:
+ *     Pointer to after the exponent, or `str` if there were no digits after the marker.
+ *-----------------------------------------------------------------------------------------------*/
+static const char *parse_exponent(const char *str, int64_t *exponent) {
+    const char *start = str++;
+    int negative = *str == '-';
+
+    if (negative || *str == '+') {
+        str++;
+    }
+
+    if (*str < '0' || *str > '9') {
+        return start;
+    }
+
+    /* Anything this big already over/underflows any format we support. */
+    int64_t value = 0;
+    while (*str >= '0' && *str <= '9') {
+        if (value < 0x10000000) {
+            value = value * 10 + *str - '0';
+        }
+
+        str++;
+    }
+
+    *exponent = negative ? -value : value;
+    return str;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sets the value to (signed) zero.
+ *
+ * PARAMETERS:
+ *     value - Output; Value to set.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void make_zero(struct __float_value *value) {
+    value->mantissa = 0;
+    value->exponent = 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sets the value to (signed) infinity.
+ *
+ * PARAMETERS:
+ *     format - Format of the value.
+ *     value - Output; Value to set.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void make_infinity(const struct __float_format *format, struct __float_value *value) {
+    value->mantissa = 1ull << (format->mantissa_bits - 1);
+    value->exponent = format->max_exponent;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function rounds a binary value (to nearest, ties to even) into the given format,
+ *     handling subnormals, and overflow into infinity.
+ *
+ * PARAMETERS:
+ *     format - Format of the value.
+ *     upper - Top 128 bits of the value; The highest bit should be set.
+ *     sticky - Set if there was anything else after the top 128 bits.
+ *     exponent - Power of two of the highest bit.
+ *     value - Output; Rounded value.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void round_binary(
+    const struct __float_format *format,
+    unsigned __int128 upper,
+    int sticky,
+    int64_t exponent,
+    struct __float_value *value) {
+    int64_t biased = exponent + format->exponent_bias;
+    int64_t bits = biased >= 1 ? format->mantissa_bits : format->mantissa_bits - 1 + biased;
+
+    if (biased >= format->max_exponent) {
+        make_infinity(format, value);
+        return;
+    } else if (bits < 0) {
+        make_zero(value);
+        return;
+    }
+
+    /* Keep `bits` bits plus the rounding bit; Everything below that goes into the sticky bit. */
+    int shift = 127 - bits;
+    unsigned __int128 mantissa = upper >> shift;
+    int round = mantissa & 1;
+
+    sticky |= (upper & (((unsigned __int128)1 << shift) - 1)) != 0;
+    mantissa >>= 1;
+    if (round && (sticky || (mantissa & 1))) {
+        mantissa++;
+    }
+
+    if (biased >= 1) {
+        if (mantissa >> format->mantissa_bits) {
+            mantissa >>= 1;
+            biased++;
+        }
+
+        if (biased >= format->max_exponent) {
+            make_infinity(format, value);
+            return;
+        }
+    } else {
+        /* Subnormals can round up into the smallest normal value. */
+        biased = (mantissa >> (format->mantissa_bits - 1)) != 0;
+    }
+
+    value->mantissa = mantissa;
+    value->exponent = biased;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts `mantissa * 10^power` using the Eisel-Lemire algorithm: We multiply
+ *     the mantissa by a 128-bit approximation of 5^power, and use the top bits of the product,
+ *     unless they're too close to a rounding boundary for the approximation to be trusted.
+ *
+ * PARAMETERS:
+ *     format - Format of the value.
+ *     mantissa - Decimal mantissa; Should not be zero.
+ *     power - Decimal exponent; Should be inside the power of five table.
+ *     value - Output; Converted value.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the slow path needs to be used.
+ *-----------------------------------------------------------------------------------------------*/
+static int eisel_lemire(
+    const struct __float_format *format,
+    uint64_t mantissa,
+    int64_t power,
+    struct __float_value *value) {
+    const uint64_t *factor = __strtod_pow5[power - __STRTOD_POW5_MIN];
+    int shift = __builtin_clzll(mantissa);
+    uint64_t normalized = mantissa << shift;
+
+    unsigned __int128 high = (unsigned __int128)normalized * factor[0];
+    unsigned __int128 low = (unsigned __int128)normalized * factor[1];
+    unsigned __int128 upper = high + (uint64_t)(low >> 64);
+    uint64_t lower = low;
+    int exact = power >= 0 && power <= 55;
+
+    /* The table entries are truncated, so the real product is somewhere in
+     * [product, product + normalized). That can only change the top bits if the lower ones are all
+     * set, and adding `normalized` can carry out of them. */
+    uint64_t mask = (1ull << 62) - 1;
+    if (!exact && ((uint64_t)upper & mask) == mask && lower > -normalized) {
+        /* Exactly representable values below 1 (such as 0.5) always end up here, but they can
+         * be calculated exactly, as the mantissa needs to be divisible by 5^-power. */
+        if (power < 0 && power >= -27 && !(mantissa % powers_of_five[-power])) {
+            uint64_t quotient = mantissa / powers_of_five[-power];
+            shift = __builtin_clzll(quotient);
+            round_binary(
+                format,
+                (unsigned __int128)(quotient << shift) << 64,
+                0,
+                63 - shift + power,
+                value);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    /* 5^power = factor * 2^(floor(power * log2(10)) - power - 127), and 10^power is that times
+     * 2^power. */
+    int64_t exponent = ((power * 217706) >> 16) + 63 - shift;
+
+    if (upper >> 127) {
+        exponent++;
+    } else {
+        upper = (upper << 1) | (lower >> 63);
+        lower <<= 1;
+    }
+
+    round_binary(format, upper, !exact || lower, exponent, value);
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function appends a digit to the decimal, or just marks it as truncated if it's full.
+ *
+ * PARAMETERS:
+ *     decimal - Decimal to append to.
+ *     digit - Digit value.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void push_digit(decimal_t *decimal, int digit) {
+    if (decimal->count < MAX_DIGITS) {
+        decimal->digits[decimal->count++] = digit;
+    } else if (digit) {
+        decimal->truncated = 1;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes any trailing zeroes from the decimal.
+ *
+ * PARAMETERS:
+ *     decimal - Decimal to trim.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void trim_decimal(decimal_t *decimal) {
+    while (decimal->count && !decimal->digits[decimal->count - 1]) {
+        decimal->count--;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function divides the decimal by a power of two.
+ *
+ * PARAMETERS:
+ *     decimal - Decimal to divide.
+ *     shift - Power of two to divide by; Should be at most MAX_SHIFT.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void shift_right(decimal_t *decimal, int shift) {
+    uint64_t mask = (1ull << shift) - 1;
+    uint64_t accumulator = 0;
+    int read = 0;
+    int write = 0;
+
+    /* Skip the digits that would become leading zeroes. */
+    while (!(accumulator >> shift)) {
+        if (read < decimal->count) {
+            accumulator = accumulator * 10 + decimal->digits[read];
+        } else {
+            accumulator *= 10;
+        }
+
+        read++;
+    }
+
+    decimal->point -= read - 1;
+
+    while (read < decimal->count) {
+        uint8_t digit = accumulator >> shift;
+        accumulator = (accumulator & mask) * 10 + decimal->digits[read++];
+        decimal->digits[write++] = digit;
+    }
+
+    while (accumulator) {
+        uint8_t digit = accumulator >> shift;
+        accumulator = (accumulator & mask) * 10;
+
+        if (write < MAX_DIGITS) {
+            decimal->digits[write++] = digit;
+        } else if (digit) {
+            decimal->truncated = 1;
+        }
+    }
+
+    decimal->count = write;
+    trim_decimal(decimal);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function multiplies the decimal by a power of two.
+ *
+ * PARAMETERS:
+ *     decimal - Decimal to multiply.
+ *     shift - Power of two to multiply by; Should be at most MAX_SHIFT.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void shift_left(decimal_t *decimal, int shift) {
+    uint64_t accumulator = 0;
+    int read = decimal->count - 1;
+    int write = decimal->count + 18;
+
+    /* 2^MAX_SHIFT has 19 digits, so that's how many new digits we can get; Write everything
+     * offset by that, and move it back into place afterwards. */
+    while (read >= 0) {
+        accumulator += (uint64_t)decimal->digits[read--] << shift;
+        uint64_t quotient = accumulator / 10;
+        decimal->digits[write--] = accumulator - quotient * 10;
+        accumulator = quotient;
+    }
+
+    while (accumulator) {
+        uint64_t quotient = accumulator / 10;
+        decimal->digits[write--] = accumulator - quotient * 10;
+        accumulator = quotient;
+    }
+
+    int count = decimal->count + 18 - write;
+    memmove(decimal->digits, decimal->digits + write + 1, count);
+    decimal->point += count - decimal->count;
+
+    if (count > MAX_DIGITS) {
+        for (int i = MAX_DIGITS; i < count; i++) {
+            decimal->truncated |= decimal->digits[i] != 0;
+        }
+
+        count = MAX_DIGITS;
+    }
+
+    decimal->count = count;
+    trim_decimal(decimal);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts a decimal number, by repeatedly scaling all of its digits by powers
+ *     of two until we know its top 128 bits. This is a lot slower than eisel_lemire(), but it
+ *     works for any input, as long as it isn't too close to a halfway point.
+ *
+ * PARAMETERS:
+ *     format - Format of the value.
+ *     number - Parsed number.
+ *     value - Output; Converted value (or the lower of the two candidates).
+ *     next - Output; Upper candidate, if the value was too close to a halfway point.
+ *
+ * RETURN VALUE:
+ *     1 if the value is between the two candidates, and needs to go through compare_halfway(),
+ *     0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int convert_decimal(
+    const struct __float_format *format,
+    const number_t *number,
+    struct __float_value *value,
+    struct __float_value *next) {
+    const char *str = number->integer;
+    decimal_t decimal;
+
+    decimal.count = 0;
+    decimal.truncated = 0;
+    decimal.point = 0;
+
+    while (str < number->integer_end && *str == '0') {
+        str++;
+    }
+
+    while (str < number->integer_end) {
+        push_digit(&decimal, *(str++) - '0');
+        decimal.point++;
+    }
+
+    str = number->fraction;
+    if (!decimal.count) {
+        while (str < number->fraction_end && *str == '0') {
+            str++;
+            decimal.point--;
+        }
+    }
+
+    while (str < number->fraction_end) {
+        push_digit(&decimal, *(str++) - '0');
+    }
+
+    decimal.point += number->exponent;
+    trim_decimal(&decimal);
+
+    /* The value is somewhere in [10^(point - 1), 10^point). */
+    if (!decimal.count || decimal.point <= format->min_power + 18) {
+        make_zero(value);
+        return 0;
+    } else if (decimal.point >= format->max_power + 2) {
+        make_infinity(format, value);
+        return 0;
+    }
+
+    /* Bring the value into [0.5, 1). */
+    int64_t exponent = 0;
+
+    while (decimal.point > 0) {
+        int shift = decimal.point < 19 ? decimal_shifts[decimal.point] : MAX_SHIFT;
+        shift_right(&decimal, shift);
+        exponent += shift;
+    }
+
+    while (decimal.point < 0 || decimal.digits[0] < 5) {
+        int shift;
+
+        if (!decimal.point) {
+            shift = decimal.digits[0] < 2 ? 2 : 1;
+        } else {
+            shift = -decimal.point < 19 ? decimal_shifts[-decimal.point] : MAX_SHIFT;
+        }
+
+        shift_left(&decimal, shift);
+        exponent -= shift;
+    }
+
+    /* And now the integer part of value * 2^128 is exactly what round_binary() wants. */
+    shift_left(&decimal, MAX_SHIFT);
+    shift_left(&decimal, MAX_SHIFT);
+    shift_left(&decimal, 128 - 2 * MAX_SHIFT);
+
+    unsigned __int128 upper = 0;
+    for (int i = 0; i < decimal.point; i++) {
+        upper = upper * 10 + (i < decimal.count ? decimal.digits[i] : 0);
+    }
+
+    round_binary(
+        format, upper, decimal.truncated || decimal.count > decimal.point, exponent - 1, value);
+
+    /* The digits we dropped are worth a lot less than a single unit of `upper`, so the real value
+     * is above `upper`, but (barely) above upper + 1 at most; If both ends round the same way (with
+     * the sticky bit set), so does the value. */
+    if (!decimal.truncated) {
+        return 0;
+    }
+
+    /* upper + 1 can carry out of the top bit (and into the next power of two). */
+    int carry = !(upper + 1);
+    round_binary(
+        format,
+        carry ? (unsigned __int128)1 << 127 : upper + 1,
+        1,
+        exponent - 1 + carry,
+        next);
+
+    return next->mantissa != value->mantissa || next->exponent != value->exponent;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the next significant digit of a parsed number, skipping over the dot.
+ *
+ * PARAMETERS:
+ *     number - Parsed number.
+ *     str - Input/output; Current position inside the number.
+ *
+ * RETURN VALUE:
+ *     Value of the digit, or -1 if there are no more digits.
+ *-----------------------------------------------------------------------------------------------*/
+static inline int next_digit(const number_t *number, const char **str) {
+    if (*str == number->integer_end) {
+        *str = number->fraction;
+    }
+
+    return *str < number->fraction_end ? *((*str)++) - '0' : -1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function multiplies a big number (stored as base 10^9 limbs, lowest limb first) by a
+ *     small factor.
+ *
+ * PARAMETERS:
+ *     limbs - Input/output; Limbs of the number.
+ *     count - Input/output; How many limbs the number has.
+ *     factor - What to multiply by.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void multiply_limbs(uint32_t *limbs, int *count, uint32_t factor) {
+    uint64_t carry = 0;
+
+    for (int i = 0; i < *count; i++) {
+        uint64_t product = (uint64_t)limbs[i] * factor + carry;
+        limbs[i] = product % LIMB_BASE;
+        carry = product / LIMB_BASE;
+    }
+
+    while (carry) {
+        limbs[(*count)++] = carry % LIMB_BASE;
+        carry /= LIMB_BASE;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function compares a parsed number exactly against the halfway point between the given
+ *     value and the next one, by expanding the halfway point into all of its decimal digits.
+ *     This only happens for inputs with a lot of digits that land right next to a halfway
+ *     point, so it's kept out of line (to keep its big buffer out of the common path).
+ *
+ * PARAMETERS:
+ *     format - Format of the value.
+ *     number - Parsed number.
+ *     value - Value right below the halfway point.
+ *
+ * RETURN VALUE:
+ *     <0 if the number is below the halfway point, 0 if it's exactly on it, >0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+__attribute__((noinline)) static int compare_halfway(
+    const struct __float_format *format,
+    const number_t *number,
+    const struct __float_value *value) {
+    uint32_t limbs[HALFWAY_LIMBS];
+    uint64_t mantissa = value->mantissa;
+    int count = 0;
+
+    /* The halfway point is (2 * mantissa + 1) * 2^power, with 2^(power + 1) being the value of
+     * the lowest mantissa bit. */
+    int64_t power = (value->exponent ? value->exponent : 1) - format->exponent_bias -
+                    format->mantissa_bits;
+
+    do {
+        limbs[count++] = mantissa % LIMB_BASE;
+        mantissa /= LIMB_BASE;
+    } while (mantissa);
+
+    multiply_limbs(limbs, &count, 2);
+    limbs[0]++;
+
+    /* halfway * 2^-n is the same as (halfway * 5^n) * 10^-n, so either way, we only need to
+     * multiply (by 5^13 or 2^29 at a time, the biggest factors that fit in 32 bits). */
+    int step = power < 0 ? 13 : 29;
+    for (int64_t remaining = power < 0 ? -power : power; remaining > 0; remaining -= step) {
+        int amount = remaining < step ? remaining : step;
+        multiply_limbs(limbs, &count, power < 0 ? powers_of_five[amount] : 1u << amount);
+    }
+
+    /* Both sides are compared as 0.digits * 10^point, starting with the halfway point. */
+    uint32_t divisor = 1;
+    int64_t halfway_point = (int64_t)(count - 1) * 9 + 1 + (power < 0 ? power : 0);
+
+    while (divisor <= limbs[count - 1] / 10) {
+        divisor *= 10;
+        halfway_point++;
+    }
+
+    const char *str = number->integer;
+    int64_t point = number->exponent;
+
+    while (str < number->integer_end && *str == '0') {
+        str++;
+    }
+
+    point += number->integer_end - str;
+    if (str == number->integer_end) {
+        str = number->fraction;
+        while (str < number->fraction_end && *str == '0') {
+            str++;
+            point--;
+        }
+    }
+
+    if (point != halfway_point) {
+        return point < halfway_point ? -1 : 1;
+    }
+
+    for (int i = count - 1; i >= 0; i--) {
+        for (; divisor; divisor /= 10) {
+            int expected = limbs[i] / divisor % 10;
+            int digit = next_digit(number, &str);
+
+            if (digit != expected) {
+                return digit < expected ? -1 : 1;
+            }
+        }
+
+        divisor = LIMB_BASE / 10;
+    }
+
+    /* Past the end of the halfway point, any non-zero digit puts us above it. */
+    for (int digit; (digit = next_digit(number, &str)) >= 0;) {
+        if (digit) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function converts a parsed decimal number, trying the fast path first.
+ *
+ * PARAMETERS:
+ *     format - Format of the value.
+ *     number - Parsed number.
+ *     value - Output; Converted value.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void convert_number(
+    const struct __float_format *format,
+    const number_t *number,
+    struct __float_value *value) {
+    if (!number->mantissa || number->power < format->min_power) {
+        make_zero(value);
+        return;
+    } else if (number->power > format->max_power) {
+        make_infinity(format, value);
+        return;
+    }
+
+    if (number->power >= __STRTOD_POW5_MIN && number->power <= __STRTOD_POW5_MAX &&
+        eisel_lemire(format, number->mantissa, number->power, value)) {
+        if (!number->truncated) {
+            return;
+        }
+
+        /* With more than 19 digits, the real value is somewhere between mantissa and
+         * mantissa + 1; If both round the same way, so does everything in between. */
+        struct __float_value next;
+        if (eisel_lemire(format, number->mantissa + 1, number->power, &next) &&
+            next.mantissa == value->mantissa && next.exponent == value->exponent) {
+            return;
+        }
+    }
+
+    struct __float_value next;
+    if (convert_decimal(format, number, value, &next)) {
+        int order = compare_halfway(format, number, value);
+        if (order > 0 || (!order && (value->mantissa & 1))) {
+            value->mantissa = next.mantissa;
+            value->exponent = next.exponent;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function parses a decimal float, saving its first 19 significant digits, and where
+ *     the digits are (in case we need to go through the slow path).
+ *
+ * PARAMETERS:
+ *     str - String to be parsed; Should start with a digit or a dot followed by a digit.
+ *     number - Output; Parsed number.
+ *
+ * RETURN VALUE:
+ *     Pointer to after the last valid character.
+ *-----------------------------------------------------------------------------------------------*/
+static const char *parse_decimal(const char *str, number_t *number) {
+    uint64_t mantissa = 0;
+
+    number->integer = str;
+    str = parse_digits(str, &mantissa);
+    number->integer_end = str;
+    number->fraction = str;
+    number->fraction_end = str;
+
+    if (*str == '.') {
+        number->fraction = ++str;
+        str = parse_digits(str, &mantissa);
+        number->fraction_end = str;
+    }
+
+    number->exponent = 0;
+    if (*str == 'e' || *str == 'E') {
+        str = parse_exponent(str, &number->exponent);
+    }
+
+    number->mantissa = mantissa;
+    number->power = number->exponent - (number->fraction_end - number->fraction);
+    number->truncated = 0;
+
+    /* Leading zeroes don't count towards the 19 digits we can hold. */
+    int64_t digits = (number->integer_end - number->integer) +
+                     (number->fraction_end - number->fraction);
+    if (digits <= 19) {
+        return str;
+    }
+
+    for (const char *start = number->integer;
+         start < number->fraction_end && (*start == '0' || *start == '.');
+         start++) {
+        digits -= *start == '0';
+    }
+
+    if (digits <= 19) {
+        return str;
+    }
+
+    /* Otherwise, the accumulated mantissa overflowed, so grab only the first 19 digits. */
+    const char *digit = number->integer;
+    mantissa = 0;
+
+    while (mantissa < 1000000000000000000ull && digit < number->integer_end) {
+        mantissa = mantissa * 10 + *(digit++) - '0';
+    }
+
+    if (mantissa >= 1000000000000000000ull) {
+        number->power = number->exponent + (number->integer_end - digit);
+    } else {
+        digit = number->fraction;
+        while (mantissa < 1000000000000000000ull && digit < number->fraction_end) {
+            mantissa = mantissa * 10 + *(digit++) - '0';
+        }
+
+        number->power = number->exponent - (digit - number->fraction);
+    }
+
+    number->mantissa = mantissa;
+    number->truncated = 1;
+    return str;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function parses and converts a hexadecimal float. These are exact in binary, so we
+ *     just need to round them.
+ *
+ * PARAMETERS:
+ *     str - String to be parsed; Should already have skipped the `0x` prefix.
+ *     format - Format of the value.
+ *     value - Output; Converted value.
+ *
+ * RETURN VALUE:
+ *     Pointer to after the last valid character.
+ *-----------------------------------------------------------------------------------------------*/
+static const char *
+parse_hex(const char *str, const struct __float_format *format, struct __float_value *value) {
+    unsigned __int128 mantissa = 0;
+    int64_t exponent = 0;
+    int sticky = 0;
+    int dot = 0;
+
+    /* We combine handling the digits before and after the dot. */
+    while (isxdigit(*str) || (!dot && *str == '.')) {
+        int digit = *(str++);
+
+        if (digit == '.') {
+            dot = 1;
+            continue;
+        }
+
+        digit = digit <= '9' ? digit - '0' : (digit | 0x20) - 'a' + 10;
+
+        /* Past 124 bits, the digits only matter as a sticky bit. */
+        if (!(mantissa >> 124)) {
+            mantissa = (mantissa << 4) | digit;
+            exponent -= dot ? 4 : 0;
+        } else {
+            sticky |= digit != 0;
+            exponent += dot ? 0 : 4;
+        }
+    }
+
+    if (*str == 'p' || *str == 'P') {
+        int64_t power = 0;
+        str = parse_exponent(str, &power);
+        exponent += power;
+    }
+
+    if (!mantissa) {
+        make_zero(value);
+        return str;
+    }
+
+    uint64_t high = mantissa >> 64;
+    int shift = high ? __builtin_clzll(high) : 64 + __builtin_clzll((uint64_t)mantissa);
+    round_binary(format, mantissa << shift, sticky, exponent + 127 - shift, value);
+    return str;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the string starts with the given (lowercase) word, ignoring case.
+ *
+ * PARAMETERS:
+ *     str - String to check.
+ *     word - Word to compare against.
+ *
+ * RETURN VALUE:
+ *     1 if it does, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int match_word(const char *str, const char *word) {
+    while (*word) {
+        if ((*(str++) | 0x20) != *(word++)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the common code for strtof/strtod/strtold; It parses a float
+ *     (decimal, hexadecimal, infinity or NaN), and converts it into the given format, correctly
+ *     rounded.
+ *
+ * PARAMETERS:
+ *     str - String to be parsed.
+ *     format - Format of the value.
+ *     value - Output; Converted value (zero if the string wasn't a valid float).
+ *
+ * RETURN VALUE:
+ *     Pointer to after the last valid character, or `str` if the string wasn't a valid float.
+ *-----------------------------------------------------------------------------------------------*/
+const char *
+__strtod(const char *str, const struct __float_format *format, struct __float_value *value) {
+    const char *start = str;
+    while (isspace(*str)) {
+        str++;
+    }
+
+    value->negative = *str == '-';
+    if (value->negative || *str == '+') {
+        str++;
+    }
+
+    if (*str == '0' && (str[1] | 0x20) == 'x' &&
+        (isxdigit(str[2]) || (str[2] == '.' && isxdigit(str[3])))) {
+        return parse_hex(str + 2, format, value);
+    } else if ((*str >= '0' && *str <= '9') || (*str == '.' && str[1] >= '0' && str[1] <= '9')) {
+        number_t number;
+        str = parse_decimal(str, &number);
+        convert_number(format, &number, value);
+        return str;
+    } else if (match_word(str, "inf")) {
+        make_infinity(format, value);
+        return str + (match_word(str + 3, "inity") ? 8 : 3);
+    } else if (match_word(str, "nan")) {
+        value->mantissa = 3ull << (format->mantissa_bits - 2);
+        value->exponent = format->max_exponent;
+        str += 3;
+
+        /* NAN(n-char-sequence); We don't do anything with the sequence. */
+        if (*str == '(') {
+            const char *end = str + 1;
+            while (isalnum(*end) || *end == '_') {
+                end++;
+            }
+
+            if (*end == ')') {
+                str = end + 1;
+            }
+        }
+
+        return str;
+    }
+
+    value->negative = 0;
+    make_zero(value);
+    return start;
+}
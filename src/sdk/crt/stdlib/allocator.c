@@ -4,148 +4,293 @@
 #include <crt_impl.h>
 #include <string.h>
 
-typedef struct allocator_entry_t {
-    int used;
-    size_t size;
-    struct allocator_entry_t *prev, *next;
-} allocator_entry_t;
-
-static allocator_entry_t *head = NULL, *tail = NULL;
+/* Small allocations are rounded up into one of the size classes below, and carved out of spans
+ * (page runs) dedicated to a single class. The first classes are 16 bytes apart, and after
+ * SMALL_LINEAR_LIMIT, each power of two is split into 4 classes (so we waste at most 25%). */
+#define SMALL_LINEAR_LIMIT 128
+#define SMALL_LINEAR_CLASSES (SMALL_LINEAR_LIMIT / 16)
+#define SMALL_LINEAR_SHIFT 7
+#define SMALL_MAX_SHIFT 15
+#define SMALL_MAX_SIZE (1ull << SMALL_MAX_SHIFT)
+#define CLASS_COUNT (SMALL_LINEAR_CLASSES + (SMALL_MAX_SHIFT - SMALL_LINEAR_SHIFT) * 4)
+
+/* Spans for small classes have at least this many pages (and at least SPAN_MIN_OBJECTS objects);
+ * Anything bigger than SMALL_MAX_SIZE gets its own span. */
+#define SPAN_MIN_PAGES 16
+#define SPAN_MIN_OBJECTS 8
+#define SPAN_LARGE 0xFFFFFFFF
+
+/* The page map is a 3-level radix tree (12 bits per level), from page number (of a 48-bits
+ * address) into the span that owns the page. */
+#define PAGE_MAP_BITS 12
+#define PAGE_MAP_SIZE (1 << PAGE_MAP_BITS)
+#define PAGE_MAP_MASK (PAGE_MAP_SIZE - 1)
+#define PAGE_MAP_PAGES ((PAGE_MAP_SIZE * sizeof(void *)) >> __PAGE_SHIFT)
+
+typedef struct allocator_object_t {
+    struct allocator_object_t *next;
+} allocator_object_t;
+
+typedef struct allocator_span_t {
+    uint32_t size_class;
+    size_t pages;
+    struct allocator_span_t *next;
+} allocator_span_t;
+
+typedef struct {
+    allocator_object_t *free_list;
+    size_t free_count;
+} allocator_cache_t;
+
+static int lock = 0;
+static allocator_cache_t caches[CLASS_COUNT] = {};
+static allocator_span_t *free_spans = NULL;
+static char *metadata_base = NULL;
+static size_t metadata_left = 0;
+static void **page_map[PAGE_MAP_SIZE] = {};
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function splits a block of memory into two blocks, one of the required size for the
- *     allocation and one of the remaining size.
+ *     This function acquires the allocator lock. There is no thread support in the CRT yet, so
+ *     all threads share the same set of caches (instead of one set per thread).
  *
  * PARAMETERS:
- *     entry - The entry to split.
+ *     None.
  *
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-static void split_entry(allocator_entry_t *entry, size_t size) {
-    if (entry->size <= size + sizeof(allocator_entry_t)) {
-        return;
+static void acquire_lock(void) {
+    while (__atomic_exchange_n(&lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&lock, __ATOMIC_RELAXED)) {
+#ifdef ARCH_amd64
+            __asm__ volatile("pause");
+#endif /* ARCH_amd64 */
+        }
     }
-
-    allocator_entry_t *new_entry =
-        (allocator_entry_t *)((uintptr_t)entry + sizeof(allocator_entry_t) + size);
-
-    new_entry->used = 0;
-    new_entry->size = entry->size - (size + sizeof(allocator_entry_t));
-    new_entry->prev = entry;
-    new_entry->next = NULL;
-
-    tail = new_entry;
-
-    entry->size = size;
-    entry->next = new_entry;
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function merges all contiguous free entries after and including the base entry into
- *     one entry.
+ *     This function releases the allocator lock.
  *
  * PARAMETERS:
- *     base - The entry to start merging from.
+ *     None.
  *
  * RETURN VALUE:
  *     None.
  *-----------------------------------------------------------------------------------------------*/
-static void merge_forward(allocator_entry_t *base) {
-    while (base->next && base + (base->size << 12) == base->next && !base->next->used) {
-        base->size += base->next->size;
-        base->next = base->next->next;
+static void release_lock(void) {
+    __atomic_store_n(&lock, 0, __ATOMIC_RELEASE);
+}
 
-        if (base->next) {
-            base->next->prev = base;
-        }
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the size class for a small allocation.
+ *
+ * PARAMETERS:
+ *     size - Size of the allocation; Should be between 1 and SMALL_MAX_SIZE.
+ *
+ * RETURN VALUE:
+ *     Index of the size class.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t get_size_class(size_t size) {
+    if (size <= SMALL_LINEAR_LIMIT) {
+        return (size - 1) >> 4;
     }
 
-    if (!base->next) {
-        tail = base;
+    uint32_t shift = 63 - __builtin_clzll(size - 1);
+    uint32_t sub_class = ((size - 1) - (1ull << shift)) >> (shift - 2);
+    return SMALL_LINEAR_CLASSES + (shift - SMALL_LINEAR_SHIFT) * 4 + sub_class;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the object size for a given size class.
+ *
+ * PARAMETERS:
+ *     size_class - Index of the size class.
+ *
+ * RETURN VALUE:
+ *     Size of each object in the class.
+ *-----------------------------------------------------------------------------------------------*/
+static size_t get_class_size(uint32_t size_class) {
+    if (size_class < SMALL_LINEAR_CLASSES) {
+        return (size_class + 1) << 4;
     }
+
+    uint32_t shift = SMALL_LINEAR_SHIFT + (size_class - SMALL_LINEAR_CLASSES) / 4;
+    uint32_t sub_class = (size_class - SMALL_LINEAR_CLASSES) % 4;
+    return (1ull << shift) + ((sub_class + 1ull) << (shift - 2));
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function merges all contiguous free entries before and including the base entry into
- *     one entry.
+ *     This function grabs some memory for the allocator's own structures (span descriptors and
+ *     page map levels). This memory is never given back.
  *
  * PARAMETERS:
- *     base - The entry to start merging from.
+ *     size - How many bytes we need; Should be a multiple of 16.
  *
  * RETURN VALUE:
- *     None.
+ *     Pointer to the allocated memory, or NULL if we're out of memory.
  *-----------------------------------------------------------------------------------------------*/
-static void merge_backward(allocator_entry_t *base) {
-    while (base->prev && base->prev + (base->prev->size << 12) == base && !base->prev->used) {
-        base->prev->size += base->size;
-        base->prev->next = base->next;
+static void *allocate_metadata(size_t size) {
+    if (size >= __PAGE_SIZE) {
+        void *base = __allocate_pages((size + __PAGE_SIZE - 1) >> __PAGE_SHIFT);
+        if (base) {
+            memset(base, 0, size);
+        }
 
-        if (base->next) {
-            base->next->prev = base->prev;
+        return base;
+    }
+
+    if (metadata_left < size) {
+        metadata_base = __allocate_pages(SPAN_MIN_PAGES);
+        if (!metadata_base) {
+            metadata_left = 0;
+            return NULL;
         }
 
-        base = base->prev;
+        metadata_left = SPAN_MIN_PAGES << __PAGE_SHIFT;
     }
 
-    if (!base->prev) {
-        head = base;
+    void *base = metadata_base;
+    metadata_base += size;
+    metadata_left -= size;
+    memset(base, 0, size);
+    return base;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets a pointer into the page map entry for the given page, optionally
+ *     allocating any missing levels.
+ *
+ * PARAMETERS:
+ *     page - Page number.
+ *     create - Set this to 1 if we should allocate any missing levels.
+ *
+ * RETURN VALUE:
+ *     Pointer to the entry, or NULL if it doesn't exist (and we couldn't/shouldn't create it).
+ *-----------------------------------------------------------------------------------------------*/
+static void **get_page_map_entry(uintptr_t page, int create) {
+    void ***middle = (void ***)&page_map[(page >> (2 * PAGE_MAP_BITS)) & PAGE_MAP_MASK];
+    if (!*middle) {
+        if (!create || !(*middle = allocate_metadata(PAGE_MAP_PAGES << __PAGE_SHIFT))) {
+            return NULL;
+        }
     }
 
-    if (!base->next) {
-        tail = base;
+    void ***leaf = (void ***)&(*middle)[(page >> PAGE_MAP_BITS) & PAGE_MAP_MASK];
+    if (!*leaf) {
+        if (!create || !(*leaf = allocate_metadata(PAGE_MAP_PAGES << __PAGE_SHIFT))) {
+            return NULL;
+        }
     }
+
+    return &(*leaf)[page & PAGE_MAP_MASK];
 }
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function finds a free entry of the specified size, or creates requests a page
- *     and uses it to create a new entry.
+ *     This function finds the span that owns the given address.
  *
  * PARAMETERS:
- *     size - The size of the entry to find or create.
+ *     ptr - Address to look up.
  *
  * RETURN VALUE:
- *     A pointer to the allocated entry, or NULL if there is no more free regions in the memory
- *     map.
+ *     Span descriptor, or NULL if the address wasn't allocated by us.
  *-----------------------------------------------------------------------------------------------*/
-static allocator_entry_t *find_free(size_t size) {
-    allocator_entry_t *entry = head;
-    size_t mask = __PAGE_SIZE - 1;
-
-    while (entry) {
-        if (!entry->used && entry->size >= size) {
-            entry->used = 1;
-            return entry;
-        }
+static allocator_span_t *find_span(void *ptr) {
+    void **entry = get_page_map_entry((uintptr_t)ptr >> __PAGE_SHIFT, 0);
+    return entry ? *entry : NULL;
+}
 
-        entry = entry->next;
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates a new span (page run), and registers it in the page map.
+ *
+ * PARAMETERS:
+ *     pages - Size of the span in pages.
+ *     size_class - Which size class the span will hold, or SPAN_LARGE for a large allocation.
+ *
+ * RETURN VALUE:
+ *     Start of the span, or NULL if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+static char *allocate_span(size_t pages, uint32_t size_class) {
+    allocator_span_t *span = free_spans;
+    if (span) {
+        free_spans = span->next;
+    } else if (!(span = allocate_metadata(sizeof(allocator_span_t)))) {
+        return NULL;
     }
 
-    entry = __allocate_pages((size + sizeof(allocator_entry_t) + mask) >> __PAGE_SHIFT);
-    if (!entry) {
+    char *base = __allocate_pages(pages);
+    if (!base) {
+        span->next = free_spans;
+        free_spans = span;
         return NULL;
     }
 
-    size = ((size + sizeof(allocator_entry_t) + mask) & ~mask) - sizeof(allocator_entry_t);
+    /* Large spans are only ever looked up using their base address, so we only need to register
+     * the first page for them. */
+    uintptr_t first_page = (uintptr_t)base >> __PAGE_SHIFT;
+    size_t mapped_pages = size_class == SPAN_LARGE ? 1 : pages;
+    for (size_t i = 0; i < mapped_pages; i++) {
+        void **entry = get_page_map_entry(first_page + i, 1);
+        if (!entry) {
+            while (i--) {
+                *get_page_map_entry(first_page + i, 0) = NULL;
+            }
+
+            __free_pages(base, pages);
+            span->next = free_spans;
+            free_spans = span;
+            return NULL;
+        }
 
-    entry->used = 1;
-    entry->size = size;
-    entry->prev = tail;
-    entry->next = NULL;
+        *entry = span;
+    }
 
-    if (tail) {
-        tail->next = entry;
-    } else {
-        head = entry;
+    span->size_class = size_class;
+    span->pages = pages;
+    return base;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function refills the cache of the given size class with a new span.
+ *
+ * PARAMETERS:
+ *     size_class - Which size class to refill.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+static int refill_cache(uint32_t size_class) {
+    size_t size = get_class_size(size_class);
+    size_t pages = (size * SPAN_MIN_OBJECTS + __PAGE_SIZE - 1) >> __PAGE_SHIFT;
+    if (pages < SPAN_MIN_PAGES) {
+        pages = SPAN_MIN_PAGES;
     }
 
-    tail = entry;
+    char *base = allocate_span(pages, size_class);
+    if (!base) {
+        return 0;
+    }
+
+    /* Thread the objects in address order, so that consecutive allocations are adjacent. */
+    allocator_cache_t *cache = &caches[size_class];
+    size_t count = (pages << __PAGE_SHIFT) / size;
+    for (size_t i = count; i--;) {
+        allocator_object_t *object = (allocator_object_t *)(base + i * size);
+        object->next = cache->free_list;
+        cache->free_list = object;
+    }
 
-    return entry;
+    cache->free_count += count;
+    return 1;
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -156,19 +301,42 @@ static allocator_entry_t *find_free(size_t size) {
  *     size - The size of the block to allocate.
  *
  * RETURN VALUE:
- *     A pointer to the allocated block, or NULL if there is was no free entry and requesting
- *     a new page failed.
+ *     A pointer to the allocated block (aligned to at least 16 bytes), or NULL if we're out of
+ *     memory.
  *-----------------------------------------------------------------------------------------------*/
 void *malloc(size_t size) {
-    size = (size + 15) & ~0x0F;
-    allocator_entry_t *entry = find_free(size);
+    if (!size) {
+        size = 1;
+    }
+
+    /* Large allocations go straight into their own page run. */
+    if (size > SMALL_MAX_SIZE) {
+        if (size > SIZE_MAX - __PAGE_SIZE) {
+            return NULL;
+        }
+
+        acquire_lock();
+        void *base = allocate_span((size + __PAGE_SIZE - 1) >> __PAGE_SHIFT, SPAN_LARGE);
+        release_lock();
+        return base;
+    }
+
+    uint32_t size_class = get_size_class(size);
+    allocator_cache_t *cache = &caches[size_class];
 
-    if (entry) {
-        split_entry(entry, size);
-        return entry + 1;
+    acquire_lock();
+
+    if (!cache->free_list && !refill_cache(size_class)) {
+        release_lock();
+        return NULL;
     }
 
-    return NULL;
+    allocator_object_t *object = cache->free_list;
+    cache->free_list = object->next;
+    cache->free_count--;
+
+    release_lock();
+    return object;
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -181,10 +349,13 @@ void *malloc(size_t size) {
  *     size - The size of each element.
  *
  * RETURN VALUE:
- *     A pointer to the allocated block, or NULL if there is was no free entry and requesting
- *     a new page failed.
+ *     A pointer to the allocated block, or NULL if the size overflows or we're out of memory.
  *-----------------------------------------------------------------------------------------------*/
 void *calloc(size_t num, size_t size) {
+    if (size && num > SIZE_MAX / size) {
+        return NULL;
+    }
+
     size *= num;
     void *base = malloc(size);
 
@@ -206,8 +377,35 @@ void *calloc(size_t num, size_t size) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void free(void *ptr) {
-    allocator_entry_t *entry = (allocator_entry_t *)ptr - 1;
-    entry->used = 0;
-    merge_forward(entry);
-    merge_backward(entry);
+    if (!ptr) {
+        return;
+    }
+
+    acquire_lock();
+
+    allocator_span_t *span = find_span(ptr);
+    if (!span) {
+        release_lock();
+        return;
+    }
+
+    /* Large allocations go straight back to the OS. */
+    if (span->size_class == SPAN_LARGE) {
+        /* The span header can be reused by someone else as soon as we release the lock. */
+        size_t pages = span->pages;
+        *get_page_map_entry((uintptr_t)ptr >> __PAGE_SHIFT, 0) = NULL;
+        span->next = free_spans;
+        free_spans = span;
+        release_lock();
+        __free_pages(ptr, pages);
+        return;
+    }
+
+    allocator_cache_t *cache = &caches[span->size_class];
+    allocator_object_t *object = ptr;
+    object->next = cache->free_list;
+    cache->free_list = object;
+    cache->free_count++;
+
+    release_lock();
 }
@@ -1,11 +1,22 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include <crt_impl.h>
 #include <stdlib.h>
 
+/* IEEE binary32. */
+static const struct __float_format format = {
+    .mantissa_bits = 24,
+    .exponent_bias = 127,
+    .max_exponent = 255,
+    .min_power = -64,
+    .max_power = 38,
+};
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
- *     This function parses a float from a string.
+ *     This function parses a float from a string. This rounds the decimal value directly into a
+ *     float (instead of going through a double, which could round twice).
  *
  * PARAMETERS:
  *     str - String to be parsed.
@@ -15,5 +26,19 @@
  *     Result of the parsing if the string was a valid float, 0.0 otherwise.
  *-----------------------------------------------------------------------------------------------*/
 float strtof(const char *str, char **str_end) {
-    return (float)strtod(str, str_end);
+    struct __float_value value;
+    const char *end = __strtod(str, &format, &value);
+
+    if (str_end) {
+        *str_end = (char *)end;
+    }
+
+    union {
+        float value;
+        uint32_t bits;
+    } result;
+
+    result.bits = ((uint32_t)value.negative << 31) | ((uint32_t)value.exponent << 23) |
+                  (value.mantissa & ((1u << 23) - 1));
+    return result.value;
 }
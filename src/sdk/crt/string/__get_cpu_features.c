@@ -0,0 +1,63 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <cpuid.h>
+#endif /* ARCH_amd64 */
+
+static int features = -1;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function detects which of the CPU features the string routines care about are
+ *     available. The result is cached after the first call.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Bitmask of __CPU_FEATURE_* values.
+ *-----------------------------------------------------------------------------------------------*/
+int __get_cpu_features(void) {
+    int Features = __atomic_load_n(&features, __ATOMIC_RELAXED);
+    if (Features >= 0) {
+        return Features;
+    }
+
+    Features = 0;
+
+#ifdef ARCH_amd64
+    uint32_t Eax, Ebx, Ecx, Edx;
+    __cpuid(0, Eax, Ebx, Ecx, Edx);
+
+    if (Eax >= 7) {
+        __cpuid_count(7, 0, Eax, Ebx, Ecx, Edx);
+        uint32_t ExtendedFeatures = Ebx;
+
+        if (ExtendedFeatures & 0x200) {
+            Features |= __CPU_FEATURE_ERMS;
+        }
+
+        if (Edx & 0x10) {
+            Features |= __CPU_FEATURE_FSRM;
+        }
+
+        /* AVX2 also needs the OS to be saving the YMM state for us (OSXSAVE, and both the SSE
+         * and AVX bits set in XCR0). */
+        __cpuid(1, Eax, Ebx, Ecx, Edx);
+        if ((ExtendedFeatures & 0x20) && (Ecx & 0x18000000) == 0x18000000) {
+            uint32_t LowPart;
+            uint32_t HighPart;
+            __asm__ volatile("xgetbv" : "=a"(LowPart), "=d"(HighPart) : "c"(0));
+            if ((LowPart & 0x06) == 0x06) {
+                Features |= __CPU_FEATURE_AVX2;
+            }
+        }
+    }
+#endif /* ARCH_amd64 */
+
+    __atomic_store_n(&features, Features, __ATOMIC_RELAXED);
+    return Features;
+}
@@ -1,7 +1,11 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <stddef.h>
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#endif /* ARCH_amd64 */
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -16,12 +20,41 @@
  *     Pointer to where the byte was found, or NULL if it wasn't found.
  *-----------------------------------------------------------------------------------------------*/
 void *memchr(const void *ptr, int ch, size_t count) {
-    const char *Buffer = ptr;
+    const unsigned char *Buffer = ptr;
+
+    if (!count) {
+        return NULL;
+    }
+
+#ifdef ARCH_amd64
+    /* Aligned loads never cross into the next page, so reading a bit before/past the buffer is
+     * safe; We just ignore any matches out there. */
+    __m128i Pattern = _mm_set1_epi8(ch);
+    size_t Misalignment = (uintptr_t)Buffer & 15;
+    const unsigned char *Block = Buffer - Misalignment;
+    uint32_t Mask =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)Block), Pattern)) >>
+        Misalignment;
+    size_t Offset = 0;
+
+    while (!Mask) {
+        Offset = Block + 16 - Buffer;
+        if (Offset >= count) {
+            return NULL;
+        }
+
+        Block += 16;
+        Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)Block), Pattern));
+    }
 
-    while (*Buffer != ch && count) {
+    Offset += __builtin_ctz(Mask);
+    return Offset < count ? (void *)(Buffer + Offset) : NULL;
+#else
+    while (count && *Buffer != (unsigned char)ch) {
         Buffer++;
         count--;
     }
 
     return count ? (void *)Buffer : NULL;
+#endif /* ARCH_amd64 */
 }
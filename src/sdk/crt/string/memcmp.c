@@ -1,7 +1,11 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <stddef.h>
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#endif /* ARCH_amd64 */
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -14,11 +18,48 @@
  *
  * RETURN VALUE:
  *     0 for equality, *lhs - *rhs if an inequality is found (where `lhs` and `rhs` are both
- *     reinterpreted as char*, and are pointing to where the inequality happened).
+ *     reinterpreted as unsigned char*, and are pointing to where the inequality happened).
  *-----------------------------------------------------------------------------------------------*/
 int memcmp(const void *lhs, const void *rhs, size_t count) {
-    const char *Left = lhs;
-    const char *Right = rhs;
+    const unsigned char *Left = lhs;
+    const unsigned char *Right = rhs;
+
+#ifdef ARCH_amd64
+    if (count >= 16) {
+        /* Compare 16 bytes at a time, with the last block overlapping the previous one. */
+        size_t Offset = 0;
+        while (1) {
+            __m128i LeftBlock = _mm_loadu_si128((const __m128i *)(Left + Offset));
+            __m128i RightBlock = _mm_loadu_si128((const __m128i *)(Right + Offset));
+            uint32_t Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(LeftBlock, RightBlock));
+            if (Mask != 0xFFFF) {
+                Offset += __builtin_ctz(~Mask);
+                return Left[Offset] - Right[Offset];
+            } else if (Offset + 16 == count) {
+                return 0;
+            }
+
+            Offset = Offset + 32 <= count ? Offset + 16 : count - 16;
+        }
+    } else if (count >= 8) {
+        /* The first differing byte is the lowest differing bit (we're little endian). */
+        size_t Offset = 0;
+        uint64_t Difference =
+            *(const __unaligned_uint64_t *)Left ^ *(const __unaligned_uint64_t *)Right;
+        if (!Difference) {
+            Offset = count - 8;
+            Difference = *(const __unaligned_uint64_t *)(Left + Offset) ^
+                         *(const __unaligned_uint64_t *)(Right + Offset);
+        }
+
+        if (!Difference) {
+            return 0;
+        }
+
+        Offset += __builtin_ctzll(Difference) >> 3;
+        return Left[Offset] - Right[Offset];
+    }
+#endif /* ARCH_amd64 */
 
     while (count--) {
         if (*Left != *Right) {
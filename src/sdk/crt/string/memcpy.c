@@ -1,11 +1,239 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <stddef.h>
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#ifdef _DLL
+#include <immintrin.h>
+#endif /* _DLL */
+
+static void *resolve(void *dest, const void *src, size_t count);
+
+static void *(*implementation)(void *, const void *, size_t) = resolve;
+static size_t rep_threshold = SIZE_MAX;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function copies up to __SMALL_COPY_SIZE bytes. Everything is loaded before we store
+ *     anything, so overlapping buffers are fine (in either direction).
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     src - Source buffer.
+ *     count - How many bytes to copy.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void copy_small(char *dest, const char *src, size_t count) {
+    if (count >= 32) {
+        __m128i First = _mm_loadu_si128((const __m128i *)src);
+        __m128i Second = _mm_loadu_si128((const __m128i *)(src + 16));
+        __m128i ThirdLast = _mm_loadu_si128((const __m128i *)(src + count - 32));
+        __m128i Last = _mm_loadu_si128((const __m128i *)(src + count - 16));
+        _mm_storeu_si128((__m128i *)dest, First);
+        _mm_storeu_si128((__m128i *)(dest + 16), Second);
+        _mm_storeu_si128((__m128i *)(dest + count - 32), ThirdLast);
+        _mm_storeu_si128((__m128i *)(dest + count - 16), Last);
+    } else if (count >= 16) {
+        __m128i First = _mm_loadu_si128((const __m128i *)src);
+        __m128i Last = _mm_loadu_si128((const __m128i *)(src + count - 16));
+        _mm_storeu_si128((__m128i *)dest, First);
+        _mm_storeu_si128((__m128i *)(dest + count - 16), Last);
+    } else if (count >= 8) {
+        uint64_t First = *(const __unaligned_uint64_t *)src;
+        uint64_t Last = *(const __unaligned_uint64_t *)(src + count - 8);
+        *(__unaligned_uint64_t *)dest = First;
+        *(__unaligned_uint64_t *)(dest + count - 8) = Last;
+    } else if (count >= 4) {
+        uint32_t First = *(const __unaligned_uint32_t *)src;
+        uint32_t Last = *(const __unaligned_uint32_t *)(src + count - 4);
+        *(__unaligned_uint32_t *)dest = First;
+        *(__unaligned_uint32_t *)(dest + count - 4) = Last;
+    } else if (count >= 2) {
+        uint16_t First = *(const __unaligned_uint16_t *)src;
+        uint16_t Last = *(const __unaligned_uint16_t *)(src + count - 2);
+        *(__unaligned_uint16_t *)dest = First;
+        *(__unaligned_uint16_t *)(dest + count - 2) = Last;
+    } else if (count) {
+        *dest = *src;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function copies the given buffer using REP MOVSB.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     src - Source buffer.
+ *     count - How many bytes to copy.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void copy_rep(void *dest, const void *src, size_t count) {
+    __asm__ volatile("cld; rep movsb"
+                     : "=D"(dest), "=S"(src), "=c"(count)
+                     : "0"(dest), "1"(src), "2"(count)
+                     : "flags", "memory");
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the SSE2 copy for anything bigger than __SMALL_COPY_SIZE. The
+ *     head and tail are loaded upfront and stored last (unaligned), while the loop in the middle
+ *     always stores to aligned addresses.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     src - Source buffer.
+ *     count - How many bytes to copy.
+ *
+ * RETURN VALUE:
+ *     Start of the destination buffer.
+ *-----------------------------------------------------------------------------------------------*/
+static void *copy_sse2(void *dest, const void *src, size_t count) {
+    char *Destination = dest;
+    const char *Source = src;
+
+    if (count <= __SMALL_COPY_SIZE) {
+        copy_small(Destination, Source, count);
+        return dest;
+    } else if (count >= rep_threshold && count < __NON_TEMPORAL_THRESHOLD) {
+        copy_rep(dest, src, count);
+        return dest;
+    }
+
+    __m128i Head = _mm_loadu_si128((const __m128i *)Source);
+    __m128i Tail = _mm_loadu_si128((const __m128i *)(Source + count - 16));
+    size_t Offset = 16 - ((uintptr_t)Destination & 15);
+    size_t End = count - 16;
+
+    if (count >= __NON_TEMPORAL_THRESHOLD) {
+        for (; Offset + 64 <= End; Offset += 64) {
+            __m128i A = _mm_loadu_si128((const __m128i *)(Source + Offset));
+            __m128i B = _mm_loadu_si128((const __m128i *)(Source + Offset + 16));
+            __m128i C = _mm_loadu_si128((const __m128i *)(Source + Offset + 32));
+            __m128i D = _mm_loadu_si128((const __m128i *)(Source + Offset + 48));
+            _mm_stream_si128((__m128i *)(Destination + Offset), A);
+            _mm_stream_si128((__m128i *)(Destination + Offset + 16), B);
+            _mm_stream_si128((__m128i *)(Destination + Offset + 32), C);
+            _mm_stream_si128((__m128i *)(Destination + Offset + 48), D);
+        }
+
+        _mm_sfence();
+    }
+
+    for (; Offset < End; Offset += 16) {
+        _mm_store_si128(
+            (__m128i *)(Destination + Offset),
+            _mm_loadu_si128((const __m128i *)(Source + Offset)));
+    }
+
+    _mm_storeu_si128((__m128i *)Destination, Head);
+    _mm_storeu_si128((__m128i *)(Destination + count - 16), Tail);
+    return dest;
+}
+
+#ifdef _DLL
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the AVX2 version of copy_sse2().
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     src - Source buffer.
+ *     count - How many bytes to copy.
+ *
+ * RETURN VALUE:
+ *     Start of the destination buffer.
+ *-----------------------------------------------------------------------------------------------*/
+__attribute__((target("avx2"))) static void *copy_avx2(void *dest, const void *src, size_t count) {
+    char *Destination = dest;
+    const char *Source = src;
+
+    if (count <= __SMALL_COPY_SIZE) {
+        copy_small(Destination, Source, count);
+        return dest;
+    } else if (count >= rep_threshold && count < __NON_TEMPORAL_THRESHOLD) {
+        copy_rep(dest, src, count);
+        return dest;
+    }
+
+    __m256i Head = _mm256_loadu_si256((const __m256i *)Source);
+    __m256i Tail = _mm256_loadu_si256((const __m256i *)(Source + count - 32));
+    size_t Offset = 32 - ((uintptr_t)Destination & 31);
+    size_t End = count - 32;
+
+    if (count >= __NON_TEMPORAL_THRESHOLD) {
+        for (; Offset + 128 <= End; Offset += 128) {
+            __m256i A = _mm256_loadu_si256((const __m256i *)(Source + Offset));
+            __m256i B = _mm256_loadu_si256((const __m256i *)(Source + Offset + 32));
+            __m256i C = _mm256_loadu_si256((const __m256i *)(Source + Offset + 64));
+            __m256i D = _mm256_loadu_si256((const __m256i *)(Source + Offset + 96));
+            _mm256_stream_si256((__m256i *)(Destination + Offset), A);
+            _mm256_stream_si256((__m256i *)(Destination + Offset + 32), B);
+            _mm256_stream_si256((__m256i *)(Destination + Offset + 64), C);
+            _mm256_stream_si256((__m256i *)(Destination + Offset + 96), D);
+        }
+
+        _mm_sfence();
+    }
+
+    for (; Offset < End; Offset += 32) {
+        _mm256_store_si256(
+            (__m256i *)(Destination + Offset),
+            _mm256_loadu_si256((const __m256i *)(Source + Offset)));
+    }
+
+    _mm256_storeu_si256((__m256i *)Destination, Head);
+    _mm256_storeu_si256((__m256i *)(Destination + count - 32), Tail);
+    return dest;
+}
+#endif /* _DLL */
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function picks the best copy routine for the current processor on the first call,
+ *     and forwards the call to it.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     src - Source buffer.
+ *     count - How many bytes to copy.
+ *
+ * RETURN VALUE:
+ *     Start of the destination buffer.
+ *-----------------------------------------------------------------------------------------------*/
+static void *resolve(void *dest, const void *src, size_t count) {
+    int Features = __get_cpu_features();
+    void *(*Implementation)(void *, const void *, size_t) = copy_sse2;
+
+    if (Features & __CPU_FEATURE_FSRM) {
+        rep_threshold = __REP_THRESHOLD_FSRM;
+    } else if (Features & __CPU_FEATURE_ERMS) {
+        rep_threshold = __REP_THRESHOLD_ERMS;
+    }
+
+#ifdef _DLL
+    if (Features & __CPU_FEATURE_AVX2) {
+        Implementation = copy_avx2;
+    }
+#endif /* _DLL */
+
+    __atomic_store_n(&implementation, Implementation, __ATOMIC_RELEASE);
+    return Implementation(dest, src, count);
+}
+#endif /* ARCH_amd64 */
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function implements generic code to copy bytes from one region of memory to another.
+ *     Copies of up to __SMALL_COPY_SIZE bytes (and any copy where `dest` comes before `src`) are
+ *     safe to use on overlapping buffers; memmove() relies on this.
  *
  * PARAMETERS:
  *     dest - Destination buffer.
@@ -17,12 +245,7 @@
  *-----------------------------------------------------------------------------------------------*/
 void *memcpy(void *dest, const void *src, size_t count) {
 #ifdef ARCH_amd64
-    void *res = dest;
-    __asm__ volatile("cld; rep movsb"
-                     : "=D"(dest), "=S"(src), "=c"(count)
-                     : "0"(dest), "1"(src), "c"(count)
-                     : "flags", "memory");
-    return res;
+    return __atomic_load_n(&implementation, __ATOMIC_ACQUIRE)(dest, src, count);
 #else
     char *Destination = dest;
     const char *Source = src;
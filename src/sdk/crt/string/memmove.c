@@ -1,8 +1,42 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include <crt_impl.h>
 #include <string.h>
 
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the SSE2 backwards copy for overlapping buffers bigger than
+ *     __SMALL_COPY_SIZE. The head and tail are loaded upfront and stored last (unaligned), while
+ *     the loop in the middle always stores to aligned addresses.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     src - Source buffer.
+ *     count - How many bytes to copy.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void copy_backwards(char *dest, const char *src, size_t count) {
+    __m128i Head = _mm_loadu_si128((const __m128i *)src);
+    __m128i Tail = _mm_loadu_si128((const __m128i *)(src + count - 16));
+    size_t Offset = count - ((uintptr_t)(dest + count) & 15);
+
+    while (Offset > 16) {
+        Offset -= 16;
+        __m128i Value = _mm_loadu_si128((const __m128i *)(src + Offset));
+        _mm_store_si128((__m128i *)(dest + Offset), Value);
+    }
+
+    _mm_storeu_si128((__m128i *)(dest + count - 16), Tail);
+    _mm_storeu_si128((__m128i *)dest, Head);
+}
+#endif /* ARCH_amd64 */
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function implements generic code to safely copy bytes from one region of memory to
@@ -27,17 +61,25 @@ void *memmove(void *dest, const void *src, size_t count) {
         Non overlapping can use just a memcpy, and overlapping like this NEEDS to use it:
         <dest--->
            <src---->
-        so we just call memcpy for both. */
+        so we just call memcpy for both (small copies are also overlap-safe in memcpy). */
     if (Source >= Destination || Source + count <= Destination) {
         return memcpy(dest, src, count);
     }
 
+#ifdef ARCH_amd64
+    if (count <= __SMALL_COPY_SIZE) {
+        return memcpy(dest, src, count);
+    }
+
+    copy_backwards(Destination, Source, count);
+#else
     Destination += count;
     Source += count;
 
     while (count--) {
         *(--Destination) = *(--Source);
     }
+#endif /* ARCH_amd64 */
 
     return dest;
 }
@@ -1,7 +1,207 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <stddef.h>
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#ifdef _DLL
+#include <immintrin.h>
+#endif /* _DLL */
+
+static void *resolve(void *dest, int ch, size_t count);
+
+static void *(*implementation)(void *, int, size_t) = resolve;
+static size_t rep_threshold = SIZE_MAX;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function fills up to __SMALL_COPY_SIZE bytes, using a few (overlapping) stores.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     ch - Byte to be used as pattern.
+ *     count - Size of the destination buffer.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void fill_small(char *dest, int ch, size_t count) {
+    uint64_t Pattern = (uint8_t)ch * 0x0101010101010101ull;
+
+    if (count >= 16) {
+        __m128i Value = _mm_set1_epi8(ch);
+        _mm_storeu_si128((__m128i *)dest, Value);
+        _mm_storeu_si128((__m128i *)(dest + count - 16), Value);
+        if (count > 32) {
+            _mm_storeu_si128((__m128i *)(dest + 16), Value);
+            _mm_storeu_si128((__m128i *)(dest + count - 32), Value);
+        }
+    } else if (count >= 8) {
+        *(__unaligned_uint64_t *)dest = Pattern;
+        *(__unaligned_uint64_t *)(dest + count - 8) = Pattern;
+    } else if (count >= 4) {
+        *(__unaligned_uint32_t *)dest = Pattern;
+        *(__unaligned_uint32_t *)(dest + count - 4) = Pattern;
+    } else if (count >= 2) {
+        *(__unaligned_uint16_t *)dest = Pattern;
+        *(__unaligned_uint16_t *)(dest + count - 2) = Pattern;
+    } else if (count) {
+        *dest = ch;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function fills the given buffer using REP STOSB.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     ch - Byte to be used as pattern.
+ *     count - Size of the destination buffer.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static inline void fill_rep(void *dest, int ch, size_t count) {
+    __asm__ volatile("cld; rep stosb"
+                     : "=D"(dest), "=c"(count)
+                     : "0"(dest), "1"(count), "a"(ch)
+                     : "flags", "memory");
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the SSE2 fill for anything bigger than __SMALL_COPY_SIZE. The
+ *     head and tail are stored unaligned, while the loop in the middle always stores to aligned
+ *     addresses.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     ch - Byte to be used as pattern.
+ *     count - Size of the destination buffer.
+ *
+ * RETURN VALUE:
+ *     Start of the destination buffer.
+ *-----------------------------------------------------------------------------------------------*/
+static void *fill_sse2(void *dest, int ch, size_t count) {
+    char *Destination = dest;
+
+    if (count <= __SMALL_COPY_SIZE) {
+        fill_small(Destination, ch, count);
+        return dest;
+    } else if (count >= rep_threshold && count < __NON_TEMPORAL_THRESHOLD) {
+        fill_rep(dest, ch, count);
+        return dest;
+    }
+
+    __m128i Value = _mm_set1_epi8(ch);
+    size_t Offset = 16 - ((uintptr_t)Destination & 15);
+    size_t End = count - 16;
+
+    _mm_storeu_si128((__m128i *)Destination, Value);
+
+    if (count >= __NON_TEMPORAL_THRESHOLD) {
+        for (; Offset + 64 <= End; Offset += 64) {
+            _mm_stream_si128((__m128i *)(Destination + Offset), Value);
+            _mm_stream_si128((__m128i *)(Destination + Offset + 16), Value);
+            _mm_stream_si128((__m128i *)(Destination + Offset + 32), Value);
+            _mm_stream_si128((__m128i *)(Destination + Offset + 48), Value);
+        }
+
+        _mm_sfence();
+    }
+
+    for (; Offset < End; Offset += 16) {
+        _mm_store_si128((__m128i *)(Destination + Offset), Value);
+    }
+
+    _mm_storeu_si128((__m128i *)(Destination + End), Value);
+    return dest;
+}
+
+#ifdef _DLL
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the AVX2 version of fill_sse2().
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     ch - Byte to be used as pattern.
+ *     count - Size of the destination buffer.
+ *
+ * RETURN VALUE:
+ *     Start of the destination buffer.
+ *-----------------------------------------------------------------------------------------------*/
+__attribute__((target("avx2"))) static void *fill_avx2(void *dest, int ch, size_t count) {
+    char *Destination = dest;
+
+    if (count <= __SMALL_COPY_SIZE) {
+        fill_small(Destination, ch, count);
+        return dest;
+    } else if (count >= rep_threshold && count < __NON_TEMPORAL_THRESHOLD) {
+        fill_rep(dest, ch, count);
+        return dest;
+    }
+
+    __m256i Value = _mm256_set1_epi8(ch);
+    size_t Offset = 32 - ((uintptr_t)Destination & 31);
+    size_t End = count - 32;
+
+    _mm256_storeu_si256((__m256i *)Destination, Value);
+
+    if (count >= __NON_TEMPORAL_THRESHOLD) {
+        for (; Offset + 128 <= End; Offset += 128) {
+            _mm256_stream_si256((__m256i *)(Destination + Offset), Value);
+            _mm256_stream_si256((__m256i *)(Destination + Offset + 32), Value);
+            _mm256_stream_si256((__m256i *)(Destination + Offset + 64), Value);
+            _mm256_stream_si256((__m256i *)(Destination + Offset + 96), Value);
+        }
+
+        _mm_sfence();
+    }
+
+    for (; Offset < End; Offset += 32) {
+        _mm256_store_si256((__m256i *)(Destination + Offset), Value);
+    }
+
+    _mm256_storeu_si256((__m256i *)(Destination + End), Value);
+    return dest;
+}
+#endif /* _DLL */
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function picks the best fill routine for the current processor on the first call,
+ *     and forwards the call to it.
+ *
+ * PARAMETERS:
+ *     dest - Destination buffer.
+ *     ch - Byte to be used as pattern.
+ *     count - Size of the destination buffer.
+ *
+ * RETURN VALUE:
+ *     Start of the destination buffer.
+ *-----------------------------------------------------------------------------------------------*/
+static void *resolve(void *dest, int ch, size_t count) {
+    int Features = __get_cpu_features();
+    void *(*Implementation)(void *, int, size_t) = fill_sse2;
+
+    /* FSRM only covers MOVSB; Short STOSB is still slow without it. */
+    if (Features & __CPU_FEATURE_ERMS) {
+        rep_threshold = __REP_THRESHOLD_ERMS;
+    }
+
+#ifdef _DLL
+    if (Features & __CPU_FEATURE_AVX2) {
+        Implementation = fill_avx2;
+    }
+#endif /* _DLL */
+
+    __atomic_store_n(&implementation, Implementation, __ATOMIC_RELEASE);
+    return Implementation(dest, ch, count);
+}
+#endif /* ARCH_amd64 */
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -9,18 +209,22 @@
  *
  * PARAMETERS:
  *     dest - Destination buffer.
- *     c - Byte to be used as pattern.
+ *     ch - Byte to be used as pattern.
  *     count - Size of the destination buffer.
  *
  * RETURN VALUE:
  *     Start of the destination buffer.
  *-----------------------------------------------------------------------------------------------*/
-void *memset(void *dest, int c, size_t count) {
+void *memset(void *dest, int ch, size_t count) {
+#ifdef ARCH_amd64
+    return __atomic_load_n(&implementation, __ATOMIC_ACQUIRE)(dest, ch, count);
+#else
     char *Destination = dest;
 
     while (count--) {
-        *(Destination++) = c;
+        *(Destination++) = ch;
     }
 
     return dest;
+#endif
 }
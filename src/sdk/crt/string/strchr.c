@@ -15,9 +15,14 @@
  *     Pointer to where the character was found, or NULL if it wasn't found.
  *-----------------------------------------------------------------------------------------------*/
 char *strchr(const char *str, int ch) {
-    while (*str && *str != ch) {
+    /* The null terminator counts as part of the string (so searching for it is valid). */
+    while (*str != (char)ch) {
+        if (!*str) {
+            return NULL;
+        }
+
         str++;
     }
 
-    return *str ? (char *)str : NULL;
+    return (char *)str;
 }
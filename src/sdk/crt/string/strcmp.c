@@ -1,7 +1,11 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <stddef.h>
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#endif /* ARCH_amd64 */
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -13,13 +17,51 @@
  *
  * RETURN VALUE:
  *     0 for equality, *lhs - *rhs if an inequality is found (where `lhs` and `rhs` would be
- *     pointers to where the inequality happened).
+ *     unsigned char pointers to where the inequality happened).
  *-----------------------------------------------------------------------------------------------*/
 int strcmp(const char *lhs, const char *rhs) {
-    while (*lhs && *rhs && *lhs == *rhs) {
-        lhs++;
-        rhs++;
+    const unsigned char *Left = (const unsigned char *)lhs;
+    const unsigned char *Right = (const unsigned char *)rhs;
+
+#ifdef ARCH_amd64
+    __m128i Zero = _mm_setzero_si128();
+
+    while (1) {
+        /* The strings can have different alignments, so we use unaligned loads, and fall back
+         * to a single byte whenever one of them would cross into the next page (which might not
+         * be mapped). */
+        if (((uintptr_t)Left & (__PAGE_SIZE - 1)) > __PAGE_SIZE - 16 ||
+            ((uintptr_t)Right & (__PAGE_SIZE - 1)) > __PAGE_SIZE - 16) {
+            if (*Left != *Right || !*Left) {
+                return *Left - *Right;
+            }
+
+            Left++;
+            Right++;
+            continue;
+        }
+
+        __m128i LeftBlock = _mm_loadu_si128((const __m128i *)Left);
+        __m128i RightBlock = _mm_loadu_si128((const __m128i *)Right);
+        uint32_t Equal = _mm_movemask_epi8(_mm_cmpeq_epi8(LeftBlock, RightBlock));
+        uint32_t Null = _mm_movemask_epi8(_mm_cmpeq_epi8(LeftBlock, Zero));
+
+        /* Stop at the first byte that either differs or ends both strings. */
+        uint32_t Mask = (~Equal | Null) & 0xFFFF;
+        if (Mask) {
+            size_t Offset = __builtin_ctz(Mask);
+            return Left[Offset] - Right[Offset];
+        }
+
+        Left += 16;
+        Right += 16;
+    }
+#else
+    while (*Left && *Left == *Right) {
+        Left++;
+        Right++;
     }
 
-    return *lhs - *rhs;
+    return *Left - *Right;
+#endif /* ARCH_amd64 */
 }
@@ -1,7 +1,11 @@
 /* SPDX-FileCopyrightText: (C) 2023-2025 ilmmatias
  * SPDX-License-Identifier: GPL-3.0-or-later */
 
-#include <stddef.h>
+#include <crt_impl.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#endif /* ARCH_amd64 */
 
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
@@ -14,6 +18,27 @@
  *     Size in bytes of the given string (excluding the \0 at the end).
  *-----------------------------------------------------------------------------------------------*/
 size_t strlen(const char *str) {
+#ifdef ARCH_amd64
+    /* Aligned loads never cross into the next page, so reading a bit before/past the string is
+     * safe; We just ignore anything before its start. */
+    __m128i Zero = _mm_setzero_si128();
+    size_t Misalignment = (uintptr_t)str & 15;
+    const char *Block = str - Misalignment;
+    uint32_t Mask =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)Block), Zero)) >>
+        Misalignment;
+
+    if (Mask) {
+        return __builtin_ctz(Mask);
+    }
+
+    do {
+        Block += 16;
+        Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)Block), Zero));
+    } while (!Mask);
+
+    return Block + __builtin_ctz(Mask) - str;
+#else
     size_t Size = 0;
 
     while (*(str++)) {
@@ -21,4 +46,5 @@ size_t strlen(const char *str) {
     }
 
     return Size;
+#endif /* ARCH_amd64 */
 }
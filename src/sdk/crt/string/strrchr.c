@@ -17,13 +17,12 @@
 char *strrchr(const char *str, int ch) {
     const char *Last = NULL;
 
-    while (*str) {
-        if (*str == ch) {
+    /* The null terminator counts as part of the string (so searching for it is valid). */
+    do {
+        if (*str == (char)ch) {
             Last = str;
         }
-
-        str++;
-    }
+    } while (*(str++));
 
     return (char *)Last;
 }
@@ -6,12 +6,17 @@ set(USER_SOURCES
 
     os/__allocate_pages.c
     os/__fclose.c
+    os/__fmap.c
     os/__fopen.c
     os/__fread.c
+    os/__freadahead.c
+    os/__free_pages.c
+    os/__funmap.c
     os/__fwrite.c
     os/handles.c
 
     stdio/__parse_fopen_mode.c
+    stdio/__release_buffer.c
     stdio/clearerr.c
     stdio/fclose.c
     stdio/feof.c
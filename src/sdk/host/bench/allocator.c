@@ -0,0 +1,203 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <bench.h>
+#include <host.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SLOT_COUNT 1024
+#define SIZE_COUNT 4096
+
+typedef struct {
+    int ours;
+    size_t size;
+    void *slots[SLOT_COUNT];
+} alloc_context_t;
+
+/* Random small sizes (16-512 bytes, with most of them at the small end), shared by every run. */
+static size_t sizes[SIZE_COUNT];
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions wrap malloc/calloc/free, calling either the SDK or the host implementation.
+ *
+ * PARAMETERS:
+ *     ctx - Which implementation to use.
+ *     num - How many elements to allocate (calloc).
+ *     size - Size of the allocation (or of each element, for calloc).
+ *     ptr - What to free.
+ *
+ * RETURN VALUE:
+ *     Start of the allocated memory (malloc/calloc), or None (free).
+ *-----------------------------------------------------------------------------------------------*/
+static inline void *do_malloc(alloc_context_t *ctx, size_t size) {
+    return ctx->ours ? host_malloc(size) : malloc(size);
+}
+
+static inline void *do_calloc(alloc_context_t *ctx, size_t num, size_t size) {
+    return ctx->ours ? host_calloc(num, size) : calloc(num, size);
+}
+
+static inline void do_free(alloc_context_t *ctx, void *ptr) {
+    if (ctx->ours) {
+        host_free(ptr);
+    } else {
+        free(ptr);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions run a single allocation pattern over and over; Each iteration counts as a
+ *     single operation (for the batch patterns, a single allocation plus its free).
+ *
+ * PARAMETERS:
+ *     context - Which implementation to use, the allocation size, and the live allocations.
+ *     iterations - How many operations to run.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_malloc_free(void *context, size_t iterations) {
+    alloc_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        void *ptr = do_malloc(ctx, ctx->size);
+        BENCH_CONSUME(ptr);
+        do_free(ctx, ptr);
+    }
+}
+
+static void run_calloc_free(void *context, size_t iterations) {
+    alloc_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        void *ptr = do_calloc(ctx, 1, ctx->size);
+        BENCH_CONSUME(ptr);
+        do_free(ctx, ptr);
+    }
+}
+
+static void run_batch_lifo(void *context, size_t iterations) {
+    alloc_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i += SLOT_COUNT) {
+        size_t count = iterations - i < SLOT_COUNT ? iterations - i : SLOT_COUNT;
+
+        for (size_t j = 0; j < count; j++) {
+            ctx->slots[j] = do_malloc(ctx, ctx->size);
+        }
+
+        for (size_t j = count; j--;) {
+            do_free(ctx, ctx->slots[j]);
+        }
+    }
+}
+
+static void run_batch_fifo(void *context, size_t iterations) {
+    alloc_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i += SLOT_COUNT) {
+        size_t count = iterations - i < SLOT_COUNT ? iterations - i : SLOT_COUNT;
+
+        for (size_t j = 0; j < count; j++) {
+            ctx->slots[j] = do_malloc(ctx, ctx->size);
+        }
+
+        for (size_t j = 0; j < count; j++) {
+            do_free(ctx, ctx->slots[j]);
+        }
+    }
+}
+
+static void run_churn(void *context, size_t iterations) {
+    /* Keeps SLOT_COUNT allocations of mixed sizes alive, replacing a pseudo-random one each
+     * time (which is closer to what a real program does than the patterns above). */
+    alloc_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        size_t slot = (i * 617) % SLOT_COUNT;
+        do_free(ctx, ctx->slots[slot]);
+        ctx->slots[slot] = do_malloc(ctx, sizes[i % SIZE_COUNT]);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures an allocation pattern against the host libc.
+ *
+ * PARAMETERS:
+ *     routine - Name of the pattern.
+ *     fn - Which pattern to run.
+ *     size - Allocation size (0 for the mixed size patterns).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void compare_alloc(const char *routine, bench_fn_t fn, size_t size) {
+    static alloc_context_t ours, host;
+    double results[2];
+
+    for (int i = 0; i < 2; i++) {
+        alloc_context_t *ctx = i ? &host : &ours;
+        ctx->ours = !i;
+        ctx->size = size;
+
+        /* The churn pattern needs its slots to already be live. */
+        for (size_t j = 0; j < SLOT_COUNT; j++) {
+            ctx->slots[j] = fn == run_churn ? do_malloc(ctx, sizes[j]) : NULL;
+        }
+
+        results[i] = bench_measure(fn, ctx);
+
+        for (size_t j = 0; fn == run_churn && j < SLOT_COUNT; j++) {
+            do_free(ctx, ctx->slots[j]);
+        }
+    }
+
+    char variant[32];
+    if (size) {
+        snprintf(variant, sizeof(variant), "%zu", size);
+    } else {
+        snprintf(variant, sizeof(variant), "16-512");
+    }
+
+    bench_report(routine, variant, results[0], results[1]);
+}
+
+int main(void) {
+    uint64_t state = 0x9E3779B97F4A7C15;
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        /* Squaring biases the sizes towards the small end. */
+        uint64_t fraction = state % 1024;
+        sizes[i] = 16 + (fraction * fraction * 496) / (1024 * 1024);
+    }
+
+    static const size_t small_sizes[] = {16, 64, 256, 1024, 4096, 32768};
+    static const size_t large_sizes[] = {65536, 1 << 20};
+
+    bench_header("malloc/free");
+    for (size_t i = 0; i < BENCH_COUNT(small_sizes); i++) {
+        compare_alloc("malloc+free", run_malloc_free, small_sizes[i]);
+    }
+
+    for (size_t i = 0; i < BENCH_COUNT(small_sizes); i++) {
+        compare_alloc("batch lifo", run_batch_lifo, small_sizes[i]);
+    }
+
+    for (size_t i = 0; i < BENCH_COUNT(small_sizes); i++) {
+        compare_alloc("batch fifo", run_batch_fifo, small_sizes[i]);
+    }
+
+    compare_alloc("churn", run_churn, 0);
+
+    bench_header("calloc/large");
+    compare_alloc("calloc+free", run_calloc_free, 64);
+    compare_alloc("calloc+free", run_calloc_free, 4096);
+
+    for (size_t i = 0; i < BENCH_COUNT(large_sizes); i++) {
+        compare_alloc("malloc+free", run_malloc_free, large_sizes[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#define _DEFAULT_SOURCE
+
+#include <bench.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* How long each sample should run for, and how many samples we take (keeping the fastest one);
+ * HOST_BENCH_QUICK cuts this down to a single short sample, for smoke testing. */
+#define SAMPLE_TIME_NS 20000000ull
+#define SAMPLE_COUNT 5
+#define QUICK_SAMPLE_TIME_NS 100000ull
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads the monotonic clock of the host.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Current time in nanoseconds.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if we've been asked to only do a quick run.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     1 if HOST_BENCH_QUICK is set in the environment, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int is_quick(void) {
+    static int quick = -1;
+
+    if (quick < 0) {
+        quick = getenv("HOST_BENCH_QUICK") != NULL;
+    }
+
+    return quick;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures how long a single run of the given operation takes. We first
+ *     figure out how many iterations fill up a sample, and then keep the fastest out of a few
+ *     samples (anything slower than that is noise from the rest of the system).
+ *
+ * PARAMETERS:
+ *     fn - Runs the operation a given amount of times.
+ *     context - Passed through to the operation.
+ *
+ * RETURN VALUE:
+ *     Time per operation, in nanoseconds.
+ *-----------------------------------------------------------------------------------------------*/
+double bench_measure(bench_fn_t fn, void *context) {
+    uint64_t sample_time = is_quick() ? QUICK_SAMPLE_TIME_NS : SAMPLE_TIME_NS;
+    int sample_count = is_quick() ? 1 : SAMPLE_COUNT;
+    size_t iterations = 1;
+    uint64_t elapsed;
+
+    while (1) {
+        uint64_t start = get_time();
+        fn(context, iterations);
+        elapsed = get_time() - start;
+
+        if (elapsed >= sample_time / 4) {
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    iterations = (size_t)((double)iterations * sample_time / (elapsed ? elapsed : 1)) + 1;
+
+    double best = 0;
+    for (int i = 0; i < sample_count; i++) {
+        uint64_t start = get_time();
+        fn(context, iterations);
+        double result = (double)(get_time() - start) / iterations;
+
+        if (!i || result < best) {
+            best = result;
+        }
+    }
+
+    return best;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function starts a new table of results.
+ *
+ * PARAMETERS:
+ *     title - What's being measured.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void bench_header(const char *title) {
+    printf("\n%s\n", title);
+    printf("%-24s %-16s %12s %12s %8s\n", "routine", "case", "sdk ns/op", "libc ns/op", "ratio");
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function prints the result of a single measurement.
+ *
+ * PARAMETERS:
+ *     routine - Which routine was measured.
+ *     variant - Which input/size was used.
+ *     ours - Time per operation of the SDK routine.
+ *     host - Time per operation of the host libc equivalent, or a negative value if there's
+ *            none.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void bench_report(const char *routine, const char *variant, double ours, double host) {
+    if (host < 0) {
+        printf("%-24s %-16s %12.2f %12s %8s\n", routine, variant, ours, "-", "-");
+    } else {
+        printf(
+            "%-24s %-16s %12.2f %12.2f %7.2fx\n", routine, variant, ours, host, ours / host);
+    }
+
+    fflush(stdout);
+}
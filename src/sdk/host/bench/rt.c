@@ -0,0 +1,362 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <bench.h>
+#include <host.h>
+#include <rt/bitmap.h>
+#include <rt/hash.h>
+#include <rt/hashtable.h>
+#include <rt/list.h>
+#include <rt/ring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    RtBitmap bitmap;
+    uint64_t bits;
+} bitmap_context_t;
+
+typedef struct {
+    const uint8_t *buffer;
+    size_t size;
+} hash_context_t;
+
+typedef struct {
+    RtHashEntry header;
+    uint64_t key;
+} hash_entry_t;
+
+typedef struct {
+    RtHashTable table;
+    hash_entry_t *entries;
+    size_t count;
+} hash_table_context_t;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions run a single bitmap operation over and over.
+ *
+ * PARAMETERS:
+ *     context - Which bitmap to use.
+ *     iterations - How many times to run the operation.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_find_clear_bits(void *context, size_t iterations) {
+    bitmap_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        uint64_t hint = (i * 977) % ctx->bitmap.NumberOfBits;
+        BENCH_CONSUME(RtFindClearBits(&ctx->bitmap, hint, ctx->bits));
+    }
+}
+
+static void run_find_set_and_clear(void *context, size_t iterations) {
+    bitmap_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        uint64_t start = RtFindClearBitsAndSet(&ctx->bitmap, 0, ctx->bits);
+        RtClearBits(&ctx->bitmap, start, ctx->bits);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions hash the same buffer over and over.
+ *
+ * PARAMETERS:
+ *     context - Which buffer to hash.
+ *     iterations - How many times to hash it.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_crc32c(void *context, size_t iterations) {
+    hash_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(RtGetCrc32c(0, ctx->buffer, ctx->size));
+    }
+}
+
+static void run_hash(void *context, size_t iterations) {
+    hash_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(RtGetHash(ctx->buffer, ctx->size));
+    }
+}
+
+static void run_xxh64(void *context, size_t iterations) {
+    hash_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(RtGetXxh64Hash(ctx->buffer, ctx->size, 0));
+    }
+}
+
+static void run_xxh3(void *context, size_t iterations) {
+    hash_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(RtGetXxh3Hash(ctx->buffer, ctx->size, 0));
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions are the callbacks of the benchmark hash table.
+ *
+ * PARAMETERS:
+ *     Depends on the callback.
+ *
+ * RETURN VALUE:
+ *     Depends on the callback.
+ *-----------------------------------------------------------------------------------------------*/
+static int compare_entry(RtHashEntry *entry, const void *key) {
+    return ((hash_entry_t *)entry)->key == *(const uint64_t *)key;
+}
+
+static void *allocate_table(size_t size) {
+    return malloc(size);
+}
+
+static void free_table(void *base) {
+    free(base);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions measure hash table operations; The lookups run against a table filled with
+ *     all entries, and the insert benchmark removes and reinserts one entry on each iteration.
+ *
+ * PARAMETERS:
+ *     context - Which table/entries to use.
+ *     iterations - How many times to run the operation.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_hash_lookup(void *context, size_t iterations) {
+    hash_table_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        hash_entry_t *entry = &ctx->entries[(i * 7919) % ctx->count];
+        BENCH_CONSUME(RtLookupHashTable(&ctx->table, entry->header.Hash, &entry->key));
+    }
+}
+
+static void run_hash_insert_remove(void *context, size_t iterations) {
+    hash_table_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        hash_entry_t *entry = &ctx->entries[(i * 7919) % ctx->count];
+        RtRemoveHashTable(&ctx->table, entry->header.Hash, &entry->key);
+        RtInsertHashTable(&ctx->table, &entry->header, entry->header.Hash);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions push and pop a single entry from each kind of list/ring.
+ *
+ * PARAMETERS:
+ *     context - Unused.
+ *     iterations - How many push/pop pairs to run.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_dlist(void *, size_t iterations) {
+    RtDList head, entry;
+    RtInitializeDList(&head);
+    for (size_t i = 0; i < iterations; i++) {
+        RtAppendDList(&head, &entry);
+        BENCH_CONSUME(RtPopDList(&head));
+    }
+}
+
+static void run_slist(void *, size_t iterations) {
+    RtSList head = {NULL}, entry;
+    for (size_t i = 0; i < iterations; i++) {
+        RtPushSList(&head, &entry);
+        BENCH_CONSUME(RtPopSList(&head));
+    }
+}
+
+static void run_atomic_slist(void *, size_t iterations) {
+    RtAtomicSList head = {NULL, 0};
+    RtSList entry;
+    for (size_t i = 0; i < iterations; i++) {
+        RtPushAtomicSList(&head, &entry);
+        BENCH_CONSUME(RtPopAtomicSList(&head));
+    }
+}
+
+static void run_spsc_ring(void *, size_t iterations) {
+    void *buffer[64], *item;
+    RtSpscRing ring;
+    RtInitializeSpscRing(&ring, buffer, 64);
+    for (size_t i = 0; i < iterations; i++) {
+        RtPushSpscRing(&ring, &ring);
+        RtPopSpscRing(&ring, &item);
+        BENCH_CONSUME(item);
+    }
+}
+
+static void run_mpmc_ring(void *, size_t iterations) {
+    RtMpmcSlot buffer[64];
+    RtMpmcRing ring;
+    void *item;
+    RtInitializeMpmcRing(&ring, buffer, 64);
+    for (size_t i = 0; i < iterations; i++) {
+        RtPushMpmcRing(&ring, &ring);
+        RtPopMpmcRing(&ring, &item);
+        BENCH_CONSUME(item);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures the bitmap routines, on a bitmap that is mostly full (with a few
+ *     clear ranges spread around).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void bench_bitmap(void) {
+    static const uint64_t sizes[] = {4096, 1 << 20};
+    static const uint64_t runs[] = {1, 16, 256};
+
+    bench_header("bitmap");
+
+    for (size_t i = 0; i < BENCH_COUNT(sizes); i++) {
+        uint64_t *buffer = malloc(sizes[i] / 8);
+        bitmap_context_t ctx;
+        RtInitializeBitmap(&ctx.bitmap, buffer, sizes[i]);
+        RtSetAllBits(&ctx.bitmap);
+        for (uint64_t bit = 0; bit + 512 <= sizes[i]; bit += sizes[i] / 8) {
+            RtClearBits(&ctx.bitmap, bit + 100, 300);
+        }
+
+        for (size_t j = 0; j < BENCH_COUNT(runs); j++) {
+            char variant[32];
+            snprintf(
+                variant,
+                sizeof(variant),
+                "%llu/%llu",
+                (unsigned long long)runs[j],
+                (unsigned long long)sizes[i]);
+            ctx.bits = runs[j];
+            bench_report("RtFindClearBits", variant, bench_measure(run_find_clear_bits, &ctx), -1);
+            bench_report(
+                "RtFindClearBitsAndSet", variant, bench_measure(run_find_set_and_clear, &ctx), -1);
+        }
+
+        free(buffer);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures the hash functions across a few buffer sizes.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void bench_hashes(void) {
+    static const size_t sizes[] = {8, 16, 64, 256, 4096, 65536};
+    static const struct {
+        const char *name;
+        bench_fn_t fn;
+    } routines[] = {
+        {"RtGetCrc32c", run_crc32c},
+        {"RtGetHash", run_hash},
+        {"RtGetXxh64Hash", run_xxh64},
+        {"RtGetXxh3Hash", run_xxh3},
+    };
+
+    uint8_t *buffer = malloc(65536);
+    for (size_t i = 0; i < 65536; i++) {
+        buffer[i] = i * 131;
+    }
+
+    bench_header("hash");
+
+    for (size_t i = 0; i < BENCH_COUNT(routines); i++) {
+        for (size_t j = 0; j < BENCH_COUNT(sizes); j++) {
+            char variant[32];
+            snprintf(variant, sizeof(variant), "%zu", sizes[j]);
+            hash_context_t ctx = {buffer, sizes[j]};
+            bench_report(routines[i].name, variant, bench_measure(routines[i].fn, &ctx), -1);
+        }
+    }
+
+    free(buffer);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures the hash table, for tables that fit in the cache and tables that
+ *     don't.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void bench_hash_table(void) {
+    static const size_t counts[] = {1024, 1 << 20};
+
+    bench_header("hash table");
+
+    for (size_t i = 0; i < BENCH_COUNT(counts); i++) {
+        hash_table_context_t ctx;
+        ctx.count = counts[i];
+        ctx.entries = malloc(counts[i] * sizeof(hash_entry_t));
+        RtInitializeHashTable(&ctx.table, compare_entry, allocate_table, free_table);
+
+        for (size_t j = 0; j < counts[i]; j++) {
+            ctx.entries[j].key = j;
+            ctx.entries[j].header.Hash = RtGetXxh3Hash(&ctx.entries[j].key, sizeof(uint64_t), 0);
+            RtInsertHashTable(&ctx.table, &ctx.entries[j].header, ctx.entries[j].header.Hash);
+        }
+
+        char variant[32];
+        snprintf(variant, sizeof(variant), "%zu", counts[i]);
+        bench_report("RtLookupHashTable", variant, bench_measure(run_hash_lookup, &ctx), -1);
+        bench_report(
+            "RtRemove+InsertHashTable", variant, bench_measure(run_hash_insert_remove, &ctx), -1);
+
+        RtFreeHashTable(&ctx.table);
+        free(ctx.entries);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures the (uncontended) list and ring operations.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void bench_lists(void) {
+    bench_header("lists and rings (push+pop)");
+    bench_report("RtDList", "1", bench_measure(run_dlist, NULL), -1);
+    bench_report("RtSList", "1", bench_measure(run_slist, NULL), -1);
+    bench_report("RtAtomicSList", "1", bench_measure(run_atomic_slist, NULL), -1);
+    bench_report("RtSpscRing", "1", bench_measure(run_spsc_ring, NULL), -1);
+    bench_report("RtMpmcRing", "1", bench_measure(run_mpmc_ring, NULL), -1);
+}
+
+int main(void) {
+    bench_bitmap();
+    bench_hashes();
+    bench_hash_table();
+    bench_lists();
+    return 0;
+}
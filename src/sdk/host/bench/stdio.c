@@ -0,0 +1,255 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <bench.h>
+#include <host.h>
+#include <stdio.h>
+
+typedef struct {
+    const char *input;
+    int ours;
+} scan_context_t;
+
+typedef struct {
+    const char *format;
+    int ours;
+    union {
+        int int_value;
+        unsigned long long ullong_value;
+        double double_value;
+    };
+} print_context_t;
+
+/* What each snprintf benchmark formats; Each table is for a different argument type. */
+static const struct {
+    const char *variant;
+    const char *format;
+    int value;
+} int_cases[] = {
+    {"%d short", "%d", 7},
+    {"%d long", "%d", -2147483647},
+    {"%08x", "%08x", 0xbeef},
+    {"%-12i", "%-12i|", 123456},
+};
+
+static const struct {
+    const char *variant;
+    const char *format;
+    unsigned long long value;
+} ullong_cases[] = {
+    {"%llu", "%llu", 18446744073709551615ull},
+    {"%#llx", "%#llx", 0xdeadbeefcafebabe},
+    {"%llo", "%llo", 01234567012345670},
+};
+
+static const struct {
+    const char *variant;
+    const char *format;
+    double value;
+} double_cases[] = {
+    {"%f", "%f", 3.14159265358979},
+    {"%.2f", "%.2f", 1234.5678},
+    {"%f 1e300", "%f", 1e300},
+    {"%e", "%e", 6.02214076e23},
+    {"%.17e", "%.17e", 0.1},
+    {"%g small", "%g", 0.000123456},
+    {"%g integer", "%g", 100.0},
+    {"%.17g subnormal", "%.17g", 2.2250738585072014e-308},
+};
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions parse the same input over and over with sscanf, using either the SDK or
+ *     the host implementation.
+ *
+ * PARAMETERS:
+ *     context - Which input to use, and which implementation.
+ *     iterations - How many times to parse the input.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_scan_int(void *context, size_t iterations) {
+    scan_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        int value;
+        BENCH_CONSUME(
+            ctx->ours ? host_sscanf(ctx->input, "%d", &value) : sscanf(ctx->input, "%d", &value));
+        BENCH_CONSUME(value);
+    }
+}
+
+static void run_scan_hex(void *context, size_t iterations) {
+    scan_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        unsigned long long value;
+        BENCH_CONSUME(
+            ctx->ours ? host_sscanf(ctx->input, "%llx", &value)
+                      : sscanf(ctx->input, "%llx", &value));
+        BENCH_CONSUME(value);
+    }
+}
+
+static void run_scan_string(void *context, size_t iterations) {
+    scan_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        char value[64];
+        BENCH_CONSUME(
+            ctx->ours ? host_sscanf(ctx->input, "%63s", value)
+                      : sscanf(ctx->input, "%63s", value));
+        BENCH_CONSUME(value);
+    }
+}
+
+static void run_scan_mixed(void *context, size_t iterations) {
+    scan_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        char name[16];
+        int a, b;
+        unsigned c;
+        BENCH_CONSUME(
+            ctx->ours ? host_sscanf(ctx->input, "%15s %d,%i %x", name, &a, &b, &c)
+                      : sscanf(ctx->input, "%15s %d,%i %x", name, &a, &b, &c));
+        BENCH_CONSUME(name);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions format the same value over and over with snprintf, using either the SDK
+ *     or the host implementation.
+ *
+ * PARAMETERS:
+ *     context - Format string, value, and which implementation to use.
+ *     iterations - How many times to format the value.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_print_int(void *context, size_t iterations) {
+    print_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        char buffer[128];
+        BENCH_CONSUME(
+            ctx->ours ? host_snprintf(buffer, sizeof(buffer), ctx->format, ctx->int_value)
+                      : snprintf(buffer, sizeof(buffer), ctx->format, ctx->int_value));
+        BENCH_CONSUME(buffer);
+    }
+}
+
+static void run_print_ullong(void *context, size_t iterations) {
+    print_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        char buffer[128];
+        BENCH_CONSUME(
+            ctx->ours ? host_snprintf(buffer, sizeof(buffer), ctx->format, ctx->ullong_value)
+                      : snprintf(buffer, sizeof(buffer), ctx->format, ctx->ullong_value));
+        BENCH_CONSUME(buffer);
+    }
+}
+
+static void run_print_double(void *context, size_t iterations) {
+    print_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        char buffer[512];
+        BENCH_CONSUME(
+            ctx->ours ? host_snprintf(buffer, sizeof(buffer), ctx->format, ctx->double_value)
+                      : snprintf(buffer, sizeof(buffer), ctx->format, ctx->double_value));
+        BENCH_CONSUME(buffer);
+    }
+}
+
+static void run_print_mixed(void *context, size_t iterations) {
+    print_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        char buffer[256];
+        BENCH_CONSUME(
+            ctx->ours ? host_snprintf(
+                            buffer,
+                            sizeof(buffer),
+                            ctx->format,
+                            "entry",
+                            ctx->int_value,
+                            42u,
+                            0xdeadbeefull,
+                            12.3456)
+                      : snprintf(
+                            buffer,
+                            sizeof(buffer),
+                            ctx->format,
+                            "entry",
+                            ctx->int_value,
+                            42u,
+                            0xdeadbeefull,
+                            12.3456));
+        BENCH_CONSUME(buffer);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures a snprintf call against the host libc.
+ *
+ * PARAMETERS:
+ *     variant - Description of the format/value.
+ *     fn - Which argument type to use.
+ *     ctx - Format string, and the value to format (stored in the field `fn` uses).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void compare_print(const char *variant, bench_fn_t fn, print_context_t ctx) {
+    ctx.ours = 1;
+    double ours = bench_measure(fn, &ctx);
+    ctx.ours = 0;
+    bench_report("snprintf", variant, ours, bench_measure(fn, &ctx));
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures a sscanf call against the host libc.
+ *
+ * PARAMETERS:
+ *     variant - Description of the input.
+ *     fn - Which conversion to run.
+ *     input - What to parse.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void compare_scan(const char *variant, bench_fn_t fn, const char *input) {
+    scan_context_t ours = {input, 1};
+    scan_context_t host = {input, 0};
+    bench_report("sscanf", variant, bench_measure(fn, &ours), bench_measure(fn, &host));
+}
+
+int main(void) {
+    bench_header("snprintf (integers)");
+    for (size_t i = 0; i < BENCH_COUNT(int_cases); i++) {
+        print_context_t ctx = {int_cases[i].format, .int_value = int_cases[i].value};
+        compare_print(int_cases[i].variant, run_print_int, ctx);
+    }
+
+    for (size_t i = 0; i < BENCH_COUNT(ullong_cases); i++) {
+        print_context_t ctx = {ullong_cases[i].format, .ullong_value = ullong_cases[i].value};
+        compare_print(ullong_cases[i].variant, run_print_ullong, ctx);
+    }
+
+    bench_header("snprintf (floating point)");
+    for (size_t i = 0; i < BENCH_COUNT(double_cases); i++) {
+        print_context_t ctx = {double_cases[i].format, .double_value = double_cases[i].value};
+        compare_print(double_cases[i].variant, run_print_double, ctx);
+    }
+
+    bench_header("snprintf (mixed)");
+    print_context_t ctx = {"%s: %d/%u (0x%08llx) %.2f%%", .int_value = -5};
+    compare_print("%s %d %u %llx %f", run_print_mixed, ctx);
+
+    bench_header("sscanf");
+    compare_scan("%d short", run_scan_int, "42");
+    compare_scan("%d long", run_scan_int, "-2147483647");
+    compare_scan("%llx", run_scan_hex, "0xdeadbeefcafebabe");
+    compare_scan("%s", run_scan_string, "  some_identifier_here rest");
+    compare_scan("%s %d,%i %x", run_scan_mixed, "name 123,0x7f ff");
+    return 0;
+}
@@ -0,0 +1,203 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <bench.h>
+#include <ctype.h>
+#include <host.h>
+#include <stdlib.h>
+
+typedef struct {
+    const char *const *inputs;
+    size_t count;
+    int ours;
+} parse_context_t;
+
+static const char *const integers[] = {
+    "0", "7", "42", "-13", "65535", "123456789", "-214748364", "1000000000",
+};
+
+static const char *const hex_integers[] = {
+    "0x0", "0xff", "0xdeadbeef", "0x7fffffffffffffff",
+};
+
+static const char *const short_doubles[] = {
+    "0", "1.5", "-2.25", "3.14159", "100", "0.001", "1e10", "-7.5e-3",
+};
+
+static const char *const long_doubles[] = {
+    "3.141592653589793",
+    "2.718281828459045",
+    "1.7976931348623157e308",
+    "2.2250738585072014e-308",
+    "4.9406564584124654e-324",
+    "0.1000000000000000055511151231257827",
+    "123456789012345678901234567890",
+    "9007199254740993",
+};
+
+static const char ctype_input[] =
+    "The quick brown fox jumps over the lazy dog 0123456789 !@#$%^&*()\t\n";
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions parse every string in the input list, using either the SDK or the host
+ *     implementation.
+ *
+ * PARAMETERS:
+ *     context - Which inputs to parse, and which implementation to use.
+ *     iterations - How many times to go through the inputs.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_strtol(void *context, size_t iterations) {
+    parse_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < ctx->count; j++) {
+            BENCH_CONSUME(
+                ctx->ours ? host_strtol(ctx->inputs[j], NULL, 0) : strtol(ctx->inputs[j], NULL, 0));
+        }
+    }
+}
+
+static void run_strtoull(void *context, size_t iterations) {
+    parse_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < ctx->count; j++) {
+            BENCH_CONSUME(
+                ctx->ours ? host_strtoull(ctx->inputs[j], NULL, 0)
+                          : strtoull(ctx->inputs[j], NULL, 0));
+        }
+    }
+}
+
+static void run_atoi(void *context, size_t iterations) {
+    parse_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < ctx->count; j++) {
+            BENCH_CONSUME(ctx->ours ? host_atoi(ctx->inputs[j]) : atoi(ctx->inputs[j]));
+        }
+    }
+}
+
+static void run_strtof(void *context, size_t iterations) {
+    parse_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < ctx->count; j++) {
+            float value =
+                ctx->ours ? host_strtof(ctx->inputs[j], NULL) : strtof(ctx->inputs[j], NULL);
+            BENCH_CONSUME(value);
+        }
+    }
+}
+
+static void run_strtod(void *context, size_t iterations) {
+    parse_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < ctx->count; j++) {
+            double value =
+                ctx->ours ? host_strtod(ctx->inputs[j], NULL) : strtod(ctx->inputs[j], NULL);
+            BENCH_CONSUME(value);
+        }
+    }
+}
+
+static void run_strtold(void *context, size_t iterations) {
+    parse_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < ctx->count; j++) {
+            long double value =
+                ctx->ours ? host_strtold(ctx->inputs[j], NULL) : strtold(ctx->inputs[j], NULL);
+            BENCH_CONSUME(&value);
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions run the remaining stdlib/ctype routines, using either the SDK or the host
+ *     implementation.
+ *
+ * PARAMETERS:
+ *     context - Pointer to an int, 1 if we should use the SDK implementation.
+ *     iterations - How many times to run the routine (or go through the ctype input).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_rand(void *context, size_t iterations) {
+    int ours = *(int *)context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(ours ? host_rand() : rand());
+    }
+}
+
+static void run_ctype(void *context, size_t iterations) {
+    int ours = *(int *)context;
+    for (size_t i = 0; i < iterations; i++) {
+        int count = 0;
+        for (const char *ch = ctype_input; *ch; ch++) {
+            if (ours) {
+                count += host_isalnum(*ch) + host_isspace(*ch) + host_toupper(*ch);
+            } else {
+                count += isalnum(*ch) + isspace(*ch) + toupper(*ch);
+            }
+        }
+
+        BENCH_CONSUME(count);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures a parsing routine against its host equivalent; The result is the
+ *     average time per string.
+ *
+ * PARAMETERS:
+ *     routine - Name of the routine.
+ *     variant - Which kind of input we're parsing.
+ *     fn - Parses all strings in the input list.
+ *     inputs - Input list.
+ *     count - Size of the input list.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void compare_parse(
+    const char *routine,
+    const char *variant,
+    bench_fn_t fn,
+    const char *const *inputs,
+    size_t count) {
+    parse_context_t ours = {inputs, count, 1};
+    parse_context_t host = {inputs, count, 0};
+    bench_report(
+        routine, variant, bench_measure(fn, &ours) / count, bench_measure(fn, &host) / count);
+}
+
+int main(void) {
+    int ours = 1, host = 0;
+
+    bench_header("integer parsing (per string)");
+    compare_parse("strtol", "decimal", run_strtol, integers, BENCH_COUNT(integers));
+    compare_parse("strtol", "hex", run_strtol, hex_integers, BENCH_COUNT(hex_integers));
+    compare_parse("strtoull", "decimal", run_strtoull, integers, BENCH_COUNT(integers));
+    compare_parse("atoi", "decimal", run_atoi, integers, BENCH_COUNT(integers));
+
+    bench_header("float parsing (per string)");
+    compare_parse("strtof", "short", run_strtof, short_doubles, BENCH_COUNT(short_doubles));
+    compare_parse("strtod", "short", run_strtod, short_doubles, BENCH_COUNT(short_doubles));
+    compare_parse("strtod", "long", run_strtod, long_doubles, BENCH_COUNT(long_doubles));
+    compare_parse("strtold", "short", run_strtold, short_doubles, BENCH_COUNT(short_doubles));
+    compare_parse("strtold", "long", run_strtold, long_doubles, BENCH_COUNT(long_doubles));
+
+    bench_header("misc");
+    bench_report("rand", "-", bench_measure(run_rand, &ours), bench_measure(run_rand, &host));
+    bench_report(
+        "isalnum+isspace+toupper",
+        "per string",
+        bench_measure(run_ctype, &ours),
+        bench_measure(run_ctype, &host));
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <bench.h>
+#include <host.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <variants.h>
+
+#define MAX_SIZE (8 << 20)
+
+typedef struct {
+    const host_variant_t *variant;
+    char *dest;
+    char *src;
+    size_t size;
+} string_context_t;
+
+static const size_t copy_sizes[] = {16, 64, 256, 1024, 4096, 65536, MAX_SIZE};
+static const size_t scan_sizes[] = {16, 256, 4096, 65536};
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions run a single string routine over and over, using either the given SDK
+ *     variant (or the dispatched build, for the routines that don't have variants), or the host
+ *     libc when there's no variant.
+ *
+ * PARAMETERS:
+ *     context - Buffers, size, and which variant to use.
+ *     iterations - How many times to run the routine.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_memcpy(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(
+            ctx->variant ? ctx->variant->memcpy(ctx->dest, ctx->src, ctx->size)
+                         : memcpy(ctx->dest, ctx->src, ctx->size));
+    }
+}
+
+static void run_memmove(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(
+            ctx->variant ? ctx->variant->memmove(ctx->src + 1, ctx->src, ctx->size)
+                         : memmove(ctx->src + 1, ctx->src, ctx->size));
+    }
+}
+
+static void run_memset(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(
+            ctx->variant ? ctx->variant->memset(ctx->dest, (int)i, ctx->size)
+                         : memset(ctx->dest, (int)i, ctx->size));
+    }
+}
+
+static void run_strlen(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(ctx->variant ? host_strlen(ctx->src) : strlen(ctx->src));
+    }
+}
+
+static void run_memchr(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(
+            ctx->variant ? host_memchr(ctx->src, 'x', ctx->size)
+                         : memchr(ctx->src, 'x', ctx->size));
+    }
+}
+
+static void run_memcmp(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(
+            ctx->variant ? host_memcmp(ctx->dest, ctx->src, ctx->size)
+                         : memcmp(ctx->dest, ctx->src, ctx->size));
+    }
+}
+
+static void run_strcmp(void *context, size_t iterations) {
+    string_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(
+            ctx->variant ? host_strcmp(ctx->dest, ctx->src) : strcmp(ctx->dest, ctx->src));
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures a string routine (with the given variant) against the host libc.
+ *
+ * PARAMETERS:
+ *     routine - Name of the routine.
+ *     fn - Which routine to run.
+ *     variant - Which SDK variant to use.
+ *     dest - Destination (or second input) buffer.
+ *     src - Source (or first input) buffer.
+ *     size - Size of the operation.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void compare_string(
+    const char *routine,
+    bench_fn_t fn,
+    const host_variant_t *variant,
+    char *dest,
+    char *src,
+    size_t size) {
+    string_context_t ours = {variant, dest, src, size};
+    string_context_t host = {NULL, dest, src, size};
+    char name[64];
+    snprintf(name, sizeof(name), "%zu %s", size, variant->name);
+    bench_report(routine, name, bench_measure(fn, &ours), bench_measure(fn, &host));
+}
+
+int main(void) {
+    /* One extra byte for memmove (which copies the source one byte forward). */
+    char *dest = malloc(MAX_SIZE + 1);
+    char *src = malloc(MAX_SIZE + 1);
+    if (!dest || !src) {
+        fprintf(stderr, "couldn't allocate the benchmark buffers\n");
+        return 1;
+    }
+
+    memset(dest, 'a', MAX_SIZE + 1);
+    memset(src, 'a', MAX_SIZE + 1);
+
+    static const host_variant_t variants[] = HOST_VARIANT_TABLE;
+    size_t count = BENCH_COUNT(variants);
+    int avx2 = __builtin_cpu_supports("avx2");
+
+    bench_header("memcpy/memmove/memset");
+    for (size_t i = 0; i < BENCH_COUNT(copy_sizes); i++) {
+        for (size_t j = 0; j < count; j++) {
+            if (!variants[j].avx2 || avx2) {
+                compare_string("memcpy", run_memcpy, &variants[j], dest, src, copy_sizes[i]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < BENCH_COUNT(copy_sizes); i++) {
+        for (size_t j = 0; j < count; j++) {
+            if (!variants[j].avx2 || avx2) {
+                compare_string("memmove", run_memmove, &variants[j], dest, src, copy_sizes[i]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < BENCH_COUNT(copy_sizes); i++) {
+        for (size_t j = 0; j < count; j++) {
+            if (!variants[j].avx2 || avx2) {
+                compare_string("memset", run_memset, &variants[j], dest, src, copy_sizes[i]);
+            }
+        }
+    }
+
+    /* The rest doesn't have variants; The last entry is the regular (dispatched) build. */
+    const host_variant_t *dispatch = &variants[count - 1];
+    bench_header("strlen/memchr/memcmp/strcmp");
+    for (size_t i = 0; i < BENCH_COUNT(scan_sizes); i++) {
+        size_t size = scan_sizes[i];
+        memset(dest, 'a', MAX_SIZE + 1);
+        memset(src, 'a', MAX_SIZE + 1);
+        dest[size - 1] = 0;
+        src[size - 1] = 0;
+
+        compare_string("strlen", run_strlen, dispatch, dest, src, size);
+        compare_string("memchr", run_memchr, dispatch, dest, src, size);
+        compare_string("memcmp", run_memcmp, dispatch, dest, src, size);
+        compare_string("strcmp", run_strcmp, dispatch, dest, src, size);
+    }
+
+    free(dest);
+    free(src);
+    return 0;
+}
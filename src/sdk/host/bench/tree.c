@@ -0,0 +1,267 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#define _GNU_SOURCE
+
+#include <bench.h>
+#include <host.h>
+#include <rt/tree.h>
+#include <search.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    RtTreeNode header;
+    uint64_t key;
+} key_node_t;
+
+typedef struct {
+    int avl;
+    RtTree tree;
+    key_node_t *nodes;
+    void *host_root;
+    uint64_t *keys;
+    size_t count;
+} tree_context_t;
+
+typedef struct {
+    RtIntervalTree tree;
+    RtIntervalNode *nodes;
+    size_t count;
+    uint64_t range;
+    uint64_t query_size;
+} interval_context_t;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions compare a key against a tree node, or against another key (for the host
+ *     tsearch() tree).
+ *
+ * PARAMETERS:
+ *     Key/lhs - Pointer to the key.
+ *     Node/rhs - What to compare against.
+ *
+ * RETURN VALUE:
+ *     <0 if the key goes first, 0 if they're equal, >0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int compare_key(const void *Key, RtTreeNode *Node) {
+    uint64_t Value = *(const uint64_t *)Key;
+    uint64_t NodeValue = CONTAINING_RECORD(Node, key_node_t, header)->key;
+    return Value < NodeValue ? -1 : Value > NodeValue;
+}
+
+static int compare_host(const void *lhs, const void *rhs) {
+    uint64_t left = *(const uint64_t *)lhs;
+    uint64_t right = *(const uint64_t *)rhs;
+    return left < right ? -1 : left > right;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets called by tdestroy() for every key; The keys live in a separate array,
+ *     so there's nothing to free.
+ *
+ * PARAMETERS:
+ *     key - Key of the node being destroyed.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void free_nothing(void *key) {
+    (void)key;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions run a single tree operation over and over, on the SDK tree (red-black or
+ *     AVL); The _host versions use the host tsearch() tree instead.
+ *
+ * PARAMETERS:
+ *     context - Which tree to use.
+ *     iterations - How many times to run the operation.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_lookup(void *context, size_t iterations) {
+    tree_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(RtLookupTree(&ctx->tree, &ctx->keys[(i * 7919) % ctx->count]));
+    }
+}
+
+static void run_lookup_host(void *context, size_t iterations) {
+    tree_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        BENCH_CONSUME(tfind(&ctx->keys[(i * 7919) % ctx->count], &ctx->host_root, compare_host));
+    }
+}
+
+static void run_remove_insert(void *context, size_t iterations) {
+    tree_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        key_node_t *node = &ctx->nodes[(i * 7919) % ctx->count];
+
+        if (ctx->avl) {
+            RtRemoveAvlTree(&ctx->tree, &node->header);
+            RtInsertAvlTree(&ctx->tree, &node->header, &node->key);
+        } else {
+            RtRemoveRbTree(&ctx->tree, &node->header);
+            RtInsertRbTree(&ctx->tree, &node->header, &node->key);
+        }
+    }
+}
+
+static void run_remove_insert_host(void *context, size_t iterations) {
+    tree_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        uint64_t *key = &ctx->keys[(i * 7919) % ctx->count];
+        tdelete(key, &ctx->host_root, compare_host);
+        BENCH_CONSUME(tsearch(key, &ctx->host_root, compare_host));
+    }
+}
+
+static void run_iterate(void *context, size_t iterations) {
+    /* One iteration is a single step (so a full walk is `count` iterations). */
+    tree_context_t *ctx = context;
+    RtTreeNode *node = NULL;
+    for (size_t i = 0; i < iterations; i++) {
+        node = node ? RtGetNextTreeNode(node) : RtGetFirstTreeNode(&ctx->tree);
+        BENCH_CONSUME(node);
+    }
+}
+
+static void run_interval_query(void *context, size_t iterations) {
+    interval_context_t *ctx = context;
+    for (size_t i = 0; i < iterations; i++) {
+        uint64_t start = (i * 2654435761u) % ctx->range;
+        uint64_t end = start + ctx->query_size;
+        for (RtIntervalNode *node = RtLookupIntervalTree(&ctx->tree, start, end); node;
+             node = RtLookupNextIntervalTree(node, start, end)) {
+            BENCH_CONSUME(node);
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures the red-black and AVL trees against the host libc tsearch() (which
+ *     is also a red-black tree) at the given size.
+ *
+ * PARAMETERS:
+ *     count - How many nodes the trees should have.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void compare_trees(size_t count) {
+    tree_context_t contexts[2];
+    uint64_t *keys = malloc(count * sizeof(uint64_t));
+    if (!keys) {
+        fprintf(stderr, "couldn't allocate the benchmark keys\n");
+        exit(1);
+    }
+
+    /* Odd multiplier, so the keys are unique, but inserted in a random looking order. */
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = i * 0x9E3779B97F4A7C15;
+    }
+
+    for (int avl = 0; avl < 2; avl++) {
+        tree_context_t *ctx = &contexts[avl];
+        ctx->avl = avl;
+        ctx->keys = keys;
+        ctx->count = count;
+        ctx->host_root = NULL;
+        ctx->nodes = malloc(count * sizeof(key_node_t));
+        if (!ctx->nodes) {
+            fprintf(stderr, "couldn't allocate the benchmark nodes\n");
+            exit(1);
+        }
+
+        RtInitializeTree(&ctx->tree, compare_key, NULL);
+        for (size_t i = 0; i < count; i++) {
+            ctx->nodes[i].key = keys[i];
+            avl ? RtInsertAvlTree(&ctx->tree, &ctx->nodes[i].header, &keys[i])
+                : RtInsertRbTree(&ctx->tree, &ctx->nodes[i].header, &keys[i]);
+        }
+    }
+
+    tree_context_t *host = &contexts[0];
+    for (size_t i = 0; i < count; i++) {
+        tsearch(&keys[i], &host->host_root, compare_host);
+    }
+
+    char rb_name[32], avl_name[32];
+    snprintf(rb_name, sizeof(rb_name), "%zu red-black", count);
+    snprintf(avl_name, sizeof(avl_name), "%zu AVL", count);
+
+    double host_lookup = bench_measure(run_lookup_host, host);
+    bench_report("lookup", rb_name, bench_measure(run_lookup, &contexts[0]), host_lookup);
+    bench_report("lookup", avl_name, bench_measure(run_lookup, &contexts[1]), host_lookup);
+
+    double host_update = bench_measure(run_remove_insert_host, host);
+    bench_report(
+        "remove+insert", rb_name, bench_measure(run_remove_insert, &contexts[0]), host_update);
+    bench_report(
+        "remove+insert", avl_name, bench_measure(run_remove_insert, &contexts[1]), host_update);
+
+    bench_report("next node", rb_name, bench_measure(run_iterate, &contexts[0]), -1);
+    bench_report("next node", avl_name, bench_measure(run_iterate, &contexts[1]), -1);
+
+    tdestroy(host->host_root, free_nothing);
+    free(contexts[0].nodes);
+    free(contexts[1].nodes);
+    free(keys);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function measures interval tree queries (there's no host equivalent).
+ *
+ * PARAMETERS:
+ *     count - How many intervals the tree should have.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void measure_intervals(size_t count) {
+    interval_context_t ctx;
+    ctx.count = count;
+    ctx.range = count * 64;
+    ctx.nodes = malloc(count * sizeof(RtIntervalNode));
+    if (!ctx.nodes) {
+        fprintf(stderr, "couldn't allocate the benchmark nodes\n");
+        exit(1);
+    }
+
+    /* Intervals of up to 256 units spread over 64 units per interval, so that each point is
+     * covered by a couple of them on average. */
+    RtInitializeIntervalTree(&ctx.tree);
+    for (size_t i = 0; i < count; i++) {
+        ctx.nodes[i].Start = (i * 2654435761u) % ctx.range;
+        ctx.nodes[i].End = ctx.nodes[i].Start + (i * 40503) % 256 + 1;
+        RtInsertIntervalTree(&ctx.tree, &ctx.nodes[i]);
+    }
+
+    static const uint64_t query_sizes[] = {1, 64, 4096};
+    for (size_t i = 0; i < BENCH_COUNT(query_sizes); i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "%zu, query %llu", count, (unsigned long long)query_sizes[i]);
+        ctx.query_size = query_sizes[i];
+        bench_report("interval query", name, bench_measure(run_interval_query, &ctx), -1);
+    }
+
+    free(ctx.nodes);
+}
+
+int main(void) {
+    bench_header("red-black/AVL trees (libc: tsearch)");
+    compare_trees(1024);
+    compare_trees(1 << 18);
+
+    bench_header("interval tree");
+    measure_intervals(1024);
+    measure_intervals(1 << 18);
+    return 0;
+}
@@ -0,0 +1,20 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Stand-in for the CPUID based __get_cpu_features(), linked into each of the string variant
+ * libraries, so that memcpy/memset resolve to a fixed implementation (given by
+ * HOST_CPU_FEATURES) instead of the best one for the host processor. */
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function returns the CPU features this variant was built for.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Bitmask of __CPU_FEATURE_* values.
+ *-----------------------------------------------------------------------------------------------*/
+int __get_cpu_features(void) {
+    return HOST_CPU_FEATURES;
+}
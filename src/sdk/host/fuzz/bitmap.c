@@ -0,0 +1,219 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <host.h>
+#include <rt/bitmap.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The input is a bitmap size, followed by a list of operations (5 bytes each: the operation, and
+ * two 16-bit arguments). We mirror everything into a plain byte array, and check each search
+ * against a naive scan of that. */
+
+#define MAX_BITS 1024
+#define MAX_OPS 32
+
+enum {
+    OP_SET_BITS,
+    OP_CLEAR_BITS,
+    OP_SET_BIT,
+    OP_CLEAR_BIT,
+    OP_SET_ALL,
+    OP_CLEAR_ALL,
+    OP_FIND_CLEAR,
+    OP_FIND_SET,
+    OP_FIND_CLEAR_AND_SET,
+    OP_FIND_SET_AND_CLEAR,
+    OP_COUNT,
+};
+
+static uint8_t reference[MAX_BITS];
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function finds a row of equal bits in the reference bitmap, the same way the Rt
+ *     functions are documented to: The first row starting at or after the hint, or if there's
+ *     none, the first row starting before the hint.
+ *
+ * PARAMETERS:
+ *     bits - Size of the bitmap.
+ *     hint - Where to start searching.
+ *     count - Size of the row.
+ *     value - Which value all bits should have.
+ *
+ * RETURN VALUE:
+ *     First bit of the row, or -1 if there's none.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t find_row(uint64_t bits, uint64_t hint, uint64_t count, uint8_t value) {
+    if (hint >= bits) {
+        hint = 0;
+    }
+
+    if (count > bits) {
+        return -1;
+    } else if (!count) {
+        return hint;
+    }
+
+    /* Size of the row starting at each bit. */
+    static uint64_t rows[MAX_BITS + 1];
+    rows[bits] = 0;
+    for (uint64_t i = bits; i--;) {
+        rows[i] = reference[i] == value ? rows[i + 1] + 1 : 0;
+    }
+
+    for (uint64_t start = hint; start + count <= bits; start++) {
+        if (rows[start] >= count) {
+            return start;
+        }
+    }
+
+    for (uint64_t start = 0; start < hint && start + count <= bits; start++) {
+        if (rows[start] >= count) {
+            return start;
+        }
+    }
+
+    return -1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function compares the result of a search against the reference, aborting if they
+ *     don't match.
+ *
+ * PARAMETERS:
+ *     name - Which function was called.
+ *     bits - Size of the bitmap.
+ *     hint - Where the search started.
+ *     count - Size of the row.
+ *     result - What the Rt function returned.
+ *     expected - What the reference returned.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_result(
+    const char *name,
+    uint64_t bits,
+    uint64_t hint,
+    uint64_t count,
+    uint64_t result,
+    uint64_t expected) {
+    if (result != expected) {
+        fprintf(
+            stderr,
+            "%s(bits=%llu, hint=%llu, count=%llu) returned %lld, expected %lld\n",
+            name,
+            (unsigned long long)bits,
+            (unsigned long long)hint,
+            (unsigned long long)count,
+            (long long)result,
+            (long long)expected);
+        abort();
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks that the bitmap contents still match the reference.
+ *
+ * PARAMETERS:
+ *     bitmap - Bitmap to check.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_contents(RtBitmap *bitmap) {
+    for (uint64_t i = 0; i < bitmap->NumberOfBits; i++) {
+        if (((bitmap->Buffer[i >> 6] >> (i & 63)) & 1) != reference[i]) {
+            fprintf(stderr, "bit %llu doesn't match the reference\n", (unsigned long long)i);
+            abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+
+    uint64_t bits = (data[0] | (data[1] << 8)) % MAX_BITS + 1;
+    data += 2;
+    size -= 2;
+
+    /* Whatever is past the end of the bitmap (in the last word) is garbage, and shouldn't
+     * change any of the results. */
+    uint64_t buffer[MAX_BITS / 64];
+    RtBitmap bitmap;
+    memset(buffer, 0xA5, sizeof(buffer));
+    RtInitializeBitmap(&bitmap, buffer, bits);
+    RtClearBits(&bitmap, 0, bits);
+    memset(reference, 0, sizeof(reference));
+
+    for (int op = 0; op < MAX_OPS && size >= 5; op++, data += 5, size -= 5) {
+        uint64_t a = (data[1] | (data[2] << 8)) % (bits + 1);
+        uint64_t b = (data[3] | (data[4] << 8)) % (bits + 2);
+        uint64_t start = a < bits ? a : bits - 1;
+        uint64_t count = b <= bits - start ? b : bits - start;
+        uint64_t result, expected;
+
+        switch (data[0] % OP_COUNT) {
+            case OP_SET_BITS:
+                RtSetBits(&bitmap, start, count);
+                memset(reference + start, 1, count);
+                break;
+            case OP_CLEAR_BITS:
+                RtClearBits(&bitmap, start, count);
+                memset(reference + start, 0, count);
+                break;
+            case OP_SET_BIT:
+                RtSetBit(&bitmap, start);
+                reference[start] = 1;
+                break;
+            case OP_CLEAR_BIT:
+                RtClearBit(&bitmap, start);
+                reference[start] = 0;
+                break;
+            case OP_SET_ALL:
+                RtSetAllBits(&bitmap);
+                memset(reference, 1, bits);
+                break;
+            case OP_CLEAR_ALL:
+                RtClearAllBits(&bitmap);
+                memset(reference, 0, bits);
+                break;
+            case OP_FIND_CLEAR:
+                result = RtFindClearBits(&bitmap, a, b);
+                expected = find_row(bits, a, b, 0);
+                check_result("RtFindClearBits", bits, a, b, result, expected);
+                break;
+            case OP_FIND_SET:
+                result = RtFindSetBits(&bitmap, a, b);
+                expected = find_row(bits, a, b, 1);
+                check_result("RtFindSetBits", bits, a, b, result, expected);
+                break;
+            case OP_FIND_CLEAR_AND_SET:
+                result = RtFindClearBitsAndSet(&bitmap, a, b);
+                expected = find_row(bits, a, b, 0);
+                check_result("RtFindClearBitsAndSet", bits, a, b, result, expected);
+                if (expected != (uint64_t)-1) {
+                    memset(reference + expected, 1, b);
+                }
+                break;
+            case OP_FIND_SET_AND_CLEAR:
+                result = RtFindSetBitsAndClear(&bitmap, a, b);
+                expected = find_row(bits, a, b, 1);
+                check_result("RtFindSetBitsAndClear", bits, a, b, result, expected);
+                if (expected != (uint64_t)-1) {
+                    memset(reference + expected, 0, b);
+                }
+                break;
+        }
+
+        check_contents(&bitmap);
+    }
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Minimal stand-in for the libFuzzer main, used when we're not being built with Clang. It
+ * understands `-runs=N`, `-seed=N` and `-max_len=N` (and ignores any other flag), runs any files
+ * given on the command line as inputs, and otherwise feeds random inputs into the target. There's
+ * no coverage feedback, so this is mostly good for smoke testing and reproducing crashes. */
+
+#define DEFAULT_RUNS 100000
+#define DEFAULT_MAX_LEN 4096
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint64_t state = 0x9E3779B97F4A7C15ull;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function generates the next pseudo-random number (xorshift64*).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Random 64-bit value.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t next_random(void) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1Dull;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs the contents of a file through the target.
+ *
+ * PARAMETERS:
+ *     path - Which file to load.
+ *
+ * RETURN VALUE:
+ *     0 on success, 1 if we couldn't read the file.
+ *-----------------------------------------------------------------------------------------------*/
+static int run_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "couldn't open %s\n", path);
+        return 1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = malloc(size > 0 ? size : 1);
+    if (!data || fread(data, 1, size, file) != (size_t)size) {
+        fprintf(stderr, "couldn't read %s\n", path);
+        fclose(file);
+        free(data);
+        return 1;
+    }
+
+    fclose(file);
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned long long runs = DEFAULT_RUNS;
+    size_t max_len = DEFAULT_MAX_LEN;
+    int files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(argv[i], "-runs=", 6)) {
+            runs = strtoull(argv[i] + 6, NULL, 0);
+        } else if (!strncmp(argv[i], "-seed=", 6)) {
+            state = strtoull(argv[i] + 6, NULL, 0) | 1;
+        } else if (!strncmp(argv[i], "-max_len=", 9)) {
+            max_len = strtoull(argv[i] + 9, NULL, 0);
+        } else if (argv[i][0] != '-') {
+            if (run_file(argv[i])) {
+                return 1;
+            }
+
+            files++;
+        }
+    }
+
+    if (files) {
+        return 0;
+    }
+
+    uint8_t *data = malloc(max_len ? max_len : 1);
+    if (!data) {
+        return 1;
+    }
+
+    /* Short inputs are a lot more likely to parse into something interesting, so bias the size
+     * towards them. */
+    for (unsigned long long run = 0; run < runs; run++) {
+        size_t size = next_random() % (max_len + 1);
+        if (next_random() & 1) {
+            size %= 64;
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            data[i] = next_random();
+        }
+
+        LLVMFuzzerTestOneInput(data, size);
+    }
+
+    free(data);
+    printf("done %llu runs\n", runs);
+    return 0;
+}
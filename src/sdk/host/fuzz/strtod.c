@@ -0,0 +1,102 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <host.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Differential target; strtof/strtod/strtold should give the same (correctly rounded) value as
+ * the host libc, and stop at the same place. Random bytes rarely look like a number, so unless
+ * the low bit of the first byte is set, we map every byte into characters that show up in
+ * floating point strings. */
+
+#define MAX_INPUT 512
+
+static const char alphabet[] = "0123456789012345678901234567890123456789..eE+-xXpPabcdefinty( ";
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function aborts with a description of the mismatch.
+ *
+ * PARAMETERS:
+ *     name - Which function mismatched.
+ *     input - String that was parsed.
+ *     ours - Our result, formatted as a hex float.
+ *     host - Host result, formatted as a hex float.
+ *     ours_end - Where we stopped parsing.
+ *     host_end - Where the host libc stopped parsing.
+ *
+ * RETURN VALUE:
+ *     Does not return.
+ *-----------------------------------------------------------------------------------------------*/
+static void report(
+    const char *name,
+    const char *input,
+    const char *ours,
+    const char *host,
+    size_t ours_end,
+    size_t host_end) {
+    fprintf(
+        stderr,
+        "%s(\"%s\") = %s (end %zu), expected %s (end %zu)\n",
+        name,
+        input,
+        ours,
+        ours_end,
+        host,
+        host_end);
+    abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    char input[MAX_INPUT + 1];
+
+    if (!size) {
+        return 0;
+    }
+
+    int mapped = !(data[0] & 1);
+    data++;
+    size = size - 1 > MAX_INPUT ? MAX_INPUT : size - 1;
+
+    for (size_t i = 0; i < size; i++) {
+        input[i] = mapped ? alphabet[data[i] % (sizeof(alphabet) - 1)] : (char)data[i];
+    }
+
+    input[size] = 0;
+
+    char *ours_end, *host_end;
+    char ours_text[64], host_text[64];
+
+    float ours_float = host_strtof(input, &ours_end);
+    float host_float = strtof(input, &host_end);
+    if (ours_end != host_end || (isnan(ours_float) != isnan(host_float)) ||
+        (!isnan(host_float) && memcmp(&ours_float, &host_float, sizeof(float)))) {
+        snprintf(ours_text, sizeof(ours_text), "%a", ours_float);
+        snprintf(host_text, sizeof(host_text), "%a", host_float);
+        report("strtof", input, ours_text, host_text, ours_end - input, host_end - input);
+    }
+
+    double ours_double = host_strtod(input, &ours_end);
+    double host_double = strtod(input, &host_end);
+    if (ours_end != host_end || (isnan(ours_double) != isnan(host_double)) ||
+        (!isnan(host_double) && memcmp(&ours_double, &host_double, sizeof(double)))) {
+        snprintf(ours_text, sizeof(ours_text), "%a", ours_double);
+        snprintf(host_text, sizeof(host_text), "%a", host_double);
+        report("strtod", input, ours_text, host_text, ours_end - input, host_end - input);
+    }
+
+    /* Only the first 10 bytes of a long double hold the value; Leave the padding out. */
+    long double ours_long = host_strtold(input, &ours_end);
+    long double host_long = strtold(input, &host_end);
+    if (ours_end != host_end || (isnan(ours_long) != isnan(host_long)) ||
+        (!isnan(host_long) && memcmp(&ours_long, &host_long, 10))) {
+        snprintf(ours_text, sizeof(ours_text), "%La", ours_long);
+        snprintf(host_text, sizeof(host_text), "%La", host_long);
+        report("strtold", input, ours_text, host_text, ours_end - input, host_end - input);
+    }
+
+    return 0;
+}
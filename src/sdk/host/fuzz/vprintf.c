@@ -0,0 +1,227 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <host.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Differential target for __vprintf; The input gets turned into a list of conversion specs (one
+ * at a time, so that the arguments always match the format), each of which should produce the
+ * same output as the host libc. Anything the standard leaves undefined (or implementation
+ * defined, like %p) is left out. Each spec takes 16 bytes of input: conversion, flags, width,
+ * precision, length modifier, 3 unused bytes, and an 8-byte value (%s uses its first byte as
+ * the string length). */
+
+#define OUTPUT_SIZE 8192
+#define SPEC_SIZE 16
+
+typedef struct {
+    char *buffer;
+    size_t size;
+} output_t;
+
+static const char conversions[] = "diuoxXcsfFeEgG%";
+static const char *const int_lengths[] = {"", "hh", "h", "l", "ll", "j", "z", "t"};
+static char ours[OUTPUT_SIZE], host[OUTPUT_SIZE];
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function appends the output of __vprintf to the output buffer.
+ *
+ * PARAMETERS:
+ *     buffer - What to append.
+ *     size - How many bytes to append.
+ *     context - Output buffer.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void put_buf(const void *buffer, int size, void *context) {
+    output_t *output = context;
+    if (output->size + size < OUTPUT_SIZE) {
+        memcpy(output->buffer + output->size, buffer, size);
+    }
+
+    output->size += size;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions format the arguments using each implementation.
+ *
+ * PARAMETERS:
+ *     buffer - Where to store the output (OUTPUT_SIZE bytes).
+ *     format - Format string.
+ *     ... - Arguments for the format string.
+ *
+ * RETURN VALUE:
+ *     How many characters were written.
+ *-----------------------------------------------------------------------------------------------*/
+static int format_ours(char *buffer, const char *format, ...) {
+    output_t output = {buffer, 0};
+    va_list vlist;
+    va_start(vlist, format);
+    int result = host___vprintf(format, vlist, &output, put_buf);
+    va_end(vlist);
+    buffer[output.size < OUTPUT_SIZE ? output.size : OUTPUT_SIZE - 1] = 0;
+    return result;
+}
+
+static int format_host(char *buffer, const char *format, ...) {
+    va_list vlist;
+    va_start(vlist, format);
+    int result = vsnprintf(buffer, OUTPUT_SIZE, format, vlist);
+    va_end(vlist);
+    return result;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function builds the format string for a single conversion.
+ *
+ * PARAMETERS:
+ *     spec - Input bytes describing the conversion.
+ *     format - Output; Format string.
+ *
+ * RETURN VALUE:
+ *     Which conversion character we picked.
+ *-----------------------------------------------------------------------------------------------*/
+static char build_format(const uint8_t *spec, char *format) {
+    char conversion = conversions[spec[0] % (sizeof(conversions) - 1)];
+    int is_signed = strchr("dieEfFgG", conversion) != NULL;
+    int is_float = strchr("eEfFgG", conversion) != NULL;
+    int is_integer = strchr("diuoxX", conversion) != NULL;
+
+    *(format++) = '%';
+
+    if (conversion != '%') {
+        if (spec[1] & 0x01) {
+            *(format++) = '-';
+        }
+
+        if ((spec[1] & 0x02) && is_signed) {
+            *(format++) = '+';
+        }
+
+        if ((spec[1] & 0x04) && is_signed) {
+            *(format++) = ' ';
+        }
+
+        if ((spec[1] & 0x08) && (is_float || strchr("oxX", conversion))) {
+            *(format++) = '#';
+        }
+
+        if ((spec[1] & 0x10) && (is_float || is_integer)) {
+            *(format++) = '0';
+        }
+
+        if (spec[2] & 0x80) {
+            format += sprintf(format, "%d", spec[2] & 0x3F);
+        }
+
+        if ((spec[3] & 0x80) && conversion != 'c') {
+            format += sprintf(format, ".%d", spec[3] % 48);
+        }
+
+        if (is_integer) {
+            format += sprintf(format, "%s", int_lengths[spec[4] % 8]);
+        } else if (is_float && (spec[4] & 1)) {
+            *(format++) = 'L';
+        }
+    }
+
+    *(format++) = conversion;
+    *format = 0;
+    return conversion;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function formats a single argument with both implementations.
+ *
+ * PARAMETERS:
+ *     format - Format string (containing a single conversion).
+ *     conversion - Which conversion the format uses.
+ *     spec - Input bytes describing the conversion.
+ *     string - String argument for %s.
+ *     ours_result - Output; Return value of our implementation.
+ *     host_result - Output; Return value of the host implementation.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void run_both(
+    const char *format,
+    char conversion,
+    const uint8_t *spec,
+    const char *string,
+    int *ours_result,
+    int *host_result) {
+    uint64_t bits;
+    memcpy(&bits, spec + 8, sizeof(bits));
+
+    if (conversion == '%') {
+        *ours_result = format_ours(ours, format);
+        *host_result = format_host(host, format);
+    } else if (conversion == 'c') {
+        *ours_result = format_ours(ours, format, (int)(bits & 0xFF));
+        *host_result = format_host(host, format, (int)(bits & 0xFF));
+    } else if (conversion == 's') {
+        *ours_result = format_ours(ours, format, string);
+        *host_result = format_host(host, format, string);
+    } else if (strchr("eEfFgG", conversion) && strchr(format, 'L')) {
+        /* Long doubles only get printed at double precision, so only use values that fit in a
+         * double (but still go through the long double path). */
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        long double long_value = value;
+        *ours_result = format_ours(ours, format, long_value);
+        *host_result = format_host(host, format, long_value);
+    } else if (strchr("eEfFgG", conversion)) {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        *ours_result = format_ours(ours, format, value);
+        *host_result = format_host(host, format, value);
+    } else {
+        /* Every integer length fits in (and gets passed as) at most 64 bits; The promotion rules
+         * take care of the smaller ones. */
+        *ours_result = format_ours(ours, format, bits);
+        *host_result = format_host(host, format, bits);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    while (size >= SPEC_SIZE) {
+        const uint8_t *spec = data;
+        data += SPEC_SIZE;
+        size -= SPEC_SIZE;
+
+        /* %s takes its string from the rest of the input (up to the given length). */
+        char string[256];
+        size_t length = spec[8] < size ? spec[8] : size;
+        memcpy(string, data, length);
+        string[length] = 0;
+
+        char format[32];
+        char conversion = build_format(spec, format);
+
+        int ours_result, host_result;
+        run_both(format, conversion, spec, string, &ours_result, &host_result);
+
+        if (ours_result != host_result || strcmp(ours, host)) {
+            fprintf(
+                stderr,
+                "format \"%s\": got \"%s\" (%d), expected \"%s\" (%d)\n",
+                format,
+                ours,
+                ours_result,
+                host,
+                host_result);
+            abort();
+        }
+    }
+
+    return 0;
+}
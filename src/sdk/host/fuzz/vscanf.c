@@ -0,0 +1,126 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <host.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Robustness target for __vscanf (through sscanf); The first few bytes of the input describe up
+ * to MAX_CONVERSIONS conversion specs (4 bytes each: conversion, width, length modifier, and what
+ * separates it from the next spec), and the rest is the string to be parsed. This isn't
+ * differential, as we report input/matching failures differently than the host libc in a few
+ * places (EOF instead of 0); Instead, we check that the result is in range, and that nothing
+ * gets written past the size of each destination. */
+
+#define MAX_CONVERSIONS 4
+#define SPEC_SIZE 4
+#define DEST_SIZE 64
+
+static const char conversions[] = "diuoxXcs%";
+static const char *const int_lengths[] = {"", "hh", "h", "l", "ll", "j", "z", "t"};
+static const int int_sizes[] = {4, 1, 2, 8, 8, 8, 8, 8};
+static const char separators[] = " ,:x-";
+static const char alphabet[] = "0123456789abcdefxX+- \t\n,:";
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function builds the format string out of the input.
+ *
+ * PARAMETERS:
+ *     data - Input bytes describing the conversions.
+ *     count - How many conversions to build.
+ *     format - Output; Format string.
+ *     sizes - Output; How many bytes each argument can take.
+ *
+ * RETURN VALUE:
+ *     How many arguments the format takes.
+ *-----------------------------------------------------------------------------------------------*/
+static int build_format(const uint8_t *data, int count, char *format, int *sizes) {
+    int arguments = 0;
+
+    for (int i = 0; i < count; i++, data += SPEC_SIZE) {
+        char conversion = conversions[data[0] % (sizeof(conversions) - 1)];
+        *(format++) = '%';
+
+        /* %s and %c always get a width, so that they can't overflow the destination. */
+        if (conversion == 's' || conversion == 'c') {
+            int width = data[1] % (DEST_SIZE - 1) + 1;
+            format += sprintf(format, "%d", width);
+            sizes[arguments++] = conversion == 's' ? width + 1 : width;
+        } else if (conversion != '%' && (data[1] & 0x80)) {
+            format += sprintf(format, "%d", data[1] % 24 + 1);
+        }
+
+        if (strchr("diuoxX", conversion)) {
+            format += sprintf(format, "%s", int_lengths[data[2] % 8]);
+            sizes[arguments++] = int_sizes[data[2] % 8];
+        }
+
+        *(format++) = conversion;
+
+        if (data[3] & 1) {
+            *(format++) = separators[(data[3] >> 1) % (sizeof(separators) - 1)];
+        }
+    }
+
+    *format = 0;
+    return arguments;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 1) {
+        return 0;
+    }
+
+    int count = data[0] % MAX_CONVERSIONS + 1;
+    int mapped = data[0] & 0x80;
+    data++;
+    size--;
+
+    if (size < count * SPEC_SIZE) {
+        return 0;
+    }
+
+    char format[MAX_CONVERSIONS * 16];
+    int sizes[MAX_CONVERSIONS];
+    int arguments = build_format(data, count, format, sizes);
+    data += count * SPEC_SIZE;
+    size -= count * SPEC_SIZE;
+
+    char *input = malloc(size + 1);
+    if (!input) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        input[i] = mapped ? alphabet[data[i] % (sizeof(alphabet) - 1)] : (char)data[i];
+    }
+
+    input[size] = 0;
+
+    uint8_t dest[MAX_CONVERSIONS][DEST_SIZE];
+    memset(dest, 0xCC, sizeof(dest));
+
+    int result = host_sscanf(input, format, dest[0], dest[1], dest[2], dest[3]);
+    int failed = result < -1 || result > arguments;
+
+    for (int i = 0; !failed && i < MAX_CONVERSIONS; i++) {
+        for (int j = i < arguments ? sizes[i] : 0; j < DEST_SIZE; j++) {
+            failed |= dest[i][j] != 0xCC;
+        }
+    }
+
+    if (failed) {
+        fprintf(
+            stderr,
+            "sscanf(\"%s\", \"%s\") returned %d, or wrote past a destination\n",
+            input,
+            format,
+            result);
+        abort();
+    }
+
+    free(input);
+    return 0;
+}
@@ -0,0 +1,22 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Runs the operation being measured `iterations` times. */
+typedef void (*bench_fn_t)(void *context, size_t iterations);
+
+#define BENCH_COUNT(array) (sizeof(array) / sizeof(*(array)))
+
+/* Hides a value from the optimizer, so that the work producing it can't be thrown away. */
+#define BENCH_CONSUME(value) __asm__ volatile("" : : "g"(value) : "memory")
+
+double bench_measure(bench_fn_t fn, void *context);
+void bench_header(const char *title);
+void bench_report(const char *routine, const char *variant, double ours, double host);
+
+#endif /* BENCH_H */
@@ -0,0 +1,151 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Everything inside the host build of the SDK has a `host_` prefix (see CMakeLists.txt), so that
+ * it can live next to the host libc. The rt headers can be used as-is after including this, as we
+ * rename their functions below; For the CRT, we declare the prefixed functions ourselves (its
+ * headers would shadow the ones from the host libc). */
+
+#define RtInitializeBitmap host_RtInitializeBitmap
+#define RtClearBit host_RtClearBit
+#define RtClearBits host_RtClearBits
+#define RtClearAllBits host_RtClearAllBits
+#define RtSetBit host_RtSetBit
+#define RtSetBits host_RtSetBits
+#define RtSetAllBits host_RtSetAllBits
+#define RtFindClearBits host_RtFindClearBits
+#define RtFindClearBitsAndSet host_RtFindClearBitsAndSet
+#define RtFindSetBits host_RtFindSetBits
+#define RtFindSetBitsAndClear host_RtFindSetBitsAndClear
+
+#define RtGetHash host_RtGetHash
+#define RtGetXxh64Hash host_RtGetXxh64Hash
+#define RtGetXxh3Hash host_RtGetXxh3Hash
+#define RtInitializeXxh3State host_RtInitializeXxh3State
+#define RtUpdateXxh3State host_RtUpdateXxh3State
+#define RtGetXxh3Digest host_RtGetXxh3Digest
+#define RtGetCrc32c host_RtGetCrc32c
+
+#define RtInitializeHashTable host_RtInitializeHashTable
+#define RtFreeHashTable host_RtFreeHashTable
+#define RtInsertHashTable host_RtInsertHashTable
+#define RtLookupHashTable host_RtLookupHashTable
+#define RtRemoveHashTable host_RtRemoveHashTable
+
+#define RtPushSList host_RtPushSList
+#define RtPopSList host_RtPopSList
+#define RtPushAtomicSList host_RtPushAtomicSList
+#define RtPushBatchAtomicSList host_RtPushBatchAtomicSList
+#define RtPopAtomicSList host_RtPopAtomicSList
+#define RtFlushAtomicSList host_RtFlushAtomicSList
+#define RtInitializeDList host_RtInitializeDList
+#define RtPushDList host_RtPushDList
+#define RtAppendDList host_RtAppendDList
+#define RtPopDList host_RtPopDList
+#define RtTruncateDList host_RtTruncateDList
+#define RtUnlinkDList host_RtUnlinkDList
+
+#define RtInitializeSpscRing host_RtInitializeSpscRing
+#define RtPushSpscRing host_RtPushSpscRing
+#define RtPushBatchSpscRing host_RtPushBatchSpscRing
+#define RtPopSpscRing host_RtPopSpscRing
+#define RtPopBatchSpscRing host_RtPopBatchSpscRing
+#define RtInitializeMpmcRing host_RtInitializeMpmcRing
+#define RtPushMpmcRing host_RtPushMpmcRing
+#define RtPushBatchMpmcRing host_RtPushBatchMpmcRing
+#define RtPopMpmcRing host_RtPopMpmcRing
+#define RtPopBatchMpmcRing host_RtPopBatchMpmcRing
+
+#define RtInitializeTree host_RtInitializeTree
+#define RtLookupTree host_RtLookupTree
+#define RtLookupLowerBoundTree host_RtLookupLowerBoundTree
+#define RtLookupUpperBoundTree host_RtLookupUpperBoundTree
+#define RtGetFirstTreeNode host_RtGetFirstTreeNode
+#define RtGetLastTreeNode host_RtGetLastTreeNode
+#define RtGetNextTreeNode host_RtGetNextTreeNode
+#define RtGetPreviousTreeNode host_RtGetPreviousTreeNode
+#define RtInsertRbTree host_RtInsertRbTree
+#define RtRemoveRbTree host_RtRemoveRbTree
+#define RtInsertAvlTree host_RtInsertAvlTree
+#define RtRemoveAvlTree host_RtRemoveAvlTree
+#define RtInitializeIntervalTree host_RtInitializeIntervalTree
+#define RtInsertIntervalTree host_RtInsertIntervalTree
+#define RtRemoveIntervalTree host_RtRemoveIntervalTree
+#define RtLookupIntervalTree host_RtLookupIntervalTree
+#define RtLookupNextIntervalTree host_RtLookupNextIntervalTree
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+int host_isalnum(int ch);
+int host_isalpha(int ch);
+int host_isdigit(int ch);
+int host_isspace(int ch);
+int host_isxdigit(int ch);
+int host_tolower(int ch);
+int host_toupper(int ch);
+
+int host___vprintf(
+    const char *format,
+    va_list vlist,
+    void *context,
+    void (*put_buf)(const void *buffer, int size, void *context));
+int host___vscanf(
+    const char *format,
+    va_list vlist,
+    void *context,
+    int (*read_ch)(void *context),
+    void (*unread_ch)(void *context, int ch));
+int host_snprintf(char *buffer, size_t bufsz, const char *format, ...);
+int host_vsnprintf(char *buffer, size_t bufsz, const char *format, va_list vlist);
+int host_sprintf(char *buffer, const char *format, ...);
+int host_sscanf(const char *buffer, const char *format, ...);
+int host_vsscanf(const char *buffer, const char *format, va_list vlist);
+
+void *host_malloc(size_t size);
+void *host_calloc(size_t num, size_t size);
+void host_free(void *ptr);
+int host_atoi(const char *str);
+long host_strtol(const char *str, char **str_end, int base);
+long long host_strtoll(const char *str, char **str_end, int base);
+unsigned long host_strtoul(const char *str, char **str_end, int base);
+unsigned long long host_strtoull(const char *str, char **str_end, int base);
+float host_strtof(const char *str, char **str_end);
+double host_strtod(const char *str, char **str_end);
+long double host_strtold(const char *str, char **str_end);
+int host_rand(void);
+void host_srand(unsigned seed);
+
+void *host_memccpy(void *dest, const void *src, int c, size_t count);
+void *host_memchr(const void *ptr, int ch, size_t count);
+int host_memcmp(const void *lhs, const void *rhs, size_t count);
+void *host_memcpy(void *dest, const void *src, size_t count);
+void *host_memmove(void *dest, const void *src, size_t count);
+void *host_memset(void *dest, int ch, size_t count);
+char *host_strcat(char *dest, const char *src);
+char *host_strchr(const char *str, int ch);
+int host_strcmp(const char *lhs, const char *rhs);
+char *host_strcpy(char *dest, const char *src);
+size_t host_strcspn(const char *dest, const char *src);
+size_t host_strlen(const char *str);
+char *host_strncat(char *dest, const char *src, size_t count);
+int host_strncmp(const char *lhs, const char *rhs, size_t count);
+char *host_strncpy(char *dest, const char *src, size_t count);
+char *host_strpbrk(const char *dest, const char *breakset);
+char *host_strrchr(const char *str, int ch);
+size_t host_strspn(const char *dest, const char *src);
+char *host_strstr(const char *str, const char *substr);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* HOST_H */
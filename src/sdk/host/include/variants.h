@@ -0,0 +1,42 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef VARIANTS_H
+#define VARIANTS_H
+
+#include <stddef.h>
+
+/* Every implementation the memcpy/memset dispatch can pick, with the __CPU_FEATURE_* bits that
+ * select it. Each one gets built into its own library (see CMakeLists.txt), with the symbols
+ * prefixed by `host_<name>_`. The last argument says if the variant needs AVX2 to run. */
+#define HOST_STRING_VARIANTS(X) \
+    X(sse2, 0x00, 0)            \
+    X(erms, 0x01, 0)            \
+    X(fsrm, 0x03, 0)            \
+    X(avx2, 0x04, 1)            \
+    X(avx2_fsrm, 0x07, 1)
+
+#define HOST_DECLARE_VARIANT(name, features, avx2)                          \
+    void *host_##name##_memcpy(void *dest, const void *src, size_t count);  \
+    void *host_##name##_memmove(void *dest, const void *src, size_t count); \
+    void *host_##name##_memset(void *dest, int ch, size_t count);
+
+HOST_STRING_VARIANTS(HOST_DECLARE_VARIANT)
+
+typedef struct {
+    const char *name;
+    int avx2;
+    void *(*memcpy)(void *dest, const void *src, size_t count);
+    void *(*memmove)(void *dest, const void *src, size_t count);
+    void *(*memset)(void *dest, int ch, size_t count);
+} host_variant_t;
+
+#define HOST_VARIANT_ENTRY(name, features, avx2) \
+    {#name, avx2, host_##name##_memcpy, host_##name##_memmove, host_##name##_memset},
+
+/* All of the variants, followed by the regular (dispatched) build of the library. */
+#define HOST_VARIANT_TABLE                    \
+    {HOST_STRING_VARIANTS(HOST_VARIANT_ENTRY) \
+     {"dispatch", 0, host_memcpy, host_memmove, host_memset}}
+
+#endif /* VARIANTS_H */
@@ -0,0 +1,41 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <sys/mman.h>
+
+/* What the SDK expects the OS to give it; The user mode CRT gets pages from the kernel, and we
+ * get them from the host kernel. */
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function allocates a range of zeroed pages for the allocator.
+ *
+ * PARAMETERS:
+ *     pages - How many pages we need.
+ *
+ * RETURN VALUE:
+ *     Start of the range, or NULL if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+void *host___allocate_pages(size_t pages) {
+    void *base =
+        mmap(NULL, pages << 12, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function returns a range of pages previously allocated with __allocate_pages.
+ *
+ * PARAMETERS:
+ *     base - Start of the range.
+ *     pages - Size of the range, in pages.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void host___free_pages(void *base, size_t pages) {
+    munmap(base, pages << 12);
+}
@@ -0,0 +1,39 @@
+# SPDX-FileCopyrightText: (C) 2025 ilmmatias
+# SPDX-License-Identifier: GPL-3.0-or-later
+
+# Prefixes every symbol of a static library (so that it can be linked next to the host libc),
+# except for the undefined symbols that the compiler itself generates references to (the GOT, and
+# the sanitizer/coverage runtimes); Those need to keep pointing at the real thing.
+#
+# Usage: cmake -DOBJCOPY=<objcopy> -DNM=<nm> -DLIBRARY=<path> -DPREFIX=<prefix> -P prefix.cmake
+
+cmake_minimum_required(VERSION 3.21)
+
+execute_process(
+    COMMAND ${NM} --undefined-only --format=just-symbols ${LIBRARY}
+    OUTPUT_VARIABLE UNDEFINED
+    COMMAND_ERROR_IS_FATAL ANY)
+
+string(REPLACE "\n" ";" UNDEFINED "${UNDEFINED}")
+list(REMOVE_DUPLICATES UNDEFINED)
+
+string(
+    CONCAT KEEP_PATTERN
+    "^(_GLOBAL_OFFSET_TABLE_|__asan_|__ubsan_|__sanitizer_|__sancov_|"
+    "__start___sancov|__stop___sancov)")
+
+set(REDEFINE_LIST "")
+foreach(SYMBOL IN LISTS UNDEFINED)
+    if(SYMBOL MATCHES "${KEEP_PATTERN}")
+        string(APPEND REDEFINE_LIST "${PREFIX}${SYMBOL} ${SYMBOL}\n")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${OBJCOPY} --prefix-symbols=${PREFIX} ${LIBRARY} COMMAND_ERROR_IS_FATAL ANY)
+
+if(REDEFINE_LIST)
+    file(WRITE ${LIBRARY}.redefine "${REDEFINE_LIST}")
+    execute_process(
+        COMMAND ${OBJCOPY} --redefine-syms=${LIBRARY}.redefine ${LIBRARY}
+        COMMAND_ERROR_IS_FATAL ANY)
+endif()
@@ -0,0 +1,360 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#define _DEFAULT_SOURCE
+
+#include <host.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <variants.h>
+
+/* Checks the string routines against the host libc. memcpy/memmove/memset get checked for every
+ * variant the dispatch can pick (across all destination alignments for small sizes, and a few
+ * alignments for the sizes that change which path gets taken), including that nothing outside
+ * the destination gets touched. The routines that read ahead of the string are checked right
+ * at the end of a page followed by an inaccessible one. */
+
+#define GUARD 128
+#define GUARD_BYTE 0xEE
+#define SMALL_LENGTH 300
+#define MAX_LENGTH ((4 << 20) + 4096)
+#define BUFFER_SIZE (MAX_LENGTH * 2 + GUARD * 4)
+#define PAGE_SIZE 4096
+#define MAX_REPORTS 20
+
+static const size_t large_lengths[] = {
+    511,
+    512,
+    513,
+    1024,
+    2047,
+    2048,
+    2049,
+    4096,
+    65536 + 13,
+    (4 << 20) - 1,
+    4 << 20,
+    (4 << 20) + 129,
+};
+
+static const size_t source_alignments[] = {0, 1, 7, 8, 15, 16, 33, 63};
+static const size_t large_alignments[][2] = {{0, 0}, {1, 0}, {0, 1}, {33, 7}, {63, 63}};
+
+static uint8_t *source, *ours, *host;
+static int failures;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reports a mismatch (only the first few get printed).
+ *
+ * PARAMETERS:
+ *     format - Description of what went wrong.
+ *     ... - Arguments for the format string.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void fail(const char *format, ...) {
+    if (failures++ < MAX_REPORTS) {
+        va_list vlist;
+        va_start(vlist, format);
+        vfprintf(stderr, format, vlist);
+        va_end(vlist);
+        fputc('\n', stderr);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function compares our output buffer against the host one, including the guard area
+ *     around the destination.
+ *
+ * PARAMETERS:
+ *     routine - Which routine was tested.
+ *     variant - Which variant of the routine was tested.
+ *     offset - Start of the destination in the buffers.
+ *     length - Size of the destination.
+ *     alignment - Source alignment (or any other argument worth printing).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_output(
+    const char *routine,
+    const char *variant,
+    size_t offset,
+    size_t length,
+    size_t alignment) {
+    size_t start = offset - GUARD;
+    if (!memcmp(ours + start, host + start, length + GUARD * 2)) {
+        return;
+    }
+
+    size_t i = start;
+    while (ours[i] == host[i]) {
+        i++;
+    }
+
+    fail(
+        "%s (%s): dest %% 64 = %zu, length %zu, arg %zu: byte %zd is %02x, expected %02x",
+        routine,
+        variant,
+        offset % 64,
+        length,
+        alignment,
+        (ssize_t)(i - offset),
+        ours[i],
+        host[i]);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     These functions run a single memcpy/memset/memmove through both implementations, starting
+ *     from the same buffer contents.
+ *
+ * PARAMETERS:
+ *     variant - Which variant to test.
+ *     dest - Destination offset.
+ *     src - Source offset (memcpy/memmove), or byte to fill with (memset).
+ *     length - How many bytes to copy/fill.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_memcpy_once(
+    const host_variant_t *variant,
+    size_t dest,
+    size_t src,
+    size_t length) {
+    memset(ours + dest - GUARD, GUARD_BYTE, length + GUARD * 2);
+    memset(host + dest - GUARD, GUARD_BYTE, length + GUARD * 2);
+
+    if (variant->memcpy(ours + dest, source + src, length) != ours + dest) {
+        fail("memcpy (%s): wrong return value", variant->name);
+    }
+
+    memcpy(host + dest, source + src, length);
+    check_output("memcpy", variant->name, dest, length, src % 64);
+}
+
+static void test_memset_once(const host_variant_t *variant, size_t dest, int ch, size_t length) {
+    memset(ours + dest - GUARD, GUARD_BYTE, length + GUARD * 2);
+    memset(host + dest - GUARD, GUARD_BYTE, length + GUARD * 2);
+
+    if (variant->memset(ours + dest, ch, length) != ours + dest) {
+        fail("memset (%s): wrong return value", variant->name);
+    }
+
+    memset(host + dest, ch, length);
+    check_output("memset", variant->name, dest, length, ch);
+}
+
+static void test_memmove_once(
+    const host_variant_t *variant,
+    size_t dest,
+    size_t src,
+    size_t length) {
+    size_t start = (dest < src ? dest : src) - GUARD;
+    size_t size = (dest > src ? dest - src : src - dest) + length + GUARD * 2;
+    memcpy(ours + start, source + start, size);
+    memcpy(host + start, source + start, size);
+
+    if (variant->memmove(ours + dest, ours + src, length) != ours + dest) {
+        fail("memmove (%s): wrong return value", variant->name);
+    }
+
+    memmove(host + dest, host + src, length);
+
+    /* The whole range both buffers cover needs to match (not just the destination). */
+    if (memcmp(ours + start, host + start, size)) {
+        fail(
+            "memmove (%s): dest %% 64 = %zu, length %zu, src - dest = %zd",
+            variant->name,
+            dest % 64,
+            length,
+            (ssize_t)(src - dest));
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks memcpy, memset and memmove for one of the variants.
+ *
+ * PARAMETERS:
+ *     variant - Which variant to test.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_variant(const host_variant_t *variant) {
+    for (size_t length = 0; length <= SMALL_LENGTH; length++) {
+        for (size_t dest = 0; dest < 64; dest++) {
+            for (size_t i = 0; i < sizeof(source_alignments) / sizeof(*source_alignments); i++) {
+                test_memcpy_once(variant, GUARD + dest, source_alignments[i], length);
+            }
+
+            test_memset_once(variant, GUARD + dest, 0, length);
+            test_memset_once(variant, GUARD + dest, 0xA5, length);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(large_lengths) / sizeof(*large_lengths); i++) {
+        for (size_t j = 0; j < sizeof(large_alignments) / sizeof(*large_alignments); j++) {
+            size_t dest = GUARD + large_alignments[j][0];
+            size_t src = large_alignments[j][1];
+            test_memcpy_once(variant, dest, src, large_lengths[i]);
+            test_memset_once(variant, dest, 0x5A, large_lengths[i]);
+        }
+    }
+
+    /* memmove: Every small overlap in both directions, and a few big ones. */
+    size_t base = GUARD + 4096;
+    for (size_t length = 0; length <= SMALL_LENGTH; length++) {
+        for (size_t delta = 0; delta <= 70; delta++) {
+            test_memmove_once(variant, base + delta, base, length);
+            test_memmove_once(variant, base, base + delta, length);
+            test_memmove_once(variant, base + 3 + delta, base + 64, length);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(large_lengths) / sizeof(*large_lengths); i++) {
+        size_t length = large_lengths[i];
+        size_t deltas[] = {1, 31, 65, length / 2 + 7, length - 1, length + 1};
+
+        for (size_t j = 0; j < sizeof(deltas) / sizeof(*deltas); j++) {
+            test_memmove_once(variant, base + deltas[j], base, length);
+            test_memmove_once(variant, base, base + deltas[j], length);
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks the routines that read ahead (or compare/search) against the host
+ *     libc, with the data placed right before an inaccessible page.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_page_end(void) {
+    uint8_t *pages = mmap(
+        NULL, PAGE_SIZE * 4, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+        fail("couldn't map the page end test buffers");
+        return;
+    }
+
+    /* Two readable pages (lhs and rhs), each followed by a guard page. */
+    uint8_t *lhs_end = pages + PAGE_SIZE, *rhs_end = pages + PAGE_SIZE * 3;
+    mprotect(lhs_end, PAGE_SIZE, PROT_NONE);
+    mprotect(rhs_end, PAGE_SIZE, PROT_NONE);
+    memset(pages, 'a', PAGE_SIZE);
+    memset(pages + PAGE_SIZE * 2, 'a', PAGE_SIZE);
+
+    for (size_t length = 0; length < PAGE_SIZE; length++) {
+        /* Strings end with their NUL right at the end of the page. */
+        char *lhs = (char *)lhs_end - length - 1;
+        char *rhs = (char *)rhs_end - length - 1;
+        lhs[length] = 0;
+        rhs[length] = 0;
+
+        if (host_strlen(lhs) != length) {
+            fail("strlen: length %zu: got %zu", length, host_strlen(lhs));
+        }
+
+        size_t positions[] = {0, length / 2, length ? length - 1 : 0};
+        for (size_t i = 0; i < sizeof(positions) / sizeof(*positions) && length; i++) {
+            size_t position = positions[i];
+            lhs[position] = 'b';
+
+            if (host_strchr(lhs, 'b') != strchr(lhs, 'b') ||
+                host_strrchr(lhs, 'a') != strrchr(lhs, 'a')) {
+                fail("strchr/strrchr: length %zu, position %zu", length, position);
+            }
+
+            if (host_memchr(lhs, 'b', length + 1) != memchr(lhs, 'b', length + 1)) {
+                fail("memchr: length %zu, position %zu", length, position);
+            }
+
+            int ours_result = host_strcmp(lhs, rhs), host_result = strcmp(lhs, rhs);
+            if ((ours_result > 0) != (host_result > 0) || (ours_result < 0) != (host_result < 0)) {
+                fail("strcmp: length %zu, position %zu", length, position);
+            }
+
+            ours_result = host_memcmp(lhs, rhs, length + 1);
+            host_result = memcmp(lhs, rhs, length + 1);
+            if ((ours_result > 0) != (host_result > 0) || (ours_result < 0) != (host_result < 0)) {
+                fail("memcmp: length %zu, position %zu", length, position);
+            }
+
+            ours_result = host_strncmp(lhs, rhs, position);
+            if (ours_result) {
+                fail("strncmp: length %zu, position %zu: got %d", length, position, ours_result);
+            }
+
+            lhs[position] = 'a';
+        }
+
+        if (host_strcmp(lhs, rhs) || host_memcmp(lhs, rhs, length + 1) ||
+            host_strncmp(lhs, rhs, length + 8)) {
+            fail("strcmp/memcmp/strncmp: length %zu: equal strings compared different", length);
+        }
+
+        if (host_strchr(lhs, 0) != lhs + length || host_strrchr(lhs, 0) != lhs + length ||
+            host_strchr(lhs, 'b') || host_memchr(lhs, 'b', length + 1)) {
+            fail("strchr/strrchr/memchr: length %zu: wrong result when searching", length);
+        }
+
+        lhs[length] = 'a';
+        rhs[length] = 'a';
+    }
+
+    munmap(pages, PAGE_SIZE * 4);
+}
+
+int main(void) {
+    source = malloc(BUFFER_SIZE);
+    ours = malloc(BUFFER_SIZE);
+    host = malloc(BUFFER_SIZE);
+    if (!source || !ours || !host) {
+        fprintf(stderr, "couldn't allocate the test buffers\n");
+        return 1;
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15;
+    for (size_t i = 0; i < BUFFER_SIZE; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        source[i] = state;
+    }
+
+    static const host_variant_t variants[] = HOST_VARIANT_TABLE;
+    int avx2 = __builtin_cpu_supports("avx2");
+
+    for (size_t i = 0; i < sizeof(variants) / sizeof(*variants); i++) {
+        if (variants[i].avx2 && !avx2) {
+            printf("%s: skipped (no AVX2 on this machine)\n", variants[i].name);
+            continue;
+        }
+
+        int previous = failures;
+        test_variant(&variants[i]);
+        printf("%s: %s\n", variants[i].name, failures == previous ? "ok" : "FAILED");
+    }
+
+    int previous = failures;
+    test_page_end();
+    printf("page end: %s\n", failures == previous ? "ok" : "FAILED");
+
+    free(source);
+    free(ours);
+    free(host);
+    return failures != 0;
+}
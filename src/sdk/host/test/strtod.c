@@ -0,0 +1,429 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <float.h>
+#include <host.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Differential test of strtof/strtod/strtold against the host libc (which rounds correctly), with
+ * the inputs that are the hardest to get right: Exact halfway points between two neighbouring
+ * values of each format (and the closest values just above/below them, which can take hundreds
+ * or thousands of digits to tell apart), subnormals and the boundaries around them, and long
+ * digit strings. Every result must match bit for bit, and stop at the same place. */
+
+/* The longest exact halfway point (between the two smallest x87 subnormals) has 11515
+ * significant digits; Leave some room for the exponent and the extra digits we append. */
+#define MAX_INPUT 12000
+#define MAX_LIMBS 1400
+#define LIMB_BASE 1000000000
+#define RANDOM_HALFWAY_COUNT 100
+#define RANDOM_SUBNORMAL_COUNT 100
+#define RANDOM_LONG_COUNT 2000
+#define MAX_LONG_DIGITS 1200
+#define MAX_REPORTS 20
+
+typedef enum { HALFWAY_EXACT, HALFWAY_ABOVE, HALFWAY_BELOW } halfway_kind_t;
+
+/* Exact big integer, in base 10^9 limbs (least significant first). */
+typedef struct {
+    int count;
+    uint32_t limbs[MAX_LIMBS];
+} bignum_t;
+
+typedef struct {
+    const char *name;
+    int mantissa_bits;
+    int min_exponent;
+    int max_exponent;
+} format_t;
+
+/* Exponents are for values in [1, 2). */
+static const format_t formats[] = {
+    {"strtof", FLT_MANT_DIG, FLT_MIN_EXP - 1, FLT_MAX_EXP - 1},
+    {"strtod", DBL_MANT_DIG, DBL_MIN_EXP - 1, DBL_MAX_EXP - 1},
+    {"strtold", LDBL_MANT_DIG, LDBL_MIN_EXP - 1, LDBL_MAX_EXP - 1},
+};
+
+static const char *const fixed_inputs[] = {
+    "0.1",
+    "1e23",
+    "8.589973e9",
+    "9007199254740993",
+    "9007199254740992.5",
+    "2.2250738585072011e-308",
+    "2.2250738585072012e-308",
+    "2.2250738585072014e-308",
+    "4.9406564584124654e-324",
+    "2.4703282292062327e-324",
+    "2.4703282292062328e-324",
+    "1.7976931348623157e308",
+    "1.7976931348623158e308",
+    "1.7976931348623159e308",
+    "3.4028234663852886e38",
+    "3.4028235677973366e38",
+    "3.4028235677973367e38",
+    "1.17549435e-38",
+    "1.40129846e-45",
+    "7.0064923216240854e-46",
+    "7.0064923216240862e-46",
+    "3.64519953188247460253e-4951",
+    "3.64519953188247460252e-4951",
+    "1.82259976594123730126e-4951",
+    "1.82259976594123730127e-4951",
+    "3.36210314311209350626e-4932",
+    "1.18973149535723176502e4932",
+    "1.18973149535723176508e4932",
+    "0.000000000000000000000000000000000000000000001",
+    "1000000000000000000000000000000000000000000000000000000000000000000000000000000001",
+    "179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017"
+    "977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273"
+    "854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704"
+    "342711559699508093042880177904174497791",
+};
+
+static char input[MAX_INPUT];
+static bignum_t number;
+static uint64_t rng_state = 0x9E3779B97F4A7C15;
+static int failures;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reports a mismatch (only the first few get printed).
+ *
+ * PARAMETERS:
+ *     format - Description of what went wrong.
+ *     ... - Arguments for the format string.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void fail(const char *format, ...) {
+    if (failures++ < MAX_REPORTS) {
+        va_list vlist;
+        va_start(vlist, format);
+        vfprintf(stderr, format, vlist);
+        va_end(vlist);
+        fputc('\n', stderr);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function generates the next pseudo-random number (xorshift64*).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Random 64-bit value.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1D;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function parses the input with all three functions, comparing each against the host.
+ *
+ * PARAMETERS:
+ *     str - What to parse.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check(const char *str) {
+    char *ours_end, *host_end;
+
+    float ours_float = host_strtof(str, &ours_end);
+    float host_float = strtof(str, &host_end);
+    if (ours_end != host_end || memcmp(&ours_float, &host_float, sizeof(float))) {
+        fail("strtof(\"%.80s...\") = %a, expected %a", str, ours_float, host_float);
+    }
+
+    double ours_double = host_strtod(str, &ours_end);
+    double host_double = strtod(str, &host_end);
+    if (ours_end != host_end || memcmp(&ours_double, &host_double, sizeof(double))) {
+        fail("strtod(\"%.80s...\") = %a, expected %a", str, ours_double, host_double);
+    }
+
+    /* Only the first 10 bytes of a long double hold the value; Leave the padding out. */
+    long double ours_long = host_strtold(str, &ours_end);
+    long double host_long = strtold(str, &host_end);
+    if (ours_end != host_end || memcmp(&ours_long, &host_long, 10)) {
+        fail(
+            "strtold(\"%.80s...\") (%zu chars) = %La, expected %La",
+            str,
+            strlen(str),
+            ours_long,
+            host_long);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function multiplies the big integer by a small factor.
+ *
+ * PARAMETERS:
+ *     factor - What to multiply by (at most 2^32 - 1).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void multiply_number(uint32_t factor) {
+    uint64_t carry = 0;
+
+    for (int i = 0; i < number.count; i++) {
+        uint64_t product = (uint64_t)number.limbs[i] * factor + carry;
+        number.limbs[i] = product % LIMB_BASE;
+        carry = product / LIMB_BASE;
+    }
+
+    while (carry) {
+        number.limbs[number.count++] = carry % LIMB_BASE;
+        carry /= LIMB_BASE;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function writes the exact decimal representation of the point halfway between two
+ *     neighbouring floating point values (or the closest decimal just above/below it) into the
+ *     input buffer.
+ *
+ * PARAMETERS:
+ *     mantissa - Odd mantissa of the halfway point (twice the lower value's mantissa, plus one).
+ *     exponent - Binary exponent of the halfway point (so that it equals mantissa * 2^exponent).
+ *     kind - Whether to write the exact point, or go one unit past its last digit.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void build_halfway(unsigned __int128 mantissa, int exponent, halfway_kind_t kind) {
+    number.count = 0;
+    while (mantissa) {
+        number.limbs[number.count++] = mantissa % LIMB_BASE;
+        mantissa /= LIMB_BASE;
+    }
+
+    /* mantissa * 2^-n is the same as (mantissa * 5^n) * 10^-n, so either way, we only need
+     * to multiply. */
+    int decimal_exponent = exponent < 0 ? exponent : 0;
+    uint32_t factor = exponent < 0 ? 1220703125 : 1 << 29;
+    int step = exponent < 0 ? 13 : 29;
+    int remaining = exponent < 0 ? -exponent : exponent;
+
+    for (; remaining >= step; remaining -= step) {
+        multiply_number(factor);
+    }
+
+    for (; remaining; remaining--) {
+        multiply_number(exponent < 0 ? 5 : 2);
+    }
+
+    char *end = input + sprintf(input, "%u", number.limbs[number.count - 1]);
+    for (int i = number.count - 2; i >= 0; i--) {
+        end += sprintf(end, "%09u", number.limbs[i]);
+    }
+
+    /* One more digit at the end takes us a hundredth of an unit (of the last digit) away from the
+     * halfway point: Appending 1 goes above it, and subtracting one before appending 9 goes
+     * below it. */
+    if (kind == HALFWAY_BELOW) {
+        char *digit = end - 1;
+        while (*digit == '0') {
+            *(digit--) = '9';
+        }
+
+        (*digit)--;
+    }
+
+    if (kind != HALFWAY_EXACT) {
+        *(end++) = kind == HALFWAY_ABOVE ? '1' : '9';
+        decimal_exponent--;
+    }
+
+    sprintf(end, "e%d", decimal_exponent);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks the halfway point above the given value, as well as the closest
+ *     decimals above/below it.
+ *
+ * PARAMETERS:
+ *     mantissa - Integer mantissa of the value below the halfway point.
+ *     exponent - Binary exponent of the lowest mantissa bit.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_halfway(uint64_t mantissa, int exponent) {
+    for (halfway_kind_t kind = HALFWAY_EXACT; kind <= HALFWAY_BELOW; kind++) {
+        build_halfway(((unsigned __int128)mantissa << 1) | 1, exponent - 1, kind);
+        check(input);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function generates a random mantissa for the given format.
+ *
+ * PARAMETERS:
+ *     format - Which format we're generating the mantissa for.
+ *     normal - Set this to generate a normal mantissa (with the highest bit set), or clear it to
+ *              generate a subnormal one.
+ *
+ * RETURN VALUE:
+ *     Random mantissa.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t random_mantissa(const format_t *format, int normal) {
+    uint64_t high_bit = 1ull << (format->mantissa_bits - 1);
+    uint64_t mantissa = next_random() & (high_bit | (high_bit - 1));
+
+    /* Mostly random bits, but the runs of zeroes/ones (at either end) are what makes things hard,
+     * so give them some extra weight. */
+    switch (next_random() % 4) {
+        case 0:
+            mantissa &= ~0ull << (next_random() % format->mantissa_bits);
+            break;
+        case 1:
+            mantissa |= (1ull << (next_random() % format->mantissa_bits)) - 1;
+            break;
+    }
+
+    return normal ? mantissa | high_bit : mantissa & ~high_bit;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks the halfway points around the edges of the given format: The
+ *     smallest subnormals, the switch from subnormals to normals, powers of two, and the largest
+ *     values.
+ *
+ * PARAMETERS:
+ *     format - Which format to check.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_boundaries(const format_t *format) {
+    uint64_t high_bit = 1ull << (format->mantissa_bits - 1);
+    uint64_t all_bits = high_bit | (high_bit - 1);
+    int subnormal_exponent = format->min_exponent - format->mantissa_bits + 1;
+
+    for (uint64_t mantissa = 0; mantissa < 4; mantissa++) {
+        check_halfway(mantissa, subnormal_exponent);
+    }
+
+    check_halfway(high_bit - 2, subnormal_exponent);
+    check_halfway(high_bit - 1, subnormal_exponent);
+    check_halfway(high_bit, subnormal_exponent);
+    check_halfway(high_bit + 1, subnormal_exponent);
+
+    static const int exponents[] = {-1000, -64, -1, 0, 1, 52, 63, 64, 1000};
+    for (size_t i = 0; i < sizeof(exponents) / sizeof(*exponents); i++) {
+        int exponent = exponents[i] - format->mantissa_bits + 1;
+        if (exponents[i] > format->min_exponent && exponents[i] < format->max_exponent) {
+            check_halfway(high_bit, exponent);
+            check_halfway(all_bits, exponent - 1);
+        }
+    }
+
+    check_halfway(all_bits - 1, format->max_exponent - format->mantissa_bits + 1);
+    check_halfway(all_bits, format->max_exponent - format->mantissa_bits + 1);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks halfway points at random (normal and subnormal) values of the given
+ *     format.
+ *
+ * PARAMETERS:
+ *     format - Which format to check.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_random_halfway(const format_t *format) {
+    int range = format->max_exponent - format->min_exponent + 1;
+
+    for (int i = 0; i < RANDOM_HALFWAY_COUNT; i++) {
+        int exponent = format->min_exponent + (int)(next_random() % range);
+        check_halfway(random_mantissa(format, 1), exponent - format->mantissa_bits + 1);
+    }
+
+    for (int i = 0; i < RANDOM_SUBNORMAL_COUNT; i++) {
+        check_halfway(
+            random_mantissa(format, 0), format->min_exponent - format->mantissa_bits + 1);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks random decimals with long mantissas, spread over (and a bit past) the
+ *     range of all formats.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_random_long(void) {
+    for (int i = 0; i < RANDOM_LONG_COUNT; i++) {
+        int digits = 17 + next_random() % (MAX_LONG_DIGITS - 16);
+        int point = next_random() % (digits + 1);
+        char *end = input;
+
+        if (next_random() % 2) {
+            *(end++) = '-';
+        }
+
+        for (int j = 0; j < digits; j++) {
+            if (j == point) {
+                *(end++) = '.';
+            }
+
+            /* Long runs of the same digit (0s and 9s in particular) make for the inputs closest
+             * to the halfway points. */
+            uint64_t value = next_random();
+            if (j && value % 4) {
+                *end = end[-1] == '.' ? end[-2] : end[-1];
+                end++;
+            } else {
+                *(end++) = '0' + (value >> 8) % 10;
+            }
+        }
+
+        sprintf(end, "e%d", (int)(next_random() % 10201) - 5100);
+        check(input);
+    }
+}
+
+int main(void) {
+    int previous = failures;
+    for (size_t i = 0; i < sizeof(fixed_inputs) / sizeof(*fixed_inputs); i++) {
+        check(fixed_inputs[i]);
+    }
+
+    printf("fixed inputs: %s\n", failures == previous ? "ok" : "FAILED");
+
+    for (size_t i = 0; i < sizeof(formats) / sizeof(*formats); i++) {
+        previous = failures;
+        test_boundaries(&formats[i]);
+        test_random_halfway(&formats[i]);
+        printf("%s halfway points: %s\n", formats[i].name, failures == previous ? "ok" : "FAILED");
+    }
+
+    previous = failures;
+    test_random_long();
+    printf("long mantissas: %s\n", failures == previous ? "ok" : "FAILED");
+    return failures != 0;
+}
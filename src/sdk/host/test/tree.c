@@ -0,0 +1,479 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <host.h>
+#include <rt/tree.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Runs random insert/remove sequences on red-black, AVL and interval trees, checking the whole
+ * tree after every operation: Parent links, key order, the red-black/AVL balance rules, and the
+ * interval MaxEnd values. The lookup/iteration functions and interval queries are checked
+ * against a brute force search over the same nodes. */
+
+#define NODE_COUNT 1000
+#define OPERATION_COUNT 20000
+#define KEY_RANGE 4000
+#define INTERVAL_RANGE 10000
+#define MAX_INTERVAL 500
+#define QUERY_COUNT 8
+#define MAX_REPORTS 20
+
+typedef enum { KIND_RB, KIND_AVL, KIND_INTERVAL } tree_kind_t;
+
+typedef struct {
+    RtTreeNode header;
+    uint64_t key;
+    int inserted;
+} key_node_t;
+
+typedef struct {
+    RtIntervalNode header;
+    int inserted;
+} interval_node_t;
+
+static const char *const kind_names[] = {"red-black", "AVL", "interval"};
+
+static key_node_t key_nodes[NODE_COUNT];
+static interval_node_t interval_nodes[NODE_COUNT];
+static uint64_t rng_state;
+static int failures;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reports a broken invariant (only the first few get printed).
+ *
+ * PARAMETERS:
+ *     format - Description of what went wrong.
+ *     ... - Arguments for the format string.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void fail(const char *format, ...) {
+    if (failures++ < MAX_REPORTS) {
+        va_list vlist;
+        va_start(vlist, format);
+        vfprintf(stderr, format, vlist);
+        va_end(vlist);
+        fputc('\n', stderr);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function generates the next pseudo-random number (xorshift64*).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     Random 64-bit value.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1D;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function compares a key against a key node.
+ *
+ * PARAMETERS:
+ *     Key - Pointer to the key.
+ *     Node - Node to compare against.
+ *
+ * RETURN VALUE:
+ *     <0 if the key goes before the node, 0 if it's equal, >0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int compare_key(const void *Key, RtTreeNode *Node) {
+    uint64_t Value = *(const uint64_t *)Key;
+    uint64_t NodeValue = CONTAINING_RECORD(Node, key_node_t, header)->key;
+    return Value < NodeValue ? -1 : Value > NodeValue;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the sort key of a node (the key itself, or the interval start).
+ *
+ * PARAMETERS:
+ *     kind - Which kind of tree the node is in.
+ *     node - Node to get the key of.
+ *
+ * RETURN VALUE:
+ *     Key of the node.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t get_key(tree_kind_t kind, RtTreeNode *node) {
+    if (kind == KIND_INTERVAL) {
+        return CONTAINING_RECORD(node, RtIntervalNode, TreeNode)->Start;
+    } else {
+        return CONTAINING_RECORD(node, key_node_t, header)->key;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks every invariant of a subtree.
+ *
+ * PARAMETERS:
+ *     kind - Which kind of tree this is.
+ *     node - Root of the subtree.
+ *     parent - Expected parent of the root.
+ *     low - Smallest key allowed in the subtree.
+ *     high - Largest key allowed in the subtree.
+ *     count - Output; Incremented for every node in the subtree.
+ *
+ * RETURN VALUE:
+ *     Height of the subtree (for AVL trees), or its black height (for red-black trees).
+ *-----------------------------------------------------------------------------------------------*/
+static int check_subtree(
+    tree_kind_t kind,
+    RtTreeNode *node,
+    RtTreeNode *parent,
+    uint64_t low,
+    uint64_t high,
+    size_t *count) {
+    if (!node) {
+        return 0;
+    }
+
+    ++*count;
+
+    if (node->Parent != parent) {
+        fail(
+            "%s: node %llu has the wrong parent",
+            kind_names[kind],
+            (unsigned long long)get_key(kind, node));
+    }
+
+    uint64_t key = get_key(kind, node);
+    if (key < low || key > high) {
+        fail("%s: node %llu is out of order", kind_names[kind], (unsigned long long)key);
+    }
+
+    int left = check_subtree(kind, node->Left, node, low, key, count);
+    int right = check_subtree(kind, node->Right, node, key, high, count);
+
+    if (kind == KIND_AVL) {
+        if (node->Balance != right - left || node->Balance < -1 || node->Balance > 1) {
+            fail(
+                "AVL: node %llu has balance %d, but its subtrees have heights %d and %d",
+                (unsigned long long)key,
+                node->Balance,
+                left,
+                right);
+        }
+
+        return (left > right ? left : right) + 1;
+    }
+
+    if (node->Red && ((node->Left && node->Left->Red) || (node->Right && node->Right->Red))) {
+        fail("%s: red node %llu has a red child", kind_names[kind], (unsigned long long)key);
+    }
+
+    if (left != right) {
+        fail(
+            "%s: node %llu has black heights %d and %d",
+            kind_names[kind],
+            (unsigned long long)key,
+            left,
+            right);
+    }
+
+    if (kind == KIND_INTERVAL) {
+        RtIntervalNode *interval = CONTAINING_RECORD(node, RtIntervalNode, TreeNode);
+        uint64_t max_end = interval->End;
+
+        if (node->Left) {
+            uint64_t end = CONTAINING_RECORD(node->Left, RtIntervalNode, TreeNode)->MaxEnd;
+            max_end = end > max_end ? end : max_end;
+        }
+
+        if (node->Right) {
+            uint64_t end = CONTAINING_RECORD(node->Right, RtIntervalNode, TreeNode)->MaxEnd;
+            max_end = end > max_end ? end : max_end;
+        }
+
+        if (interval->MaxEnd != max_end) {
+            fail(
+                "interval: node %llu has MaxEnd %llu, expected %llu",
+                (unsigned long long)key,
+                (unsigned long long)interval->MaxEnd,
+                (unsigned long long)max_end);
+        }
+    }
+
+    return left + !node->Red;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks the whole tree, and that iterating it in both directions visits the
+ *     expected amount of nodes in order.
+ *
+ * PARAMETERS:
+ *     kind - Which kind of tree this is.
+ *     tree - Tree to check.
+ *     expected - How many nodes should be in the tree.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_tree(tree_kind_t kind, RtTree *tree, size_t expected) {
+    size_t count = 0;
+    check_subtree(kind, tree->Root, NULL, 0, UINT64_MAX, &count);
+
+    if (kind != KIND_AVL && tree->Root && tree->Root->Red) {
+        fail("%s: the root is red", kind_names[kind]);
+    }
+
+    if (count != expected) {
+        fail("%s: tree has %zu nodes, expected %zu", kind_names[kind], count, expected);
+    }
+
+    size_t forward = 0, backward = 0;
+    uint64_t last = 0;
+    for (RtTreeNode *node = RtGetFirstTreeNode(tree); node; node = RtGetNextTreeNode(node)) {
+        if (forward++ && get_key(kind, node) < last) {
+            fail("%s: forward iteration is out of order", kind_names[kind]);
+        }
+
+        last = get_key(kind, node);
+    }
+
+    last = UINT64_MAX;
+    for (RtTreeNode *node = RtGetLastTreeNode(tree); node; node = RtGetPreviousTreeNode(node)) {
+        if (backward++ && get_key(kind, node) > last) {
+            fail("%s: backward iteration is out of order", kind_names[kind]);
+        }
+
+        last = get_key(kind, node);
+    }
+
+    if (forward != expected || backward != expected) {
+        fail(
+            "%s: iteration visited %zu/%zu nodes, expected %zu",
+            kind_names[kind],
+            forward,
+            backward,
+            expected);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks the lookup functions of a key tree against a brute force search.
+ *
+ * PARAMETERS:
+ *     kind - Which kind of tree this is.
+ *     tree - Tree to search in.
+ *     key - Key to search for.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_lookup(tree_kind_t kind, RtTree *tree, uint64_t key) {
+    key_node_t *exact = NULL, *lower = NULL, *upper = NULL;
+
+    for (size_t i = 0; i < NODE_COUNT; i++) {
+        key_node_t *node = &key_nodes[i];
+        if (!node->inserted) {
+            continue;
+        }
+
+        if (node->key == key) {
+            exact = node;
+        }
+
+        if (node->key >= key && (!lower || node->key < lower->key)) {
+            lower = node;
+        }
+
+        if (node->key > key && (!upper || node->key < upper->key)) {
+            upper = node;
+        }
+    }
+
+    if (RtLookupTree(tree, &key) != (exact ? &exact->header : NULL) ||
+        RtLookupLowerBoundTree(tree, &key) != (lower ? &lower->header : NULL) ||
+        RtLookupUpperBoundTree(tree, &key) != (upper ? &upper->header : NULL)) {
+        fail(
+            "%s: lookup of %llu returned the wrong node",
+            kind_names[kind],
+            (unsigned long long)key);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs a random sequence of inserts and removals on a red-black or AVL tree.
+ *
+ * PARAMETERS:
+ *     kind - Which kind of tree to test.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_key_tree(tree_kind_t kind) {
+    RtTree tree;
+    RtInitializeTree(&tree, compare_key, NULL);
+    size_t count = 0;
+    int previous = failures;
+
+    /* Keys are unique (the trees don't define where duplicates go), and sparse, so that there
+     * are misses to look up. */
+    for (size_t i = 0; i < NODE_COUNT; i++) {
+        key_nodes[i].key = (i * 2654435761u) % KEY_RANGE * 4 + 1;
+        key_nodes[i].inserted = 0;
+    }
+
+    for (size_t op = 0; op < OPERATION_COUNT; op++) {
+        key_node_t *node = &key_nodes[next_random() % NODE_COUNT];
+
+        /* Toggling random nodes keeps the tree at about half of NODE_COUNT. */
+        if (node->inserted) {
+            kind == KIND_RB ? RtRemoveRbTree(&tree, &node->header)
+                            : RtRemoveAvlTree(&tree, &node->header);
+            node->inserted = 0;
+            count--;
+        } else {
+            kind == KIND_RB ? RtInsertRbTree(&tree, &node->header, &node->key)
+                            : RtInsertAvlTree(&tree, &node->header, &node->key);
+            node->inserted = 1;
+            count++;
+        }
+
+        check_tree(kind, &tree, count);
+        check_lookup(kind, &tree, next_random() % (KEY_RANGE * 4 + 8));
+        check_lookup(kind, &tree, node->key);
+
+        if (failures != previous) {
+            fail("%s: failed after %zu operations", kind_names[kind], op + 1);
+            return;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks an interval query against a brute force search.
+ *
+ * PARAMETERS:
+ *     tree - Tree to search in.
+ *     start - Start of the query range.
+ *     end - End of the query range (exclusive).
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void check_query(RtIntervalTree *tree, uint64_t start, uint64_t end) {
+    static uint8_t found[NODE_COUNT];
+    size_t expected = 0, count = 0;
+
+    for (size_t i = 0; i < NODE_COUNT; i++) {
+        RtIntervalNode *node = &interval_nodes[i].header;
+        found[i] = 0;
+        expected += interval_nodes[i].inserted && node->Start < end && node->End > start;
+    }
+
+    uint64_t last = 0;
+    for (RtIntervalNode *node = RtLookupIntervalTree(tree, start, end); node;
+         node = RtLookupNextIntervalTree(node, start, end)) {
+        size_t index = CONTAINING_RECORD(node, interval_node_t, header) - interval_nodes;
+
+        if (!interval_nodes[index].inserted || node->Start >= end || node->End <= start ||
+            found[index] || node->Start < last || count >= expected) {
+            fail(
+                "interval: query [%llu, %llu) returned a wrong (or repeated) node [%llu, %llu)",
+                (unsigned long long)start,
+                (unsigned long long)end,
+                (unsigned long long)node->Start,
+                (unsigned long long)node->End);
+            return;
+        }
+
+        found[index] = 1;
+        last = node->Start;
+        count++;
+    }
+
+    if (count != expected) {
+        fail(
+            "interval: query [%llu, %llu) returned %zu nodes, expected %zu",
+            (unsigned long long)start,
+            (unsigned long long)end,
+            count,
+            expected);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function runs a random sequence of inserts, removals and queries on an interval tree.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void test_interval_tree(void) {
+    RtIntervalTree tree;
+    RtInitializeIntervalTree(&tree);
+    size_t count = 0;
+    int previous = failures;
+
+    for (size_t i = 0; i < NODE_COUNT; i++) {
+        interval_nodes[i].inserted = 0;
+    }
+
+    for (size_t op = 0; op < OPERATION_COUNT; op++) {
+        interval_node_t *node = &interval_nodes[next_random() % NODE_COUNT];
+
+        if (node->inserted) {
+            RtRemoveIntervalTree(&tree, &node->header);
+            node->inserted = 0;
+            count--;
+        } else {
+            /* Intervals can overlap, and share their start with others. */
+            node->header.Start = next_random() % INTERVAL_RANGE;
+            node->header.End = node->header.Start + next_random() % MAX_INTERVAL + 1;
+            RtInsertIntervalTree(&tree, &node->header);
+            node->inserted = 1;
+            count++;
+        }
+
+        check_tree(KIND_INTERVAL, &tree.Tree, count);
+
+        for (int i = 0; i < QUERY_COUNT; i++) {
+            uint64_t start = next_random() % (INTERVAL_RANGE + MAX_INTERVAL);
+            uint64_t end = start + (i & 1 ? next_random() % 16 : next_random() % 2000) + 1;
+            check_query(&tree, start, end);
+        }
+
+        if (failures != previous) {
+            fail("interval: failed after %zu operations", op + 1);
+            return;
+        }
+    }
+}
+
+int main(void) {
+    for (int kind = KIND_RB; kind <= KIND_INTERVAL; kind++) {
+        rng_state = 0x9E3779B97F4A7C15 + kind;
+        int previous = failures;
+
+        if (kind == KIND_INTERVAL) {
+            test_interval_tree();
+        } else {
+            test_key_tree(kind);
+        }
+
+        printf("%s: %s\n", kind_names[kind], failures == previous ? "ok" : "FAILED");
+    }
+
+    return failures != 0;
+}
@@ -23,7 +23,7 @@ int RtDispatchException(RtExceptionRecord *ExceptionRecord, RtContext *ContextRe
     memcpy(&ActiveContext, ContextRecord, sizeof(RtContext));
 
     /* We need this to validate the establisher frame. */
-    uint64_t StackBase = (uint64_t)HalGetCurrentProcessor()->CurrentThread->Stack;
+    uint64_t StackBase = (uint64_t)KeGetCurrentThread()->Stack;
     uint64_t StackLimit = StackBase + KE_STACK_SIZE;
     uint64_t ControlPc = (uint64_t)ExceptionRecord->ExceptionAddress;
 
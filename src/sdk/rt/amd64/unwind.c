@@ -434,7 +434,7 @@ RtUnwind(void *TargetFrame, void *TargetIp, RtExceptionRecord *ExceptionRecord,
     RtSaveContext(&ActiveContext);
 
     /* We need this to validate the establisher frame. */
-    uint64_t StackBase = (uint64_t)HalGetCurrentProcessor()->CurrentThread->Stack;
+    uint64_t StackBase = (uint64_t)KeGetCurrentThread()->Stack;
     uint64_t StackLimit = StackBase + KE_STACK_SIZE;
 
     RtExceptionRecord DefaultExceptionRecord;
@@ -0,0 +1,149 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/list.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads the current value of the list header. The two halves are read
+ *     separately, but that's fine, as a torn read will just make the following compare exchange
+ *     fail (and give us the real value).
+ *
+ * PARAMETERS:
+ *     Head - Header of the list.
+ *
+ * RETURN VALUE:
+ *     Snapshot of the header.
+ *-----------------------------------------------------------------------------------------------*/
+static inline RtAtomicSList ReadHead(RtAtomicSList *Head) {
+    RtAtomicSList Value;
+    Value.Sequence = __atomic_load_n(&Head->Sequence, __ATOMIC_ACQUIRE);
+    Value.Next = __atomic_load_n(&Head->Next, __ATOMIC_ACQUIRE);
+    return Value;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function atomically replaces the list header if it still matches what we expect.
+ *
+ * PARAMETERS:
+ *     Head - Header of the list.
+ *     Expected - What we expect the header to be; Gets updated with the current value on failure.
+ *     Desired - What we want the header to be.
+ *
+ * RETURN VALUE:
+ *     1 if the header was updated, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static inline int
+CompareExchangeHead(RtAtomicSList *Head, RtAtomicSList *Expected, RtAtomicSList Desired) {
+#ifdef ARCH_amd64
+    /* Using __atomic_compare_exchange here would need -mcx16 (or libatomic), so go straight for
+     * the instruction (which every amd64 processor we support has). */
+    uint8_t Success;
+    __asm__ volatile("lock cmpxchg16b %1"
+                     : "=@ccz"(Success), "+m"(*Head), "+a"(Expected->Next),
+                       "+d"(Expected->Sequence)
+                     : "b"(Desired.Next), "c"(Desired.Sequence)
+                     : "memory");
+    return Success;
+#else
+    return __atomic_compare_exchange(
+        Head, Expected, &Desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif /* ARCH_amd64 */
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function atomically inserts a new entry into a lock-free singly linked list.
+ *
+ * PARAMETERS:
+ *     Head - Header of the list.
+ *     Entry - What we're inserting.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtPushAtomicSList(RtAtomicSList *Head, RtSList *Entry) {
+    RtPushBatchAtomicSList(Head, Entry, Entry);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function atomically inserts an already linked chain of entries into a lock-free singly
+ *     linked list. The chain keeps its order (First will be the next entry to be popped).
+ *
+ * PARAMETERS:
+ *     Head - Header of the list.
+ *     First - First entry of the chain.
+ *     Last - Last entry of the chain; Its Next pointer will be overwritten.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtPushBatchAtomicSList(RtAtomicSList *Head, RtSList *First, RtSList *Last) {
+    RtAtomicSList Current = ReadHead(Head);
+    RtAtomicSList New;
+
+    do {
+        Last->Next = Current.Next;
+        New.Next = First;
+        New.Sequence = Current.Sequence + 1;
+    } while (!CompareExchangeHead(Head, &Current, New));
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function atomically removes the last inserted entry from a lock-free singly linked
+ *     list.
+ *
+ * PARAMETERS:
+ *     Head - Header of the list.
+ *
+ * RETURN VALUE:
+ *     NULL if the list was empty, what we removed otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+RtSList *RtPopAtomicSList(RtAtomicSList *Head) {
+    RtAtomicSList Current = ReadHead(Head);
+    RtAtomicSList New;
+
+    do {
+        if (!Current.Next) {
+            return NULL;
+        }
+
+        /* The entry might get popped (and reused) by someone else right after we read its Next
+         * pointer; The sequence number makes sure we notice that. */
+        New.Next = __atomic_load_n(&Current.Next->Next, __ATOMIC_RELAXED);
+        New.Sequence = Current.Sequence + 1;
+    } while (!CompareExchangeHead(Head, &Current, New));
+
+    Current.Next->Next = NULL;
+    return Current.Next;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function atomically removes all entries from a lock-free singly linked list.
+ *
+ * PARAMETERS:
+ *     Head - Header of the list.
+ *
+ * RETURN VALUE:
+ *     NULL if the list was empty, otherwise the first entry of the (NULL terminated) chain we
+ *     removed.
+ *-----------------------------------------------------------------------------------------------*/
+RtSList *RtFlushAtomicSList(RtAtomicSList *Head) {
+    RtAtomicSList Current = ReadHead(Head);
+    RtAtomicSList New;
+
+    do {
+        if (!Current.Next) {
+            return NULL;
+        }
+
+        New.Next = NULL;
+        New.Sequence = Current.Sequence + 1;
+    } while (!CompareExchangeHead(Head, &Current, New));
+
+    return Current.Next;
+}
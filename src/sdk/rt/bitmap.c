@@ -90,7 +90,7 @@ void RtClearBits(RtBitmap *Header, uint64_t Start, uint64_t NumberOfBits) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void RtClearAllBits(RtBitmap *Header) {
-    memset(Header->Buffer, 0, Header->NumberOfBits >> 3);
+    memset(Header->Buffer, 0, (Header->NumberOfBits + 7) >> 3);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -160,7 +160,7 @@ void RtSetBits(RtBitmap *Header, uint64_t Start, uint64_t NumberOfBits) {
  *     None.
  *-----------------------------------------------------------------------------------------------*/
 void RtSetAllBits(RtBitmap *Header) {
-    memset(Header->Buffer, 0xFF, Header->NumberOfBits >> 3);
+    memset(Header->Buffer, 0xFF, (Header->NumberOfBits + 7) >> 3);
 }
 
 /*-------------------------------------------------------------------------------------------------
@@ -178,7 +178,7 @@ void RtSetAllBits(RtBitmap *Header) {
  *-----------------------------------------------------------------------------------------------*/
 static uint64_t CountBitRow(RtBitmap *Header, uint64_t Offset, uint64_t NumberOfBits, int Inverse) {
     uint64_t *Buffer = Header->Buffer + (Offset >> 6);
-    uint64_t *End = Buffer + ((NumberOfBits + 63) >> 6);
+    uint64_t *End = Header->Buffer + ((Offset + NumberOfBits + 63) >> 6);
 
     /* Do not consider anything before the given offset */
     uint64_t LeadingBits = Offset & 0x3F;
@@ -221,13 +221,14 @@ static uint64_t FindBitRow(RtBitmap *Header, uint64_t Hint, uint64_t NumberOfBit
         return Hint;
     }
 
-    /* Two attempts, one from the hint to the end, and one from the start to the hint. */
+    /* Two attempts, one from the hint to the end, and one from the start to the hint (where the
+       range is still allowed to cross the hint). */
     int Retry = (Hint != 0) + 1;
     uint64_t Offset = Hint;
     uint64_t End = Header->NumberOfBits;
 
     do {
-        while (Offset + NumberOfBits < End) {
+        while (Offset + NumberOfBits <= End) {
             Offset += CountBitRow(Header, Offset, Header->NumberOfBits - Offset, !Inverse);
             if (Offset + NumberOfBits > End) {
                 break;
@@ -244,7 +245,10 @@ static uint64_t FindBitRow(RtBitmap *Header, uint64_t Hint, uint64_t NumberOfBit
         Retry--;
         if (Retry) {
             Offset = 0;
-            End = Hint;
+            End = Hint + NumberOfBits - 1;
+            if (End > Header->NumberOfBits) {
+                End = Header->NumberOfBits;
+            }
         }
     } while (Retry);
 
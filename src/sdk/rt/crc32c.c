@@ -0,0 +1,186 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/hash.h>
+
+#ifdef ARCH_amd64
+#include <cpuid.h>
+#include <nmmintrin.h>
+#endif /* ARCH_amd64 */
+
+/* Castagnoli polynomial (bit reversed). */
+#define CRC32C_POLYNOMIAL 0x82F63B78
+
+static uint32_t Resolve(uint32_t Crc, const uint8_t *Data, size_t Length);
+
+static uint32_t (*Implementation)(uint32_t, const uint8_t *, size_t) = Resolve;
+static uint32_t Table[8][256];
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads a 32-bits little endian value from a possibly unaligned address.
+ *
+ * PARAMETERS:
+ *     Data - Where to read from.
+ *
+ * RETURN VALUE:
+ *     Value at the given address.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint32_t Read32(const uint8_t *Data) {
+    uint32_t Value;
+    __builtin_memcpy(&Value, Data, sizeof(uint32_t));
+    return Value;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function fills the slice-by-8 tables. Table[0] is the usual byte-at-a-time table,
+ *     while Table[N] gives the CRC of a byte followed by N zero bytes.
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void InitializeTable(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t Crc = i;
+
+        for (int Bit = 0; Bit < 8; Bit++) {
+            Crc = (Crc >> 1) ^ (CRC32C_POLYNOMIAL & -(Crc & 1));
+        }
+
+        Table[0][i] = Crc;
+    }
+
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int Slice = 1; Slice < 8; Slice++) {
+            uint32_t Previous = Table[Slice - 1][i];
+            Table[Slice][i] = (Previous >> 8) ^ Table[0][Previous & 0xFF];
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the table-based (slice-by-8) CRC32C, for processors without
+ *     SSE4.2.
+ *
+ * PARAMETERS:
+ *     Crc - Current (inverted) CRC value.
+ *     Data - Data to be processed.
+ *     Length - Size of the data.
+ *
+ * RETURN VALUE:
+ *     Updated (inverted) CRC value.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t UpdateSoftware(uint32_t Crc, const uint8_t *Data, size_t Length) {
+    while (Length >= 8) {
+        uint32_t Low = Crc ^ Read32(Data);
+        uint32_t High = Read32(Data + 4);
+
+        Crc = Table[7][Low & 0xFF] ^ Table[6][(Low >> 8) & 0xFF] ^ Table[5][(Low >> 16) & 0xFF] ^
+              Table[4][Low >> 24] ^ Table[3][High & 0xFF] ^ Table[2][(High >> 8) & 0xFF] ^
+              Table[1][(High >> 16) & 0xFF] ^ Table[0][High >> 24];
+
+        Data += 8;
+        Length -= 8;
+    }
+
+    while (Length--) {
+        Crc = (Crc >> 8) ^ Table[0][(Crc ^ *(Data++)) & 0xFF];
+    }
+
+    return Crc;
+}
+
+#ifdef ARCH_amd64
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements CRC32C using the SSE4.2 CRC32 instruction. This doesn't touch
+ *     any vector registers, so it's also safe to use in the kernel.
+ *
+ * PARAMETERS:
+ *     Crc - Current (inverted) CRC value.
+ *     Data - Data to be processed.
+ *     Length - Size of the data.
+ *
+ * RETURN VALUE:
+ *     Updated (inverted) CRC value.
+ *-----------------------------------------------------------------------------------------------*/
+__attribute__((target("sse4.2"))) static uint32_t
+UpdateHardware(uint32_t Crc, const uint8_t *Data, size_t Length) {
+    while (Length && ((uintptr_t)Data & 7)) {
+        Crc = _mm_crc32_u8(Crc, *(Data++));
+        Length--;
+    }
+
+    uint64_t Crc64 = Crc;
+    while (Length >= 8) {
+        uint64_t Value;
+        __builtin_memcpy(&Value, Data, sizeof(uint64_t));
+        Crc64 = _mm_crc32_u64(Crc64, Value);
+        Data += 8;
+        Length -= 8;
+    }
+
+    Crc = Crc64;
+    while (Length--) {
+        Crc = _mm_crc32_u8(Crc, *(Data++));
+    }
+
+    return Crc;
+}
+#endif /* ARCH_amd64 */
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function picks the best CRC32C routine for the current processor on the first call,
+ *     and forwards the call to it.
+ *
+ * PARAMETERS:
+ *     Crc - Current (inverted) CRC value.
+ *     Data - Data to be processed.
+ *     Length - Size of the data.
+ *
+ * RETURN VALUE:
+ *     Updated (inverted) CRC value.
+ *-----------------------------------------------------------------------------------------------*/
+static uint32_t Resolve(uint32_t Crc, const uint8_t *Data, size_t Length) {
+    uint32_t (*NewImplementation)(uint32_t, const uint8_t *, size_t) = UpdateSoftware;
+
+#ifdef ARCH_amd64
+    uint32_t Eax, Ebx, Ecx, Edx;
+    __cpuid(1, Eax, Ebx, Ecx, Edx);
+    if (Ecx & 0x100000) {
+        NewImplementation = UpdateHardware;
+    }
+#endif /* ARCH_amd64 */
+
+    /* Anyone racing with us will generate the exact same table, and nobody uses the table
+     * before the pointer gets published. */
+    if (NewImplementation == UpdateSoftware) {
+        InitializeTable();
+    }
+
+    __atomic_store_n(&Implementation, NewImplementation, __ATOMIC_RELEASE);
+    return NewImplementation(Crc, Data, Length);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function calculates the CRC32C (Castagnoli) of some data. This can be called in
+ *     chunks, by passing the result of the previous call as the initial value.
+ *
+ * PARAMETERS:
+ *     Crc - Initial value; Use 0 when starting a new checksum.
+ *     Buffer - Data to be processed.
+ *     Length - Size of the data.
+ *
+ * RETURN VALUE:
+ *     CRC32C of the data.
+ *-----------------------------------------------------------------------------------------------*/
+uint32_t RtGetCrc32c(uint32_t Crc, const void *Buffer, size_t Length) {
+    return ~__atomic_load_n(&Implementation, __ATOMIC_ACQUIRE)(~Crc, Buffer, Length);
+}
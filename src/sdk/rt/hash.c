@@ -10,6 +10,77 @@
 #define PRIME32_4 0x27D4EB2F
 #define PRIME32_5 0x165667B1
 
+#define PRIME64_1 0x9E3779B185EBCA87ull
+#define PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define PRIME64_3 0x165667B19E3779F9ull
+#define PRIME64_4 0x85EBCA77C2B2AE63ull
+#define PRIME64_5 0x27D4EB2F165667C5ull
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads a 64-bits little endian value from a possibly unaligned address.
+ *
+ * PARAMETERS:
+ *     Data - Where to read from.
+ *
+ * RETURN VALUE:
+ *     Value at the given address.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t Read64(const uint8_t *Data) {
+    uint64_t Value;
+    __builtin_memcpy(&Value, Data, sizeof(uint64_t));
+    return Value;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads a 32-bits little endian value from a possibly unaligned address.
+ *
+ * PARAMETERS:
+ *     Data - Where to read from.
+ *
+ * RETURN VALUE:
+ *     Value at the given address.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint32_t Read32(const uint8_t *Data) {
+    uint32_t Value;
+    __builtin_memcpy(&Value, Data, sizeof(uint32_t));
+    return Value;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function mixes a single 64-bits lane of input into an XXH64 accumulator.
+ *
+ * PARAMETERS:
+ *     Accum - Current value of the accumulator.
+ *     Input - Input lane.
+ *
+ * RETURN VALUE:
+ *     New value of the accumulator.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t Round64(uint64_t Accum, uint64_t Input) {
+    Accum += Input * PRIME64_2;
+    Accum = (Accum << 31) | (Accum >> 33);
+    return Accum * PRIME64_1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function merges one of the XXH64 accumulators into the result.
+ *
+ * PARAMETERS:
+ *     Result - Current value of the result.
+ *     Accum - Accumulator to be merged.
+ *
+ * RETURN VALUE:
+ *     New value of the result.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t MergeRound64(uint64_t Result, uint64_t Accum) {
+    Result ^= Round64(0, Accum);
+    return Result * PRIME64_1 + PRIME64_4;
+}
+
 /*-------------------------------------------------------------------------------------------------
  * PURPOSE:
  *     This function gives a 32-bits hash of some data, using a fast (though not cryptographically
@@ -83,3 +154,78 @@ uint32_t RtGetHash(const void* Buffer, size_t Length) {
 
     return Result;
 }
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gives a 64-bits hash of some data, using the 64-bits version of xxHash.
+ *     Prefer RtGetXxh3Hash() for anything new; This is mostly for on-disk formats that already
+ *     use XXH64.
+ *
+ * PARAMETERS:
+ *     Buffer - Data to be hashed.
+ *     Length - Size of the data.
+ *     Seed - Initial value for the accumulators.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the data.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t RtGetXxh64Hash(const void *Buffer, size_t Length, uint64_t Seed) {
+    const uint8_t *Data = Buffer;
+    uint64_t Result;
+
+    if (Length >= 32) {
+        uint64_t Accum1 = Seed + PRIME64_1 + PRIME64_2;
+        uint64_t Accum2 = Seed + PRIME64_2;
+        uint64_t Accum3 = Seed;
+        uint64_t Accum4 = Seed - PRIME64_1;
+        size_t Remaining = Length;
+
+        while (Remaining >= 32) {
+            Accum1 = Round64(Accum1, Read64(Data));
+            Accum2 = Round64(Accum2, Read64(Data + 8));
+            Accum3 = Round64(Accum3, Read64(Data + 16));
+            Accum4 = Round64(Accum4, Read64(Data + 24));
+            Data += 32;
+            Remaining -= 32;
+        }
+
+        Result = ((Accum1 << 1) | (Accum1 >> 63)) + ((Accum2 << 7) | (Accum2 >> 57)) +
+                 ((Accum3 << 12) | (Accum3 >> 52)) + ((Accum4 << 18) | (Accum4 >> 46));
+        Result = MergeRound64(Result, Accum1);
+        Result = MergeRound64(Result, Accum2);
+        Result = MergeRound64(Result, Accum3);
+        Result = MergeRound64(Result, Accum4);
+    } else {
+        Result = Seed + PRIME64_5;
+    }
+
+    Result += Length;
+    Length &= 31;
+
+    while (Length >= 8) {
+        Result ^= Round64(0, Read64(Data));
+        Result = ((Result << 27) | (Result >> 37)) * PRIME64_1 + PRIME64_4;
+        Data += 8;
+        Length -= 8;
+    }
+
+    if (Length >= 4) {
+        Result ^= Read32(Data) * PRIME64_1;
+        Result = ((Result << 23) | (Result >> 41)) * PRIME64_2 + PRIME64_3;
+        Data += 4;
+        Length -= 4;
+    }
+
+    while (Length--) {
+        Result ^= *(Data++) * PRIME64_5;
+        Result = ((Result << 11) | (Result >> 53)) * PRIME64_1;
+    }
+
+    Result ^= Result >> 33;
+    Result *= PRIME64_2;
+    Result ^= Result >> 29;
+    Result *= PRIME64_3;
+    Result ^= Result >> 32;
+
+    return Result;
+}
@@ -0,0 +1,396 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/hashtable.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#endif /* ARCH_amd64 */
+
+/* Slots are split into groups of 16, with one control byte per slot; Full slots store the low 7
+ * bits of the hash in their control byte, while free slots have the high bit set. This lets us
+ * check a whole group for possible matches with a single compare. */
+#define GROUP_SIZE 16
+#define CONTROL_EMPTY 0x80
+#define CONTROL_DELETED 0xFE
+#define MIN_CAPACITY GROUP_SIZE
+
+/* Resizing doesn't move everything at once; Each insert/remove moves this many groups from the
+ * previous storage into the current one, so that no single operation pays for the whole table. */
+#define MIGRATION_GROUPS 4
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function finds all control bytes in a group that match the given value.
+ *
+ * PARAMETERS:
+ *     Control - Start of the group.
+ *     Value - Which control byte we're looking for.
+ *
+ * RETURN VALUE:
+ *     Bitmask of the matching slots.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint32_t MatchGroup(const uint8_t *Control, uint8_t Value) {
+#ifdef ARCH_amd64
+    __m128i Group = _mm_loadu_si128((const __m128i *)Control);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(Group, _mm_set1_epi8(Value)));
+#else
+    uint32_t Mask = 0;
+
+    for (int i = 0; i < GROUP_SIZE; i++) {
+        if (Control[i] == Value) {
+            Mask |= 1 << i;
+        }
+    }
+
+    return Mask;
+#endif /* ARCH_amd64 */
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function finds all free (empty or deleted) slots in a group.
+ *
+ * PARAMETERS:
+ *     Control - Start of the group.
+ *
+ * RETURN VALUE:
+ *     Bitmask of the free slots.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint32_t MatchFree(const uint8_t *Control) {
+#ifdef ARCH_amd64
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)Control));
+#else
+    uint32_t Mask = 0;
+
+    for (int i = 0; i < GROUP_SIZE; i++) {
+        if (Control[i] & 0x80) {
+            Mask |= 1 << i;
+        }
+    }
+
+    return Mask;
+#endif /* ARCH_amd64 */
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for an entry inside the given storage.
+ *
+ * PARAMETERS:
+ *     Table - Table the storage belongs to.
+ *     Storage - Which storage to search in.
+ *     Hash - Hash of the key.
+ *     Key - Key to be compared against the entries.
+ *
+ * RETURN VALUE:
+ *     Slot index of the entry, or SIZE_MAX if we didn't find it.
+ *-----------------------------------------------------------------------------------------------*/
+static size_t
+FindSlot(RtHashTable *Table, RtHashStorage *Storage, uint64_t Hash, const void *Key) {
+    if (!Storage->Capacity) {
+        return SIZE_MAX;
+    }
+
+    /* Triangular probing over a power of two amount of groups visits every group exactly once. */
+    size_t Mask = Storage->Capacity / GROUP_SIZE - 1;
+    size_t Group = (Hash >> 7) & Mask;
+
+    for (size_t Step = 1; Step <= Mask + 1; Step++) {
+        const uint8_t *Control = Storage->Control + Group * GROUP_SIZE;
+        uint32_t Matches = MatchGroup(Control, Hash & 0x7F);
+
+        while (Matches) {
+            size_t Slot = Group * GROUP_SIZE + __builtin_ctz(Matches);
+            RtHashEntry *Entry = Storage->Slots[Slot];
+
+            if (Entry->Hash == Hash && Table->Compare(Entry, Key)) {
+                return Slot;
+            }
+
+            Matches &= Matches - 1;
+        }
+
+        /* Inserts always take the first free slot in the probe sequence, so an empty slot means
+         * the entry can't be any further ahead. */
+        if (MatchGroup(Control, CONTROL_EMPTY)) {
+            break;
+        }
+
+        Group = (Group + Step) & Mask;
+    }
+
+    return SIZE_MAX;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function places an entry in the first free slot of its probe sequence. The caller is
+ *     responsible for making sure there is a free slot.
+ *
+ * PARAMETERS:
+ *     Storage - Which storage to insert into.
+ *     Entry - Entry to be inserted.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void InsertSlot(RtHashStorage *Storage, RtHashEntry *Entry) {
+    size_t Mask = Storage->Capacity / GROUP_SIZE - 1;
+    size_t Group = (Entry->Hash >> 7) & Mask;
+
+    for (size_t Step = 1;; Step++) {
+        uint8_t *Control = Storage->Control + Group * GROUP_SIZE;
+        uint32_t Matches = MatchFree(Control);
+
+        if (Matches) {
+            size_t Index = __builtin_ctz(Matches);
+
+            if (Control[Index] == CONTROL_EMPTY) {
+                Storage->Used++;
+            }
+
+            Control[Index] = Entry->Hash & 0x7F;
+            Storage->Slots[Group * GROUP_SIZE + Index] = Entry;
+            return;
+        }
+
+        Group = (Group + Step) & Mask;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function frees up a slot.
+ *
+ * PARAMETERS:
+ *     Storage - Which storage the slot belongs to.
+ *     Slot - Index of the slot.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void RemoveSlot(RtHashStorage *Storage, size_t Slot) {
+    uint8_t *Control = Storage->Control + (Slot & ~(size_t)(GROUP_SIZE - 1));
+
+    /* If the group still has an empty slot, no probe sequence ever went past it, and we can mark
+     * the slot as empty (instead of leaving a tombstone behind). */
+    if (MatchGroup(Control, CONTROL_EMPTY)) {
+        Storage->Control[Slot] = CONTROL_EMPTY;
+        Storage->Used--;
+    } else {
+        Storage->Control[Slot] = CONTROL_DELETED;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function moves some groups from the previous storage into the current one, freeing the
+ *     previous storage once it has been fully moved.
+ *
+ * PARAMETERS:
+ *     Table - Which table to work on.
+ *     Groups - How many groups to move.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void Migrate(RtHashTable *Table, size_t Groups) {
+    RtHashStorage *Previous = &Table->Previous;
+
+    while (Previous->Capacity && Groups--) {
+        size_t Base = Table->MigrationGroup * GROUP_SIZE;
+
+        /* Moved entries become tombstones, as other entries still in the previous storage might
+         * have probed past them. */
+        for (size_t Slot = Base; Slot < Base + GROUP_SIZE; Slot++) {
+            if (!(Previous->Control[Slot] & 0x80)) {
+                InsertSlot(&Table->Current, Previous->Slots[Slot]);
+                Previous->Control[Slot] = CONTROL_DELETED;
+            }
+        }
+
+        if (++Table->MigrationGroup * GROUP_SIZE >= Previous->Capacity) {
+            Table->Free(Previous->Slots);
+            Previous->Slots = NULL;
+            Previous->Control = NULL;
+            Previous->Capacity = 0;
+            Previous->Used = 0;
+            Table->MigrationGroup = 0;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function starts moving the table into new storage; We grow it if it's getting full,
+ *     or rebuild it at the same size if it's mostly tombstones.
+ *
+ * PARAMETERS:
+ *     Table - Which table to resize.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+static int Resize(RtHashTable *Table) {
+    /* We only keep one migration going at a time; This should be rare, as migrations finish well
+     * before the new storage fills up. */
+    Migrate(Table, SIZE_MAX);
+
+    size_t Capacity = Table->Current.Capacity;
+    if (!Capacity) {
+        Capacity = MIN_CAPACITY;
+    } else if (Table->Count + 1 > Capacity * 7 / 16) {
+        Capacity *= 2;
+    }
+
+    RtHashEntry **Slots = Table->Allocate(Capacity * (sizeof(RtHashEntry *) + 1));
+    if (!Slots) {
+        return 0;
+    }
+
+    uint8_t *Control = (uint8_t *)(Slots + Capacity);
+    for (size_t i = 0; i < Capacity; i++) {
+        Control[i] = CONTROL_EMPTY;
+    }
+
+    Table->Previous = Table->Current;
+    Table->Current.Slots = Slots;
+    Table->Current.Control = Control;
+    Table->Current.Capacity = Capacity;
+    Table->Current.Used = 0;
+    Table->MigrationGroup = 0;
+
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes an empty hash table. No memory is allocated until the first
+ *     insert.
+ *
+ * PARAMETERS:
+ *     Table - Table to be initialized.
+ *     Compare - Callback to check if an entry matches a key; Should return non-zero if so.
+ *     Allocate - Callback to allocate the table's storage.
+ *     Free - Callback to free the table's storage.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInitializeHashTable(
+    RtHashTable *Table,
+    RtHashCompareFn Compare,
+    RtHashAllocateFn Allocate,
+    RtHashFreeFn Free) {
+    *Table = (RtHashTable)RT_HASH_TABLE_INITIALIZER(Compare, Allocate, Free);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function frees the table's storage, leaving it empty. The entries themselves are owned
+ *     by the caller, and are left untouched.
+ *
+ * PARAMETERS:
+ *     Table - Table to be freed.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtFreeHashTable(RtHashTable *Table) {
+    if (Table->Previous.Capacity) {
+        Table->Free(Table->Previous.Slots);
+    }
+
+    if (Table->Current.Capacity) {
+        Table->Free(Table->Current.Slots);
+    }
+
+    RtInitializeHashTable(Table, Table->Compare, Table->Allocate, Table->Free);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts an entry into the hash table. The caller is responsible for making
+ *     sure no entry with the same key is already in the table.
+ *
+ * PARAMETERS:
+ *     Table - Which table to insert into.
+ *     Entry - Header of the entry.
+ *     Hash - Hash of the entry's key.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if we're out of memory.
+ *-----------------------------------------------------------------------------------------------*/
+int RtInsertHashTable(RtHashTable *Table, RtHashEntry *Entry, uint64_t Hash) {
+    Migrate(Table, MIGRATION_GROUPS);
+
+    if (Table->Current.Used + 1 > Table->Current.Capacity * 7 / 8 && !Resize(Table)) {
+        return 0;
+    }
+
+    Entry->Hash = Hash;
+    InsertSlot(&Table->Current, Entry);
+    Table->Count++;
+
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for an entry in the hash table. This doesn't modify the table, so
+ *     multiple lookups can run in parallel (as long as nothing else is modifying the table).
+ *
+ * PARAMETERS:
+ *     Table - Which table to search in.
+ *     Hash - Hash of the key.
+ *     Key - What we're looking for; This is passed as-is into the compare callback.
+ *
+ * RETURN VALUE:
+ *     Header of the entry, or NULL if we didn't find it.
+ *-----------------------------------------------------------------------------------------------*/
+RtHashEntry *RtLookupHashTable(RtHashTable *Table, uint64_t Hash, const void *Key) {
+    size_t Slot = FindSlot(Table, &Table->Current, Hash, Key);
+    if (Slot != SIZE_MAX) {
+        return Table->Current.Slots[Slot];
+    }
+
+    Slot = FindSlot(Table, &Table->Previous, Hash, Key);
+    if (Slot != SIZE_MAX) {
+        return Table->Previous.Slots[Slot];
+    }
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for an entry in the hash table, and removes it.
+ *
+ * PARAMETERS:
+ *     Table - Which table to remove from.
+ *     Hash - Hash of the key.
+ *     Key - What we're looking for; This is passed as-is into the compare callback.
+ *
+ * RETURN VALUE:
+ *     Header of the removed entry, or NULL if we didn't find it.
+ *-----------------------------------------------------------------------------------------------*/
+RtHashEntry *RtRemoveHashTable(RtHashTable *Table, uint64_t Hash, const void *Key) {
+    RtHashStorage *Storage = &Table->Current;
+    size_t Slot = FindSlot(Table, Storage, Hash, Key);
+
+    if (Slot == SIZE_MAX) {
+        Storage = &Table->Previous;
+        Slot = FindSlot(Table, Storage, Hash, Key);
+        if (Slot == SIZE_MAX) {
+            return NULL;
+        }
+    }
+
+    RtHashEntry *Entry = Storage->Slots[Slot];
+    RemoveSlot(Storage, Slot);
+    Table->Count--;
+
+    Migrate(Table, MIGRATION_GROUPS);
+    return Entry;
+}
@@ -7,11 +7,32 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define RT_XXH3_SECRET_SIZE 192
+#define RT_XXH3_BUFFER_SIZE 256
+
+typedef struct {
+    uint64_t Accumulators[8];
+    uint8_t Secret[RT_XXH3_SECRET_SIZE];
+    uint8_t Buffer[RT_XXH3_BUFFER_SIZE];
+    size_t BufferSize;
+    size_t StripesSoFar;
+    uint64_t TotalLength;
+    uint64_t Seed;
+} RtXxh3State;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
 uint32_t RtGetHash(const void *Buffer, size_t Size);
+uint64_t RtGetXxh64Hash(const void *Buffer, size_t Size, uint64_t Seed);
+
+uint64_t RtGetXxh3Hash(const void *Buffer, size_t Size, uint64_t Seed);
+void RtInitializeXxh3State(RtXxh3State *State, uint64_t Seed);
+void RtUpdateXxh3State(RtXxh3State *State, const void *Buffer, size_t Size);
+uint64_t RtGetXxh3Digest(const RtXxh3State *State);
+
+uint32_t RtGetCrc32c(uint32_t Crc, const void *Buffer, size_t Size);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,56 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef _RT_HASHTABLE_H_
+#define _RT_HASHTABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RT_HASH_TABLE_INITIALIZER(CompareFn, AllocateFn, FreeFn) \
+    {.Compare = (CompareFn), .Allocate = (AllocateFn), .Free = (FreeFn)}
+
+typedef struct {
+    uint64_t Hash;
+} RtHashEntry;
+
+typedef int (*RtHashCompareFn)(RtHashEntry *Entry, const void *Key);
+typedef void *(*RtHashAllocateFn)(size_t Size);
+typedef void (*RtHashFreeFn)(void *Base);
+
+typedef struct {
+    RtHashEntry **Slots;
+    uint8_t *Control;
+    size_t Capacity;
+    size_t Used;
+} RtHashStorage;
+
+typedef struct {
+    RtHashStorage Current;
+    RtHashStorage Previous;
+    size_t MigrationGroup;
+    size_t Count;
+    RtHashCompareFn Compare;
+    RtHashAllocateFn Allocate;
+    RtHashFreeFn Free;
+} RtHashTable;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void RtInitializeHashTable(
+    RtHashTable *Table,
+    RtHashCompareFn Compare,
+    RtHashAllocateFn Allocate,
+    RtHashFreeFn Free);
+void RtFreeHashTable(RtHashTable *Table);
+int RtInsertHashTable(RtHashTable *Table, RtHashEntry *Entry, uint64_t Hash);
+RtHashEntry *RtLookupHashTable(RtHashTable *Table, uint64_t Hash, const void *Key);
+RtHashEntry *RtRemoveHashTable(RtHashTable *Table, uint64_t Hash, const void *Key);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _RT_HASHTABLE_H_ */
@@ -18,6 +18,15 @@ typedef struct RtDList {
     struct RtDList *Next, *Prev;
 } RtDList;
 
+/* Header for a lock-free singly linked list; The sequence number gets bumped on every update, so
+ * that a pop racing with a pop+push of the same entry (the ABA problem) fails its compare
+ * exchange instead of corrupting the list. Entries might still get read after being popped by
+ * someone else, so they shouldn't be unmapped while the list is in use. */
+typedef struct {
+    RtSList *Next;
+    uint64_t Sequence;
+} __attribute__((aligned(16))) RtAtomicSList;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -25,6 +34,11 @@ extern "C" {
 void RtPushSList(RtSList *Head, RtSList *Entry);
 RtSList *RtPopSList(RtSList *Head);
 
+void RtPushAtomicSList(RtAtomicSList *Head, RtSList *Entry);
+void RtPushBatchAtomicSList(RtAtomicSList *Head, RtSList *First, RtSList *Last);
+RtSList *RtPopAtomicSList(RtAtomicSList *Head);
+RtSList *RtFlushAtomicSList(RtAtomicSList *Head);
+
 void RtInitializeDList(RtDList *Head);
 void RtPushDList(RtDList *Head, RtDList *Entry);
 void RtAppendDList(RtDList *Head, RtDList *Entry);
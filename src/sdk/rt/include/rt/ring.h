@@ -0,0 +1,56 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef _RT_RING_H_
+#define _RT_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bounded single producer/single consumer ring of pointers. Each side gets its own cache line,
+ * with a cached copy of the other side's index, so that the shared lines only get touched when
+ * the ring looks full (producer) or empty (consumer). */
+typedef struct {
+    void **Buffer;
+    uint64_t Mask;
+    uint64_t Head __attribute__((aligned(64)));
+    uint64_t CachedTail;
+    uint64_t Tail __attribute__((aligned(64)));
+    uint64_t CachedHead;
+} __attribute__((aligned(64))) RtSpscRing;
+
+typedef struct {
+    uint64_t Sequence;
+    void *Value;
+} RtMpmcSlot;
+
+/* Bounded multi producer/multi consumer ring of pointers; Each slot has a sequence number saying
+ * if it's ready to be written or read in the current lap around the ring. */
+typedef struct {
+    RtMpmcSlot *Buffer;
+    uint64_t Mask;
+    uint64_t Head __attribute__((aligned(64)));
+    uint64_t Tail __attribute__((aligned(64)));
+} __attribute__((aligned(64))) RtMpmcRing;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+int RtInitializeSpscRing(RtSpscRing *Ring, void **Buffer, size_t Capacity);
+int RtPushSpscRing(RtSpscRing *Ring, void *Item);
+size_t RtPushBatchSpscRing(RtSpscRing *Ring, void *const *Items, size_t Count);
+int RtPopSpscRing(RtSpscRing *Ring, void **Item);
+size_t RtPopBatchSpscRing(RtSpscRing *Ring, void **Items, size_t Count);
+
+int RtInitializeMpmcRing(RtMpmcRing *Ring, RtMpmcSlot *Buffer, size_t Capacity);
+int RtPushMpmcRing(RtMpmcRing *Ring, void *Item);
+size_t RtPushBatchMpmcRing(RtMpmcRing *Ring, void *const *Items, size_t Count);
+int RtPopMpmcRing(RtMpmcRing *Ring, void **Item);
+size_t RtPopBatchMpmcRing(RtMpmcRing *Ring, void **Items, size_t Count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _RT_RING_H_ */
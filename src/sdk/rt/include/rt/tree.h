@@ -0,0 +1,77 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#ifndef _RT_TREE_H_
+#define _RT_TREE_H_
+
+#include <rt/list.h>
+
+#define RT_TREE_INITIALIZER(CompareFn) {.Compare = (CompareFn)}
+
+/* The same node type is used by both the red-black and the AVL trees; `Balance` is only valid
+ * for AVL trees, and `Red` is only valid for red-black trees. */
+typedef struct RtTreeNode {
+    struct RtTreeNode *Parent, *Left, *Right;
+    union {
+        int Red;
+        int Balance;
+    };
+} RtTreeNode;
+
+/* Should return <0 if Key goes before the Node, 0 if they're equal, and >0 if the Key goes after
+ * the node. */
+typedef int (*RtTreeCompareFn)(const void *Key, RtTreeNode *Node);
+
+/* Called on every node whose subtree changed (children were added/removed/rotated), from the
+ * bottom up; Used to keep per-subtree (augmented) data up to date. */
+typedef void (*RtTreeUpdateFn)(RtTreeNode *Node);
+
+typedef struct {
+    RtTreeNode *Root;
+    RtTreeCompareFn Compare;
+    RtTreeUpdateFn Update;
+} RtTree;
+
+/* Half-open [Start, End) range; MaxEnd is the largest End inside this node's subtree, and is
+ * managed by the interval tree functions. */
+typedef struct {
+    RtTreeNode TreeNode;
+    uint64_t Start;
+    uint64_t End;
+    uint64_t MaxEnd;
+} RtIntervalNode;
+
+typedef struct {
+    RtTree Tree;
+} RtIntervalTree;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void RtInitializeTree(RtTree *Tree, RtTreeCompareFn Compare, RtTreeUpdateFn Update);
+RtTreeNode *RtLookupTree(RtTree *Tree, const void *Key);
+RtTreeNode *RtLookupLowerBoundTree(RtTree *Tree, const void *Key);
+RtTreeNode *RtLookupUpperBoundTree(RtTree *Tree, const void *Key);
+RtTreeNode *RtGetFirstTreeNode(RtTree *Tree);
+RtTreeNode *RtGetLastTreeNode(RtTree *Tree);
+RtTreeNode *RtGetNextTreeNode(RtTreeNode *Node);
+RtTreeNode *RtGetPreviousTreeNode(RtTreeNode *Node);
+
+void RtInsertRbTree(RtTree *Tree, RtTreeNode *Node, const void *Key);
+void RtRemoveRbTree(RtTree *Tree, RtTreeNode *Node);
+
+void RtInsertAvlTree(RtTree *Tree, RtTreeNode *Node, const void *Key);
+void RtRemoveAvlTree(RtTree *Tree, RtTreeNode *Node);
+
+void RtInitializeIntervalTree(RtIntervalTree *Tree);
+void RtInsertIntervalTree(RtIntervalTree *Tree, RtIntervalNode *Node);
+void RtRemoveIntervalTree(RtIntervalTree *Tree, RtIntervalNode *Node);
+RtIntervalNode *RtLookupIntervalTree(RtIntervalTree *Tree, uint64_t Start, uint64_t End);
+RtIntervalNode *RtLookupNextIntervalTree(RtIntervalNode *Node, uint64_t Start, uint64_t End);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _RT_TREE_H_ */
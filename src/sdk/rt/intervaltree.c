@@ -0,0 +1,195 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/tree.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function compares an interval start against the start of a node.
+ *
+ * PARAMETERS:
+ *     Key - Pointer to the start of the interval.
+ *     Node - Tree node of the interval.
+ *
+ * RETURN VALUE:
+ *     <0 if the key goes before the node, 0 if they're equal, >0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int CompareStart(const void *Key, RtTreeNode *Node) {
+    uint64_t Start = *(const uint64_t *)Key;
+    uint64_t NodeStart = CONTAINING_RECORD(Node, RtIntervalNode, TreeNode)->Start;
+    return Start < NodeStart ? -1 : Start > NodeStart;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function recalculates the highest end address inside the given node's subtree.
+ *
+ * PARAMETERS:
+ *     Node - Tree node of the interval.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void UpdateMaxEnd(RtTreeNode *Node) {
+    RtIntervalNode *Interval = CONTAINING_RECORD(Node, RtIntervalNode, TreeNode);
+    uint64_t MaxEnd = Interval->End;
+
+    if (Node->Left) {
+        uint64_t LeftEnd = CONTAINING_RECORD(Node->Left, RtIntervalNode, TreeNode)->MaxEnd;
+        MaxEnd = LeftEnd > MaxEnd ? LeftEnd : MaxEnd;
+    }
+
+    if (Node->Right) {
+        uint64_t RightEnd = CONTAINING_RECORD(Node->Right, RtIntervalNode, TreeNode)->MaxEnd;
+        MaxEnd = RightEnd > MaxEnd ? RightEnd : MaxEnd;
+    }
+
+    Interval->MaxEnd = MaxEnd;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for the leftmost interval inside the given subtree overlapping the
+ *     [Start, End) range.
+ *
+ * PARAMETERS:
+ *     Node - Root of the subtree; Can be NULL.
+ *     Start - First address of the range.
+ *     End - One past the last address of the range.
+ *
+ * RETURN VALUE:
+ *     Overlapping interval, or NULL if none was found.
+ *-----------------------------------------------------------------------------------------------*/
+static RtIntervalNode *FindFirst(RtTreeNode *Node, uint64_t Start, uint64_t End) {
+    while (Node) {
+        RtIntervalNode *Interval = CONTAINING_RECORD(Node, RtIntervalNode, TreeNode);
+
+        if (Interval->MaxEnd <= Start) {
+            return NULL;
+        }
+
+        /* If anything on the left ends after Start, either it overlaps us, or it starts after
+         * End (and so does everything after it); Either way, the answer is on the left. */
+        if (Node->Left &&
+            CONTAINING_RECORD(Node->Left, RtIntervalNode, TreeNode)->MaxEnd > Start) {
+            Node = Node->Left;
+        } else if (Interval->Start >= End) {
+            return NULL;
+        } else if (Interval->End > Start) {
+            return Interval;
+        } else {
+            Node = Node->Right;
+        }
+    }
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes an empty interval tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to be initialized.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInitializeIntervalTree(RtIntervalTree *Tree) {
+    RtInitializeTree(&Tree->Tree, CompareStart, UpdateMaxEnd);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts a new interval into the tree. Start and End should be filled by the
+ *     caller, and shouldn't be changed while the node is inside the tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to insert the interval into.
+ *     Node - Interval to be inserted.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInsertIntervalTree(RtIntervalTree *Tree, RtIntervalNode *Node) {
+    Node->MaxEnd = Node->End;
+    RtInsertRbTree(&Tree->Tree, &Node->TreeNode, &Node->Start);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes an interval from the tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the interval.
+ *     Node - Interval to be removed.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtRemoveIntervalTree(RtIntervalTree *Tree, RtIntervalNode *Node) {
+    RtRemoveRbTree(&Tree->Tree, &Node->TreeNode);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for the first interval (lowest start) overlapping the [Start, End)
+ *     range.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to search in.
+ *     Start - First address of the range.
+ *     End - One past the last address of the range.
+ *
+ * RETURN VALUE:
+ *     Overlapping interval, or NULL if none was found.
+ *-----------------------------------------------------------------------------------------------*/
+RtIntervalNode *RtLookupIntervalTree(RtIntervalTree *Tree, uint64_t Start, uint64_t End) {
+    return FindFirst(Tree->Tree.Root, Start, End);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for the next interval (after the given one, in order) overlapping the
+ *     [Start, End) range. This should be used to iterate after RtLookupIntervalTree().
+ *
+ * PARAMETERS:
+ *     Node - Last interval we found.
+ *     Start - First address of the range.
+ *     End - One past the last address of the range.
+ *
+ * RETURN VALUE:
+ *     Next overlapping interval, or NULL if there are no more.
+ *-----------------------------------------------------------------------------------------------*/
+RtIntervalNode *RtLookupNextIntervalTree(RtIntervalNode *Node, uint64_t Start, uint64_t End) {
+    RtTreeNode *TreeNode = &Node->TreeNode;
+    RtIntervalNode *Result = FindFirst(TreeNode->Right, Start, End);
+    if (Result) {
+        return Result;
+    }
+
+    /* Anything after us on the tree is either an ancestor we're on the left of, or is on the right
+     * subtree of such an ancestor. */
+    while (TreeNode->Parent) {
+        RtTreeNode *Parent = TreeNode->Parent;
+
+        if (TreeNode == Parent->Left) {
+            RtIntervalNode *Interval = CONTAINING_RECORD(Parent, RtIntervalNode, TreeNode);
+
+            if (Interval->Start >= End) {
+                return NULL;
+            } else if (Interval->End > Start) {
+                return Interval;
+            }
+
+            Result = FindFirst(Parent->Right, Start, End);
+            if (Result) {
+                return Result;
+            }
+        }
+
+        TreeNode = Parent;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,297 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/ring.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes an empty single producer/single consumer ring.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to be initialized.
+ *     Buffer - Storage for the ring entries; Should stay valid while the ring is in use.
+ *     Capacity - How many entries the buffer has; Needs to be a power of two.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the capacity is invalid.
+ *-----------------------------------------------------------------------------------------------*/
+int RtInitializeSpscRing(RtSpscRing *Ring, void **Buffer, size_t Capacity) {
+    if (!Capacity || (Capacity & (Capacity - 1))) {
+        return 0;
+    }
+
+    Ring->Buffer = Buffer;
+    Ring->Mask = Capacity - 1;
+    Ring->Head = 0;
+    Ring->CachedTail = 0;
+    Ring->Tail = 0;
+    Ring->CachedHead = 0;
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts a single entry into a single producer/single consumer ring. This
+ *     should only be called by the producer.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to insert the entry into.
+ *     Item - What we're inserting.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the ring is full.
+ *-----------------------------------------------------------------------------------------------*/
+int RtPushSpscRing(RtSpscRing *Ring, void *Item) {
+    return RtPushBatchSpscRing(Ring, &Item, 1) == 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts as many entries as possible (up to Count) into a single
+ *     producer/single consumer ring. This should only be called by the producer.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to insert the entries into.
+ *     Items - What we're inserting.
+ *     Count - How many entries we want to insert.
+ *
+ * RETURN VALUE:
+ *     How many entries were inserted (from the start of the Items array).
+ *-----------------------------------------------------------------------------------------------*/
+size_t RtPushBatchSpscRing(RtSpscRing *Ring, void *const *Items, size_t Count) {
+    uint64_t Tail = Ring->Tail;
+    uint64_t Free = Ring->Mask + 1 - (Tail - Ring->CachedHead);
+
+    if (Free < Count) {
+        Ring->CachedHead = __atomic_load_n(&Ring->Head, __ATOMIC_ACQUIRE);
+        Free = Ring->Mask + 1 - (Tail - Ring->CachedHead);
+        Count = Free < Count ? Free : Count;
+    }
+
+    for (size_t i = 0; i < Count; i++) {
+        Ring->Buffer[(Tail + i) & Ring->Mask] = Items[i];
+    }
+
+    if (Count) {
+        __atomic_store_n(&Ring->Tail, Tail + Count, __ATOMIC_RELEASE);
+    }
+
+    return Count;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes the oldest entry from a single producer/single consumer ring. This
+ *     should only be called by the consumer.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to remove the entry from.
+ *     Item - Output; What we removed.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the ring is empty.
+ *-----------------------------------------------------------------------------------------------*/
+int RtPopSpscRing(RtSpscRing *Ring, void **Item) {
+    return RtPopBatchSpscRing(Ring, Item, 1) == 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes as many entries as possible (up to Count) from a single
+ *     producer/single consumer ring, oldest first. This should only be called by the consumer.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to remove the entries from.
+ *     Items - Output; What we removed.
+ *     Count - How many entries we want to remove.
+ *
+ * RETURN VALUE:
+ *     How many entries were removed.
+ *-----------------------------------------------------------------------------------------------*/
+size_t RtPopBatchSpscRing(RtSpscRing *Ring, void **Items, size_t Count) {
+    uint64_t Head = Ring->Head;
+    uint64_t Used = Ring->CachedTail - Head;
+
+    if (Used < Count) {
+        Ring->CachedTail = __atomic_load_n(&Ring->Tail, __ATOMIC_ACQUIRE);
+        Used = Ring->CachedTail - Head;
+        Count = Used < Count ? Used : Count;
+    }
+
+    for (size_t i = 0; i < Count; i++) {
+        Items[i] = Ring->Buffer[(Head + i) & Ring->Mask];
+    }
+
+    if (Count) {
+        __atomic_store_n(&Ring->Head, Head + Count, __ATOMIC_RELEASE);
+    }
+
+    return Count;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes an empty multi producer/multi consumer ring.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to be initialized.
+ *     Buffer - Storage for the ring entries; Should stay valid while the ring is in use.
+ *     Capacity - How many entries the buffer has; Needs to be a power of two.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the capacity is invalid.
+ *-----------------------------------------------------------------------------------------------*/
+int RtInitializeMpmcRing(RtMpmcRing *Ring, RtMpmcSlot *Buffer, size_t Capacity) {
+    if (!Capacity || (Capacity & (Capacity - 1))) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < Capacity; i++) {
+        Buffer[i].Sequence = i;
+    }
+
+    Ring->Buffer = Buffer;
+    Ring->Mask = Capacity - 1;
+    Ring->Head = 0;
+    Ring->Tail = 0;
+    return 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function claims a range of positions in a multi producer/multi consumer ring. A slot
+ *     is ready for position `Position` when its sequence is `Position + Offset` (0 for producers,
+ *     1 for consumers).
+ *
+ * PARAMETERS:
+ *     Ring - Ring we're working on.
+ *     Index - Either the Head or the Tail index of the ring.
+ *     Offset - Which sequence offset marks a slot as ready for us.
+ *     Count - How many positions we want.
+ *     Position - Output; First position we claimed.
+ *
+ * RETURN VALUE:
+ *     How many positions we claimed (0 if the ring was full/empty).
+ *-----------------------------------------------------------------------------------------------*/
+static size_t ClaimMpmcRing(
+    RtMpmcRing *Ring,
+    uint64_t *Index,
+    uint64_t Offset,
+    size_t Count,
+    uint64_t *Position) {
+    uint64_t Current = __atomic_load_n(Index, __ATOMIC_RELAXED);
+
+    while (1) {
+        size_t Ready = 0;
+        while (Ready < Count && Ready <= Ring->Mask) {
+            RtMpmcSlot *Slot = &Ring->Buffer[(Current + Ready) & Ring->Mask];
+            if (__atomic_load_n(&Slot->Sequence, __ATOMIC_ACQUIRE) != Current + Ready + Offset) {
+                break;
+            }
+
+            Ready++;
+        }
+
+        if (!Ready) {
+            /* The slot either belongs to the previous lap (we're full/empty), or someone already
+             * claimed it and moved the index forward (reload and retry). */
+            RtMpmcSlot *Slot = &Ring->Buffer[Current & Ring->Mask];
+            int64_t Difference =
+                __atomic_load_n(&Slot->Sequence, __ATOMIC_ACQUIRE) - (Current + Offset);
+            if (Difference < 0) {
+                return 0;
+            }
+
+            Current = __atomic_load_n(Index, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if (__atomic_compare_exchange_n(
+                Index, &Current, Current + Ready, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *Position = Current;
+            return Ready;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts a single entry into a multi producer/multi consumer ring.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to insert the entry into.
+ *     Item - What we're inserting.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the ring is full.
+ *-----------------------------------------------------------------------------------------------*/
+int RtPushMpmcRing(RtMpmcRing *Ring, void *Item) {
+    return RtPushBatchMpmcRing(Ring, &Item, 1) == 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts as many entries as possible (up to Count) into a multi
+ *     producer/multi consumer ring; The entries are inserted contiguously.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to insert the entries into.
+ *     Items - What we're inserting.
+ *     Count - How many entries we want to insert.
+ *
+ * RETURN VALUE:
+ *     How many entries were inserted (from the start of the Items array).
+ *-----------------------------------------------------------------------------------------------*/
+size_t RtPushBatchMpmcRing(RtMpmcRing *Ring, void *const *Items, size_t Count) {
+    uint64_t Position;
+    Count = ClaimMpmcRing(Ring, &Ring->Tail, 0, Count, &Position);
+
+    for (size_t i = 0; i < Count; i++) {
+        RtMpmcSlot *Slot = &Ring->Buffer[(Position + i) & Ring->Mask];
+        Slot->Value = Items[i];
+        __atomic_store_n(&Slot->Sequence, Position + i + 1, __ATOMIC_RELEASE);
+    }
+
+    return Count;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes the oldest entry from a multi producer/multi consumer ring.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to remove the entry from.
+ *     Item - Output; What we removed.
+ *
+ * RETURN VALUE:
+ *     1 on success, 0 if the ring is empty.
+ *-----------------------------------------------------------------------------------------------*/
+int RtPopMpmcRing(RtMpmcRing *Ring, void **Item) {
+    return RtPopBatchMpmcRing(Ring, Item, 1) == 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes as many entries as possible (up to Count) from a multi
+ *     producer/multi consumer ring, oldest first.
+ *
+ * PARAMETERS:
+ *     Ring - Ring to remove the entries from.
+ *     Items - Output; What we removed.
+ *     Count - How many entries we want to remove.
+ *
+ * RETURN VALUE:
+ *     How many entries were removed.
+ *-----------------------------------------------------------------------------------------------*/
+size_t RtPopBatchMpmcRing(RtMpmcRing *Ring, void **Items, size_t Count) {
+    uint64_t Position;
+    Count = ClaimMpmcRing(Ring, &Ring->Head, 1, Count, &Position);
+
+    for (size_t i = 0; i < Count; i++) {
+        RtMpmcSlot *Slot = &Ring->Buffer[(Position + i) & Ring->Mask];
+        Items[i] = Slot->Value;
+        __atomic_store_n(&Slot->Sequence, Position + i + Ring->Mask + 1, __ATOMIC_RELEASE);
+    }
+
+    return Count;
+}
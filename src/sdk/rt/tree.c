@@ -0,0 +1,710 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/tree.h>
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes an empty tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to be initialized.
+ *     Compare - Function used to compare a search key against a node.
+ *     Update - Function used to update any augmented data after the tree changes; Can be NULL.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInitializeTree(RtTree *Tree, RtTreeCompareFn Compare, RtTreeUpdateFn Update) {
+    Tree->Root = NULL;
+    Tree->Compare = Compare;
+    Tree->Update = Update;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the leftmost (smallest) node of a subtree.
+ *
+ * PARAMETERS:
+ *     Node - Root of the subtree; Should not be NULL.
+ *
+ * RETURN VALUE:
+ *     Leftmost node.
+ *-----------------------------------------------------------------------------------------------*/
+static RtTreeNode *GetLeftmost(RtTreeNode *Node) {
+    while (Node->Left) {
+        Node = Node->Left;
+    }
+
+    return Node;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the rightmost (largest) node of a subtree.
+ *
+ * PARAMETERS:
+ *     Node - Root of the subtree; Should not be NULL.
+ *
+ * RETURN VALUE:
+ *     Rightmost node.
+ *-----------------------------------------------------------------------------------------------*/
+static RtTreeNode *GetRightmost(RtTreeNode *Node) {
+    while (Node->Right) {
+        Node = Node->Right;
+    }
+
+    return Node;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function makes whoever pointed to `Old` (its parent, or the tree root) point to `New`
+ *     instead. This doesn't update `New->Parent`.
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Old - Node being replaced.
+ *     New - What should take its place; Can be NULL.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void ReplaceChild(RtTree *Tree, RtTreeNode *Old, RtTreeNode *New) {
+    if (!Old->Parent) {
+        Tree->Root = New;
+    } else if (Old->Parent->Left == Old) {
+        Old->Parent->Left = New;
+    } else {
+        Old->Parent->Right = New;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function calls the update function on the given node and all of its ancestors.
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Node - Lowest node whose subtree changed; Can be NULL.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void Propagate(RtTree *Tree, RtTreeNode *Node) {
+    if (!Tree->Update) {
+        return;
+    }
+
+    while (Node) {
+        Tree->Update(Node);
+        Node = Node->Parent;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function rotates the given node to the left (making its right child take its place).
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Node - Node to be rotated.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void RotateLeft(RtTree *Tree, RtTreeNode *Node) {
+    RtTreeNode *Right = Node->Right;
+
+    Node->Right = Right->Left;
+    if (Right->Left) {
+        Right->Left->Parent = Node;
+    }
+
+    Right->Parent = Node->Parent;
+    ReplaceChild(Tree, Node, Right);
+    Right->Left = Node;
+    Node->Parent = Right;
+
+    /* The set of nodes under `Right` is the same that was under `Node` before, so only these two
+     * need to be updated (bottom-up). */
+    if (Tree->Update) {
+        Tree->Update(Node);
+        Tree->Update(Right);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function rotates the given node to the right (making its left child take its place).
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Node - Node to be rotated.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void RotateRight(RtTree *Tree, RtTreeNode *Node) {
+    RtTreeNode *Left = Node->Left;
+
+    Node->Left = Left->Right;
+    if (Left->Right) {
+        Left->Right->Parent = Node;
+    }
+
+    Left->Parent = Node->Parent;
+    ReplaceChild(Tree, Node, Left);
+    Left->Right = Node;
+    Node->Parent = Left;
+
+    if (Tree->Update) {
+        Tree->Update(Node);
+        Tree->Update(Left);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function links a new node as a leaf in the right position of the tree, without any
+ *     rebalancing. Nodes with the same key as existing ones are placed after them.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to insert the node into.
+ *     Node - Node to be inserted.
+ *     Key - Key associated with the node.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void Link(RtTree *Tree, RtTreeNode *Node, const void *Key) {
+    RtTreeNode *Parent = NULL;
+    RtTreeNode **Position = &Tree->Root;
+
+    while (*Position) {
+        Parent = *Position;
+        Position = Tree->Compare(Key, Parent) < 0 ? &Parent->Left : &Parent->Right;
+    }
+
+    Node->Parent = Parent;
+    Node->Left = NULL;
+    Node->Right = NULL;
+    *Position = Node;
+
+    Propagate(Tree, Node);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for the first node (in order) matching the given key.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to search in.
+ *     Key - What we're searching for.
+ *
+ * RETURN VALUE:
+ *     Matching node, or NULL if we didn't find it.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtLookupTree(RtTree *Tree, const void *Key) {
+    RtTreeNode *Node = RtLookupLowerBoundTree(Tree, Key);
+    return Node && !Tree->Compare(Key, Node) ? Node : NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for the first node (in order) that doesn't go before the given key.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to search in.
+ *     Key - What we're searching for.
+ *
+ * RETURN VALUE:
+ *     First node >= Key, or NULL if all nodes go before the key.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtLookupLowerBoundTree(RtTree *Tree, const void *Key) {
+    RtTreeNode *Result = NULL;
+    RtTreeNode *Node = Tree->Root;
+
+    while (Node) {
+        if (Tree->Compare(Key, Node) <= 0) {
+            Result = Node;
+            Node = Node->Left;
+        } else {
+            Node = Node->Right;
+        }
+    }
+
+    return Result;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function searches for the first node (in order) that goes after the given key.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to search in.
+ *     Key - What we're searching for.
+ *
+ * RETURN VALUE:
+ *     First node > Key, or NULL if no node goes after the key.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtLookupUpperBoundTree(RtTree *Tree, const void *Key) {
+    RtTreeNode *Result = NULL;
+    RtTreeNode *Node = Tree->Root;
+
+    while (Node) {
+        if (Tree->Compare(Key, Node) < 0) {
+            Result = Node;
+            Node = Node->Left;
+        } else {
+            Node = Node->Right;
+        }
+    }
+
+    return Result;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the first (smallest) node of the tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to search in.
+ *
+ * RETURN VALUE:
+ *     First node, or NULL if the tree is empty.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtGetFirstTreeNode(RtTree *Tree) {
+    return Tree->Root ? GetLeftmost(Tree->Root) : NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the last (largest) node of the tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to search in.
+ *
+ * RETURN VALUE:
+ *     Last node, or NULL if the tree is empty.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtGetLastTreeNode(RtTree *Tree) {
+    return Tree->Root ? GetRightmost(Tree->Root) : NULL;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the node that comes after the given one (in order).
+ *
+ * PARAMETERS:
+ *     Node - Current node.
+ *
+ * RETURN VALUE:
+ *     Next node, or NULL if this was the last node.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtGetNextTreeNode(RtTreeNode *Node) {
+    if (Node->Right) {
+        return GetLeftmost(Node->Right);
+    }
+
+    while (Node->Parent && Node == Node->Parent->Right) {
+        Node = Node->Parent;
+    }
+
+    return Node->Parent;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the node that comes before the given one (in order).
+ *
+ * PARAMETERS:
+ *     Node - Current node.
+ *
+ * RETURN VALUE:
+ *     Previous node, or NULL if this was the first node.
+ *-----------------------------------------------------------------------------------------------*/
+RtTreeNode *RtGetPreviousTreeNode(RtTreeNode *Node) {
+    if (Node->Left) {
+        return GetRightmost(Node->Left);
+    }
+
+    while (Node->Parent && Node == Node->Parent->Left) {
+        Node = Node->Parent;
+    }
+
+    return Node->Parent;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if the given red-black tree node is red; NULL (leaf) nodes are black.
+ *
+ * PARAMETERS:
+ *     Node - Node to be checked.
+ *
+ * RETURN VALUE:
+ *     1 if the node is red, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static inline int IsRed(RtTreeNode *Node) {
+    return Node && Node->Red;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts a new node into a red-black tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to insert the node into.
+ *     Node - Node to be inserted.
+ *     Key - Key associated with the node.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInsertRbTree(RtTree *Tree, RtTreeNode *Node, const void *Key) {
+    Link(Tree, Node, Key);
+    Node->Red = 1;
+
+    RtTreeNode *Parent;
+    while ((Parent = Node->Parent) && Parent->Red) {
+        /* The root is always black, so a red parent always has a parent of its own. */
+        RtTreeNode *Grandparent = Parent->Parent;
+
+        if (Parent == Grandparent->Left) {
+            RtTreeNode *Uncle = Grandparent->Right;
+
+            if (IsRed(Uncle)) {
+                Parent->Red = 0;
+                Uncle->Red = 0;
+                Grandparent->Red = 1;
+                Node = Grandparent;
+                continue;
+            }
+
+            if (Node == Parent->Right) {
+                RotateLeft(Tree, Parent);
+                Parent = Node;
+            }
+
+            Parent->Red = 0;
+            Grandparent->Red = 1;
+            RotateRight(Tree, Grandparent);
+        } else {
+            RtTreeNode *Uncle = Grandparent->Left;
+
+            if (IsRed(Uncle)) {
+                Parent->Red = 0;
+                Uncle->Red = 0;
+                Grandparent->Red = 1;
+                Node = Grandparent;
+                continue;
+            }
+
+            if (Node == Parent->Left) {
+                RotateRight(Tree, Parent);
+                Parent = Node;
+            }
+
+            Parent->Red = 0;
+            Grandparent->Red = 1;
+            RotateLeft(Tree, Grandparent);
+        }
+
+        break;
+    }
+
+    Tree->Root->Red = 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes a node from a red-black tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Node - Node to be removed.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtRemoveRbTree(RtTree *Tree, RtTreeNode *Node) {
+    RtTreeNode *Child;
+    RtTreeNode *Parent;
+    int RemovedRed;
+
+    if (!Node->Left || !Node->Right) {
+        Child = Node->Left ? Node->Left : Node->Right;
+        Parent = Node->Parent;
+        RemovedRed = Node->Red;
+
+        ReplaceChild(Tree, Node, Child);
+        if (Child) {
+            Child->Parent = Parent;
+        }
+    } else {
+        /* Two children; The in-order successor (which has no left child) takes the place (and
+         * color) of the removed node, so the imbalance happens where the successor was. */
+        RtTreeNode *Successor = GetLeftmost(Node->Right);
+        Child = Successor->Right;
+        RemovedRed = Successor->Red;
+
+        if (Successor->Parent == Node) {
+            Parent = Successor;
+        } else {
+            Parent = Successor->Parent;
+            Parent->Left = Child;
+            if (Child) {
+                Child->Parent = Parent;
+            }
+
+            Successor->Right = Node->Right;
+            Node->Right->Parent = Successor;
+        }
+
+        Successor->Left = Node->Left;
+        Node->Left->Parent = Successor;
+        Successor->Parent = Node->Parent;
+        Successor->Red = Node->Red;
+        ReplaceChild(Tree, Node, Successor);
+    }
+
+    Propagate(Tree, Parent);
+
+    if (RemovedRed) {
+        return;
+    }
+
+    /* We removed a black node, so the path through `Child` is now missing one black node. */
+    while (Child != Tree->Root && !IsRed(Child)) {
+        if (Child == Parent->Left) {
+            RtTreeNode *Sibling = Parent->Right;
+
+            if (Sibling->Red) {
+                Sibling->Red = 0;
+                Parent->Red = 1;
+                RotateLeft(Tree, Parent);
+                Sibling = Parent->Right;
+            }
+
+            if (!IsRed(Sibling->Left) && !IsRed(Sibling->Right)) {
+                Sibling->Red = 1;
+                Child = Parent;
+                Parent = Child->Parent;
+                continue;
+            }
+
+            if (!IsRed(Sibling->Right)) {
+                Sibling->Left->Red = 0;
+                Sibling->Red = 1;
+                RotateRight(Tree, Sibling);
+                Sibling = Parent->Right;
+            }
+
+            Sibling->Red = Parent->Red;
+            Parent->Red = 0;
+            Sibling->Right->Red = 0;
+            RotateLeft(Tree, Parent);
+        } else {
+            RtTreeNode *Sibling = Parent->Left;
+
+            if (Sibling->Red) {
+                Sibling->Red = 0;
+                Parent->Red = 1;
+                RotateRight(Tree, Parent);
+                Sibling = Parent->Left;
+            }
+
+            if (!IsRed(Sibling->Left) && !IsRed(Sibling->Right)) {
+                Sibling->Red = 1;
+                Child = Parent;
+                Parent = Child->Parent;
+                continue;
+            }
+
+            if (!IsRed(Sibling->Left)) {
+                Sibling->Right->Red = 0;
+                Sibling->Red = 1;
+                RotateLeft(Tree, Sibling);
+                Sibling = Parent->Left;
+            }
+
+            Sibling->Red = Parent->Red;
+            Parent->Red = 0;
+            Sibling->Left->Red = 0;
+            RotateRight(Tree, Parent);
+        }
+
+        Child = Tree->Root;
+        break;
+    }
+
+    if (Child) {
+        Child->Red = 0;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function restores the AVL property on a node whose balance factor is +2 or -2.
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Node - Unbalanced node.
+ *
+ * RETURN VALUE:
+ *     New root of the subtree; Its balance factor is 0 if the subtree height decreased.
+ *-----------------------------------------------------------------------------------------------*/
+static RtTreeNode *Rebalance(RtTree *Tree, RtTreeNode *Node) {
+    if (Node->Balance > 0) {
+        RtTreeNode *Right = Node->Right;
+
+        if (Right->Balance < 0) {
+            RtTreeNode *Pivot = Right->Left;
+            RotateRight(Tree, Right);
+            RotateLeft(Tree, Node);
+            Node->Balance = Pivot->Balance > 0 ? -1 : 0;
+            Right->Balance = Pivot->Balance < 0 ? 1 : 0;
+            Pivot->Balance = 0;
+            return Pivot;
+        }
+
+        RotateLeft(Tree, Node);
+
+        /* This can only be 0 during removals (and the subtree height stays the same then). */
+        if (!Right->Balance) {
+            Node->Balance = 1;
+            Right->Balance = -1;
+        } else {
+            Node->Balance = 0;
+            Right->Balance = 0;
+        }
+
+        return Right;
+    } else {
+        RtTreeNode *Left = Node->Left;
+
+        if (Left->Balance > 0) {
+            RtTreeNode *Pivot = Left->Right;
+            RotateLeft(Tree, Left);
+            RotateRight(Tree, Node);
+            Node->Balance = Pivot->Balance < 0 ? 1 : 0;
+            Left->Balance = Pivot->Balance > 0 ? -1 : 0;
+            Pivot->Balance = 0;
+            return Pivot;
+        }
+
+        RotateRight(Tree, Node);
+
+        if (!Left->Balance) {
+            Node->Balance = -1;
+            Left->Balance = 1;
+        } else {
+            Node->Balance = 0;
+            Left->Balance = 0;
+        }
+
+        return Left;
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function inserts a new node into an AVL tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree to insert the node into.
+ *     Node - Node to be inserted.
+ *     Key - Key associated with the node.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInsertAvlTree(RtTree *Tree, RtTreeNode *Node, const void *Key) {
+    Link(Tree, Node, Key);
+    Node->Balance = 0;
+
+    /* Walk up while the subtree height keeps growing; A single (or double) rotation brings the
+     * height back to what it was before the insertion, so we can stop after one. */
+    for (RtTreeNode *Parent = Node->Parent; Parent; Node = Parent, Parent = Parent->Parent) {
+        Parent->Balance += Node == Parent->Left ? -1 : 1;
+
+        if (!Parent->Balance) {
+            break;
+        } else if (Parent->Balance == 2 || Parent->Balance == -2) {
+            Rebalance(Tree, Parent);
+            break;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function removes a node from an AVL tree.
+ *
+ * PARAMETERS:
+ *     Tree - Tree containing the node.
+ *     Node - Node to be removed.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtRemoveAvlTree(RtTree *Tree, RtTreeNode *Node) {
+    RtTreeNode *Parent;
+    int LeftShrunk;
+
+    if (!Node->Left || !Node->Right) {
+        RtTreeNode *Child = Node->Left ? Node->Left : Node->Right;
+        Parent = Node->Parent;
+        LeftShrunk = Parent && Parent->Left == Node;
+
+        ReplaceChild(Tree, Node, Child);
+        if (Child) {
+            Child->Parent = Parent;
+        }
+    } else {
+        RtTreeNode *Successor = GetLeftmost(Node->Right);
+
+        if (Successor->Parent == Node) {
+            Parent = Successor;
+            LeftShrunk = 0;
+        } else {
+            Parent = Successor->Parent;
+            LeftShrunk = 1;
+
+            Parent->Left = Successor->Right;
+            if (Successor->Right) {
+                Successor->Right->Parent = Parent;
+            }
+
+            Successor->Right = Node->Right;
+            Node->Right->Parent = Successor;
+        }
+
+        Successor->Left = Node->Left;
+        Node->Left->Parent = Successor;
+        Successor->Parent = Node->Parent;
+        Successor->Balance = Node->Balance;
+        ReplaceChild(Tree, Node, Successor);
+    }
+
+    Propagate(Tree, Parent);
+
+    /* Walk up while the subtree height keeps shrinking. */
+    while (Parent) {
+        Parent->Balance += LeftShrunk ? 1 : -1;
+
+        RtTreeNode *Subtree = Parent;
+        if (Parent->Balance == 1 || Parent->Balance == -1) {
+            break;
+        } else if (Parent->Balance) {
+            Subtree = Rebalance(Tree, Parent);
+            if (Subtree->Balance) {
+                break;
+            }
+        }
+
+        Parent = Subtree->Parent;
+        LeftShrunk = Parent && Parent->Left == Subtree;
+    }
+}
@@ -0,0 +1,831 @@
+/* SPDX-FileCopyrightText: (C) 2025 ilmmatias
+ * SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <rt/hash.h>
+
+#ifdef ARCH_amd64
+#include <emmintrin.h>
+#ifdef _DLL
+#include <cpuid.h>
+#include <immintrin.h>
+#endif /* _DLL */
+#endif /* ARCH_amd64 */
+
+#define PRIME32_1 0x9E3779B1u
+#define PRIME32_2 0x85EBCA77u
+#define PRIME32_3 0xC2B2AE3Du
+
+#define PRIME64_1 0x9E3779B185EBCA87ull
+#define PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define PRIME64_3 0x165667B19E3779F9ull
+#define PRIME64_4 0x85EBCA77C2B2AE63ull
+#define PRIME64_5 0x27D4EB2F165667C5ull
+
+#define PRIME_MX1 0x165667919E3779F9ull
+#define PRIME_MX2 0x9FB21C651E98DF25ull
+
+/* Long inputs are processed in 64-bytes stripes; Each stripe consumes 8 more bytes of the secret,
+ * and once we run out of it (after a block), the accumulators get scrambled. */
+#define STRIPE_SIZE 64
+#define SECRET_CONSUME_RATE 8
+#define STRIPES_PER_BLOCK ((RT_XXH3_SECRET_SIZE - STRIPE_SIZE) / SECRET_CONSUME_RATE)
+#define BLOCK_SIZE (STRIPE_SIZE * STRIPES_PER_BLOCK)
+#define BUFFER_STRIPES (RT_XXH3_BUFFER_SIZE / STRIPE_SIZE)
+
+#define MIDSIZE_MAX 240
+#define MIDSIZE_START_OFFSET 3
+#define MIDSIZE_LAST_OFFSET 17
+#define SECRET_SIZE_MIN 136
+#define SECRET_LAST_ACCUMULATE_START 7
+#define SECRET_MERGE_START 11
+
+typedef void (*AccumulateFunction)(
+    uint64_t *Accumulators,
+    const uint8_t *Data,
+    const uint8_t *Secret,
+    size_t Stripes);
+
+typedef void (*ScrambleFunction)(uint64_t *Accumulators, const uint8_t *Secret);
+
+static const uint8_t DefaultSecret[RT_XXH3_SECRET_SIZE] __attribute__((aligned(64))) = {
+    0xB8, 0xFE, 0x6C, 0x39, 0x23, 0xA4, 0x4B, 0xBE, 0x7C, 0x01, 0x81, 0x2C, 0xF7, 0x21, 0xAD, 0x1C,
+    0xDE, 0xD4, 0x6D, 0xE9, 0x83, 0x90, 0x97, 0xDB, 0x72, 0x40, 0xA4, 0xA4, 0xB7, 0xB3, 0x67, 0x1F,
+    0xCB, 0x79, 0xE6, 0x4E, 0xCC, 0xC0, 0xE5, 0x78, 0x82, 0x5A, 0xD0, 0x7D, 0xCC, 0xFF, 0x72, 0x21,
+    0xB8, 0x08, 0x46, 0x74, 0xF7, 0x43, 0x24, 0x8E, 0xE0, 0x35, 0x90, 0xE6, 0x81, 0x3A, 0x26, 0x4C,
+    0x3C, 0x28, 0x52, 0xBB, 0x91, 0xC3, 0x00, 0xCB, 0x88, 0xD0, 0x65, 0x8B, 0x1B, 0x53, 0x2E, 0xA3,
+    0x71, 0x64, 0x48, 0x97, 0xA2, 0x0D, 0xF9, 0x4E, 0x38, 0x19, 0xEF, 0x46, 0xA9, 0xDE, 0xAC, 0xD8,
+    0xA8, 0xFA, 0x76, 0x3F, 0xE3, 0x9C, 0x34, 0x3F, 0xF9, 0xDC, 0xBB, 0xC7, 0xC7, 0x0B, 0x4F, 0x1D,
+    0x8A, 0x51, 0xE0, 0x4B, 0xCD, 0xB4, 0x59, 0x31, 0xC8, 0x9F, 0x7E, 0xC9, 0xD9, 0x78, 0x73, 0x64,
+    0xEA, 0xC5, 0xAC, 0x83, 0x34, 0xD3, 0xEB, 0xC3, 0xC5, 0x81, 0xA0, 0xFF, 0xFA, 0x13, 0x63, 0xEB,
+    0x17, 0x0D, 0xDD, 0x51, 0xB7, 0xF0, 0xDA, 0x49, 0xD3, 0x16, 0x55, 0x26, 0x29, 0xD4, 0x68, 0x9E,
+    0x2B, 0x16, 0xBE, 0x58, 0x7D, 0x47, 0xA1, 0xFC, 0x8F, 0xF8, 0xB8, 0xD1, 0x7A, 0xD0, 0x31, 0xCE,
+    0x45, 0xCB, 0x3A, 0x8F, 0x95, 0x16, 0x04, 0x28, 0xAF, 0xD7, 0xFB, 0xCA, 0xBB, 0x4B, 0x40, 0x7E,
+};
+
+static void ResolveAccumulate(
+    uint64_t *Accumulators,
+    const uint8_t *Data,
+    const uint8_t *Secret,
+    size_t Stripes);
+
+#ifdef ARCH_amd64
+static void ScrambleSse2(uint64_t *Accumulators, const uint8_t *Secret);
+static ScrambleFunction Scramble = ScrambleSse2;
+#else
+static void ScrambleScalar(uint64_t *Accumulators, const uint8_t *Secret);
+static ScrambleFunction Scramble = ScrambleScalar;
+#endif /* ARCH_amd64 */
+
+static AccumulateFunction Accumulate = ResolveAccumulate;
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads a 64-bits little endian value from a possibly unaligned address.
+ *
+ * PARAMETERS:
+ *     Data - Where to read from.
+ *
+ * RETURN VALUE:
+ *     Value at the given address.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t Read64(const uint8_t *Data) {
+    uint64_t Value;
+    __builtin_memcpy(&Value, Data, sizeof(uint64_t));
+    return Value;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function reads a 32-bits little endian value from a possibly unaligned address.
+ *
+ * PARAMETERS:
+ *     Data - Where to read from.
+ *
+ * RETURN VALUE:
+ *     Value at the given address.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint32_t Read32(const uint8_t *Data) {
+    uint32_t Value;
+    __builtin_memcpy(&Value, Data, sizeof(uint32_t));
+    return Value;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function multiplies two 64-bits values into a 128-bits result, and folds it back into
+ *     64-bits (by XORing the two halves together).
+ *
+ * PARAMETERS:
+ *     Left - First operand.
+ *     Right - Second operand.
+ *
+ * RETURN VALUE:
+ *     Folded product.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t MultiplyFold64(uint64_t Left, uint64_t Right) {
+    unsigned __int128 Product = (unsigned __int128)Left * Right;
+    return (uint64_t)Product ^ (uint64_t)(Product >> 64);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the XXH64 avalanche step (used by the 1-3 bytes path).
+ *
+ * PARAMETERS:
+ *     Hash - Value to be mixed.
+ *
+ * RETURN VALUE:
+ *     Mixed value.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t Xxh64Avalanche(uint64_t Hash) {
+    Hash ^= Hash >> 33;
+    Hash *= PRIME64_2;
+    Hash ^= Hash >> 29;
+    Hash *= PRIME64_3;
+    Hash ^= Hash >> 32;
+    return Hash;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the (fast) XXH3 avalanche step, for inputs that are already
+ *     somewhat mixed.
+ *
+ * PARAMETERS:
+ *     Hash - Value to be mixed.
+ *
+ * RETURN VALUE:
+ *     Mixed value.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t Avalanche(uint64_t Hash) {
+    Hash ^= Hash >> 37;
+    Hash *= PRIME_MX1;
+    Hash ^= Hash >> 32;
+    return Hash;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the stronger (rrmxmx) avalanche step used by the 4-8 bytes path.
+ *
+ * PARAMETERS:
+ *     Hash - Value to be mixed.
+ *     Length - Size of the input.
+ *
+ * RETURN VALUE:
+ *     Mixed value.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t StrongAvalanche(uint64_t Hash, uint64_t Length) {
+    Hash ^= ((Hash << 49) | (Hash >> 15)) ^ ((Hash << 24) | (Hash >> 40));
+    Hash *= PRIME_MX2;
+    Hash ^= (Hash >> 35) + Length;
+    Hash *= PRIME_MX2;
+    Hash ^= Hash >> 28;
+    return Hash;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hashes inputs of up to 16 bytes.
+ *
+ * PARAMETERS:
+ *     Data - Data to be hashed.
+ *     Length - Size of the data.
+ *     Seed - Seed for the hash.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the data.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t HashSmall(const uint8_t *Data, size_t Length, uint64_t Seed) {
+    const uint8_t *Secret = DefaultSecret;
+
+    if (Length > 8) {
+        uint64_t Low = Read64(Data) ^ ((Read64(Secret + 24) ^ Read64(Secret + 32)) + Seed);
+        uint64_t High =
+            Read64(Data + Length - 8) ^ ((Read64(Secret + 40) ^ Read64(Secret + 48)) - Seed);
+        return Avalanche(
+            Length + __builtin_bswap64(Low) + High + MultiplyFold64(Low, High));
+    } else if (Length >= 4) {
+        Seed ^= (uint64_t)__builtin_bswap32((uint32_t)Seed) << 32;
+        uint64_t Input = Read32(Data + Length - 4) + ((uint64_t)Read32(Data) << 32);
+        uint64_t Flip = (Read64(Secret + 8) ^ Read64(Secret + 16)) - Seed;
+        return StrongAvalanche(Input ^ Flip, Length);
+    } else if (Length) {
+        uint32_t Combined = ((uint32_t)Data[0] << 16) | ((uint32_t)Data[Length >> 1] << 24) |
+                            Data[Length - 1] | ((uint32_t)Length << 8);
+        uint64_t Flip = (Read32(Secret) ^ Read32(Secret + 4)) + Seed;
+        return Xxh64Avalanche(Combined ^ Flip);
+    }
+
+    return Xxh64Avalanche(Seed ^ Read64(Secret + 56) ^ Read64(Secret + 64));
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function mixes 16 bytes of input with 16 bytes of the secret.
+ *
+ * PARAMETERS:
+ *     Data - Input to be mixed.
+ *     Secret - Secret to mix with.
+ *     Seed - Seed for the hash.
+ *
+ * RETURN VALUE:
+ *     Mixed value.
+ *-----------------------------------------------------------------------------------------------*/
+static inline uint64_t Mix16(const uint8_t *Data, const uint8_t *Secret, uint64_t Seed) {
+    return MultiplyFold64(
+        Read64(Data) ^ (Read64(Secret) + Seed), Read64(Data + 8) ^ (Read64(Secret + 8) - Seed));
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hashes inputs between 17 and 240 bytes.
+ *
+ * PARAMETERS:
+ *     Data - Data to be hashed.
+ *     Length - Size of the data.
+ *     Seed - Seed for the hash.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the data.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t HashMedium(const uint8_t *Data, size_t Length, uint64_t Seed) {
+    const uint8_t *Secret = DefaultSecret;
+    uint64_t Accum = Length * PRIME64_1;
+
+    if (Length <= 128) {
+        /* Mix pairs of 16 bytes from both ends of the input, moving inwards. */
+        for (size_t i = 0; i <= (Length - 1) / 32; i++) {
+            Accum += Mix16(Data + 16 * i, Secret + 32 * i, Seed);
+            Accum += Mix16(Data + Length - 16 * (i + 1), Secret + 32 * i + 16, Seed);
+        }
+
+        return Avalanche(Accum);
+    }
+
+    for (size_t i = 0; i < 8; i++) {
+        Accum += Mix16(Data + 16 * i, Secret + 16 * i, Seed);
+    }
+
+    Accum = Avalanche(Accum);
+
+    uint64_t EndAccum =
+        Mix16(Data + Length - 16, Secret + SECRET_SIZE_MIN - MIDSIZE_LAST_OFFSET, Seed);
+    for (size_t i = 8; i < Length / 16; i++) {
+        EndAccum += Mix16(Data + 16 * i, Secret + 16 * (i - 8) + MIDSIZE_START_OFFSET, Seed);
+    }
+
+    return Avalanche(Accum + EndAccum);
+}
+
+#ifdef ARCH_amd64
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function accumulates the given amount of stripes into the accumulators, using SSE2.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Data - Input stripes.
+ *     Secret - Where in the secret the first stripe starts.
+ *     Stripes - How many stripes to process.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void AccumulateSse2(
+    uint64_t *Accumulators,
+    const uint8_t *Data,
+    const uint8_t *Secret,
+    size_t Stripes) {
+    __m128i Accum[4];
+    for (int i = 0; i < 4; i++) {
+        Accum[i] = _mm_loadu_si128((const __m128i *)(Accumulators + i * 2));
+    }
+
+    for (; Stripes; Stripes--, Data += STRIPE_SIZE, Secret += SECRET_CONSUME_RATE) {
+        for (int i = 0; i < 4; i++) {
+            __m128i Input = _mm_loadu_si128((const __m128i *)(Data + i * 16));
+            __m128i Key = _mm_xor_si128(Input, _mm_loadu_si128((const __m128i *)(Secret + i * 16)));
+            __m128i Product = _mm_mul_epu32(Key, _mm_shuffle_epi32(Key, _MM_SHUFFLE(0, 3, 0, 1)));
+            Accum[i] = _mm_add_epi64(Accum[i], _mm_shuffle_epi32(Input, _MM_SHUFFLE(1, 0, 3, 2)));
+            Accum[i] = _mm_add_epi64(Accum[i], Product);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(Accumulators + i * 2), Accum[i]);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function scrambles the accumulators at the end of a block, using SSE2.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Secret - Last stripe of the secret.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void ScrambleSse2(uint64_t *Accumulators, const uint8_t *Secret) {
+    __m128i Prime = _mm_set1_epi32((int)PRIME32_1);
+
+    for (int i = 0; i < 4; i++) {
+        __m128i Accum = _mm_loadu_si128((const __m128i *)(Accumulators + i * 2));
+        Accum = _mm_xor_si128(Accum, _mm_srli_epi64(Accum, 47));
+        Accum = _mm_xor_si128(Accum, _mm_loadu_si128((const __m128i *)(Secret + i * 16)));
+
+        __m128i High = _mm_shuffle_epi32(Accum, _MM_SHUFFLE(0, 3, 0, 1));
+        Accum = _mm_add_epi64(
+            _mm_mul_epu32(Accum, Prime), _mm_slli_epi64(_mm_mul_epu32(High, Prime), 32));
+        _mm_storeu_si128((__m128i *)(Accumulators + i * 2), Accum);
+    }
+}
+
+#ifdef _DLL
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the AVX2 version of AccumulateSse2().
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Data - Input stripes.
+ *     Secret - Where in the secret the first stripe starts.
+ *     Stripes - How many stripes to process.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+__attribute__((target("avx2"))) static void AccumulateAvx2(
+    uint64_t *Accumulators,
+    const uint8_t *Data,
+    const uint8_t *Secret,
+    size_t Stripes) {
+    __m256i Accum[2];
+    for (int i = 0; i < 2; i++) {
+        Accum[i] = _mm256_loadu_si256((const __m256i *)(Accumulators + i * 4));
+    }
+
+    for (; Stripes; Stripes--, Data += STRIPE_SIZE, Secret += SECRET_CONSUME_RATE) {
+        for (int i = 0; i < 2; i++) {
+            __m256i Input = _mm256_loadu_si256((const __m256i *)(Data + i * 32));
+            __m256i Key =
+                _mm256_xor_si256(Input, _mm256_loadu_si256((const __m256i *)(Secret + i * 32)));
+            __m256i Product = _mm256_mul_epu32(Key, _mm256_srli_epi64(Key, 32));
+            Accum[i] = _mm256_add_epi64(
+                Accum[i], _mm256_shuffle_epi32(Input, _MM_SHUFFLE(1, 0, 3, 2)));
+            Accum[i] = _mm256_add_epi64(Accum[i], Product);
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        _mm256_storeu_si256((__m256i *)(Accumulators + i * 4), Accum[i]);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function implements the AVX2 version of ScrambleSse2().
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Secret - Last stripe of the secret.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+__attribute__((target("avx2"))) static void ScrambleAvx2(
+    uint64_t *Accumulators,
+    const uint8_t *Secret) {
+    __m256i Prime = _mm256_set1_epi32((int)PRIME32_1);
+
+    for (int i = 0; i < 2; i++) {
+        __m256i Accum = _mm256_loadu_si256((const __m256i *)(Accumulators + i * 4));
+        Accum = _mm256_xor_si256(Accum, _mm256_srli_epi64(Accum, 47));
+        Accum = _mm256_xor_si256(Accum, _mm256_loadu_si256((const __m256i *)(Secret + i * 32)));
+
+        __m256i High = _mm256_srli_epi64(Accum, 32);
+        Accum = _mm256_add_epi64(
+            _mm256_mul_epu32(Accum, Prime), _mm256_slli_epi64(_mm256_mul_epu32(High, Prime), 32));
+        _mm256_storeu_si256((__m256i *)(Accumulators + i * 4), Accum);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function checks if we can use AVX2 (supported by the processor, and with the YMM state
+ *     enabled by the OS).
+ *
+ * PARAMETERS:
+ *     None.
+ *
+ * RETURN VALUE:
+ *     1 if AVX2 is usable, 0 otherwise.
+ *-----------------------------------------------------------------------------------------------*/
+static int HasAvx2(void) {
+    uint32_t Eax, Ebx, Ecx, Edx;
+
+    __cpuid(0, Eax, Ebx, Ecx, Edx);
+    if (Eax < 7) {
+        return 0;
+    }
+
+    __cpuid(1, Eax, Ebx, Ecx, Edx);
+    if ((Ecx & 0x18000000) != 0x18000000) {
+        return 0;
+    }
+
+    uint32_t LowPart, HighPart;
+    __asm__ volatile("xgetbv" : "=a"(LowPart), "=d"(HighPart) : "c"(0));
+    if ((LowPart & 0x06) != 0x06) {
+        return 0;
+    }
+
+    __cpuid_count(7, 0, Eax, Ebx, Ecx, Edx);
+    return (Ebx & 0x20) != 0;
+}
+#endif /* _DLL */
+#else
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function accumulates the given amount of stripes into the accumulators.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Data - Input stripes.
+ *     Secret - Where in the secret the first stripe starts.
+ *     Stripes - How many stripes to process.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void AccumulateScalar(
+    uint64_t *Accumulators,
+    const uint8_t *Data,
+    const uint8_t *Secret,
+    size_t Stripes) {
+    for (; Stripes; Stripes--, Data += STRIPE_SIZE, Secret += SECRET_CONSUME_RATE) {
+        for (int i = 0; i < 8; i++) {
+            uint64_t Input = Read64(Data + i * 8);
+            uint64_t Key = Input ^ Read64(Secret + i * 8);
+            Accumulators[i ^ 1] += Input;
+            Accumulators[i] += (Key & 0xFFFFFFFF) * (Key >> 32);
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function scrambles the accumulators at the end of a block.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Secret - Last stripe of the secret.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void ScrambleScalar(uint64_t *Accumulators, const uint8_t *Secret) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t Accum = Accumulators[i];
+        Accum ^= Accum >> 47;
+        Accum ^= Read64(Secret + i * 8);
+        Accumulators[i] = Accum * PRIME32_1;
+    }
+}
+#endif /* ARCH_amd64 */
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function picks the best accumulate/scramble routines for the current processor on the
+ *     first call, and forwards the call to the new accumulate routine. All implementations give
+ *     the same results, so it doesn't matter if another thread is still using the old ones.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Data - Input stripes.
+ *     Secret - Where in the secret the first stripe starts.
+ *     Stripes - How many stripes to process.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void ResolveAccumulate(
+    uint64_t *Accumulators,
+    const uint8_t *Data,
+    const uint8_t *Secret,
+    size_t Stripes) {
+#ifdef ARCH_amd64
+    AccumulateFunction Implementation = AccumulateSse2;
+
+#ifdef _DLL
+    if (HasAvx2()) {
+        __atomic_store_n(&Scramble, ScrambleAvx2, __ATOMIC_RELAXED);
+        Implementation = AccumulateAvx2;
+    }
+#endif /* _DLL */
+#else
+    AccumulateFunction Implementation = AccumulateScalar;
+#endif /* ARCH_amd64 */
+
+    __atomic_store_n(&Accumulate, Implementation, __ATOMIC_RELAXED);
+    Implementation(Accumulators, Data, Secret, Stripes);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function sets up the initial value of the accumulators.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void InitializeAccumulators(uint64_t *Accumulators) {
+    Accumulators[0] = PRIME32_3;
+    Accumulators[1] = PRIME64_1;
+    Accumulators[2] = PRIME64_2;
+    Accumulators[3] = PRIME64_3;
+    Accumulators[4] = PRIME64_4;
+    Accumulators[5] = PRIME32_2;
+    Accumulators[6] = PRIME64_5;
+    Accumulators[7] = PRIME32_1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function derives the secret used for long inputs from the seed.
+ *
+ * PARAMETERS:
+ *     Secret - Output buffer (RT_XXH3_SECRET_SIZE bytes).
+ *     Seed - Seed for the hash.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+static void InitializeSecret(uint8_t *Secret, uint64_t Seed) {
+    for (int i = 0; i < RT_XXH3_SECRET_SIZE; i += 16) {
+        uint64_t Low = Read64(DefaultSecret + i) + Seed;
+        uint64_t High = Read64(DefaultSecret + i + 8) - Seed;
+        __builtin_memcpy(Secret + i, &Low, sizeof(uint64_t));
+        __builtin_memcpy(Secret + i + 8, &High, sizeof(uint64_t));
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function merges the accumulators into the final hash.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     Secret - Secret used for the hash.
+ *     Length - Total size of the input.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the input.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t MergeAccumulators(
+    const uint64_t *Accumulators,
+    const uint8_t *Secret,
+    uint64_t Length) {
+    uint64_t Result = Length * PRIME64_1;
+    Secret += SECRET_MERGE_START;
+
+    for (int i = 0; i < 4; i++) {
+        Result += MultiplyFold64(
+            Accumulators[2 * i] ^ Read64(Secret + 16 * i),
+            Accumulators[2 * i + 1] ^ Read64(Secret + 16 * i + 8));
+    }
+
+    return Avalanche(Result);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function accumulates a run of stripes that might cross block boundaries, scrambling
+ *     the accumulators whenever we reach the end of a block.
+ *
+ * PARAMETERS:
+ *     Accumulators - The 8 accumulator lanes.
+ *     StripesSoFar - Input/output; How many stripes of the current block were already consumed.
+ *     Data - Input stripes.
+ *     Stripes - How many stripes to process.
+ *     Secret - Secret used for the hash.
+ *
+ * RETURN VALUE:
+ *     Pointer just past the last consumed stripe.
+ *-----------------------------------------------------------------------------------------------*/
+static const uint8_t *ConsumeStripes(
+    uint64_t *Accumulators,
+    size_t *StripesSoFar,
+    const uint8_t *Data,
+    size_t Stripes,
+    const uint8_t *Secret) {
+    AccumulateFunction AccumulateStripes = __atomic_load_n(&Accumulate, __ATOMIC_RELAXED);
+    size_t BlockStripes = STRIPES_PER_BLOCK - *StripesSoFar;
+    const uint8_t *BlockSecret = Secret + *StripesSoFar * SECRET_CONSUME_RATE;
+
+    if (Stripes >= BlockStripes) {
+        do {
+            AccumulateStripes(Accumulators, Data, BlockSecret, BlockStripes);
+            __atomic_load_n(&Scramble, __ATOMIC_RELAXED)(
+                Accumulators, Secret + RT_XXH3_SECRET_SIZE - STRIPE_SIZE);
+            AccumulateStripes = __atomic_load_n(&Accumulate, __ATOMIC_RELAXED);
+            Data += BlockStripes * STRIPE_SIZE;
+            Stripes -= BlockStripes;
+            BlockStripes = STRIPES_PER_BLOCK;
+            BlockSecret = Secret;
+        } while (Stripes >= STRIPES_PER_BLOCK);
+
+        *StripesSoFar = 0;
+    }
+
+    if (Stripes) {
+        AccumulateStripes(Accumulators, Data, BlockSecret, Stripes);
+        Data += Stripes * STRIPE_SIZE;
+        *StripesSoFar += Stripes;
+    }
+
+    return Data;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function hashes inputs bigger than 240 bytes.
+ *
+ * PARAMETERS:
+ *     Data - Data to be hashed.
+ *     Length - Size of the data.
+ *     Secret - Secret derived from the seed.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the data.
+ *-----------------------------------------------------------------------------------------------*/
+static uint64_t HashLarge(const uint8_t *Data, size_t Length, const uint8_t *Secret) {
+    uint64_t Accumulators[8] __attribute__((aligned(64)));
+    size_t StripesSoFar = 0;
+
+    /* The last stripe always gets processed separately (with a different part of the secret),
+     * even when the input is a multiple of the stripe size. */
+    InitializeAccumulators(Accumulators);
+    ConsumeStripes(Accumulators, &StripesSoFar, Data, (Length - 1) / STRIPE_SIZE, Secret);
+    __atomic_load_n(&Accumulate, __ATOMIC_RELAXED)(
+        Accumulators,
+        Data + Length - STRIPE_SIZE,
+        Secret + RT_XXH3_SECRET_SIZE - STRIPE_SIZE - SECRET_LAST_ACCUMULATE_START,
+        1);
+
+    return MergeAccumulators(Accumulators, Secret, Length);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gives a 64-bits hash of some data, using XXH3. This is considerably faster
+ *     than RtGetHash() and RtGetXxh64Hash() for both small and large inputs.
+ *
+ * PARAMETERS:
+ *     Buffer - Data to be hashed.
+ *     Length - Size of the data.
+ *     Seed - Seed for the hash.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the data.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t RtGetXxh3Hash(const void *Buffer, size_t Length, uint64_t Seed) {
+    if (Length <= 16) {
+        return HashSmall(Buffer, Length, Seed);
+    } else if (Length <= MIDSIZE_MAX) {
+        return HashMedium(Buffer, Length, Seed);
+    } else if (!Seed) {
+        return HashLarge(Buffer, Length, DefaultSecret);
+    }
+
+    uint8_t Secret[RT_XXH3_SECRET_SIZE] __attribute__((aligned(64)));
+    InitializeSecret(Secret, Seed);
+    return HashLarge(Buffer, Length, Secret);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function initializes the state for a streaming XXH3 hash.
+ *
+ * PARAMETERS:
+ *     State - State to be initialized.
+ *     Seed - Seed for the hash.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtInitializeXxh3State(RtXxh3State *State, uint64_t Seed) {
+    InitializeAccumulators(State->Accumulators);
+    InitializeSecret(State->Secret, Seed);
+    State->BufferSize = 0;
+    State->StripesSoFar = 0;
+    State->TotalLength = 0;
+    State->Seed = Seed;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function adds more data into a streaming XXH3 hash.
+ *
+ * PARAMETERS:
+ *     State - State of the hash.
+ *     Buffer - Data to be hashed.
+ *     Length - Size of the data.
+ *
+ * RETURN VALUE:
+ *     None.
+ *-----------------------------------------------------------------------------------------------*/
+void RtUpdateXxh3State(RtXxh3State *State, const void *Buffer, size_t Length) {
+    const uint8_t *Data = Buffer;
+    const uint8_t *End = Data + Length;
+
+    State->TotalLength += Length;
+
+    if (Length <= RT_XXH3_BUFFER_SIZE - State->BufferSize) {
+        __builtin_memcpy(State->Buffer + State->BufferSize, Data, Length);
+        State->BufferSize += Length;
+        return;
+    }
+
+    /* Top off and flush the buffer first. */
+    if (State->BufferSize) {
+        size_t Size = RT_XXH3_BUFFER_SIZE - State->BufferSize;
+        __builtin_memcpy(State->Buffer + State->BufferSize, Data, Size);
+        Data += Size;
+        ConsumeStripes(
+            State->Accumulators,
+            &State->StripesSoFar,
+            State->Buffer,
+            BUFFER_STRIPES,
+            State->Secret);
+        State->BufferSize = 0;
+    }
+
+    /* Process the rest straight from the caller's buffer, but always leave something behind (as
+     * the last stripe needs special handling); We also keep a copy of the last consumed stripe,
+     * in case RtGetXxh3Digest() needs to complete a partial stripe. */
+    if (End - Data > RT_XXH3_BUFFER_SIZE) {
+        Data = ConsumeStripes(
+            State->Accumulators,
+            &State->StripesSoFar,
+            Data,
+            (End - Data - 1) / STRIPE_SIZE,
+            State->Secret);
+        __builtin_memcpy(
+            State->Buffer + RT_XXH3_BUFFER_SIZE - STRIPE_SIZE, Data - STRIPE_SIZE, STRIPE_SIZE);
+    }
+
+    __builtin_memcpy(State->Buffer, Data, End - Data);
+    State->BufferSize = End - Data;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * PURPOSE:
+ *     This function gets the hash of everything fed into a streaming XXH3 hash so far. The state
+ *     is not modified, so more data can still be added afterwards.
+ *
+ * PARAMETERS:
+ *     State - State of the hash.
+ *
+ * RETURN VALUE:
+ *     64-bits hash of the data.
+ *-----------------------------------------------------------------------------------------------*/
+uint64_t RtGetXxh3Digest(const RtXxh3State *State) {
+    if (State->TotalLength <= MIDSIZE_MAX) {
+        return RtGetXxh3Hash(State->Buffer, State->TotalLength, State->Seed);
+    }
+
+    uint64_t Accumulators[8] __attribute__((aligned(64)));
+    uint8_t LastStripe[STRIPE_SIZE];
+    const uint8_t *LastStripePointer;
+
+    __builtin_memcpy(Accumulators, State->Accumulators, sizeof(Accumulators));
+
+    if (State->BufferSize >= STRIPE_SIZE) {
+        size_t StripesSoFar = State->StripesSoFar;
+        ConsumeStripes(
+            Accumulators,
+            &StripesSoFar,
+            State->Buffer,
+            (State->BufferSize - 1) / STRIPE_SIZE,
+            State->Secret);
+        LastStripePointer = State->Buffer + State->BufferSize - STRIPE_SIZE;
+    } else {
+        size_t Size = STRIPE_SIZE - State->BufferSize;
+        __builtin_memcpy(LastStripe, State->Buffer + RT_XXH3_BUFFER_SIZE - Size, Size);
+        __builtin_memcpy(LastStripe + Size, State->Buffer, State->BufferSize);
+        LastStripePointer = LastStripe;
+    }
+
+    __atomic_load_n(&Accumulate, __ATOMIC_RELAXED)(
+        Accumulators,
+        LastStripePointer,
+        State->Secret + RT_XXH3_SECRET_SIZE - STRIPE_SIZE - SECRET_LAST_ACCUMULATE_START,
+        1);
+
+    return MergeAccumulators(Accumulators, State->Secret, State->TotalLength);
+}